@@ -17,6 +17,11 @@
 #include <Engine/TextFormats/INI.h>
 
 class Application {
+private:
+    static void ParseArguments(int argc, char* args[]);
+    static void RunBenchmark();
+    static void WriteJSONString(FILE* f, const char* str);
+
 public:
     static INI*        Settings;
     static float       FPS;
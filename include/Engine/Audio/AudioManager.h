@@ -59,6 +59,8 @@ public:
     static void   AudioUnpauseAll();
     static void   AudioPauseAll();
     static void   AudioStopAll();
+    static void   AudioDecode(StackNode* audio);
+    static int    DecodeThread(void* data);
     static bool   AudioPlayMix(StackNode* audio, Uint8* stream, int len, float volume);
     static void   AudioCallback(void* data, Uint8* stream, int len);
     static void   Dispose();
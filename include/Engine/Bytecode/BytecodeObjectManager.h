@@ -29,10 +29,15 @@ public:
     static HashMap<char*>*      Tokens;
     static vector<char*>        TokensList;
     static SDL_mutex*           GlobalLock;
+    static SDL_SpinLock         GlobalsWriteLock;
+    static SDL_atomic_t         GlobalsReaders;
+    static SDL_SpinLock         ObjectLocks[OBJECT_LOCK_COUNT];
 
     static bool    ThrowError(bool fatal, const char* errorMessage, ...);
     static void    RequestGarbageCollection();
     static void    ForceGarbageCollection();
+    static void    StepGarbageCollection();
+    static void    CollectYoungGarbage();
     static void    ResetStack();
     static void    Init();
     static void    Dispose();
@@ -51,6 +56,12 @@ public:
     static void    FreeValue(VMValue value);
     static bool    Lock();
     static void    Unlock();
+    static void    LockGlobalsRead();
+    static void    UnlockGlobalsRead();
+    static void    LockGlobalsWrite();
+    static void    UnlockGlobalsWrite();
+    static void    LockObject(void* object);
+    static void    UnlockObject(void* object);
     static void    DefineMethod(int index, Uint32 hash);
     static void    DefineNative(ObjClass* klass, const char* name, NativeFn function);
     static void    GlobalLinkInteger(ObjClass* klass, const char* name, int* value);
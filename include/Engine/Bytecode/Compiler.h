@@ -15,21 +15,36 @@ class Compiler;
 
 class Compiler {
 public:
-    static Parser               parser;
-    static Scanner              scanner;
     static ParseRule*           Rules;
-    static vector<ObjFunction*> Functions;
-    static HashMap<Token>*      TokenMap;
     static const char*          Magic;
+    static Uint8                IBCVersion;
+    static Uint32               CodegenRevision;
     static bool                 PrettyPrint;
+    static bool                 DoOptimizations;
     Compiler* Enclosing = NULL;
+    Compiler* TopLevel = NULL;
+    Parser          parser;
+    Scanner         scanner;
     ObjFunction*    Function = NULL;
     int             Type = 0;
-    Local           Locals[0x100];
+    Local           Locals[LOCALS_MAX];
     int             LocalCount = 0;
     int             ScopeDepth = 0;
     vector<Uint32>  ClassHashList;
     vector<Uint32>  ClassExtendedList;
+    int             LocalOpPosition = -1;
+    int             ConstantOpPosition = -1;
+    int             CompareOpPosition = -1;
+    int             JumpTargetPosition = 0;
+    vector<ObjFunction*> Functions;
+    vector<ObjString*>   Strings;
+    HashMap<Token>*      TokenMap = NULL;
+    stack<vector<int>*>         BreakJumpListStack;
+    stack<vector<int>*>         ContinueJumpListStack;
+    stack<vector<switch_case>*> SwitchJumpListStack;
+    stack<int>                  BreakScopeStack;
+    stack<int>                  ContinueScopeStack;
+    stack<int>                  SwitchScopeStack;
 
     Token         MakeToken(int type);
     Token         MakeTokenRaw(int type, const char* message);
@@ -139,6 +154,7 @@ public:
     void          EmitByte(Uint8 byte);
     void          EmitBytes(Uint8 byte1, Uint8 byte2);
     void          EmitUint16(Uint16 value);
+    void          EmitUint24(Uint32 value);
     void          EmitUint32(Uint32 value);
     void          EmitConstant(VMValue value);
     void          EmitLoop(int loopStart);
@@ -147,6 +163,9 @@ public:
     int           EmitJump(Uint8 instruction);
     int           EmitJump(Uint8 instruction, int jump);
     void          PatchJump(int offset);
+    bool          CanFuseInstruction(int position, int length, int opcode);
+    void          EmitAdd();
+    void          EmitCompare(Uint8 compare);
     void          EmitStringHash(char* string);
     void          EmitStringHash(Token token);
     void          EmitReturn();
@@ -157,30 +176,41 @@ public:
     void          StartSwitchJumpList();
     void          EndSwitchJumpList();
     int           FindConstant(VMValue value);
-    Uint8         MakeConstant(VMValue value);
+    int           MakeConstant(VMValue value);
     static void   PrintValue(VMValue value);
     static void   PrintValue(char** buffer, int* buf_start, VMValue value);
     static void   PrintValue(char** buffer, int* buf_start, VMValue value, int indent);
     static void   PrintObject(char** buffer, int* buf_start, VMValue value, int indent);
-    static int    HashInstruction(const char* name, Chunk* chunk, int offset);
+    int           HashInstruction(const char* name, Chunk* chunk, int offset);
     static int    ConstantInstruction(const char* name, Chunk* chunk, int offset);
+    static int    ConstantLongInstruction(const char* name, Chunk* chunk, int offset);
     static int    ConstantInstructionN(const char* name, int n, Chunk* chunk, int offset);
     static int    SimpleInstruction(const char* name, int offset);
     static int    SimpleInstructionN(const char* name, int n, int offset);
     static int    ByteInstruction(const char* name, Chunk* chunk, int offset);
     static int    LocalInstruction(const char* name, Chunk* chunk, int offset);
-    static int    InvokeInstruction(const char* name, Chunk* chunk, int offset);
+    static int    LocalLongInstruction(const char* name, Chunk* chunk, int offset);
+    int           InvokeInstruction(const char* name, Chunk* chunk, int offset);
     static int    JumpInstruction(const char* name, int sign, Chunk* chunk, int offset);
     static int    WithInstruction(const char* name, Chunk* chunk, int offset);
-    static int    DebugInstruction(Chunk* chunk, int offset);
-    static void   DebugChunk(Chunk* chunk, const char* name, int arity);
-    static void   HTML5ConvertChunk(Chunk* chunk, const char* name, int arity);
+    static int    LocalConstantInstruction(const char* name, Chunk* chunk, int offset);
+    static int    CompareJumpInstruction(const char* name, Chunk* chunk, int offset);
+    int           DebugInstruction(Chunk* chunk, int offset);
+    void          DebugChunk(Chunk* chunk, const char* name, int arity);
+    void          HTML5ConvertChunk(Chunk* chunk, const char* name, int arity);
+    static int    GetInstructionLength(Chunk* chunk, int offset);
+    static bool   OptimizeChunk(Chunk* chunk);
     static void   Init();
+    static bool   IsDebugging();
+    static Uint32 GetBuildKey();
     void          Initialize(Compiler* enclosing, int scope, int type);
     bool          Compile(const char* filename, const char* source, const char* output);
     ObjFunction*  FinishCompiler();
     virtual       ~Compiler();
-    static void   Dispose(bool freeTokens);
+    static void   Dispose();
+
+private:
+    static bool   FoldConstants(Uint8 op, VMValue a, VMValue b, VMValue* result);
 };
 
 #endif /* ENGINE_BYTECODE_COMPILER_H */
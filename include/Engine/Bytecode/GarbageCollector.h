@@ -14,14 +14,41 @@
 
 class GarbageCollector {
 public:
+    enum CollectorState {
+        STATE_IDLE = 0,
+        STATE_MARK = 1,
+        STATE_SWEEP = 2,
+    };
+
     static vector<Obj*> GrayList;
     static Obj*         RootObject;
+    static Uint32       State;
+    static Obj*         SweepList;
+    static Obj**        SweepCursor;
+    static Obj*         YoungObject;
+    static size_t       YoungSize;
+    static size_t       NurserySize;
+    static vector<Obj*> RememberedSet;
+    static bool         MinorCollection;
     static size_t       NextGC;
     static size_t       GarbageSize;
     static double       MaxTimeAlotted;
+    static double       CollectionTime;
+    static Uint32       CollectionCount;
     static bool         Print;
 
     static void Collect();
+    static void Step();
+    static bool IsCollecting();
+    static void CollectYoung();
+    static void PromoteYoung();
+    static void ForgetRememberedSet();
+    static void BeginCycle();
+    static void GrayRoots();
+    static void RunUntil(double endTime);
+    static bool MarkSome(double endTime);
+    static bool SweepSome(double endTime);
+    static void WriteBarrier(void* container, VMValue value);
     static void GrayValue(VMValue value);
     static void GrayObject(void* obj);
     static void GrayHashMapItem(Uint32, VMValue value);
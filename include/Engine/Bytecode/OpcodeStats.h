@@ -0,0 +1,30 @@
+#ifndef ENGINE_BYTECODE_OPCODESTATS_H
+#define ENGINE_BYTECODE_OPCODESTATS_H
+
+#define PUBLIC
+#define PRIVATE
+#define PROTECTED
+#define STATIC
+#define VIRTUAL
+#define EXPOSED
+
+
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+#include <Engine/Bytecode/Types.h>
+#include <Engine/Bytecode/VMThread.h>
+
+class OpcodeStats {
+public:
+    static void Init();
+    static int  RegisterNative(ObjClass* klass, const char* name);
+    static void RecordInstruction(VMThread* thread, ObjFunction* function, Uint8 opcode, Uint64 cycles);
+    static void RecordNative(VMThread* thread, ObjNative* native, Uint64 cycles);
+    static bool WriteReport(const char* filename);
+    static void Dispose();
+
+private:
+    static int  GetFunctionID(ObjFunction* function);
+};
+
+#endif /* ENGINE_BYTECODE_OPCODESTATS_H */
@@ -0,0 +1,30 @@
+#ifndef ENGINE_BYTECODE_SCRIPTPROFILER_H
+#define ENGINE_BYTECODE_SCRIPTPROFILER_H
+
+#define PUBLIC
+#define PRIVATE
+#define PROTECTED
+#define STATIC
+#define VIRTUAL
+#define EXPOSED
+
+
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+#include <Engine/Bytecode/VMThread.h>
+
+class ScriptProfiler {
+public:
+    static bool         Running;
+    static SDL_atomic_t Tick;
+
+    static void Start();
+    static void Start(const char* filename);
+    static void Stop();
+    static void Toggle();
+    static void Sample(VMThread* thread);
+    static bool WriteFolded(const char* filename);
+    static void Dispose();
+};
+
+#endif /* ENGINE_BYTECODE_SCRIPTPROFILER_H */
@@ -9,9 +9,20 @@
 #define EXPOSED
 
 
+#include <Engine/Includes/Standard.h>
 #include <Engine/Hashing/CombinedHash.h>
 #include <Engine/Includes/HashMap.h>
 
+struct SourceFileJob {
+    char*          Filename;
+    Uint32         FilenameHash;
+    char*          Source;
+    Uint32         Checksum;
+    bool           Compile;
+    vector<Uint32> ClassHashList;
+    vector<Uint32> ClassExtendedList;
+};
+
 class SourceFileMap {
 public:
     static bool                      Initialized;
@@ -22,6 +33,9 @@ public:
     static void CheckInit();
     static void CheckForUpdate();
     static void Dispose();
+
+private:
+    static void RunJobs(vector<SourceFileJob>* jobs, int phase, int threadCount);
 };
 
 #endif /* ENGINE_BYTECODE_SOURCEFILEMAP_H */
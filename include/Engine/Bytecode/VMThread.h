@@ -40,6 +40,7 @@ public:
     Uint32    ID;
     Uint32    State;
     bool      DebugInfo;
+    Uint32    ProfilerTick;
 
     bool    ThrowError(bool fatal, const char* errorMessage, ...);
     void    PrintStack();
@@ -50,10 +51,14 @@ public:
     void    ResetStack();
     Uint8   ReadByte(CallFrame* frame);
     Uint16  ReadUInt16(CallFrame* frame);
+    Uint32  ReadUInt24(CallFrame* frame);
     Uint32  ReadUInt32(CallFrame* frame);
     Sint16  ReadSInt16(CallFrame* frame);
     Sint32  ReadSInt32(CallFrame* frame);
     VMValue ReadConstant(CallFrame* frame);
+    VMValue ReadConstantLong(CallFrame* frame);
+    int     GetFieldSlot(CallFrame* frame, Table* fields, Uint32 hash);
+    void    CacheFieldSlot(CallFrame* frame, int slot);
     int     RunInstruction();
     void    RunInstructionSet();
     void    RunValue(VMValue value, int argCount);
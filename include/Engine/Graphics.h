@@ -61,6 +61,8 @@ public:
     static int      UpdateYUVTexture(Texture* texture, SDL_Rect* src, Uint8* pixelsY, int pitchY, Uint8* pixelsU, int pitchU, Uint8* pixelsV, int pitchV);
     static void     UnlockTexture(Texture* texture);
     static void     DisposeTexture(Texture* texture);
+    static bool     SupportsPalettes();
+    static bool     SetTexturePalette(Texture* texture, Uint32* palette, int count, int transparentIndex);
     static void     UseShader(void* shader);
     static void     SetTextureInterpolation(bool interpolate);
     static void     Clear();
@@ -83,6 +85,7 @@ public:
     static void     SetBlendColor(float r, float g, float b, float a);
     static void     SetBlendMode(int srcC, int dstC, int srcA, int dstA);
     static void     SetLineWidth(float n);
+    static void     SetFilter(int filter);
     static void     StrokeLine(float x1, float y1, float x2, float y2);
     static void     StrokeCircle(float x, float y, float rad);
     static void     StrokeEllipse(float x, float y, float w, float h);
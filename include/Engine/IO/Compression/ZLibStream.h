@@ -32,7 +32,8 @@ public:
            size_t      Length();
            size_t      ReadBytes(void* data, size_t n);
            size_t      WriteBytes(void* data, size_t n);
-    static void        Decompress(void* dst, size_t dstLen, void* src, size_t srcLen);
+    static bool        Decompress(void* dst, size_t dstLen, void* src, size_t srcLen);
+    static bool        Compress(void* src, size_t srcLen, void** out, size_t* outLen);
 };
 
 #endif /* ENGINE_IO_COMPRESSION_ZLIBSTREAM_H */
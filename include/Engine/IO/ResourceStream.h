@@ -17,8 +17,13 @@ public:
     Uint8* pointer = NULL;
     Uint8* pointer_start = NULL;
     size_t size = 0;
+    bool   owns_memory = false;
+    void*  blocks = NULL;
+    size_t block_size = 0;
+    Uint8* blocks_ready = NULL;
 
     static ResourceStream* New(const char* filename);
+           bool            ReadyBlocks(size_t offset, size_t n);
            void            Close();
            void            Seek(Sint64 offset);
            void            SeekEnd(Sint64 offset);
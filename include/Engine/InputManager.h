@@ -12,6 +12,7 @@
 #include <Engine/Includes/Standard.h>
 #include <Engine/Includes/StandardSDL2.h>
 #include <Engine/Application.h>
+#include <Engine/IO/Stream.h>
 
 class InputManager {
 public:
@@ -26,9 +27,13 @@ public:
     static void* ControllerHaptics[8];
     static SDL_TouchID TouchDevice;
     static void*       TouchStates;
+    static Stream*     ReplayStream;
+    static Stream*     RecordStream;
 
     static void  Init();
     static void  Poll();
+    static bool  StartReplay(const char* filename);
+    static bool  StartRecording(const char* filename);
     static bool  GetControllerAttached(int controller_index);
     static float GetControllerAxis(int controller_index, int index);
     static bool  GetControllerButton(int controller_index, int index);
@@ -53,6 +53,8 @@ public:
     static void     SetUniformTexture(Texture* texture, int uniform_index, int slot);
     static void     Clear();
     static void     Present();
+    static void     GetStateCacheCounters(Uint32* issued, Uint32* skipped);
+    static void     ResetStateCacheCounters();
     static void     SetBlendColor(float r, float g, float b, float a);
     static void     SetBlendMode(int srcC, int dstC, int srcA, int dstA);
     static void     SetLineWidth(float n);
@@ -65,6 +67,8 @@ public:
     static void     FillTriangle(float x1, float y1, float x2, float y2, float x3, float y3);
     static void     FillRectangle(float x, float y, float w, float h);
     static Uint32   CreateTexturedShapeBuffer(float* data, int vertexCount);
+    static void     UpdateTexturedShapeBuffer(Uint32 bufferID, float* data, int vertexCount);
+    static void     DisposeTexturedShapeBuffer(Uint32 bufferID);
     static void     DrawTexturedShapeBuffer(Texture* texture, Uint32 bufferID, int vertexCount);
     static void     DrawTexture(Texture* texture, float sx, float sy, float sw, float sh, float x, float y, float w, float h);
     static void     DrawSprite(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY);
@@ -37,6 +37,7 @@ public:
     float      CachedBlendColors[4];
     Matrix4x4* CachedProjectionMatrix = NULL;
     Matrix4x4* CachedModelViewMatrix = NULL;
+    int        CachedTextureUnits[3];
 
            GLShader(const GLchar** vertexShaderSource, size_t vsSZ, const GLchar** fragmentShaderSource, size_t fsSZ);
            GLShader(Stream* streamVS, Stream* streamFS);
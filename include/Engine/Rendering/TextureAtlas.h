@@ -0,0 +1,30 @@
+#ifndef ENGINE_RENDERING_TEXTUREATLAS_H
+#define ENGINE_RENDERING_TEXTUREATLAS_H
+
+#define PUBLIC
+#define PRIVATE
+#define PROTECTED
+#define STATIC
+#define VIRTUAL
+#define EXPOSED
+
+class Texture;
+
+#include <Engine/Includes/Standard.h>
+#include <Engine/Rendering/Texture.h>
+
+class TextureAtlas {
+public:
+    static bool Enabled;
+    static int  PageSize;
+    static int  MaxSheetSize;
+
+    static void     Init();
+    static Uint32   GetResourceChecksum(const char* filename);
+    static bool     Get(const char* name, Uint32 sourceChecksum, Texture** page, int* x, int* y);
+    static bool     GetSheet(const char* filename, Texture** page, int* x, int* y);
+    static bool     Insert(const char* name, Uint32 sourceChecksum, Uint32* pixels, Uint32 width, Uint32 height, Texture** page, int* x, int* y);
+    static void     Dispose();
+};
+
+#endif /* ENGINE_RENDERING_TEXTUREATLAS_H */
@@ -18,9 +18,11 @@ class ISprite {
 public:
     char              Filename[256];
     bool              Print = false;
-    Texture*          Spritesheets[4];
-    bool              SpritesheetsBorrowed[4];
-    char              SpritesheetsFilenames[128][4];
+    Texture*          Spritesheets[32];
+    bool              SpritesheetsBorrowed[32];
+    char              SpritesheetsFilenames[32][128];
+    int               SpritesheetsOffsetX[32];
+    int               SpritesheetsOffsetY[32];
     int               SpritesheetCount = 0;
     int               CollisionBoxCount = 0;
     vector<Animation> Animations;
@@ -28,6 +30,8 @@ public:
     ISprite();
     ISprite(const char* filename);
     static Texture* AddSpriteSheet(const char* filename);
+    static Texture* AddSpriteSheet(const char* filename, int* offsetX, int* offsetY);
+    static Texture* AddSpriteSheet(const char* filename, Uint32 checksum, Uint32* data, Uint32 width, Uint32 height, int* offsetX, int* offsetY);
     void ReserveAnimationCount(int count);
     void AddAnimation(const char* name, int animationSpeed, int frameToLoop);
     void AddAnimation(const char* name, int animationSpeed, int frameToLoop, int frmAlloc);
@@ -19,8 +19,11 @@ public:
     Texture*          TexturePtr = NULL;
 
     Image(const char* filename);
+    Image(const char* filename, Texture* texture);
     void Dispose();
     ~Image();
+    static Uint32*  LoadPixelsFromResource(const char* filename, Uint32* width, Uint32* height);
+    static Texture* CreateTextureFromPixels(const char* filename, Uint32* data, Uint32 width, Uint32 height);
     static Texture* LoadTextureFromResource(const char* filename);
 };
 
@@ -0,0 +1,42 @@
+#ifndef ENGINE_RESOURCETYPES_RESOURCELOADER_H
+#define ENGINE_RESOURCETYPES_RESOURCELOADER_H
+
+#define PUBLIC
+#define PRIVATE
+#define PROTECTED
+#define STATIC
+#define VIRTUAL
+#define EXPOSED
+
+
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+
+class ResourceLoader {
+public:
+    static int    ThreadCount;
+    static int    FrameBudget;
+
+    enum {
+        TYPE_SPRITE,
+        TYPE_IMAGE,
+        TYPE_SOUND,
+        TYPE_MUSIC,
+    };
+    enum {
+        STATUS_PENDING = 0,
+        STATUS_LOADED = 1,
+        STATUS_FAILED = 2,
+    };
+
+    static void Init();
+    static int  Request(int type, const char* filename, Uint32 unloadPolicy);
+    static int  GetStatus(int handle);
+    static int  GetResult(int handle);
+    static int  GetPendingCount();
+    static void Update();
+    static void DisposeInScope(Uint32 scope);
+    static void Dispose();
+};
+
+#endif /* ENGINE_RESOURCETYPES_RESOURCELOADER_H */
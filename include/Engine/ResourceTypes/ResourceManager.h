@@ -21,6 +21,10 @@ public:
     static void   Init(const char* filename);
     static void   Load(const char* filename);
     static bool   LoadResource(const char* filename, Uint8** out, size_t* size);
+    static bool   MapResource(const char* filename, Uint8** out, size_t* size);
+    static void*  OpenResourceBlocks(const char* filename, size_t* size, size_t* blockSize);
+    static bool   ReadResourceBlock(void* entry, Uint32 index, Uint8* out);
+    static void   CloseResourceBlocks(void* entry);
     static bool   ResourceExists(const char* filename);
     static void   Dispose();
 };
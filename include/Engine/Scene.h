@@ -34,6 +34,8 @@ public:
     static int                   DynamicObjectCount;
     static Entity*               DynamicObjectFirst;
     static Entity*               DynamicObjectLast;
+    static vector<Entity*>       StaticObjectArray;
+    static vector<Entity*>       DynamicObjectArray;
     static int                   PriorityPerLayer;
     static vector<Entity*>*      PriorityLists;
     static ISprite*              TileSprite;
@@ -67,6 +69,7 @@ public:
     static void Add(Entity** first, Entity** last, int* count, Entity* obj);
     static void Remove(Entity** first, Entity** last, int* count, Entity* obj);
     static void Clear(Entity** first, Entity** last, int* count);
+    static void CompactObjectArrays();
     static void AddStatic(ObjectList* objectList, Entity* obj);
     static void AddDynamic(ObjectList* objectList, Entity* obj);
     static void OnEvent(Uint32 event);
@@ -81,10 +84,16 @@ public:
     static void DisposeInScope(Uint32 scope);
     static void Dispose();
     static void Exit();
-    static void UpdateTileBatchAll();
-    static void UpdateTileBatch(int l, int batchx, int batchy);
+    static void SetTileChunksDirty(int l);
+    static void SetTileChunkDirty(int l, int x, int y);
+    static void UpdateTileChunk(SceneLayer* layer, int chunkX, int chunkY);
+    static void RenderTileChunks(int l, View* currentView);
+    static void DisposeTileChunks(SceneLayer* layer);
     static void SetTile(int layer, int x, int y, int tileID, int flip_x, int flip_y, int collA, int collB);
     static int  CollisionAt(int x, int y, int collisionField, int collideSide, int* angle);
+
+private:
+    static vector<Entity*>* GetObjectArray(Entity** first);
 };
 
 #endif /* ENGINE_SCENE_H */
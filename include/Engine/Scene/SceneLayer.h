@@ -37,9 +37,9 @@ public:
     int            ScrollInfosSplitIndexesCount = 0;
     Uint16*        ScrollInfosSplitIndexes = NULL;
     Uint8*         ScrollIndexes = NULL;
-    Uint32         BufferID = 0;
-    int            VertexCount = 0;
-    void*          TileBatches = NULL;
+    void*          TileChunks = NULL;
+    int            TileChunkCountX = 0;
+    int            TileChunkCountY = 0;
     enum {
     FLAGS_COLLIDEABLE = 1,
     FLAGS_NO_REPEAT_X = 2,
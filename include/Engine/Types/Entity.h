@@ -65,6 +65,7 @@ public:
     int          Interactable = true;
     Entity*      PrevEntity = NULL;
     Entity*      NextEntity = NULL;
+    int          SceneIndex = -1;
     ObjectList*  List = NULL;
     Entity*      PrevEntityInList = NULL;
     Entity*      NextEntityInList = NULL;
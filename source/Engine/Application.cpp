@@ -25,16 +25,21 @@ public:
 
 #include <Engine/Bytecode/BytecodeObjectManager.h>
 #include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/OpcodeStats.h>
+#include <Engine/Bytecode/ScriptProfiler.h>
 #include <Engine/Bytecode/SourceFileMap.h>
 #include <Engine/Diagnostics/Clock.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Diagnostics/Memory.h>
 #include <Engine/Filesystem/Directory.h>
+#include <Engine/ResourceTypes/ResourceLoader.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
 #include <Engine/TextFormats/XML/XMLParser.h>
 
 #include <Engine/Media/MediaSource.h>
 #include <Engine/Media/MediaPlayer.h>
+#include <Engine/Rendering/GL/GLRenderer.h>
+#include <Engine/Rendering/TextureAtlas.h>
 
 #if   WIN32
     Platforms Application::Platform = Platforms::Windows;
@@ -70,6 +75,42 @@ char        Application::WindowTitle[256];
 
 char        StartingScene[256];
 
+// Headless benchmark mode (--benchmark <scene>)
+bool        BenchmarkMode = false;
+char        BenchmarkScene[256];
+int         BenchmarkFrames = 600;
+const char* BenchmarkOutput = "benchmark.json";
+const char* InputReplayFile = NULL;
+const char* InputRecordFile = NULL;
+const char* ProfileOutputFile = NULL;
+
+enum {
+    BenchmarkTime_AfterScene,
+    BenchmarkTime_GarbageCollector,
+    BenchmarkTime_Poll,
+    BenchmarkTime_Update,
+    BenchmarkTime_Clear,
+    BenchmarkTime_Render,
+    BenchmarkTime_Present,
+    BenchmarkTime_Frame,
+    BenchmarkTime_COUNT,
+};
+const char* BenchmarkTimeNames[] = {
+    "afterScene",
+    "gc",
+    "poll",
+    "update",
+    "clear",
+    "render",
+    "present",
+    "frame",
+};
+struct BenchmarkFrame {
+    double Times[BenchmarkTime_COUNT];
+    Uint32 Collections;
+    size_t GarbageSize;
+};
+
 ISprite*    DEBUG_fontSprite = NULL;
 void        DEBUG_DrawText(char* text, float x, float y) {
     for (char* i = text; *i; i++) {
@@ -81,6 +122,16 @@ void        DEBUG_DrawText(char* text, float x, float y) {
 PUBLIC STATIC void Application::Init(int argc, char* args[]) {
     Log::Init();
 
+    Application::ParseArguments(argc, args);
+    if (BenchmarkMode) {
+        // NOTE: Only picked when the user hasn't chosen drivers
+        //   themselves, so that a GPU-less machine can still boot.
+        #if defined(LINUX) || defined(UBUNTU)
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+        #endif
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    }
+
     // SDL_SetHint(SDL_HINT_ORIENTATIONS, "LandscapeLeft LandscapeRight Portrait PortraitUpsideDown"); // iOS only
     SDL_SetHint(SDL_HINT_WINDOWS_DISABLE_THREAD_NAMING, "1");
     SDL_SetHint(SDL_HINT_ACCELEROMETER_AS_JOYSTICK, "0");
@@ -96,6 +147,8 @@ PUBLIC STATIC void Application::Init(int argc, char* args[]) {
     SDL_SetEventFilter(Application::HandleAppEvents, NULL);
 
     Application::LoadSettings();
+    if (BenchmarkMode)
+        Graphics::VsyncEnabled = false;
 
     Graphics::ChooseBackend();
 
@@ -108,7 +161,10 @@ PUBLIC STATIC void Application::Init(int argc, char* args[]) {
     Application::Settings->GetInteger("display", "defaultMonitor", &defaultMonitor);
 
     Uint32 window_flags = 0;
-    window_flags |= SDL_WINDOW_SHOWN;
+    if (BenchmarkMode)
+        window_flags |= SDL_WINDOW_HIDDEN;
+    else
+        window_flags |= SDL_WINDOW_SHOWN;
     window_flags |= Graphics::GetWindowFlags();
     if (allowRetina)
         window_flags |= SDL_WINDOW_ALLOW_HIGHDPI;
@@ -133,13 +189,27 @@ PUBLIC STATIC void Application::Init(int argc, char* args[]) {
     // Initialize subsystems
     Math::Init();
     Graphics::Init();
+    TextureAtlas::Init();
     if (argc > 1 && !!strstr(args[1], ".hatch"))
         ResourceManager::Init(args[1]);
     else
         ResourceManager::Init(NULL);
     AudioManager::Init();
+    ResourceLoader::Init();
     InputManager::Init();
     Clock::Init();
+    OpcodeStats::Init();
+
+    if (InputReplayFile)
+        InputManager::StartReplay(InputReplayFile);
+    if (InputRecordFile)
+        InputManager::StartRecording(InputRecordFile);
+    if (ProfileOutputFile)
+        ScriptProfiler::Start(ProfileOutputFile);
+
+    // Benchmarks must replay identically from run to run
+    if (BenchmarkMode)
+        srand(0);
 
     Application::LoadGameConfig();
 
@@ -172,6 +242,32 @@ PUBLIC STATIC void Application::Init(int argc, char* args[]) {
 
     Running = true;
 }
+PRIVATE STATIC void Application::ParseArguments(int argc, char* args[]) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(args[i], "--benchmark") && i + 1 < argc) {
+            BenchmarkMode = true;
+            strncpy(BenchmarkScene, args[++i], sizeof(BenchmarkScene) - 1);
+            BenchmarkScene[sizeof(BenchmarkScene) - 1] = 0;
+        }
+        else if (!strcmp(args[i], "--frames") && i + 1 < argc) {
+            BenchmarkFrames = atoi(args[++i]);
+            if (BenchmarkFrames < 1)
+                BenchmarkFrames = 1;
+        }
+        else if (!strcmp(args[i], "--output") && i + 1 < argc) {
+            BenchmarkOutput = args[++i];
+        }
+        else if (!strcmp(args[i], "--replay-input") && i + 1 < argc) {
+            InputReplayFile = args[++i];
+        }
+        else if (!strcmp(args[i], "--record-input") && i + 1 < argc) {
+            InputRecordFile = args[++i];
+        }
+        else if (!strcmp(args[i], "--profile") && i + 1 < argc) {
+            ProfileOutputFile = args[++i];
+        }
+    }
+}
 
 int     MetricFrameCounterTime = 0;
 
@@ -237,6 +333,14 @@ PUBLIC STATIC void Application::GetPerformanceSnapshot() {
 
         Log::Print(Log::LOG_IMPORTANT, "Garbage Size:");
         Log::Print(Log::LOG_INFO, "%u", (Uint32)GarbageCollector::GarbageSize);
+
+        if (Graphics::Internal.Init == GLRenderer::Init) {
+            Uint32 issued, skipped;
+            GLRenderer::GetStateCacheCounters(&issued, &skipped);
+            GLRenderer::ResetStateCacheCounters();
+            Log::Print(Log::LOG_IMPORTANT, "GL State Changes (since last snapshot):");
+            Log::Print(Log::LOG_INFO, "Issued %u, Skipped %u", issued, skipped);
+        }
     }
 }
 
@@ -258,7 +362,10 @@ PUBLIC STATIC void Application::Run(int argc, char* args[]) {
     Application::Settings->GetInteger("dev", "fastforward", &UpdatesPerFastForward);
 
     Scene::Init();
-    if (argc > 1 && !!strstr(args[1], ".tmx")) {
+    if (BenchmarkMode) {
+        Scene::LoadScene(BenchmarkScene);
+    }
+    else if (argc > 1 && !!strstr(args[1], ".tmx")) {
         char cwd[512];
         if (Directory::GetCurrentWorkingDirectory(cwd, sizeof(cwd))) {
             if (!!strstr(args[1], "/Resources/") || !!strstr(args[1], "\\Resources\\")) {
@@ -294,6 +401,11 @@ PUBLIC STATIC void Application::Run(int argc, char* args[]) {
     Graphics::Clear();
     Graphics::Present();
 
+    if (BenchmarkMode) {
+        Application::RunBenchmark();
+        Running = false;
+    }
+
     SDL_Event e;
     int test = 0;
     while (Running) {
@@ -361,6 +473,13 @@ PUBLIC STATIC void Application::Run(int argc, char* args[]) {
                             }
                             break;
                         }
+                        // Toggle script profiler (dev)
+                        case SDLK_F2: {
+                            if (DevMenu) {
+                                ScriptProfiler::Toggle();
+                            }
+                            break;
+                        }
                         // Print performance snapshot (dev)
                         case SDLK_F3: {
                             if (DevMenu) {
@@ -526,6 +645,7 @@ PUBLIC STATIC void Application::Run(int argc, char* args[]) {
 
         MetricAfterSceneTime = Clock::GetTicks();
         Scene::AfterScene();
+        ResourceLoader::Update();
         MetricAfterSceneTime = Clock::GetTicks() - MetricAfterSceneTime;
 
         if (DoNothing) goto DO_NOTHING;
@@ -823,11 +943,145 @@ PUBLIC STATIC void Application::Run(int argc, char* args[]) {
     Memory::PrintLeak();
 }
 
+PRIVATE STATIC void Application::RunBenchmark() {
+    vector<BenchmarkFrame> frames;
+    frames.reserve(BenchmarkFrames);
+
+    // NOTE: Every frame runs exactly one update with no pacing, so
+    //   anything reading the frame rate sees the target rate.
+    FPS = TargetFPS;
+
+    Log::Print(Log::LOG_IMPORTANT, "Benchmarking \"%s\" for %d frames...", BenchmarkScene, BenchmarkFrames);
+
+    SDL_Event e;
+    double benchmarkStart = Clock::GetTicks();
+    for (int f = 0; f < BenchmarkFrames && Running; f++) {
+        BenchmarkFrame frame;
+        double* times = frame.Times;
+        double frameStart = Clock::GetTicks();
+        double collectionTime = GarbageCollector::CollectionTime;
+        Uint32 collectionCount = GarbageCollector::CollectionCount;
+
+        // Drain events so the OS doesn't consider us hung, but only
+        // honor quitting; all input comes from the replay.
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT)
+                Running = false;
+        }
+
+        times[BenchmarkTime_AfterScene] = Clock::GetTicks();
+        Scene::AfterScene();
+        ResourceLoader::Update();
+        times[BenchmarkTime_AfterScene] = Clock::GetTicks() - times[BenchmarkTime_AfterScene];
+
+        times[BenchmarkTime_Poll] = Clock::GetTicks();
+        InputManager::Poll();
+        times[BenchmarkTime_Poll] = Clock::GetTicks() - times[BenchmarkTime_Poll];
+
+        times[BenchmarkTime_Update] = Clock::GetTicks();
+        Scene::Update();
+        times[BenchmarkTime_Update] = Clock::GetTicks() - times[BenchmarkTime_Update];
+
+        times[BenchmarkTime_Clear] = Clock::GetTicks();
+        Graphics::Clear();
+        times[BenchmarkTime_Clear] = Clock::GetTicks() - times[BenchmarkTime_Clear];
+
+        times[BenchmarkTime_Render] = Clock::GetTicks();
+        Scene::Render();
+        times[BenchmarkTime_Render] = Clock::GetTicks() - times[BenchmarkTime_Render];
+
+        times[BenchmarkTime_Present] = Clock::GetTicks();
+        Graphics::Present();
+        times[BenchmarkTime_Present] = Clock::GetTicks() - times[BenchmarkTime_Present];
+
+        times[BenchmarkTime_Frame] = Clock::GetTicks() - frameStart;
+        times[BenchmarkTime_GarbageCollector] = GarbageCollector::CollectionTime - collectionTime;
+        frame.Collections = GarbageCollector::CollectionCount - collectionCount;
+        frame.GarbageSize = GarbageCollector::GarbageSize;
+        frames.push_back(frame);
+    }
+    double benchmarkTime = Clock::GetTicks() - benchmarkStart;
+
+    Log::Print(Log::LOG_IMPORTANT, "Benchmark finished %d frames in %.3f ms", (int)frames.size(), benchmarkTime);
+
+    FILE* f = fopen(BenchmarkOutput, "w");
+    if (!f) {
+        Log::Print(Log::LOG_ERROR, "Could not open \"%s\" for writing!", BenchmarkOutput);
+        return;
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "    \"scene\": ");
+    Application::WriteJSONString(f, BenchmarkScene);
+    fprintf(f, ",\n");
+    fprintf(f, "    \"replay\": ");
+    if (InputReplayFile)
+        Application::WriteJSONString(f, InputReplayFile);
+    else
+        fprintf(f, "null");
+    fprintf(f, ",\n");
+    fprintf(f, "    \"frameCount\": %d,\n", (int)frames.size());
+    fprintf(f, "    \"timestep\": %.6f,\n", 1000.0 / TargetFPS);
+    fprintf(f, "    \"totalTime\": %.6f,\n", benchmarkTime);
+
+    // Summary of each timing, all in milliseconds
+    fprintf(f, "    \"summary\": {\n");
+    for (int t = 0; t < BenchmarkTime_COUNT; t++) {
+        double total = 0.0, min = 0.0, max = 0.0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            double value = frames[i].Times[t];
+            total += value;
+            if (i == 0 || value < min)
+                min = value;
+            if (i == 0 || value > max)
+                max = value;
+        }
+
+        fprintf(f, "        \"%s\": { \"avg\": %.6f, \"min\": %.6f, \"max\": %.6f, \"total\": %.6f }%s\n",
+            BenchmarkTimeNames[t], frames.size() ? total / frames.size() : 0.0, min, max, total,
+            t + 1 < BenchmarkTime_COUNT ? "," : "");
+    }
+    fprintf(f, "    },\n");
+
+    // Per-frame timings
+    fprintf(f, "    \"frames\": [\n");
+    for (size_t i = 0; i < frames.size(); i++) {
+        BenchmarkFrame* frame = &frames[i];
+        fprintf(f, "        { \"frame\": %d", (int)i);
+        for (int t = 0; t < BenchmarkTime_COUNT; t++) {
+            fprintf(f, ", \"%s\": %.6f", BenchmarkTimeNames[t], frame->Times[t]);
+        }
+        fprintf(f, ", \"collections\": %u, \"garbageSize\": %u }%s\n",
+            frame->Collections, (Uint32)frame->GarbageSize, i + 1 < frames.size() ? "," : "");
+    }
+    fprintf(f, "    ]\n");
+    fprintf(f, "}\n");
+
+    fclose(f);
+
+    Log::Print(Log::LOG_INFO, "Benchmark results written to \"%s\"", BenchmarkOutput);
+}
+PRIVATE STATIC void Application::WriteJSONString(FILE* f, const char* str) {
+    fputc('"', f);
+    for (const char* c = str; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', f);
+        fputc(*c, f);
+    }
+    fputc('"', f);
+}
+
 PUBLIC STATIC void Application::Cleanup() {
+    ScriptProfiler::Dispose();
+    OpcodeStats::Dispose();
+
+    ResourceLoader::Dispose();
     ResourceManager::Dispose();
     AudioManager::Dispose();
     InputManager::Dispose();
 
+    TextureAtlas::Dispose();
+
     Graphics::Dispose();
 
     SDL_DestroyWindow(Application::Window);
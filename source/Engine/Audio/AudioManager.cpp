@@ -81,6 +81,127 @@ Sint16 mZy[2 * 2]; // 2 per channel
 float  mZxF[2 * 2]; // 2 per channel
 float  mZyF[2 * 2]; // 2 per channel
 
+// NOTE: Sounds and music are decoded on their own thread into a
+//   single-producer/single-consumer ring per StackNode, so the audio
+//   callback only ever mixes samples that are already in device format.
+//   AudioManager::Lock() holds both Audio_DecodeLock and the device lock,
+//   so the main thread can change nodes without racing either side.
+#define AUDIO_RING_PERIODS 3
+
+struct SampleRing {
+    Uint8*       Data;
+    int          Size;
+    // Positions run over [0, 2 * Size) so a full ring can be told apart
+    //   from an empty one without wasting a slot.
+    SDL_atomic_t ReadPos;
+    SDL_atomic_t WritePos;
+    SDL_atomic_t Ended;
+};
+
+SDL_Thread*  Audio_DecodeThread = NULL;
+SDL_sem*     Audio_DecodeSemaphore = NULL;
+SDL_mutex*   Audio_DecodeLock = NULL;
+volatile bool Audio_DecodeQuit = false;
+
+SampleRing* Ring_Create(int size) {
+    SampleRing* ring = (SampleRing*)Memory::Calloc(1, sizeof(SampleRing));
+    ring->Data = (Uint8*)Memory::Malloc(size);
+    ring->Size = size;
+    return ring;
+}
+void        Ring_Free(SampleRing* ring) {
+    if (!ring)
+        return;
+
+    Memory::Free(ring->Data);
+    Memory::Free(ring);
+}
+// Only safe while neither the decode thread nor the callback can touch the ring
+void        Ring_Reset(SampleRing* ring) {
+    SDL_AtomicSet(&ring->ReadPos, 0);
+    SDL_AtomicSet(&ring->WritePos, 0);
+    SDL_AtomicSet(&ring->Ended, 0);
+}
+int         Ring_Used(SampleRing* ring, int readPos, int writePos) {
+    int used = writePos - readPos;
+    if (used < 0)
+        used += ring->Size * 2;
+    return used;
+}
+// Producer side
+int         Ring_Writable(SampleRing* ring) {
+    int readPos = SDL_AtomicGet(&ring->ReadPos);
+    SDL_MemoryBarrierAcquire();
+    return ring->Size - Ring_Used(ring, readPos, SDL_AtomicGet(&ring->WritePos));
+}
+void        Ring_Write(SampleRing* ring, Uint8* data, int len) {
+    int writePos = SDL_AtomicGet(&ring->WritePos);
+    int index = writePos % ring->Size;
+    int first = ring->Size - index;
+    if (first > len)
+        first = len;
+
+    memcpy(ring->Data + index, data, first);
+    memcpy(ring->Data, data + first, len - first);
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->WritePos, (writePos + len) % (ring->Size * 2));
+}
+void        Ring_SetEnded(SampleRing* ring) {
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->Ended, 1);
+}
+// Consumer side
+int         Ring_Readable(SampleRing* ring) {
+    int writePos = SDL_AtomicGet(&ring->WritePos);
+    SDL_MemoryBarrierAcquire();
+    return Ring_Used(ring, SDL_AtomicGet(&ring->ReadPos), writePos);
+}
+bool        Ring_IsEnded(SampleRing* ring) {
+    bool ended = SDL_AtomicGet(&ring->Ended) != 0;
+    SDL_MemoryBarrierAcquire();
+    return ended;
+}
+int         Ring_Mix(SampleRing* ring, Uint8* stream, int len, int volume) {
+    int available = Ring_Readable(ring);
+    if (len > available)
+        len = available;
+    if (len == 0)
+        return 0;
+
+    int readPos = SDL_AtomicGet(&ring->ReadPos);
+    int index = readPos % ring->Size;
+    int first = ring->Size - index;
+    if (first > len)
+        first = len;
+
+    SDL_MixAudioFormat(stream, ring->Data + index, AudioManager::DeviceFormat.format, (Uint32)first, volume);
+    if (len > first)
+        SDL_MixAudioFormat(stream + first, ring->Data, AudioManager::DeviceFormat.format, (Uint32)(len - first), volume);
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->ReadPos, (readPos + len) % (ring->Size * 2));
+    return len;
+}
+
+int         Audio_GetPeriodSize() {
+    return AudioManager::DeviceFormat.samples * AudioManager::DeviceFormat.channels * (SDL_AUDIO_BITSIZE(AudioManager::DeviceFormat.format) >> 3);
+}
+void        Audio_PrepareNode(StackNode* audio) {
+    if (!audio->Ring)
+        audio->Ring = Ring_Create(Audio_GetPeriodSize() * AUDIO_RING_PERIODS);
+    Ring_Reset(audio->Ring);
+    SDL_AtomicSet(&audio->Finished, 0);
+}
+void        Audio_DeleteNode(StackNode* audio) {
+    Ring_Free(audio->Ring);
+    delete audio;
+}
+void        Audio_WakeDecoder() {
+    if (Audio_DecodeSemaphore)
+        SDL_SemPost(Audio_DecodeSemaphore);
+}
+
 PUBLIC STATIC void   AudioManager::CalculateCoeffs() {
     double theta = 2.0 * M_PI * mNormalizedFreq; // normalized frequency has been precalculated as fc/fs
     double d = 0.5 * (1.0 / mQuality) * sin(theta);
@@ -204,6 +325,13 @@ PUBLIC STATIC void   AudioManager::Init() {
         AudioQueueMaxSize = 0x1000;
     AudioQueueSize    = 0;
     AudioQueue        = (Uint8*)Memory::Calloc(8, AudioQueueMaxSize);
+
+    Audio_DecodeLock = SDL_CreateMutex();
+    if (AudioEnabled) {
+        Audio_DecodeQuit = false;
+        Audio_DecodeSemaphore = SDL_CreateSemaphore(0);
+        Audio_DecodeThread = SDL_CreateThread(AudioManager::DecodeThread, "AudioManager::DecodeThread", NULL);
+    }
 }
 
 PUBLIC STATIC void   AudioManager::SetSound(int channel, ISound* music) {
@@ -227,8 +355,11 @@ PUBLIC STATIC void   AudioManager::SetSound(int channel, ISound* music, bool loo
     audio->Loop = loop;
     audio->LoopPoint = loopPoint;
     audio->FadeOut = false;
+    Audio_PrepareNode(audio);
 
     AudioManager::Unlock();
+
+    Audio_WakeDecoder();
 }
 
 PUBLIC STATIC void   AudioManager::PushMusic(ISound* music, bool loop, Uint32 lp) {
@@ -250,6 +381,7 @@ PUBLIC STATIC void   AudioManager::PushMusicAt(ISound* music, double at, bool lo
     newms->Loop = loop;
     newms->LoopPoint = lp;
     newms->FadeOut = false;
+    Audio_PrepareNode(newms);
     MusicStack.push_front(newms);
 
     for (size_t i = 1; i < MusicStack.size(); i++)
@@ -259,12 +391,14 @@ PUBLIC STATIC void   AudioManager::PushMusicAt(ISound* music, double at, bool lo
     FadeOutTimerMax = 1.0;
 
     AudioManager::Unlock();
+
+    Audio_WakeDecoder();
 }
 PUBLIC STATIC void   AudioManager::RemoveMusic(ISound* music) {
     AudioManager::Lock();
     for (size_t i = 0; i < MusicStack.size(); i++) {
         if (MusicStack[i]->Audio == music) {
-            delete MusicStack[i];
+            Audio_DeleteNode(MusicStack[i]);
             MusicStack.erase(MusicStack.begin() + i);
         }
     }
@@ -284,7 +418,7 @@ PUBLIC STATIC bool   AudioManager::IsPlayingMusic(ISound* music) {
 PUBLIC STATIC void   AudioManager::ClearMusic() {
     AudioManager::Lock();
     for (size_t i = 0; i < MusicStack.size(); i++) {
-        delete MusicStack[i];
+        Audio_DeleteNode(MusicStack[i]);
     }
     MusicStack.clear();
     AudioManager::Unlock();
@@ -300,10 +434,14 @@ PUBLIC STATIC void   AudioManager::FadeMusic(double seconds) {
 }
 
 PUBLIC STATIC void   AudioManager::Lock() {
+    if (Audio_DecodeLock)
+        SDL_LockMutex(Audio_DecodeLock);
     SDL_LockAudioDevice(Device); //// SDL_LockAudio();
 }
 PUBLIC STATIC void   AudioManager::Unlock() {
     SDL_UnlockAudioDevice(Device); //// SDL_UnlockAudio();
+    if (Audio_DecodeLock)
+        SDL_UnlockMutex(Audio_DecodeLock);
 }
 
 PUBLIC STATIC void   AudioManager::AudioUnpause(int channel) {
@@ -340,6 +478,63 @@ PUBLIC STATIC void   AudioManager::AudioStopAll() {
     AudioManager::Unlock();
 }
 
+PUBLIC STATIC void   AudioManager::AudioDecode(StackNode* audio) {
+    SampleRing* ring = audio->Ring;
+    if (!audio->Audio || !ring || audio->Stopped)
+        return;
+    if (SDL_AtomicGet(&audio->Finished) || SDL_AtomicGet(&ring->Ended))
+        return;
+
+    int period = Audio_GetPeriodSize();
+    while (Ring_Writable(ring) >= period) {
+        int bytes = audio->Audio->RequestSamples(DeviceFormat.samples, audio->Loop, audio->LoopPoint);
+        if (bytes > 0) {
+            Ring_Write(ring, audio->Audio->Buffer, bytes);
+            continue;
+        }
+
+        // Anything else is an error or the conversion stream
+        //   waiting on input, so try again on the next pass.
+        if (bytes == REQUEST_EOF)
+            Ring_SetEnded(ring);
+        break;
+    }
+}
+PUBLIC STATIC int    AudioManager::DecodeThread(void* data) {
+    vector<StackNode*> finished;
+    while (true) {
+        SDL_SemWait(Audio_DecodeSemaphore);
+        if (Audio_DecodeQuit)
+            break;
+
+        SDL_LockMutex(Audio_DecodeLock);
+
+        // The callback can't free nodes without waiting on this
+        //   thread, so played out music is removed here instead.
+        SDL_LockAudioDevice(Device);
+        for (size_t i = 0; i < MusicStack.size(); ) {
+            if (SDL_AtomicGet(&MusicStack[i]->Finished)) {
+                finished.push_back(MusicStack[i]);
+                MusicStack.erase(MusicStack.begin() + i);
+            }
+            else i++;
+        }
+        SDL_UnlockAudioDevice(Device);
+
+        for (size_t i = 0; i < finished.size(); i++)
+            Audio_DeleteNode(finished[i]);
+        finished.clear();
+
+        if (MusicStack.size() > 0)
+            AudioManager::AudioDecode(MusicStack[0]);
+        for (int i = 0; i < SoundArrayLength; i++)
+            AudioManager::AudioDecode(&SoundArray[i]);
+
+        SDL_UnlockMutex(Audio_DecodeLock);
+    }
+    return 0;
+}
+
 PUBLIC STATIC bool   AudioManager::AudioPlayMix(StackNode* audio, Uint8* stream, int len, float volume) {
     if (audio->FadeOut) {
         FadeOutTimer -= (double)DeviceFormat.samples / DeviceFormat.freq;
@@ -350,26 +545,20 @@ PUBLIC STATIC bool   AudioManager::AudioPlayMix(StackNode* audio, Uint8* stream,
         }
     }
 
-    int bytes = audio->Audio->RequestSamples(DeviceFormat.samples, audio->Loop, audio->LoopPoint);
-    switch (bytes) {
-        // End of file
-        case REQUEST_EOF:
-            return true;
-        // Waiting
-        case REQUEST_CONVERTING:
-            break;
-        // Error
-        case REQUEST_ERROR:
-            break;
-        // Normal
-        default:
-            SDL_MixAudioFormat(stream, audio->Audio->Buffer, DeviceFormat.format, (Uint32)bytes, (int)(SDL_MIX_MAXVOLUME * MasterVolume * volume * (FadeOutTimer / FadeOutTimerMax)));
+    SampleRing* ring = audio->Ring;
+    if (!ring)
+        return false;
 
-            // NOTE: In order to time scale, we need some kind of sample queue system,
-            //       and this system needs to intake samples, work a bilinear interpolation
-            //       algorithm on them, and then it can work.
-    }
-    return false;
+    // Read the end flag first, so all samples written before it are seen
+    bool ended = Ring_IsEnded(ring);
+
+    Ring_Mix(ring, stream, len, (int)(SDL_MIX_MAXVOLUME * MasterVolume * volume * (FadeOutTimer / FadeOutTimerMax)));
+
+    // NOTE: In order to time scale, we need some kind of sample queue system,
+    //       and this system needs to intake samples, work a bilinear interpolation
+    //       algorithm on them, and then it can work.
+
+    return ended && Ring_Readable(ring) == 0;
 }
 
 PUBLIC STATIC void   AudioManager::AudioCallback(void* data, Uint8* stream, int len) {
@@ -384,14 +573,19 @@ PUBLIC STATIC void   AudioManager::AudioCallback(void* data, Uint8* stream, int
             memmove(AudioManager::AudioQueue, AudioManager::AudioQueue + len, AudioManager::AudioQueueSize);
     }
 
-    if (MusicStack.size() > 0) {
-        StackNode* audio = MusicStack[0];
-        if (!audio->Paused)
-        if (AudioManager::AudioPlayMix(MusicStack[0], stream, len, MusicVolume)) {
-            delete MusicStack[0];
-            MusicStack.pop_front();
+    // Music that has finished stays on the stack until the decode
+    //   thread removes it.
+    StackNode* music = NULL;
+    for (size_t i = 0; i < MusicStack.size(); i++) {
+        if (!SDL_AtomicGet(&MusicStack[i]->Finished)) {
+            music = MusicStack[i];
+            break;
         }
     }
+    if (music && !music->Paused) {
+        if (AudioManager::AudioPlayMix(music, stream, len, MusicVolume))
+            SDL_AtomicSet(&music->Finished, 1);
+    }
 
     for (int i = 0; i < SoundArrayLength; i++) {
         StackNode* audio = &SoundArray[i];
@@ -404,8 +598,11 @@ PUBLIC STATIC void   AudioManager::AudioCallback(void* data, Uint8* stream, int
         if (audio->Paused)
             continue;
 
+        if (SDL_AtomicGet(&audio->Finished))
+            continue;
+
         if (AudioManager::AudioPlayMix(audio, stream, len, SoundVolume)) {
-            audio->Stopped = true;
+            SDL_AtomicSet(&audio->Finished, 1);
         }
     }
 
@@ -432,12 +629,36 @@ PUBLIC STATIC void   AudioManager::AudioCallback(void* data, Uint8* stream, int
             }
         }
     }
+
+    Audio_WakeDecoder();
 }
 
 PUBLIC STATIC void   AudioManager::Dispose() {
-    Memory::Free(SoundArray);
-    Memory::Free(AudioQueue);
+    if (Audio_DecodeThread) {
+        Audio_DecodeQuit = true;
+        SDL_SemPost(Audio_DecodeSemaphore);
+        SDL_WaitThread(Audio_DecodeThread, NULL);
+        Audio_DecodeThread = NULL;
+    }
 
     SDL_PauseAudioDevice(Device, 1); // SDL_PauseAudio(1); //
     SDL_CloseAudioDevice(Device); // SDL_CloseAudio(); //
+
+    for (size_t i = 0; i < MusicStack.size(); i++)
+        Audio_DeleteNode(MusicStack[i]);
+    MusicStack.clear();
+
+    for (int i = 0; i < SoundArrayLength; i++)
+        Ring_Free(SoundArray[i].Ring);
+    Memory::Free(SoundArray);
+    Memory::Free(AudioQueue);
+
+    if (Audio_DecodeSemaphore) {
+        SDL_DestroySemaphore(Audio_DecodeSemaphore);
+        Audio_DecodeSemaphore = NULL;
+    }
+    if (Audio_DecodeLock) {
+        SDL_DestroyMutex(Audio_DecodeLock);
+        Audio_DecodeLock = NULL;
+    }
 }
@@ -2,14 +2,20 @@
 #define ENGINE_AUDIO_STACKNODE_H
 
 class ISound;
+struct SampleRing;
 
 struct StackNode {
-    ISound*  Audio = NULL;
-    bool     Loop = false;
-    Uint32   LoopPoint = 0;
-    bool     FadeOut = false;
-    bool     Paused = false;
-    bool     Stopped = false;
+    ISound*      Audio = NULL;
+    bool         Loop = false;
+    Uint32       LoopPoint = 0;
+    bool         FadeOut = false;
+    bool         Paused = false;
+    bool         Stopped = false;
+
+    // Decoded samples waiting to be mixed, filled by the decode thread
+    SampleRing*  Ring = NULL;
+    // Set by the audio callback once the node has played out
+    SDL_atomic_t Finished = { 0 };
 };
 
 #endif /* ENGINE_AUDIO_STACKNODE_H */
@@ -256,7 +256,9 @@ bool _TestCollision(BytecodeObject* other, BytecodeObject* self) {
         other->Y + other->HitboxH / 2.0f >= self->Y - self->HitboxH / 2.0f &&
         other->X - other->HitboxW / 2.0f  < self->X + self->HitboxW / 2.0f &&
         other->Y - other->HitboxH / 2.0f  < self->Y + self->HitboxH / 2.0f) {
+        BytecodeObjectManager::LockGlobalsWrite();
         BytecodeObjectManager::Globals->Put("other", OBJECT_VAL(other->Instance));
+        BytecodeObjectManager::UnlockGlobalsWrite();
         return true;
     }
     return false;
@@ -24,12 +24,16 @@ public:
     static vector<char*>        TokensList;
 
     static SDL_mutex*           GlobalLock;
+    static SDL_SpinLock         GlobalsWriteLock;
+    static SDL_atomic_t         GlobalsReaders;
+    static SDL_SpinLock         ObjectLocks[OBJECT_LOCK_COUNT];
 };
 #endif
 
 #include <Engine/Bytecode/BytecodeObjectManager.h>
 #include <Engine/Bytecode/BytecodeObject.h>
 #include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/OpcodeStats.h>
 #include <Engine/Bytecode/StandardLibrary.h>
 #include <Engine/Bytecode/SourceFileMap.h>
 #include <Engine/Diagnostics/Log.h>
@@ -59,6 +63,9 @@ HashMap<char*>*      BytecodeObjectManager::Tokens = NULL;
 vector<char*>        BytecodeObjectManager::TokensList;
 
 SDL_mutex*           BytecodeObjectManager::GlobalLock = NULL;
+SDL_SpinLock         BytecodeObjectManager::GlobalsWriteLock = 0;
+SDL_atomic_t         BytecodeObjectManager::GlobalsReaders = { 0 };
+SDL_SpinLock         BytecodeObjectManager::ObjectLocks[OBJECT_LOCK_COUNT];
 
 PUBLIC STATIC bool    BytecodeObjectManager::ThrowError(bool fatal, const char* errorMessage, ...) {
     va_list args;
@@ -72,14 +79,19 @@ PUBLIC STATIC void    BytecodeObjectManager::RequestGarbageCollection() {
     #ifdef DEBUG_STRESS_GC
         ForceGarbageCollection();
     #endif
-    if (GarbageCollector::GarbageSize > GarbageCollector::NextGC) {
+    // NOTE: Once a cycle has started, keep giving it a slice of time
+    //   every time we're asked, until it's done.
+    if (GarbageCollector::IsCollecting() || GarbageCollector::GarbageSize > GarbageCollector::NextGC) {
         size_t startSize = GarbageCollector::GarbageSize;
 
-        ForceGarbageCollection();
+        StepGarbageCollection();
 
         // startSize = GarbageCollector::GarbageSize - startSize;
         // Log::Print(Log::LOG_INFO, "Freed garbage from %u to %u (%d), next GC at %d", (Uint32)startSize, (Uint32)GarbageCollector::GarbageSize, GarbageCollector::GarbageSize - startSize, GarbageCollector::NextGC);
     }
+    else if (GarbageCollector::YoungSize > GarbageCollector::NurserySize) {
+        CollectYoungGarbage();
+    }
 }
 PUBLIC STATIC void    BytecodeObjectManager::ForceGarbageCollection() {
     if (BytecodeObjectManager::Lock()) {
@@ -94,6 +106,32 @@ PUBLIC STATIC void    BytecodeObjectManager::ForceGarbageCollection() {
     }
 }
 
+PUBLIC STATIC void    BytecodeObjectManager::StepGarbageCollection() {
+    if (BytecodeObjectManager::Lock()) {
+        if (BytecodeObjectManager::ThreadCount > 1) {
+            BytecodeObjectManager::Unlock();
+            return;
+        }
+
+        GarbageCollector::Step();
+
+        BytecodeObjectManager::Unlock();
+    }
+}
+
+PUBLIC STATIC void    BytecodeObjectManager::CollectYoungGarbage() {
+    if (BytecodeObjectManager::Lock()) {
+        if (BytecodeObjectManager::ThreadCount > 1) {
+            BytecodeObjectManager::Unlock();
+            return;
+        }
+
+        GarbageCollector::CollectYoung();
+
+        BytecodeObjectManager::Unlock();
+    }
+}
+
 PUBLIC STATIC void    BytecodeObjectManager::ResetStack() {
     Threads[0].ResetStack();
 }
@@ -110,6 +148,7 @@ PUBLIC STATIC void    BytecodeObjectManager::Init() {
         Tokens = new HashMap<char*>(NULL, 64);
 
     GarbageCollector::RootObject = NULL;
+    GarbageCollector::YoungObject = NULL;
     GarbageCollector::NextGC = 1024 * 1024;
 
     GlobalLock = SDL_CreateMutex();
@@ -226,6 +265,9 @@ PUBLIC STATIC void    BytecodeObjectManager::FreeGlobalValue(Uint32 hash, VMValu
                 for (size_t i = 0; i < function->Chunk.Constants->size(); i++)
                     FreeValue((*function->Chunk.Constants)[i]);
 
+                if (function->Chunk.PropertyCache)
+                    Memory::Free(function->Chunk.PropertyCache);
+
                 GarbageCollector::GarbageSize -= sizeof(ObjFunction);
                 Memory::Free(function);
                 break;
@@ -342,7 +384,7 @@ PUBLIC STATIC VMValue BytecodeObjectManager::Concatenate(VMValue va, VMValue vb)
     memcpy(result->Chars, a->Chars, a->Length);
     memcpy(result->Chars + a->Length, b->Chars, b->Length);
     result->Chars[length] = 0;
-    return OBJECT_VAL(result);
+    return OBJECT_VAL(InternString(result));
 }
 
 PUBLIC STATIC bool    BytecodeObjectManager::ValuesSortaEqual(VMValue a, VMValue b) {
@@ -356,6 +398,8 @@ PUBLIC STATIC bool    BytecodeObjectManager::ValuesSortaEqual(VMValue a, VMValue
     if (IS_STRING(a) && IS_STRING(b)) {
         ObjString* astr = AS_STRING(a);
         ObjString* bstr = AS_STRING(b);
+        if (astr == bstr)
+            return true;
         return astr->Length == bstr->Length && !memcmp(astr->Chars, bstr->Chars, astr->Length);
     }
 
@@ -435,6 +479,12 @@ PUBLIC STATIC void    BytecodeObjectManager::FreeValue(VMValue value) {
             }
             case OBJ_STRING: {
                 ObjString* string = AS_STRING(value);
+
+                // NOTE: Strings can be freed outside of a collection (ie.
+                //   when globals are disposed), so drop the intern entry here.
+                if (Strings && Strings->Exists(string->Hash) && AS_STRING(Strings->Get(string->Hash)) == string)
+                    Strings->Remove(string->Hash);
+
                 if (string->Chars != NULL)
                     Memory::Free(string->Chars);
                 string->Chars = NULL;
@@ -473,6 +523,13 @@ PUBLIC STATIC void    BytecodeObjectManager::FreeValue(VMValue value) {
                 Memory::Free(map);
                 break;
             }
+            case OBJ_TYPED_ARRAY: {
+                ObjTypedArray* array = AS_TYPED_ARRAY(value);
+
+                GarbageCollector::GarbageSize -= sizeof(ObjTypedArray) + (size_t)array->Length * array->ElementSize;
+                Memory::Free(array);
+                break;
+            }
             default:
                 break;
         }
@@ -487,11 +544,41 @@ PUBLIC STATIC bool    BytecodeObjectManager::Lock() {
 PUBLIC STATIC void    BytecodeObjectManager::Unlock() {
     SDL_UnlockMutex(GlobalLock);
 }
+// NOTE: The globals and object locks below are leaf locks: they may be
+//   taken while holding GlobalLock, but nothing may be locked while
+//   holding one of them, and they are not re-entrant.
+PUBLIC STATIC void    BytecodeObjectManager::LockGlobalsRead() {
+    // Any number of readers; a waiting writer holds the write lock,
+    // which stops new readers from coming in.
+    SDL_AtomicLock(&GlobalsWriteLock);
+    SDL_AtomicIncRef(&GlobalsReaders);
+    SDL_AtomicUnlock(&GlobalsWriteLock);
+}
+PUBLIC STATIC void    BytecodeObjectManager::UnlockGlobalsRead() {
+    SDL_AtomicAdd(&GlobalsReaders, -1);
+}
+PUBLIC STATIC void    BytecodeObjectManager::LockGlobalsWrite() {
+    SDL_AtomicLock(&GlobalsWriteLock);
+    // Readers only hold the lock for a lookup, but one may have been
+    //   preempted, so yield instead of spinning flat out.
+    while (SDL_AtomicGet(&GlobalsReaders) > 0)
+        SDL_Delay(0);
+}
+PUBLIC STATIC void    BytecodeObjectManager::UnlockGlobalsWrite() {
+    SDL_AtomicUnlock(&GlobalsWriteLock);
+}
+PUBLIC STATIC void    BytecodeObjectManager::LockObject(void* object) {
+    SDL_AtomicLock(&ObjectLocks[((uintptr_t)object >> 4) & (OBJECT_LOCK_COUNT - 1)]);
+}
+PUBLIC STATIC void    BytecodeObjectManager::UnlockObject(void* object) {
+    SDL_AtomicUnlock(&ObjectLocks[((uintptr_t)object >> 4) & (OBJECT_LOCK_COUNT - 1)]);
+}
 
 PUBLIC STATIC void    BytecodeObjectManager::DefineMethod(int index, Uint32 hash) {
     VMValue method = OBJECT_VAL(FunctionList[index]);
     ObjClass* klass = AS_CLASS(Threads[0].Peek(0)); // AS_CLASS(Peek(1));
     klass->Methods->Put(hash, method);
+    GarbageCollector::WriteBarrier(klass, method);
     Threads[0].Pop();
     // Pop();
 }
@@ -500,7 +587,11 @@ PUBLIC STATIC void    BytecodeObjectManager::DefineNative(ObjClass* klass, const
     if (klass == NULL) return;
     if (name == NULL) return;
 
-    klass->Methods->Put(name, OBJECT_VAL(NewNative(function)));
+    ObjNative* native = NewNative(function);
+    #ifdef VM_OPCODE_STATS
+    native->StatsID = OpcodeStats::RegisterNative(klass, name);
+    #endif
+    klass->Methods->Put(name, OBJECT_VAL(native));
 }
 PUBLIC STATIC void    BytecodeObjectManager::GlobalLinkInteger(ObjClass* klass, const char* name, int* value) {
     if (name == NULL) return;
@@ -598,9 +689,16 @@ PUBLIC STATIC void    BytecodeObjectManager::RunFromIBC(Uint8* head, size_t size
 
     bool doLineNumbers;
 
+    // NOTE: Version 0 files are a subset of version 1 (no wide operand
+    //   opcodes), so both load the same way.
+    Uint8 version = *head++;
+    if (version > Compiler::IBCVersion) {
+        Log::Print(Log::LOG_ERROR, "Unsupported bytecode version %d! (Expected %d or lower)", version, Compiler::IBCVersion);
+        return;
+    }
+
     Uint8 opts;
     opts = *head++;
-    opts = *head++;
     doLineNumbers = opts;
     opts = *head++;
     opts = *head++;
@@ -623,6 +721,8 @@ PUBLIC STATIC void    BytecodeObjectManager::RunFromIBC(Uint8* head, size_t size
         function->Chunk.Code = head;
         head += count * 1;
 
+        ChunkAllocPropertyCache(&function->Chunk);
+
         if (doLineNumbers) {
             function->Chunk.Lines = (int*)head;
             head += count * 4;
@@ -4,22 +4,41 @@
 
 class Compiler {
 public:
-    static Parser               parser;
-    static Scanner              scanner;
     static ParseRule*           Rules;
-    static vector<ObjFunction*> Functions;
-    static HashMap<Token>*      TokenMap;
     static const char*          Magic;
+    static Uint8                IBCVersion;
+    static Uint32               CodegenRevision;
     static bool                 PrettyPrint;
+    static bool                 DoOptimizations;
 
     class Compiler* Enclosing = NULL;
+    class Compiler* TopLevel = NULL;
+    Parser          parser;
+    Scanner         scanner;
     ObjFunction*    Function = NULL;
     int             Type = 0;
-    Local           Locals[0x100];
+    Local           Locals[LOCALS_MAX];
     int             LocalCount = 0;
     int             ScopeDepth = 0;
     vector<Uint32>  ClassHashList;
     vector<Uint32>  ClassExtendedList;
+    int             LocalOpPosition = -1;
+    int             ConstantOpPosition = -1;
+    int             CompareOpPosition = -1;
+    int             JumpTargetPosition = 0;
+
+    // Only used by the top-level compiler of a file
+    vector<ObjFunction*> Functions;
+    vector<ObjString*>   Strings;
+    // Shared with the enclosing compiler
+    HashMap<Token>*      TokenMap = NULL;
+
+    stack<vector<int>*>         BreakJumpListStack;
+    stack<vector<int>*>         ContinueJumpListStack;
+    stack<vector<switch_case>*> SwitchJumpListStack;
+    stack<int>                  BreakScopeStack;
+    stack<int>                  ContinueScopeStack;
+    stack<int>                  SwitchScopeStack;
 };
 #endif
 
@@ -34,14 +53,51 @@ public:
 
 #include <Engine/Application.h>
 
-Parser               Compiler::parser;
-Scanner              Compiler::scanner;
 ParseRule*           Compiler::Rules = NULL;
-vector<ObjFunction*> Compiler::Functions;
-HashMap<Token>*      Compiler::TokenMap = NULL;
 const char*          Compiler::Magic = "HTVM";
+// NOTE: Version 1 added the wide operand opcodes (OP_CONSTANT_LONG and
+//   friends); the file layout is otherwise the same as version 0.
+Uint8                Compiler::IBCVersion = 1;
+// NOTE: Bump this whenever the compiler or optimizer changes the bytecode
+//   it emits for the same source, even if the file layout (IBCVersion)
+//   stays the same. It keys the bytecode cache, so stale entries are
+//   never reused.
+Uint32               Compiler::CodegenRevision = 1;
 bool                 Compiler::PrettyPrint = true;
-vector<ObjString*>   Strings;
+#ifdef DEBUG
+bool                 Compiler::DoOptimizations = false;
+#else
+bool                 Compiler::DoOptimizations = true;
+#endif
+
+// Read once in Compiler::Init, since files may be compiled on several threads
+bool                 Compiler_DebugOutput = false;
+bool                 Compiler_OptimizeBytecode = false;
+
+// NOTE: Functions and strings made while compiling are freed along with
+//   the compiler and never reach the VM, so they are kept out of the
+//   garbage collector's object lists. That also lets several files
+//   compile at the same time.
+ObjString*   Compiler_AllocString(int length) {
+    ObjString* string = (ObjString*)Memory::Calloc(1, sizeof(ObjString));
+    string->Object.Type = OBJ_STRING;
+    string->Length = length;
+    string->Chars = (char*)Memory::Malloc(length + 1);
+    string->Chars[length] = '\0';
+    return string;
+}
+ObjString*   Compiler_CopyString(const char* chars, int length) {
+    ObjString* string = Compiler_AllocString(length);
+    memcpy(string->Chars, chars, length);
+    string->Hash = FNV1A::EncryptData(chars, length);
+    return string;
+}
+ObjFunction* Compiler_NewFunction() {
+    ObjFunction* function = (ObjFunction*)Memory::Calloc(1, sizeof(ObjFunction));
+    function->Object.Type = OBJ_FUNCTION;
+    ChunkInit(&function->Chunk);
+    return function;
+}
 
 
 #define Panic(returnMe) if (parser.PanicMode) { SynchronizeToken(); return returnMe; }
@@ -734,6 +790,11 @@ PUBLIC void  Compiler::EmitSetOperation(Uint8 setOp, int arg, Token name) {
             EmitStringHash(name);
             break;
         case OP_SET_LOCAL:
+            if (arg > UINT8_MAX) {
+                EmitByte(OP_SET_LOCAL_LONG);
+                EmitUint16(arg);
+                break;
+            }
             EmitBytes(setOp, (Uint8)arg);
             break;
         case OP_SET_ELEMENT:
@@ -746,11 +807,27 @@ PUBLIC void  Compiler::EmitSetOperation(Uint8 setOp, int arg, Token name) {
 PUBLIC void  Compiler::EmitGetOperation(Uint8 getOp, int arg, Token name) {
     switch (getOp) {
         case OP_GET_GLOBAL:
+            EmitByte(getOp);
+            EmitStringHash(name);
+            break;
         case OP_GET_PROPERTY:
+            // NOTE: GET_LOCAL immediately followed by GET_PROPERTY becomes
+            //   GET_LOCAL_PROPERTY, keeping the slot byte where it was.
+            if (CanFuseInstruction(LocalOpPosition, 2, OP_GET_LOCAL)) {
+                CurrentChunk()->Code[LocalOpPosition] = OP_GET_LOCAL_PROPERTY;
+                EmitStringHash(name);
+                break;
+            }
             EmitByte(getOp);
             EmitStringHash(name);
             break;
         case OP_GET_LOCAL:
+            if (arg > UINT8_MAX) {
+                EmitByte(OP_GET_LOCAL_LONG);
+                EmitUint16(arg);
+                break;
+            }
+            LocalOpPosition = CodePointer();
             EmitBytes(getOp, (Uint8)arg);
             break;
         case OP_GET_ELEMENT:
@@ -763,7 +840,7 @@ PUBLIC void  Compiler::EmitGetOperation(Uint8 getOp, int arg, Token name) {
 PUBLIC void  Compiler::EmitAssignmentToken(Token assignmentToken) {
     switch (assignmentToken.Type) {
         case TOKEN_ASSIGNMENT_PLUS:
-            EmitByte(OP_ADD);
+            EmitAdd();
             break;
         case TOKEN_ASSIGNMENT_MINUS:
             EmitByte(OP_SUBTRACT);
@@ -877,7 +954,7 @@ PUBLIC void  Compiler::PopToScope(int depth) {
     }
 }
 PUBLIC void  Compiler::AddLocal(Token name) {
-    if (LocalCount == 0xFF) {
+    if (LocalCount == LOCALS_MAX) {
         Error("Too many local variables in function.");
         return;
     }
@@ -1048,7 +1125,7 @@ PUBLIC void Compiler::GetDecimal(bool canAssign) {
     EmitConstant(DECIMAL_VAL(value));
 }
 PUBLIC void Compiler::GetString(bool canAssign) {
-    ObjString* string = CopyString(parser.Previous.Start + 1, parser.Previous.Length - 2);
+    ObjString* string = Compiler_AllocString(parser.Previous.Length - 2);
 
     // Escape the string
     char* dst = string->Chars;
@@ -1084,7 +1161,7 @@ PUBLIC void Compiler::GetString(bool canAssign) {
     *dst++ = 0;
 
     EmitConstant(OBJECT_VAL(string));
-    Strings.push_back(string);
+    TopLevel->Strings.push_back(string);
 }
 PUBLIC void Compiler::GetArray(bool canAssign) {
     Uint32 count = 0;
@@ -1204,7 +1281,7 @@ PUBLIC void Compiler::GetBinary(bool canAssign) {
 
     switch (operatorType) {
         // Numeric Operations
-        case TOKEN_PLUS:                EmitByte(OP_ADD); break;
+        case TOKEN_PLUS:                EmitAdd(); break;
         case TOKEN_MINUS:               EmitByte(OP_SUBTRACT); break;
         case TOKEN_MULTIPLY:            EmitByte(OP_MULTIPLY); break;
         case TOKEN_DIVISION:            EmitByte(OP_DIVIDE); break;
@@ -1219,12 +1296,12 @@ PUBLIC void Compiler::GetBinary(bool canAssign) {
         case TOKEN_LOGICAL_AND:         EmitByte(OP_LG_AND); break;
         case TOKEN_LOGICAL_OR:          EmitByte(OP_LG_OR); break;
         // Equality and Comparison Operators
-        case TOKEN_NOT_EQUALS:          EmitByte(OP_EQUAL_NOT); break;
-        case TOKEN_EQUALS:              EmitByte(OP_EQUAL); break;
-        case TOKEN_GREATER:             EmitByte(OP_GREATER); break;
-        case TOKEN_GREATER_EQUAL:       EmitByte(OP_GREATER_EQUAL); break;
-        case TOKEN_LESS:                EmitByte(OP_LESS); break;
-        case TOKEN_LESS_EQUAL:          EmitByte(OP_LESS_EQUAL); break;
+        case TOKEN_NOT_EQUALS:          EmitCompare(OP_EQUAL_NOT); break;
+        case TOKEN_EQUALS:              EmitCompare(OP_EQUAL); break;
+        case TOKEN_GREATER:             EmitCompare(OP_GREATER); break;
+        case TOKEN_GREATER_EQUAL:       EmitCompare(OP_GREATER_EQUAL); break;
+        case TOKEN_LESS:                EmitCompare(OP_LESS); break;
+        case TOKEN_LESS_EQUAL:          EmitCompare(OP_LESS_EQUAL); break;
         default:
             ErrorAt(&operato, "Unknown binary operator.");
             return; // Unreachable.
@@ -1242,17 +1319,6 @@ PUBLIC void Compiler::GetExpression() {
     ParsePrecedence(PREC_ASSIGNMENT);
 }
 // Reading statements
-struct switch_case {
-    int position;
-    int constant_index;
-    int patch_ptr;
-};
-stack<vector<int>*> BreakJumpListStack;
-stack<vector<int>*> ContinueJumpListStack;
-stack<vector<switch_case>*> SwitchJumpListStack;
-stack<int> BreakScopeStack;
-stack<int> ContinueScopeStack;
-stack<int> SwitchScopeStack;
 PUBLIC void Compiler::GetPrintStatement() {
     GetExpression();
     ConsumeToken(TOKEN_SEMICOLON, "Expected \";\" after value.");
@@ -1438,12 +1504,23 @@ PUBLIC void Compiler::GetSwitchStatement() {
 
         // EmitByte(OP_PRINT_STACK);
 
-        EmitByte(OP_SWITCH_TABLE);
+        // Constant indices past 0xFE need the long table, since 0xFF
+        // marks the default case.
+        bool wide = false;
+        for (size_t i = 0; i < cases.size(); i++) {
+            if (cases[i].constant_index >= 0xFF)
+                wide = true;
+        }
+
+        EmitByte(wide ? OP_SWITCH_TABLE_LONG : OP_SWITCH_TABLE);
         EmitUint16(cases.size());
         for (size_t i = 0; i < cases.size(); i++) {
             int position = cases[i].position - code_block_start;
             int constant_index = cases[i].constant_index;
-            EmitByte(constant_index);
+            if (wide)
+                EmitUint24(constant_index < 0 ? 0xFFFFFF : constant_index);
+            else
+                EmitByte(constant_index);
             EmitUint16(position);
         }
 
@@ -1488,8 +1565,13 @@ PUBLIC void Compiler::GetCaseStatement() {
     GetConstant(false);
     ConsumeToken(TOKEN_COLON, "Expected \":\" after \"case\".");
 
-    constant_index = CurrentChunk()->Code[position + 1];
+    Uint8* code = &CurrentChunk()->Code[position];
+    if (code[0] == OP_CONSTANT_LONG)
+        constant_index = code[1] | code[2] << 8 | code[3] << 16;
+    else
+        constant_index = code[1];
     CurrentChunk()->Count = position;
+    JumpTargetPosition = position;
 
     SwitchJumpListStack.top()->push_back(switch_case { position, constant_index, 0 });
 }
@@ -1502,6 +1584,7 @@ PUBLIC void Compiler::GetDefaultStatement() {
 
     int position, constant_index;
     position = CodePointer();
+    JumpTargetPosition = position;
 
     SwitchJumpListStack.top()->push_back(switch_case { position, -1, 0 });
 }
@@ -1748,7 +1831,7 @@ PUBLIC void Compiler::GetStatement() {
 }
 // Reading declarations
 PUBLIC int  Compiler::GetFunction(int type) {
-    int index = Compiler::Functions.size();
+    int index = TopLevel->Functions.size();
 
     Compiler* compiler = new Compiler;
     compiler->Initialize(this, 1, type);
@@ -1785,6 +1868,11 @@ PUBLIC int  Compiler::GetFunction(int type) {
     // ObjFunction* function =
         compiler->FinishCompiler();
 
+    // Pick up where the function body left off
+    parser = compiler->parser;
+    scanner = compiler->scanner;
+    delete compiler;
+
     return index;
 }
 PUBLIC void Compiler::GetMethod() {
@@ -2065,6 +2153,11 @@ PUBLIC void          Compiler::EmitUint16(Uint16 value) {
     EmitByte(value & 0xFF);
     EmitByte(value >> 8 & 0xFF);
 }
+PUBLIC void          Compiler::EmitUint24(Uint32 value) {
+    EmitByte(value & 0xFF);
+    EmitByte(value >> 8 & 0xFF);
+    EmitByte(value >> 16 & 0xFF);
+}
 PUBLIC void          Compiler::EmitUint32(Uint32 value) {
     EmitByte(value & 0xFF);
     EmitByte(value >> 8 & 0xFF);
@@ -2076,6 +2169,13 @@ PUBLIC void          Compiler::EmitConstant(VMValue value) {
     if (index < 0)
         index = MakeConstant(value);
 
+    if (index > UINT8_MAX) {
+        EmitByte(OP_CONSTANT_LONG);
+        EmitUint24(index);
+        return;
+    }
+
+    ConstantOpPosition = CodePointer();
     EmitBytes(OP_CONSTANT, index);
 }
 PUBLIC void          Compiler::EmitLoop(int loopStart) {
@@ -2099,6 +2199,19 @@ PUBLIC int           Compiler::GetPosition() {
     return CurrentChunk()->Count;
 }
 PUBLIC int           Compiler::EmitJump(Uint8 instruction) {
+    // NOTE: A comparison immediately followed by JUMP_IF_FALSE becomes
+    //   COMPARE_JUMP_IF_FALSE, which is the same length in total.
+    if (instruction == OP_JUMP_IF_FALSE && CanFuseInstruction(CompareOpPosition, 1, -1)
+        && CurrentChunk()->Code[CompareOpPosition] >= OP_EQUAL
+        && CurrentChunk()->Code[CompareOpPosition] <= OP_LESS_EQUAL) {
+        Uint8 compare = CurrentChunk()->Code[CompareOpPosition];
+        CurrentChunk()->Code[CompareOpPosition] = OP_COMPARE_JUMP_IF_FALSE;
+        EmitByte(compare);
+        EmitByte(0xFF);
+        EmitByte(0xFF);
+        return CurrentChunk()->Count - 2;
+    }
+
     EmitByte(instruction);
     EmitByte(0xFF);
     EmitByte(0xFF);
@@ -2114,6 +2227,36 @@ PUBLIC void          Compiler::PatchJump(int offset) {
 
     CurrentChunk()->Code[offset]     = jump & 0xFF;
     CurrentChunk()->Code[offset + 1] = (jump >> 8) & 0xFF;
+
+    JumpTargetPosition = CodePointer();
+}
+PUBLIC bool          Compiler::CanFuseInstruction(int position, int length, int opcode) {
+    // An instruction can only be folded into the next one if it was the
+    // last thing emitted, and nothing jumps to the code in between.
+    if (position < 0 || position + length != CodePointer())
+        return false;
+    if (position < JumpTargetPosition)
+        return false;
+    if (opcode >= 0 && CurrentChunk()->Code[position] != opcode)
+        return false;
+    return true;
+}
+PUBLIC void          Compiler::EmitAdd() {
+    // NOTE: GET_LOCAL, CONSTANT, ADD becomes ADD_LOCAL_CONSTANT.
+    if (CanFuseInstruction(ConstantOpPosition, 2, OP_CONSTANT)
+        && CanFuseInstruction(LocalOpPosition, 4, OP_GET_LOCAL)) {
+        Chunk* chunk = CurrentChunk();
+        chunk->Code[LocalOpPosition] = OP_ADD_LOCAL_CONSTANT;
+        chunk->Code[LocalOpPosition + 2] = chunk->Code[ConstantOpPosition + 1];
+        chunk->Count--;
+        return;
+    }
+
+    EmitByte(OP_ADD);
+}
+PUBLIC void          Compiler::EmitCompare(Uint8 compare) {
+    CompareOpPosition = CodePointer();
+    EmitByte(compare);
 }
 PUBLIC void          Compiler::EmitStringHash(char* string) {
     EmitUint32(GetHash(string));
@@ -2184,13 +2327,13 @@ PUBLIC int           Compiler::FindConstant(VMValue value) {
     }
     return -1;
 }
-PUBLIC Uint8         Compiler::MakeConstant(VMValue value) {
+PUBLIC int           Compiler::MakeConstant(VMValue value) {
     int constant = ChunkAddConstant(CurrentChunk(), value);
-    if (constant > UINT8_MAX) {
+    if (constant > 0xFFFFFF) {
         Error("Too many constants in one chunk.");
         return 0;
     }
-    return (Uint8)constant;
+    return constant;
 }
 
 int  justin_print(char** buffer, int* buf_start, const char *format, ...) {
@@ -2345,13 +2488,26 @@ PUBLIC STATIC void   Compiler::PrintObject(char** buffer, int* buf_start, VMValu
             justin_print(buffer, buf_start, "}");
             break;
         }
+        case OBJ_TYPED_ARRAY: {
+            ObjTypedArray* array = (ObjTypedArray*)AS_OBJECT(value);
+
+            justin_print(buffer, buf_start, "[");
+            for (int i = 0; i < array->Length; i++) {
+                if (i > 0)
+                    justin_print(buffer, buf_start, ", ");
+
+                PrintValue(buffer, buf_start, TypedArrayGet(array, i), indent + 1);
+            }
+            justin_print(buffer, buf_start, "]");
+            break;
+        }
         default:
             justin_print(buffer, buf_start, "UNKNOWN OBJECT TYPE %d", OBJECT_TYPE(value));
     }
 }
 
 // Debugging functions
-PUBLIC STATIC int    Compiler::HashInstruction(const char* name, Chunk* chunk, int offset) {
+PUBLIC int           Compiler::HashInstruction(const char* name, Chunk* chunk, int offset) {
     uint32_t hash = *(uint32_t*)&chunk->Code[offset + 1];
     printf("%-16s #%08X", name, hash);
     if (TokenMap->Exists(hash)) {
@@ -2368,6 +2524,13 @@ PUBLIC STATIC int    Compiler::ConstantInstruction(const char* name, Chunk* chun
     printf("'\n");
     return offset + 2;
 }
+PUBLIC STATIC int    Compiler::ConstantLongInstruction(const char* name, Chunk* chunk, int offset) {
+    int constant = chunk->Code[offset + 1] | chunk->Code[offset + 2] << 8 | chunk->Code[offset + 3] << 16;
+    printf("%-16s %9d '", name, constant);
+    PrintValue(NULL, NULL, (*chunk->Constants)[constant]);
+    printf("'\n");
+    return offset + 4;
+}
 PUBLIC STATIC int    Compiler::ConstantInstructionN(const char* name, int n, Chunk* chunk, int offset) {
     uint8_t constant = chunk->Code[offset + 1];
     printf("%s_%-*d %9d '", name, 15 - (int)strlen(name), n, constant);
@@ -2396,7 +2559,12 @@ PUBLIC STATIC int    Compiler::LocalInstruction(const char* name, Chunk* chunk,
         printf("%-16s %9d 'this'\n", name, slot);
     return offset + 2; // [debug]
 }
-PUBLIC STATIC int    Compiler::InvokeInstruction(const char* name, Chunk* chunk, int offset) {
+PUBLIC STATIC int    Compiler::LocalLongInstruction(const char* name, Chunk* chunk, int offset) {
+    int slot = chunk->Code[offset + 1] | chunk->Code[offset + 2] << 8;
+    printf("%-16s %9d\n", name, slot);
+    return offset + 3; // [debug]
+}
+PUBLIC int           Compiler::InvokeInstruction(const char* name, Chunk* chunk, int offset) {
     uint8_t slot = chunk->Code[offset + 1];
     uint32_t hash = *(uint32_t*)&chunk->Code[offset + 2];
     printf("%-13s %2d", name, slot);
@@ -2417,16 +2585,30 @@ PUBLIC STATIC int    Compiler::JumpInstruction(const char* name, int sign, Chunk
 }
 PUBLIC STATIC int    Compiler::WithInstruction(const char* name, Chunk* chunk, int offset) {
     uint8_t slot = chunk->Code[offset + 1];
-    if (slot == 0) {
-        printf("%-16s %9d\n", name, slot);
-        return offset + 2; // [debug]
-    }
     uint16_t jump = (uint16_t)(chunk->Code[offset + 2]);
     jump |= chunk->Code[offset + 3] << 8;
-    printf("%-16s %9d -> %d\n", name, slot, jump);
+    if (slot == 0)
+        printf("%-16s %9d -> %d\n", name, slot, offset + 4 + jump);
+    else
+        printf("%-16s %9d -> %d\n", name, slot, offset + 4 - jump);
     return offset + 4; // [debug]
 }
-PUBLIC STATIC int    Compiler::DebugInstruction(Chunk* chunk, int offset) {
+PUBLIC STATIC int    Compiler::LocalConstantInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t slot = chunk->Code[offset + 1];
+    uint8_t constant = chunk->Code[offset + 2];
+    printf("%-13s %2d %9d '", name, slot, constant);
+    PrintValue(NULL, NULL, (*chunk->Constants)[constant]);
+    printf("'\n");
+    return offset + 3; // [debug]
+}
+PUBLIC STATIC int    Compiler::CompareJumpInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t compare = chunk->Code[offset + 1];
+    uint16_t jump = (uint16_t)(chunk->Code[offset + 2]);
+    jump |= chunk->Code[offset + 3] << 8;
+    printf("%-13s %2d %9d -> %d\n", name, compare, offset, offset + 4 + jump);
+    return offset + 4; // [debug]
+}
+PUBLIC int           Compiler::DebugInstruction(Chunk* chunk, int offset) {
     printf("%04d ", offset);
     if (offset > 0 && (chunk->Lines[offset] & 0xFFFF) == (chunk->Lines[offset - 1] & 0xFFFF)) {
         printf("   | ");
@@ -2439,6 +2621,8 @@ PUBLIC STATIC int    Compiler::DebugInstruction(Chunk* chunk, int offset) {
     switch (instruction) {
         case OP_CONSTANT:
             return ConstantInstruction("OP_CONSTANT", chunk, offset);
+        case OP_CONSTANT_LONG:
+            return ConstantLongInstruction("OP_CONSTANT_LONG", chunk, offset);
         case OP_NULL:
             return SimpleInstruction("OP_NULL", offset);
         case OP_TRUE:
@@ -2448,11 +2632,19 @@ PUBLIC STATIC int    Compiler::DebugInstruction(Chunk* chunk, int offset) {
         case OP_POP:
             return SimpleInstruction("OP_POP", offset);
         case OP_COPY:
-            return SimpleInstruction("OP_COPY", offset);
+            return ByteInstruction("OP_COPY", chunk, offset);
+        case OP_SAVE_VALUE:
+            return SimpleInstruction("OP_SAVE_VALUE", offset);
+        case OP_LOAD_VALUE:
+            return SimpleInstruction("OP_LOAD_VALUE", offset);
         case OP_GET_LOCAL:
             return LocalInstruction("OP_GET_LOCAL", chunk, offset);
         case OP_SET_LOCAL:
             return LocalInstruction("OP_SET_LOCAL", chunk, offset);
+        case OP_GET_LOCAL_LONG:
+            return LocalLongInstruction("OP_GET_LOCAL_LONG", chunk, offset);
+        case OP_SET_LOCAL_LONG:
+            return LocalLongInstruction("OP_SET_LOCAL_LONG", chunk, offset);
         case OP_GET_GLOBAL:
             return HashInstruction("OP_GET_GLOBAL", chunk, offset);
         case OP_DEFINE_GLOBAL:
@@ -2560,17 +2752,49 @@ PUBLIC STATIC int    Compiler::DebugInstruction(Chunk* chunk, int offset) {
         case OP_WITH:
             return WithInstruction("OP_WITH", chunk, offset);
         case OP_CLASS:
-            return HashInstruction("OP_CLASS", chunk, offset);
+            return HashInstruction("OP_CLASS", chunk, offset) + 1;
+        case OP_ENUM:
+            return HashInstruction("OP_ENUM", chunk, offset);
+        case OP_SWITCH_TABLE:
+        case OP_SWITCH_TABLE_LONG: {
+            bool wide = instruction == OP_SWITCH_TABLE_LONG;
+            int size = wide ? 5 : 3;
+            int count = chunk->Code[offset + 1] | chunk->Code[offset + 2] << 8;
+            int base = offset + 3 + size * count + 3;
+            printf("%-16s %9d\n", wide ? "OP_SWITCH_TABLE_LONG" : "OP_SWITCH_TABLE", count);
+            for (int i = 0; i < count; i++) {
+                int entry = offset + 3 + size * i;
+                int constant = chunk->Code[entry];
+                if (wide)
+                    constant |= chunk->Code[entry + 1] << 8 | chunk->Code[entry + 2] << 16;
+                int jump = chunk->Code[entry + size - 2] | chunk->Code[entry + size - 1] << 8;
+                if (constant == (wide ? 0xFFFFFF : 0xFF)) {
+                    printf("%04d   |                     default -> %d\n", entry, base + jump);
+                }
+                else {
+                    printf("%04d   |                     '", entry);
+                    PrintValue(NULL, NULL, (*chunk->Constants)[constant]);
+                    printf("' -> %d\n", base + jump);
+                }
+            }
+            return offset + 3 + size * count;
+        }
         case OP_INHERIT:
             return SimpleInstruction("OP_INHERIT", offset);
         case OP_METHOD:
             return InvokeInstruction("OP_METHOD", chunk, offset);
+        case OP_GET_LOCAL_PROPERTY:
+            return InvokeInstruction("OP_GET_LOCAL_PROPERTY", chunk, offset);
+        case OP_ADD_LOCAL_CONSTANT:
+            return LocalConstantInstruction("OP_ADD_LOCAL_CONSTANT", chunk, offset);
+        case OP_COMPARE_JUMP_IF_FALSE:
+            return CompareJumpInstruction("OP_COMPARE_JUMP_IF_FALSE", chunk, offset);
         default:
             printf("\x1b[1;93mUnknown opcode %d\x1b[m\n", instruction);
             return offset + 1;
     }
 }
-PUBLIC STATIC void   Compiler::DebugChunk(Chunk* chunk, const char* name, int arity) {
+PUBLIC void          Compiler::DebugChunk(Chunk* chunk, const char* name, int arity) {
     printf("== %s (argCount: %d) ==\n", name, arity);
     printf("byte   ln\n");
     for (int offset = 0; offset < chunk->Count;) {
@@ -2585,7 +2809,7 @@ PUBLIC STATIC void   Compiler::DebugChunk(Chunk* chunk, const char* name, int ar
     }
 }
 
-PUBLIC STATIC void   Compiler::HTML5ConvertChunk(Chunk* chunk, const char* name, int arity) {
+PUBLIC void          Compiler::HTML5ConvertChunk(Chunk* chunk, const char* name, int arity) {
     printf("== %s (argCount: %d) ==\n", name, arity);
     printf("byte   ln\n");
     for (int offset = 0; offset < chunk->Count;) {
@@ -2593,33 +2817,556 @@ PUBLIC STATIC void   Compiler::HTML5ConvertChunk(Chunk* chunk, const char* name,
     }
 }
 
+// Optimizing
+PUBLIC STATIC int    Compiler::GetInstructionLength(Chunk* chunk, int offset) {
+    switch (chunk->Code[offset]) {
+        case OP_PRINT_STACK:
+        case OP_INHERIT:
+        case OP_RETURN:
+        case OP_POP:
+        case OP_ADD:
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_MODULO:
+        case OP_NEGATE:
+        case OP_INCREMENT:
+        case OP_DECREMENT:
+        case OP_BITSHIFT_LEFT:
+        case OP_BITSHIFT_RIGHT:
+        case OP_NULL:
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_BW_NOT:
+        case OP_BW_AND:
+        case OP_BW_OR:
+        case OP_BW_XOR:
+        case OP_LG_NOT:
+        case OP_LG_AND:
+        case OP_LG_OR:
+        case OP_EQUAL:
+        case OP_EQUAL_NOT:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+        case OP_PRINT:
+        case OP_SAVE_VALUE:
+        case OP_LOAD_VALUE:
+        case OP_GET_ELEMENT:
+        case OP_SET_ELEMENT:
+            return 1;
+        case OP_CONSTANT:
+        case OP_GET_LOCAL:
+        case OP_SET_LOCAL:
+        case OP_CALL:
+        case OP_COPY:
+            return 2;
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_BACK:
+        case OP_ADD_LOCAL_CONSTANT:
+        case OP_GET_LOCAL_LONG:
+        case OP_SET_LOCAL_LONG:
+            return 3;
+        case OP_WITH:
+        case OP_COMPARE_JUMP_IF_FALSE:
+        case OP_CONSTANT_LONG:
+            return 4;
+        case OP_DEFINE_GLOBAL:
+        case OP_GET_PROPERTY:
+        case OP_SET_PROPERTY:
+        case OP_GET_GLOBAL:
+        case OP_SET_GLOBAL:
+        case OP_ENUM:
+        case OP_NEW_ARRAY:
+        case OP_NEW_MAP:
+            return 5;
+        case OP_METHOD:
+        case OP_CLASS:
+        case OP_INVOKE:
+        case OP_GET_LOCAL_PROPERTY:
+            return 6;
+        case OP_SWITCH_TABLE:
+            if (offset + 2 >= chunk->Count)
+                return -1;
+            return 3 + 3 * (chunk->Code[offset + 1] | chunk->Code[offset + 2] << 8);
+        case OP_SWITCH_TABLE_LONG:
+            if (offset + 2 >= chunk->Count)
+                return -1;
+            return 3 + 5 * (chunk->Code[offset + 1] | chunk->Code[offset + 2] << 8);
+    }
+    return -1;
+}
+PRIVATE STATIC bool  Compiler::FoldConstants(Uint8 op, VMValue a, VMValue b, VMValue* result) {
+    if (a.Type != VAL_INTEGER && a.Type != VAL_DECIMAL)
+        return false;
+    if (b.Type != VAL_INTEGER && b.Type != VAL_DECIMAL)
+        return false;
+
+    // Mirrors VMThread::Values_*; anything that could behave differently
+    // at runtime (division by zero, odd shifts) is left alone.
+    bool decimal = a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL;
+    float a_d = a.Type == VAL_DECIMAL ? AS_DECIMAL(a) : (float)AS_INTEGER(a);
+    float b_d = b.Type == VAL_DECIMAL ? AS_DECIMAL(b) : (float)AS_INTEGER(b);
+    Uint32 a_i = a.Type == VAL_INTEGER ? (Uint32)AS_INTEGER(a) : 0;
+    Uint32 b_i = b.Type == VAL_INTEGER ? (Uint32)AS_INTEGER(b) : 0;
+
+    switch (op) {
+        case OP_ADD:
+            *result = decimal ? DECIMAL_VAL(a_d + b_d) : INTEGER_VAL((int)(a_i + b_i));
+            break;
+        case OP_SUBTRACT:
+            *result = decimal ? DECIMAL_VAL(a_d - b_d) : INTEGER_VAL((int)(a_i - b_i));
+            break;
+        case OP_MULTIPLY:
+            *result = decimal ? DECIMAL_VAL(a_d * b_d) : INTEGER_VAL((int)(a_i * b_i));
+            break;
+        case OP_DIVIDE:
+            if (decimal) {
+                if (b_d == 0.0f)
+                    return false;
+                *result = DECIMAL_VAL(a_d / b_d);
+            }
+            else {
+                if (AS_INTEGER(b) == 0 || (AS_INTEGER(b) == -1 && a_i == 0x80000000U))
+                    return false;
+                *result = INTEGER_VAL(AS_INTEGER(a) / AS_INTEGER(b));
+            }
+            break;
+        case OP_NEGATE:
+            *result = a.Type == VAL_DECIMAL ? DECIMAL_VAL(-a_d) : INTEGER_VAL((int)(0U - a_i));
+            break;
+        case OP_BW_AND:
+        case OP_BW_OR:
+        case OP_BW_XOR:
+        case OP_BITSHIFT_LEFT:
+        case OP_BITSHIFT_RIGHT:
+            if (decimal)
+                return false;
+            switch (op) {
+                case OP_BW_AND: *result = INTEGER_VAL((int)(a_i & b_i)); break;
+                case OP_BW_OR:  *result = INTEGER_VAL((int)(a_i | b_i)); break;
+                case OP_BW_XOR: *result = INTEGER_VAL((int)(a_i ^ b_i)); break;
+                default:
+                    if (b_i >= 32)
+                        return false;
+                    if (op == OP_BITSHIFT_LEFT)
+                        *result = INTEGER_VAL((int)(a_i << b_i));
+                    else
+                        *result = INTEGER_VAL(AS_INTEGER(a) >> b_i);
+                    break;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    // -0.0 would be merged with 0.0 by FindConstant.
+    VMValue folded = *result;
+    if (folded.Type == VAL_DECIMAL && AS_DECIMAL(folded) == 0.0f)
+        return false;
+    return true;
+}
+PUBLIC STATIC bool   Compiler::OptimizeChunk(Chunk* chunk) {
+    // NOTE: Runs after a function has been fully compiled. Every pass
+    //   only marks instructions as removed or retargets jumps; the code
+    //   is laid out again at the end and jump offsets are re-encoded. If
+    //   anything can't be represented, the chunk is left untouched.
+    struct Instruction {
+        int         Offset;
+        int         Length;
+        int         NewOffset;
+        bool        Removed;
+        bool        Reachable;
+        bool        JumpTarget;
+        bool        Pinned;
+        vector<int> Targets;
+    };
+
+    if (chunk->Count == 0)
+        return false;
+
+    vector<Instruction> code;
+    vector<int> indexOf(chunk->Count + 1, -1);
+
+    // Decode
+    for (int offset = 0; offset < chunk->Count; ) {
+        int length = GetInstructionLength(chunk, offset);
+        if (length <= 0 || offset + length > chunk->Count)
+            return false;
+
+        indexOf[offset] = code.size();
+        code.push_back(Instruction { offset, length, 0, false, false, false, false, vector<int>() });
+        offset += length;
+    }
+
+    #define READ_SINT16(o) ((Sint16)(chunk->Code[(o)] | chunk->Code[(o) + 1] << 8))
+
+    for (size_t i = 0; i < code.size(); i++) {
+        Instruction* ins = &code[i];
+        int end = ins->Offset + ins->Length;
+        switch (chunk->Code[ins->Offset]) {
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+                ins->Targets.push_back(end + READ_SINT16(ins->Offset + 1));
+                break;
+            case OP_JUMP_BACK:
+                ins->Targets.push_back(end - READ_SINT16(ins->Offset + 1));
+                break;
+            case OP_COMPARE_JUMP_IF_FALSE:
+                ins->Targets.push_back(end + READ_SINT16(ins->Offset + 2));
+                break;
+            case OP_WITH:
+                if (chunk->Code[ins->Offset + 1] == 0)
+                    ins->Targets.push_back(end + READ_SINT16(ins->Offset + 2));
+                else
+                    ins->Targets.push_back(end - READ_SINT16(ins->Offset + 2));
+                break;
+            case OP_SWITCH_TABLE:
+            case OP_SWITCH_TABLE_LONG: {
+                // Case offsets are relative to the end of the OP_JUMP that
+                // follows the table, so that jump must stay where it is.
+                if (i + 1 >= code.size() || chunk->Code[code[i + 1].Offset] != OP_JUMP)
+                    return false;
+                code[i + 1].Pinned = true;
+
+                int base = end + 3;
+                int entry = chunk->Code[ins->Offset] == OP_SWITCH_TABLE_LONG ? 5 : 3;
+                for (int c = ins->Offset + 3 + entry - 2; c < end; c += entry)
+                    ins->Targets.push_back(base + (chunk->Code[c] | chunk->Code[c + 1] << 8));
+                break;
+            }
+        }
+
+        for (size_t t = 0; t < ins->Targets.size(); t++) {
+            int target = ins->Targets[t];
+            if (target < 0 || target >= chunk->Count || indexOf[target] < 0)
+                return false;
+            ins->Targets[t] = indexOf[target];
+        }
+    }
+
+    #undef READ_SINT16
+
+    // Jump threading: a jump onto an unconditional jump goes straight to
+    // the final destination.
+    for (size_t i = 0; i < code.size(); i++) {
+        Uint8 op = chunk->Code[code[i].Offset];
+        if (op != OP_JUMP && op != OP_JUMP_BACK && op != OP_JUMP_IF_FALSE && op != OP_COMPARE_JUMP_IF_FALSE)
+            continue;
+
+        int target = code[i].Targets[0];
+        for (int hops = 0; hops < 8; hops++) {
+            Uint8 targetOp = chunk->Code[code[target].Offset];
+            if ((targetOp != OP_JUMP && targetOp != OP_JUMP_BACK) || target == (int)i)
+                break;
+            target = code[target].Targets[0];
+        }
+
+        // Conditional jumps only go forward.
+        if ((op == OP_JUMP_IF_FALSE || op == OP_COMPARE_JUMP_IF_FALSE) && target <= (int)i)
+            continue;
+        code[i].Targets[0] = target;
+    }
+
+    // Dead code elimination
+    vector<int> work;
+    work.push_back(0);
+    while (work.size()) {
+        int i = work.back();
+        work.pop_back();
+        if (i >= (int)code.size() || code[i].Reachable)
+            continue;
+
+        code[i].Reachable = true;
+        for (size_t t = 0; t < code[i].Targets.size(); t++)
+            work.push_back(code[i].Targets[t]);
+
+        Uint8 op = chunk->Code[code[i].Offset];
+        if (op != OP_JUMP && op != OP_JUMP_BACK && op != OP_RETURN)
+            work.push_back(i + 1);
+    }
+    for (size_t i = 0; i < code.size(); i++) {
+        if (!code[i].Reachable) {
+            code[i].Removed = true;
+            continue;
+        }
+        for (size_t t = 0; t < code[i].Targets.size(); t++)
+            code[code[i].Targets[t]].JumpTarget = true;
+    }
+
+    // Constant folding and push/pop peepholes. "live" holds the kept
+    // instructions so far, so removals let earlier ones line up again.
+    vector<int> live;
+    for (size_t i = 0; i < code.size(); i++) {
+        Instruction* ins = &code[i];
+        if (ins->Removed)
+            continue;
+
+        Uint8* op = &chunk->Code[ins->Offset];
+        size_t n = live.size();
+
+        // CONSTANT a, CONSTANT b, <op> -> CONSTANT (a op b)
+        // CONSTANT a, NEGATE           -> CONSTANT (-a)
+        if (!ins->JumpTarget && n >= 1) {
+            Instruction* a = NULL;
+            Instruction* b = NULL;
+            if (*op == OP_NEGATE) {
+                a = &code[live[n - 1]];
+            }
+            else if (n >= 2 && !code[live[n - 1]].JumpTarget) {
+                a = &code[live[n - 2]];
+                b = &code[live[n - 1]];
+            }
+
+            VMValue result;
+            if (a && chunk->Code[a->Offset] == OP_CONSTANT && (!b || chunk->Code[b->Offset] == OP_CONSTANT)
+                && FoldConstants(*op,
+                    (*chunk->Constants)[chunk->Code[a->Offset + 1]],
+                    (*chunk->Constants)[chunk->Code[(b ? b : a)->Offset + 1]], &result)) {
+                int index = -1;
+                for (size_t c = 0; c < chunk->Constants->size(); c++) {
+                    if (ValuesEqual(result, (*chunk->Constants)[c])) {
+                        index = c;
+                        break;
+                    }
+                }
+                if (index < 0 && chunk->Constants->size() <= UINT8_MAX)
+                    index = ChunkAddConstant(chunk, result);
+
+                if (index >= 0 && index <= UINT8_MAX) {
+                    chunk->Code[a->Offset + 1] = (Uint8)index;
+                    ins->Removed = true;
+                    if (b) {
+                        b->Removed = true;
+                        live.pop_back();
+                    }
+                    continue;
+                }
+            }
+        }
+
+        // <pure push>, POP -> (nothing)
+        if (*op == OP_POP && !ins->JumpTarget && n >= 1) {
+            Instruction* push = &code[live[n - 1]];
+            Uint8 pushOp = chunk->Code[push->Offset];
+            if (!push->JumpTarget && !push->Pinned
+                && (pushOp == OP_CONSTANT || pushOp == OP_CONSTANT_LONG
+                    || pushOp == OP_GET_LOCAL || pushOp == OP_GET_LOCAL_LONG || pushOp == OP_LOAD_VALUE
+                    || pushOp == OP_NULL || pushOp == OP_TRUE || pushOp == OP_FALSE
+                    || (pushOp == OP_COPY && chunk->Code[push->Offset + 1] == 1))) {
+                push->Removed = true;
+                ins->Removed = true;
+                live.pop_back();
+                continue;
+            }
+        }
+
+        // SET_LOCAL n, POP, GET_LOCAL n -> SET_LOCAL n
+        if ((*op == OP_GET_LOCAL || *op == OP_GET_LOCAL_LONG) && !ins->JumpTarget && n >= 2) {
+            Instruction* pop = &code[live[n - 1]];
+            Instruction* set = &code[live[n - 2]];
+            Uint8 setOp = *op == OP_GET_LOCAL ? OP_SET_LOCAL : OP_SET_LOCAL_LONG;
+            if (!pop->JumpTarget
+                && chunk->Code[pop->Offset] == OP_POP
+                && chunk->Code[set->Offset] == setOp
+                && memcmp(&chunk->Code[set->Offset + 1], &op[1], ins->Length - 1) == 0) {
+                pop->Removed = true;
+                ins->Removed = true;
+                live.pop_back();
+                continue;
+            }
+        }
+
+        live.push_back(i);
+    }
+
+    // Jumps to the next kept instruction do nothing.
+    for (size_t i = 0; i < code.size(); i++) {
+        Instruction* ins = &code[i];
+        Uint8 op = chunk->Code[ins->Offset];
+        if (ins->Removed || ins->Pinned || (op != OP_JUMP && op != OP_JUMP_IF_FALSE))
+            continue;
+
+        size_t next = i + 1;
+        while (next < code.size() && code[next].Removed)
+            next++;
+
+        size_t target = ins->Targets[0];
+        while (target < code.size() && code[target].Removed)
+            target++;
+
+        if (target == next)
+            ins->Removed = true;
+    }
+
+    // Layout
+    int newCount = 0;
+    bool changed = false;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].Removed) {
+            changed = true;
+            continue;
+        }
+        code[i].NewOffset = newCount;
+        newCount += code[i].Length;
+    }
+    if (newCount == 0)
+        return false;
+
+    // Removed instructions resolve to the next kept one.
+    int nextOffset = newCount;
+    for (int i = (int)code.size() - 1; i >= 0; i--) {
+        if (code[i].Removed)
+            code[i].NewOffset = nextOffset;
+        else
+            nextOffset = code[i].NewOffset;
+    }
+
+    Uint8* newCode = (Uint8*)Memory::Malloc(newCount * sizeof(Uint8));
+    int*   newLines = (int*)Memory::Malloc(newCount * sizeof(int));
+    bool   fits = true;
+
+    #define WRITE_JUMP(o, value, max) \
+        if ((value) < 0 || (value) > (max)) fits = false; \
+        newCode[(o)] = (value) & 0xFF; \
+        newCode[(o) + 1] = ((value) >> 8) & 0xFF;
+
+    for (size_t i = 0; i < code.size() && fits; i++) {
+        Instruction* ins = &code[i];
+        if (ins->Removed)
+            continue;
+
+        int o = ins->NewOffset;
+        int end = o + ins->Length;
+        memcpy(&newCode[o], &chunk->Code[ins->Offset], ins->Length);
+        memcpy(&newLines[o], &chunk->Lines[ins->Offset], ins->Length * sizeof(int));
+
+        switch (newCode[o]) {
+            case OP_JUMP:
+            case OP_JUMP_BACK: {
+                int relative = code[ins->Targets[0]].NewOffset - end;
+                if (relative >= 0) {
+                    newCode[o] = OP_JUMP;
+                    WRITE_JUMP(o + 1, relative, INT16_MAX);
+                }
+                else {
+                    newCode[o] = OP_JUMP_BACK;
+                    WRITE_JUMP(o + 1, -relative, INT16_MAX);
+                }
+                break;
+            }
+            case OP_JUMP_IF_FALSE: {
+                WRITE_JUMP(o + 1, code[ins->Targets[0]].NewOffset - end, INT16_MAX);
+                break;
+            }
+            case OP_COMPARE_JUMP_IF_FALSE: {
+                WRITE_JUMP(o + 2, code[ins->Targets[0]].NewOffset - end, INT16_MAX);
+                break;
+            }
+            case OP_WITH: {
+                if (newCode[o + 1] == 0) {
+                    WRITE_JUMP(o + 2, code[ins->Targets[0]].NewOffset - end, INT16_MAX);
+                }
+                else {
+                    WRITE_JUMP(o + 2, end - code[ins->Targets[0]].NewOffset, INT16_MAX);
+                }
+                break;
+            }
+            case OP_SWITCH_TABLE:
+            case OP_SWITCH_TABLE_LONG: {
+                int base = end + 3;
+                int entry = newCode[o] == OP_SWITCH_TABLE_LONG ? 5 : 3;
+                for (size_t t = 0; t < ins->Targets.size(); t++) {
+                    WRITE_JUMP(o + 3 + t * entry + entry - 2, code[ins->Targets[t]].NewOffset - base, UINT16_MAX);
+                }
+                break;
+            }
+        }
+    }
+
+    #undef WRITE_JUMP
+
+    if (fits) {
+        changed |= memcmp(newCode, chunk->Code, newCount) != 0;
+        memcpy(chunk->Code, newCode, newCount);
+        memcpy(chunk->Lines, newLines, newCount * sizeof(int));
+        chunk->Count = newCount;
+    }
+
+    Memory::Free(newCode);
+    Memory::Free(newLines);
+    return fits && changed;
+}
+
 // Compiling
 PUBLIC STATIC void   Compiler::Init() {
-    Compiler::MakeRules();
+    if (!Compiler::Rules)
+        Compiler::MakeRules();
 
-    if (Compiler::TokenMap == NULL) {
-        Compiler::TokenMap = new HashMap<Token>(NULL, 8);
-    }
+    Compiler_DebugOutput = false;
+    Application::Settings->GetBool("dev", "debugCompiler", &Compiler_DebugOutput);
+
+    Compiler_OptimizeBytecode = Compiler::DoOptimizations;
+    Application::Settings->GetBool("dev", "optimizeBytecode", &Compiler_OptimizeBytecode);
+}
+PUBLIC STATIC bool   Compiler::IsDebugging() {
+    return Compiler_DebugOutput;
+}
+// NOTE: Identifies everything besides the source text that the compiled
+//   output depends on, for the bytecode cache in SourceFileMap. It must
+//   stay the same across builds of the same compiler, so that working
+//   copies and rebuilds can share cache entries.
+PUBLIC STATIC Uint32 Compiler::GetBuildKey() {
+    Uint32 key = FNV1A::EncryptData(&Compiler::CodegenRevision, sizeof(Compiler::CodegenRevision));
+    key = FNV1A::EncryptData(&Compiler::IBCVersion, sizeof(Compiler::IBCVersion), key);
+    key = FNV1A::EncryptData(&Compiler_OptimizeBytecode, sizeof(Compiler_OptimizeBytecode), key);
+
+    bool doLineNumbers = false;
+    #ifdef DEBUG
+    doLineNumbers = true;
+    #endif
+    key = FNV1A::EncryptData(&doLineNumbers, sizeof(doLineNumbers), key);
+    return key;
 }
 PUBLIC void          Compiler::Initialize(Compiler* enclosing, int scope, int type) {
     Type = type;
     LocalCount = 0;
     ScopeDepth = scope;
     Enclosing = enclosing;
-    Function = NewFunction();
-    Compiler::Functions.push_back(Function);
+
+    // Function bodies carry on with the enclosing compiler's state
+    if (enclosing) {
+        TopLevel = enclosing->TopLevel;
+        parser = enclosing->parser;
+        scanner = enclosing->scanner;
+        TokenMap = enclosing->TokenMap;
+        BreakJumpListStack = enclosing->BreakJumpListStack;
+        ContinueJumpListStack = enclosing->ContinueJumpListStack;
+        SwitchJumpListStack = enclosing->SwitchJumpListStack;
+        BreakScopeStack = enclosing->BreakScopeStack;
+        ContinueScopeStack = enclosing->ContinueScopeStack;
+        SwitchScopeStack = enclosing->SwitchScopeStack;
+    }
+    else {
+        TopLevel = this;
+    }
+
+    Function = Compiler_NewFunction();
+    TopLevel->Functions.push_back(Function);
 
     switch (type) {
         case TYPE_CONSTRUCTOR:
         case TYPE_METHOD:
         case TYPE_FUNCTION:
-            Function->Name = CopyString(parser.Previous.Start, parser.Previous.Length);
+            Function->Name = Compiler_CopyString(parser.Previous.Start, parser.Previous.Length);
             break;
         case TYPE_WITH:
-            Function->Name = CopyString("<anonymous-fn>", 14);
+            Function->Name = Compiler_CopyString("<anonymous-fn>", 14);
             break;
         case TYPE_TOP_LEVEL:
-            Function->Name = CopyString("main", 4);
+            Function->Name = Compiler_CopyString("main", 4);
             break;
     }
 
@@ -2653,7 +3400,9 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
     parser.HadError = false;
     parser.PanicMode = false;
 
-    Compiler::Functions.clear();
+    if (!TokenMap)
+        TokenMap = new HashMap<Token>(NULL, 8);
+
     Initialize(NULL, 0, TYPE_TOP_LEVEL);
 
     AdvanceToken();
@@ -2667,16 +3416,27 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
     ConsumeToken(TOKEN_EOF, "Expected end of file.");
     FinishCompiler();
 
-    bool debugCompiler = false;
-    Application::Settings->GetBool("dev", "debugCompiler", &debugCompiler);
+    bool debugCompiler = Compiler_DebugOutput;
     if (debugCompiler) {
-        for (size_t c = 0; c < Compiler::Functions.size(); c++) {
-            Chunk* chunk = &Compiler::Functions[c]->Chunk;
-            DebugChunk(chunk, Compiler::Functions[c]->Name->Chars, Compiler::Functions[c]->Arity);
+        for (size_t c = 0; c < Functions.size(); c++) {
+            Chunk* chunk = &Functions[c]->Chunk;
+            DebugChunk(chunk, Functions[c]->Name->Chars, Functions[c]->Arity);
             printf("\n");
         }
     }
 
+    if (Compiler_OptimizeBytecode) {
+        for (size_t c = 0; c < Functions.size(); c++) {
+            Chunk* chunk = &Functions[c]->Chunk;
+            int oldCount = chunk->Count;
+            if (OptimizeChunk(chunk) && debugCompiler) {
+                printf("optimized: %d -> %d bytes\n", oldCount, chunk->Count);
+                DebugChunk(chunk, Functions[c]->Name->Chars, Functions[c]->Arity);
+                printf("\n");
+            }
+        }
+    }
+
     // return false;
 
     Stream* stream = FileStream::New(output, FileStream::WRITE_ACCESS);
@@ -2688,21 +3448,21 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
     #endif
 
     stream->WriteBytes((char*)Compiler::Magic, 4);
-    stream->WriteByte(0x00);
+    stream->WriteByte(Compiler::IBCVersion);
     stream->WriteByte(doLineNumbers);
     stream->WriteByte(0x00);
     stream->WriteByte(0x00);
 
-    int chunkCount = Compiler::Functions.size();
+    int chunkCount = Functions.size();
 
     stream->WriteUInt32(chunkCount);
     for (int c = 0; c < chunkCount; c++) {
-        int    arity = Compiler::Functions[c]->Arity;
-        Chunk* chunk = &Compiler::Functions[c]->Chunk;
+        int    arity = Functions[c]->Arity;
+        Chunk* chunk = &Functions[c]->Chunk;
 
         stream->WriteUInt32(chunk->Count);
         stream->WriteUInt32(arity);
-        stream->WriteUInt32(FNV1A::EncryptString(Compiler::Functions[c]->Name->Chars));
+        stream->WriteUInt32(FNV1A::EncryptString(Functions[c]->Name->Chars));
 
         stream->WriteBytes(chunk->Code, chunk->Count);
         if (doLineNumbers) {
@@ -2741,14 +3501,12 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
 
     // Output HTML5 here
     bool html5output = false;
-    Application::Settings->GetBool("dev", "html5output", &html5output);
-    html5output = false;
     if (html5output) {
         Log::Print(Log::LOG_IMPORTANT, "Filename: %s", filename);
-        // for (size_t c = 0; c < Compiler::Functions.size(); c++) {
+        // for (size_t c = 0; c < Functions.size(); c++) {
         int c = 1;
-            Chunk* chunk = &Compiler::Functions[c]->Chunk;
-            HTML5ConvertChunk(chunk, Compiler::Functions[c]->Name->Chars, Compiler::Functions[c]->Arity);
+            Chunk* chunk = &Functions[c]->Chunk;
+            HTML5ConvertChunk(chunk, Functions[c]->Name->Chars, Functions[c]->Arity);
         //     printf("\n");
         // }
         exit(0);
@@ -2766,12 +3524,6 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
 
     stream->Close();
 
-    for (size_t s = 0; s < Strings.size(); s++) {
-        Memory::Free(Strings[s]->Chars);
-        Memory::Free(Strings[s]);
-    }
-    Strings.clear();
-
     return !parser.HadError;
 }
 PUBLIC ObjFunction*  Compiler::FinishCompiler() {
@@ -2781,19 +3533,21 @@ PUBLIC ObjFunction*  Compiler::FinishCompiler() {
 }
 
 PUBLIC VIRTUAL       Compiler::~Compiler() {
-
-}
-PUBLIC STATIC void   Compiler::Dispose(bool freeTokens) {
-    for (size_t c = 0; c < Compiler::Functions.size(); c++) {
-        ChunkFree(&Compiler::Functions[c]->Chunk);
-        Memory::Free(Compiler::Functions[c]->Name->Chars);
-        Memory::Free(Compiler::Functions[c]->Name);
-        Memory::Free(Compiler::Functions[c]);
+    for (size_t c = 0; c < Functions.size(); c++) {
+        ChunkFree(&Functions[c]->Chunk);
+        Memory::Free(Functions[c]->Name->Chars);
+        Memory::Free(Functions[c]->Name);
+        Memory::Free(Functions[c]);
+    }
+    for (size_t s = 0; s < Strings.size(); s++) {
+        Memory::Free(Strings[s]->Chars);
+        Memory::Free(Strings[s]);
     }
-    Memory::Free(Rules);
 
-    if (TokenMap && freeTokens) {
+    if (TopLevel == this && TokenMap)
         delete TokenMap;
-        TokenMap = NULL;
-    }
+}
+PUBLIC STATIC void   Compiler::Dispose() {
+    Memory::Free(Rules);
+    Rules = NULL;
 }
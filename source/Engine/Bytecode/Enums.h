@@ -28,6 +28,12 @@ public:
     char* SourceStart;
 };
 
+struct switch_case {
+    int position;
+    int constant_index;
+    int patch_ptr;
+};
+
 enum Precedence {
     PREC_NONE,
     PREC_ASSIGNMENT,      // =
@@ -4,13 +4,32 @@
 
 class GarbageCollector {
 public:
+    enum CollectorState {
+        STATE_IDLE = 0,
+        STATE_MARK = 1,
+        STATE_SWEEP = 2,
+    };
+
     static vector<Obj*> GrayList;
     static Obj*         RootObject;
 
+    static Uint32       State;
+    static Obj*         SweepList;
+    static Obj**        SweepCursor;
+
+    static Obj*         YoungObject;
+    static size_t       YoungSize;
+    static size_t       NurserySize;
+    static vector<Obj*> RememberedSet;
+    static bool         MinorCollection;
+
     static size_t       NextGC;
     static size_t       GarbageSize;
     static double       MaxTimeAlotted;
 
+    static double       CollectionTime;
+    static Uint32       CollectionCount;
+
     static bool         Print;
 };
 #endif
@@ -25,19 +44,163 @@ public:
 #include <Engine/Scene.h>
 
 #define GC_HEAP_GROW_FACTOR 2
+// How many objects to process between checks of the clock.
+#define GC_WORK_CHUNK 32
 
 vector<Obj*> GarbageCollector::GrayList;
 Obj*         GarbageCollector::RootObject;
 
+Uint32       GarbageCollector::State = GarbageCollector::STATE_IDLE;
+Obj*         GarbageCollector::SweepList = NULL;
+Obj**        GarbageCollector::SweepCursor = NULL;
+
+Obj*         GarbageCollector::YoungObject = NULL;
+size_t       GarbageCollector::YoungSize = 0;
+size_t       GarbageCollector::NurserySize = 256 * 1024;
+vector<Obj*> GarbageCollector::RememberedSet;
+bool         GarbageCollector::MinorCollection = false;
+
 size_t       GarbageCollector::NextGC = 1024;
 size_t       GarbageCollector::GarbageSize = 0;
 double       GarbageCollector::MaxTimeAlotted = 1.0; // 1ms
 
+double       GarbageCollector::CollectionTime = 0.0;
+Uint32       GarbageCollector::CollectionCount = 0;
+
 bool         GarbageCollector::Print = false;
 
+// NOTE: The collector is incremental. A cycle starts by graying the
+//   roots, then marks and sweeps in slices of at most MaxTimeAlotted
+//   milliseconds, one slice per call to Step.
+//   - Objects allocated while marking start out gray, so they survive
+//     the cycle and get traced.
+//   - Stores into the heap while marking go through WriteBarrier, which
+//     grays the stored value (see OP_SET_PROPERTY, OP_SET_ELEMENT,
+//     OP_SET_GLOBAL and the container natives).
+//   - Thread stacks and entities are not guarded by barriers, so they
+//     are grayed again right before marking finishes.
+//   - Sweeping works on a detached list, so objects allocated during
+//     the sweep are left alone until the next cycle.
+//
+//   Between cycles, new objects go in a young generation that is
+//   collected on its own by CollectYoung. Nothing is moved; survivors
+//   are just relinked into the old list. Old objects that have young
+//   objects stored in them are kept in RememberedSet by WriteBarrier
+//   and act as extra roots for the minor collection.
 PUBLIC STATIC void GarbageCollector::Collect() {
+    double collectStartTime = Clock::GetTicks();
+
+    // Finish whatever cycle is in progress, then run a whole new one so
+    // that everything unreachable right now is freed.
+    if (State != STATE_IDLE)
+        RunUntil(-1.0);
+
+    BeginCycle();
+    RunUntil(-1.0);
+
+    GarbageCollector::CollectionTime += Clock::GetTicks() - collectStartTime;
+}
+PUBLIC STATIC void GarbageCollector::Step() {
+    double stepStartTime = Clock::GetTicks();
+
+    if (State == STATE_IDLE)
+        BeginCycle();
+
+    RunUntil(stepStartTime + MaxTimeAlotted);
+
+    GarbageCollector::CollectionTime += Clock::GetTicks() - stepStartTime;
+}
+PUBLIC STATIC bool GarbageCollector::IsCollecting() {
+    return State != STATE_IDLE;
+}
+PUBLIC STATIC void GarbageCollector::CollectYoung() {
+    if (State != STATE_IDLE)
+        return;
+
+    double collectStartTime = Clock::GetTicks();
+
+    MinorCollection = true;
+    GrayList.clear();
+
+    // Old objects are taken as live, so only trace the ones that point
+    // into the young generation.
+    for (size_t i = 0; i < RememberedSet.size(); i++) {
+        BlackenObject(RememberedSet[i]);
+    }
+
+    GrayRoots();
+    GrayHashMap(BytecodeObjectManager::Globals);
+    for (size_t i = 0; i < BytecodeObjectManager::AllFunctionList.size(); i++) {
+        GrayObject(BytecodeObjectManager::AllFunctionList[i]);
+    }
+
+    MarkSome(-1.0);
+
+    RemoveWhiteHashMap(BytecodeObjectManager::Strings);
+
+    // Free the dead young objects and promote the rest.
+    for (Obj* object = YoungObject, *next; object; object = next) {
+        next = object->Next;
+
+        if (!object->IsDark) {
+            BytecodeObjectManager::FreeValue(OBJECT_VAL(object));
+        }
+        else {
+            object->IsDark = false;
+            object->IsOld = true;
+            object->Next = RootObject;
+            RootObject = object;
+        }
+    }
+    YoungObject = NULL;
+    YoungSize = 0;
+
+    ForgetRememberedSet();
+
+    MinorCollection = false;
+
+    GarbageCollector::CollectionTime += Clock::GetTicks() - collectStartTime;
+}
+PUBLIC STATIC void GarbageCollector::PromoteYoung() {
+    for (Obj* object = YoungObject, *next; object; object = next) {
+        next = object->Next;
+
+        object->IsOld = true;
+        object->Next = RootObject;
+        RootObject = object;
+    }
+    YoungObject = NULL;
+    YoungSize = 0;
+
+    ForgetRememberedSet();
+}
+PUBLIC STATIC void GarbageCollector::ForgetRememberedSet() {
+    for (size_t i = 0; i < RememberedSet.size(); i++) {
+        RememberedSet[i]->IsRemembered = false;
+    }
+    RememberedSet.clear();
+}
+
+PUBLIC STATIC void GarbageCollector::BeginCycle() {
     GrayList.clear();
 
+    // A full cycle looks at every object, so fold the young generation
+    // into the old list first.
+    PromoteYoung();
+
+    GrayRoots();
+
+    // Mark global roots
+    GrayHashMap(BytecodeObjectManager::Globals);
+
+    // Mark functions
+    for (size_t i = 0; i < BytecodeObjectManager::AllFunctionList.size(); i++) {
+        GrayObject(BytecodeObjectManager::AllFunctionList[i]);
+    }
+
+    State = STATE_MARK;
+}
+PUBLIC STATIC void GarbageCollector::GrayRoots() {
     // Mark threads (should lock here for safety)
     for (Uint32 t = 0; t < BytecodeObjectManager::ThreadCount; t++) {
         VMThread* thread = BytecodeObjectManager::Threads + t;
@@ -51,9 +214,6 @@ PUBLIC STATIC void GarbageCollector::Collect() {
         }
     }
 
-    // Mark global roots
-    GrayHashMap(BytecodeObjectManager::Globals);
-
     // Mark static objects
     for (Entity* ent = Scene::StaticObjectFirst, *next; ent; ent = next) {
         next = ent->NextEntity;
@@ -70,37 +230,109 @@ PUBLIC STATIC void GarbageCollector::Collect() {
         GrayObject(bobj->Instance);
         GrayHashMap(bobj->Properties);
     }
+}
+PUBLIC STATIC void GarbageCollector::RunUntil(double endTime) {
+    // NOTE: A negative end time means no time limit.
+    if (State == STATE_MARK) {
+        if (!MarkSome(endTime))
+            return;
 
-    // Mark functions
-    for (size_t i = 0; i < BytecodeObjectManager::AllFunctionList.size(); i++) {
-        GrayObject(BytecodeObjectManager::AllFunctionList[i]);
+        // The gray list ran dry. Gray the roots again, since stack slots
+        // and entities may have picked up objects since the cycle began,
+        // and trace whatever that turned up before sweeping.
+        GrayRoots();
+        MarkSome(-1.0);
+
+        // Strings are weak references, so forget the unreached ones
+        // before they are freed.
+        RemoveWhiteHashMap(BytecodeObjectManager::Strings);
+
+        SweepList = RootObject;
+        SweepCursor = &SweepList;
+        RootObject = NULL;
+        State = STATE_SWEEP;
     }
 
-    // Traverse references
-    for (size_t i = 0; i < GrayList.size(); i++) {
-        BlackenObject(GrayList[i]);
+    if (State == STATE_SWEEP) {
+        if (!SweepSome(endTime))
+            return;
+
+        // Put the survivors back in front of anything allocated during
+        // the sweep.
+        *SweepCursor = RootObject;
+        RootObject = SweepList;
+        SweepList = NULL;
+        SweepCursor = NULL;
+        State = STATE_IDLE;
+
+        GarbageCollector::NextGC = GarbageCollector::GarbageSize * GC_HEAP_GROW_FACTOR;
+        GarbageCollector::CollectionCount++;
     }
+}
+PUBLIC STATIC bool GarbageCollector::MarkSome(double endTime) {
+    // Traverse references
+    while (GrayList.size()) {
+        for (int i = 0; i < GC_WORK_CHUNK && GrayList.size(); i++) {
+            Obj* object = GrayList.back();
+            GrayList.pop_back();
+            BlackenObject(object);
+        }
 
+        if (endTime >= 0.0 && Clock::GetTicks() >= endTime)
+            return GrayList.size() == 0;
+    }
+    return true;
+}
+PUBLIC STATIC bool GarbageCollector::SweepSome(double endTime) {
     // Collect the white objects
-    Obj** object = &GarbageCollector::RootObject;
-    while (*object != NULL) {
-        if (!((*object)->IsDark)) {
-            // This object wasn't reached, so remove it from the list and
-            // free it.
-            Obj* unreached = *object;
-            *object = unreached->Next;
-
-            BytecodeObjectManager::FreeValue(OBJECT_VAL(unreached));
-        }
-        else {
-            // This object was reached, so unmark it (for the next GC) and
-            // move on to the next.
-            (*object)->IsDark = false;
-            object = &(*object)->Next;
+    while (*SweepCursor != NULL) {
+        for (int i = 0; i < GC_WORK_CHUNK && *SweepCursor != NULL; i++) {
+            if (!((*SweepCursor)->IsDark)) {
+                // This object wasn't reached, so remove it from the list and
+                // free it.
+                Obj* unreached = *SweepCursor;
+                *SweepCursor = unreached->Next;
+
+                BytecodeObjectManager::FreeValue(OBJECT_VAL(unreached));
+            }
+            else {
+                // This object was reached, so unmark it (for the next GC) and
+                // move on to the next.
+                (*SweepCursor)->IsDark = false;
+                SweepCursor = &(*SweepCursor)->Next;
+            }
         }
+
+        if (endTime >= 0.0 && Clock::GetTicks() >= endTime)
+            return *SweepCursor == NULL;
     }
+    return true;
+}
+
+PUBLIC STATIC void GarbageCollector::WriteBarrier(void* container, VMValue value) {
+    if (!IS_OBJECT(value))
+        return;
 
-    GarbageCollector::NextGC = GarbageCollector::GarbageSize * GC_HEAP_GROW_FACTOR;
+    Obj* object = AS_OBJECT(value);
+    if (object == NULL)
+        return;
+
+    // NOTE: The container is NULL when storing into a root (ie. globals).
+    Obj* owner = (Obj*)container;
+    bool remember = owner && owner->IsOld && !owner->IsRemembered && !object->IsOld;
+    bool gray = State == STATE_MARK && !object->IsDark;
+    if (!remember && !gray)
+        return;
+
+    if (BytecodeObjectManager::Lock()) {
+        if (remember && !owner->IsRemembered) {
+            owner->IsRemembered = true;
+            RememberedSet.push_back(owner);
+        }
+        if (gray)
+            GrayObject(object);
+        BytecodeObjectManager::Unlock();
+    }
 }
 
 PUBLIC STATIC void GarbageCollector::GrayValue(VMValue value) {
@@ -112,6 +344,7 @@ PUBLIC STATIC void GarbageCollector::GrayObject(void* obj) {
 
     Obj* object = (Obj*)obj;
     if (object->IsDark) return;
+    if (MinorCollection && object->IsOld) return;
 
     object->IsDark = true;
 
@@ -181,5 +414,16 @@ PUBLIC STATIC void GarbageCollector::RemoveWhiteHashMapItem(Uint32, VMValue valu
 }
 PUBLIC STATIC void GarbageCollector::RemoveWhiteHashMap(void* pointer) {
     if (!pointer) return;
-    ((HashMap<VMValue>*)pointer)->ForAll(RemoveWhiteHashMapItem);
+
+    HashMap<VMValue>* map = (HashMap<VMValue>*)pointer;
+    for (int i = 0; i < map->Capacity; i++) {
+        if (!map->Data[i].Used || !IS_OBJECT(map->Data[i].Data))
+            continue;
+
+        Obj* object = AS_OBJECT(map->Data[i].Data);
+        if (!object->IsDark && !(MinorCollection && object->IsOld)) {
+            map->Data[i].Used = false;
+            map->Count--;
+        }
+    }
 }
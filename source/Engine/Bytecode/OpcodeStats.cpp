@@ -0,0 +1,393 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+#include <Engine/Bytecode/Types.h>
+#include <Engine/Bytecode/VMThread.h>
+
+class OpcodeStats {
+public:
+};
+#endif
+
+#include <Engine/Bytecode/OpcodeStats.h>
+#include <Engine/Application.h>
+#include <Engine/Bytecode/BytecodeObjectManager.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+
+// NOTE: Counters are only fed when the engine is built with
+//   VM_OPCODE_STATS, which times every instruction and native call with
+//   SDL_GetPerformanceCounter. Each VMThread counts into its own tables
+//   so the hot path takes no locks; the lock only guards handing out IDs
+//   for functions and natives, which happens once per name.
+#define OPCODE_STATS_THREADS 8
+
+struct OpcodeStats_Counters {
+    Uint64 Count[0x100];
+    Uint64 Cycles[0x100];
+};
+struct OpcodeStats_NativeCounter {
+    Uint64 Count;
+    Uint64 Cycles;
+};
+struct OpcodeStats_Thread {
+    vector<OpcodeStats_Counters*>     Functions;
+    vector<OpcodeStats_NativeCounter> Natives;
+    Uint64*                           Pairs;
+    Uint8                             LastOpcode;
+};
+
+SDL_mutex*                  OpcodeStats_Lock = NULL;
+OpcodeStats_Thread          OpcodeStats_Threads[OPCODE_STATS_THREADS];
+const char*                 OpcodeStats_OpcodeNames[0x100];
+
+vector<string>              OpcodeStats_FunctionNames;
+unordered_map<string, int>  OpcodeStats_FunctionIDs;
+vector<string>              OpcodeStats_NativeNames;
+unordered_map<string, int>  OpcodeStats_NativeIDs;
+
+int OpcodeStats_GetID(const string& name, vector<string>* names, unordered_map<string, int>* ids) {
+    SDL_LockMutex(OpcodeStats_Lock);
+    int id;
+    auto it = ids->find(name);
+    if (it != ids->end()) {
+        id = it->second;
+    }
+    else {
+        id = (int)names->size();
+        names->push_back(name);
+        (*ids)[name] = id;
+    }
+    SDL_UnlockMutex(OpcodeStats_Lock);
+    // IDs are stored off by one, so that zeroed objects read as unassigned
+    return id + 1;
+}
+
+PUBLIC STATIC void OpcodeStats::Init() {
+    if (!OpcodeStats_Lock)
+        OpcodeStats_Lock = SDL_CreateMutex();
+
+    for (int i = 0; i < 0x100; i++)
+        OpcodeStats_OpcodeNames[i] = NULL;
+
+    #define OPCODE_NAME(op) OpcodeStats_OpcodeNames[op] = #op
+    OPCODE_NAME(OP_ERROR);
+    OPCODE_NAME(OP_CONSTANT);
+    OPCODE_NAME(OP_DEFINE_GLOBAL);
+    OPCODE_NAME(OP_GET_PROPERTY);
+    OPCODE_NAME(OP_SET_PROPERTY);
+    OPCODE_NAME(OP_GET_GLOBAL);
+    OPCODE_NAME(OP_SET_GLOBAL);
+    OPCODE_NAME(OP_GET_LOCAL);
+    OPCODE_NAME(OP_SET_LOCAL);
+    OPCODE_NAME(OP_PRINT_STACK);
+    OPCODE_NAME(OP_INHERIT);
+    OPCODE_NAME(OP_RETURN);
+    OPCODE_NAME(OP_METHOD);
+    OPCODE_NAME(OP_CLASS);
+    OPCODE_NAME(OP_CALL);
+    OPCODE_NAME(OP_SUPER);
+    OPCODE_NAME(OP_INVOKE);
+    OPCODE_NAME(OP_JUMP);
+    OPCODE_NAME(OP_JUMP_IF_FALSE);
+    OPCODE_NAME(OP_JUMP_BACK);
+    OPCODE_NAME(OP_POP);
+    OPCODE_NAME(OP_COPY);
+    OPCODE_NAME(OP_ADD);
+    OPCODE_NAME(OP_SUBTRACT);
+    OPCODE_NAME(OP_MULTIPLY);
+    OPCODE_NAME(OP_DIVIDE);
+    OPCODE_NAME(OP_MODULO);
+    OPCODE_NAME(OP_NEGATE);
+    OPCODE_NAME(OP_INCREMENT);
+    OPCODE_NAME(OP_DECREMENT);
+    OPCODE_NAME(OP_BITSHIFT_LEFT);
+    OPCODE_NAME(OP_BITSHIFT_RIGHT);
+    OPCODE_NAME(OP_NULL);
+    OPCODE_NAME(OP_TRUE);
+    OPCODE_NAME(OP_FALSE);
+    OPCODE_NAME(OP_BW_NOT);
+    OPCODE_NAME(OP_BW_AND);
+    OPCODE_NAME(OP_BW_OR);
+    OPCODE_NAME(OP_BW_XOR);
+    OPCODE_NAME(OP_LG_NOT);
+    OPCODE_NAME(OP_LG_AND);
+    OPCODE_NAME(OP_LG_OR);
+    OPCODE_NAME(OP_EQUAL);
+    OPCODE_NAME(OP_EQUAL_NOT);
+    OPCODE_NAME(OP_GREATER);
+    OPCODE_NAME(OP_GREATER_EQUAL);
+    OPCODE_NAME(OP_LESS);
+    OPCODE_NAME(OP_LESS_EQUAL);
+    OPCODE_NAME(OP_PRINT);
+    OPCODE_NAME(OP_ENUM);
+    OPCODE_NAME(OP_SAVE_VALUE);
+    OPCODE_NAME(OP_LOAD_VALUE);
+    OPCODE_NAME(OP_WITH);
+    OPCODE_NAME(OP_GET_ELEMENT);
+    OPCODE_NAME(OP_SET_ELEMENT);
+    OPCODE_NAME(OP_NEW_ARRAY);
+    OPCODE_NAME(OP_NEW_MAP);
+    OPCODE_NAME(OP_SWITCH_TABLE);
+    OPCODE_NAME(OP_GET_LOCAL_PROPERTY);
+    OPCODE_NAME(OP_ADD_LOCAL_CONSTANT);
+    OPCODE_NAME(OP_COMPARE_JUMP_IF_FALSE);
+    OPCODE_NAME(OP_CONSTANT_LONG);
+    OPCODE_NAME(OP_GET_LOCAL_LONG);
+    OPCODE_NAME(OP_SET_LOCAL_LONG);
+    OPCODE_NAME(OP_SWITCH_TABLE_LONG);
+    #undef  OPCODE_NAME
+}
+
+PUBLIC STATIC int  OpcodeStats::RegisterNative(ObjClass* klass, const char* name) {
+    string fullName = klass->Name ? string(klass->Name->Chars) + "." + name : string(name);
+    return OpcodeStats_GetID(fullName, &OpcodeStats_NativeNames, &OpcodeStats_NativeIDs);
+}
+PRIVATE STATIC int OpcodeStats::GetFunctionID(ObjFunction* function) {
+    if (function->StatsID)
+        return function->StatsID;
+
+    char name[16];
+    const char* functionName = name;
+    if (BytecodeObjectManager::Tokens && BytecodeObjectManager::Tokens->Exists(function->NameHash))
+        functionName = BytecodeObjectManager::Tokens->Get(function->NameHash);
+    else
+        snprintf(name, sizeof(name), "$[%08X]", function->NameHash);
+
+    // Keyed by name rather than by pointer, so that recompiled or
+    //   reloaded functions keep adding to the same row.
+    string fullName = string(function->SourceFilename) + "." + functionName;
+    function->StatsID = OpcodeStats_GetID(fullName, &OpcodeStats_FunctionNames, &OpcodeStats_FunctionIDs);
+    return function->StatsID;
+}
+
+PUBLIC STATIC void OpcodeStats::RecordInstruction(VMThread* thread, ObjFunction* function, Uint8 opcode, Uint64 cycles) {
+    if (thread->ID >= OPCODE_STATS_THREADS)
+        return;
+
+    OpcodeStats_Thread* stats = &OpcodeStats_Threads[thread->ID];
+
+    size_t id = (size_t)OpcodeStats::GetFunctionID(function) - 1;
+    if (id >= stats->Functions.size())
+        stats->Functions.resize(id + 1, NULL);
+    if (!stats->Functions[id])
+        stats->Functions[id] = (OpcodeStats_Counters*)Memory::Calloc(1, sizeof(OpcodeStats_Counters));
+
+    stats->Functions[id]->Count[opcode]++;
+    stats->Functions[id]->Cycles[opcode] += cycles;
+
+    if (!stats->Pairs)
+        stats->Pairs = (Uint64*)Memory::Calloc(0x100 * 0x100, sizeof(Uint64));
+    stats->Pairs[(stats->LastOpcode << 8) | opcode]++;
+    stats->LastOpcode = opcode;
+}
+PUBLIC STATIC void OpcodeStats::RecordNative(VMThread* thread, ObjNative* native, Uint64 cycles) {
+    if (thread->ID >= OPCODE_STATS_THREADS || !native->StatsID)
+        return;
+
+    OpcodeStats_Thread* stats = &OpcodeStats_Threads[thread->ID];
+
+    size_t id = (size_t)native->StatsID - 1;
+    if (id >= stats->Natives.size()) {
+        OpcodeStats_NativeCounter empty = { 0, 0 };
+        stats->Natives.resize(id + 1, empty);
+    }
+
+    stats->Natives[id].Count++;
+    stats->Natives[id].Cycles += cycles;
+}
+
+PUBLIC STATIC bool OpcodeStats::WriteReport(const char* filename) {
+    struct Row {
+        string Name;
+        Uint64 Count;
+        Uint64 Cycles;
+    };
+
+    // Merge every thread's tables
+    SDL_LockMutex(OpcodeStats_Lock);
+    size_t functionCount = OpcodeStats_FunctionNames.size();
+    size_t nativeCount = OpcodeStats_NativeNames.size();
+    SDL_UnlockMutex(OpcodeStats_Lock);
+
+    OpcodeStats_Counters totals;
+    memset(&totals, 0, sizeof(totals));
+
+    vector<Row> pairRows;
+    vector<Row> nativeRows(nativeCount);
+    Uint64*     pairs = (Uint64*)Memory::Calloc(0x100 * 0x100, sizeof(Uint64));
+    Uint64      totalCount = 0, totalCycles = 0;
+
+    for (size_t f = 0; f < functionCount; f++) {
+        OpcodeStats_Counters counters;
+        memset(&counters, 0, sizeof(counters));
+
+        for (int t = 0; t < OPCODE_STATS_THREADS; t++) {
+            OpcodeStats_Thread* stats = &OpcodeStats_Threads[t];
+            if (f >= stats->Functions.size() || !stats->Functions[f])
+                continue;
+
+            for (int op = 0; op < 0x100; op++) {
+                counters.Count[op] += stats->Functions[f]->Count[op];
+                counters.Cycles[op] += stats->Functions[f]->Cycles[op];
+            }
+        }
+
+        for (int op = 0; op < 0x100; op++) {
+            if (!counters.Count[op])
+                continue;
+
+            Row row;
+            row.Name = OpcodeStats_FunctionNames[f] + " " + (OpcodeStats_OpcodeNames[op] ? OpcodeStats_OpcodeNames[op] : "OP_UNKNOWN");
+            row.Count = counters.Count[op];
+            row.Cycles = counters.Cycles[op];
+            pairRows.push_back(row);
+
+            totals.Count[op] += counters.Count[op];
+            totals.Cycles[op] += counters.Cycles[op];
+            totalCount += counters.Count[op];
+            totalCycles += counters.Cycles[op];
+        }
+    }
+    for (size_t n = 0; n < nativeCount; n++) {
+        nativeRows[n].Name = OpcodeStats_NativeNames[n];
+        nativeRows[n].Count = 0;
+        nativeRows[n].Cycles = 0;
+        for (int t = 0; t < OPCODE_STATS_THREADS; t++) {
+            OpcodeStats_Thread* stats = &OpcodeStats_Threads[t];
+            if (n >= stats->Natives.size())
+                continue;
+
+            nativeRows[n].Count += stats->Natives[n].Count;
+            nativeRows[n].Cycles += stats->Natives[n].Cycles;
+        }
+    }
+    for (int t = 0; t < OPCODE_STATS_THREADS; t++) {
+        if (!OpcodeStats_Threads[t].Pairs)
+            continue;
+        for (int i = 0; i < 0x100 * 0x100; i++)
+            pairs[i] += OpcodeStats_Threads[t].Pairs[i];
+    }
+
+    if (!totalCount) {
+        Memory::Free(pairs);
+        return false;
+    }
+
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        Log::Print(Log::LOG_ERROR, "Could not open \"%s\" to write opcode stats!", filename);
+        Memory::Free(pairs);
+        return false;
+    }
+
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    auto byCycles = [](const Row& a, const Row& b) -> bool {
+        return a.Cycles > b.Cycles;
+    };
+    auto byCount = [](const Row& a, const Row& b) -> bool {
+        return a.Count > b.Count;
+    };
+
+    fprintf(f, "%llu instructions, %.3f ms\n", (unsigned long long)totalCount, totalCycles * 1000.0 / frequency);
+
+    vector<Row> opcodeRows;
+    for (int op = 0; op < 0x100; op++) {
+        if (!totals.Count[op])
+            continue;
+
+        Row row;
+        row.Name = OpcodeStats_OpcodeNames[op] ? OpcodeStats_OpcodeNames[op] : "OP_UNKNOWN";
+        row.Count = totals.Count[op];
+        row.Cycles = totals.Cycles[op];
+        opcodeRows.push_back(row);
+    }
+    std::sort(opcodeRows.begin(), opcodeRows.end(), byCycles);
+
+    fprintf(f, "\nOpcodes:\n");
+    fprintf(f, "    %-28s %14s %12s %10s %7s\n", "Opcode", "Count", "Time (ms)", "ns/op", "Time %");
+    for (size_t i = 0; i < opcodeRows.size(); i++) {
+        Row& row = opcodeRows[i];
+        fprintf(f, "    %-28s %14llu %12.3f %10.1f %6.2f%%\n", row.Name.c_str(), (unsigned long long)row.Count,
+            row.Cycles * 1000.0 / frequency, row.Cycles * 1.0e9 / frequency / row.Count, row.Cycles * 100.0 / totalCycles);
+    }
+
+    vector<Row> sequenceRows;
+    for (int i = 0; i < 0x100 * 0x100; i++) {
+        if (!pairs[i])
+            continue;
+
+        const char* first = OpcodeStats_OpcodeNames[i >> 8];
+        const char* second = OpcodeStats_OpcodeNames[i & 0xFF];
+
+        Row row;
+        row.Name = string(first ? first : "OP_UNKNOWN") + " -> " + (second ? second : "OP_UNKNOWN");
+        row.Count = pairs[i];
+        row.Cycles = 0;
+        sequenceRows.push_back(row);
+    }
+    std::sort(sequenceRows.begin(), sequenceRows.end(), byCount);
+
+    // Adjacent pairs are what a superinstruction would fuse
+    fprintf(f, "\nOpcode pairs:\n");
+    fprintf(f, "    %-56s %14s %7s\n", "Pair", "Count", "Count %");
+    for (size_t i = 0; i < sequenceRows.size() && i < 100; i++) {
+        Row& row = sequenceRows[i];
+        fprintf(f, "    %-56s %14llu %6.2f%%\n", row.Name.c_str(), (unsigned long long)row.Count, row.Count * 100.0 / totalCount);
+    }
+
+    std::sort(pairRows.begin(), pairRows.end(), byCycles);
+
+    fprintf(f, "\nFunctions:\n");
+    fprintf(f, "    %-72s %14s %12s %7s\n", "Function / Opcode", "Count", "Time (ms)", "Time %");
+    for (size_t i = 0; i < pairRows.size(); i++) {
+        Row& row = pairRows[i];
+        fprintf(f, "    %-72s %14llu %12.3f %6.2f%%\n", row.Name.c_str(), (unsigned long long)row.Count,
+            row.Cycles * 1000.0 / frequency, row.Cycles * 100.0 / totalCycles);
+    }
+
+    std::sort(nativeRows.begin(), nativeRows.end(), byCount);
+
+    // Native time includes any script the native calls back into
+    fprintf(f, "\nNatives:\n");
+    fprintf(f, "    %-48s %14s %12s %10s\n", "Native", "Calls", "Time (ms)", "us/call");
+    for (size_t i = 0; i < nativeRows.size(); i++) {
+        Row& row = nativeRows[i];
+        if (!row.Count)
+            continue;
+        fprintf(f, "    %-48s %14llu %12.3f %10.3f\n", row.Name.c_str(), (unsigned long long)row.Count,
+            row.Cycles * 1000.0 / frequency, row.Cycles * 1.0e6 / frequency / row.Count);
+    }
+
+    fclose(f);
+    Memory::Free(pairs);
+
+    Log::Print(Log::LOG_INFO, "Wrote opcode stats for %llu instructions to \"%s\".", (unsigned long long)totalCount, filename);
+    return true;
+}
+
+PUBLIC STATIC void OpcodeStats::Dispose() {
+    char filename[4096];
+    snprintf(filename, sizeof(filename), "opcode-stats.txt");
+    if (Application::Settings)
+        Application::Settings->GetString("dev", "opcodeStatsFile", filename);
+
+    OpcodeStats::WriteReport(filename);
+
+    for (int t = 0; t < OPCODE_STATS_THREADS; t++) {
+        OpcodeStats_Thread* stats = &OpcodeStats_Threads[t];
+        for (size_t i = 0; i < stats->Functions.size(); i++)
+            Memory::Free(stats->Functions[i]);
+        if (stats->Pairs)
+            Memory::Free(stats->Pairs);
+
+        stats->Functions.clear();
+        stats->Natives.clear();
+        stats->Pairs = NULL;
+    }
+
+    if (OpcodeStats_Lock) {
+        SDL_DestroyMutex(OpcodeStats_Lock);
+        OpcodeStats_Lock = NULL;
+    }
+}
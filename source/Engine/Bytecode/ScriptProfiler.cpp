@@ -0,0 +1,174 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+#include <Engine/Bytecode/VMThread.h>
+
+class ScriptProfiler {
+public:
+    static bool         Running;
+    static SDL_atomic_t Tick;
+};
+#endif
+
+#include <Engine/Bytecode/ScriptProfiler.h>
+#include <Engine/Application.h>
+#include <Engine/Bytecode/BytecodeObjectManager.h>
+#include <Engine/Diagnostics/Log.h>
+
+bool         ScriptProfiler::Running = false;
+SDL_atomic_t ScriptProfiler::Tick = { 0 };
+
+// NOTE: The timer never touches the VM; it only advances Tick. Each
+//   VMThread checks Tick between instructions and, when it has moved,
+//   records its own call stack weighted by how many ticks went by. That
+//   keeps the timer away from the interpreter, and time spent inside a
+//   native call is charged to the script line that made it. Threads
+//   started with Thread.RunEvent sample too, so the stack table is
+//   still guarded by a mutex.
+SDL_TimerID  Profiler_Timer = 0;
+SDL_mutex*   Profiler_Lock = NULL;
+int          Profiler_Interval = 1;
+Uint32       Profiler_SampleCount = 0;
+char         Profiler_Filename[4096] = "profile.folded";
+
+unordered_map<string, Uint32> Profiler_Stacks;
+
+Uint32 Profiler_TimerCallback(Uint32 interval, void* param) {
+    SDL_AtomicAdd(&ScriptProfiler::Tick, 1);
+    return interval;
+}
+
+PUBLIC STATIC void ScriptProfiler::Start() {
+    if (Running)
+        return;
+
+    Profiler_Interval = 1;
+    Application::Settings->GetInteger("dev", "profilerInterval", &Profiler_Interval);
+    if (Profiler_Interval < 1)
+        Profiler_Interval = 1;
+
+    if (!SDL_WasInit(SDL_INIT_TIMER) && SDL_InitSubSystem(SDL_INIT_TIMER) < 0) {
+        Log::Print(Log::LOG_ERROR, "Could not start script profiler: %s", SDL_GetError());
+        return;
+    }
+
+    Profiler_Timer = SDL_AddTimer(Profiler_Interval, Profiler_TimerCallback, NULL);
+    if (!Profiler_Timer) {
+        Log::Print(Log::LOG_ERROR, "Could not start script profiler: %s", SDL_GetError());
+        return;
+    }
+
+    if (!Profiler_Lock)
+        Profiler_Lock = SDL_CreateMutex();
+
+    SDL_LockMutex(Profiler_Lock);
+    Profiler_Stacks.clear();
+    Profiler_SampleCount = 0;
+    SDL_UnlockMutex(Profiler_Lock);
+
+    Running = true;
+    Log::Print(Log::LOG_INFO, "Script profiler started (sampling every %d ms).", Profiler_Interval);
+}
+PUBLIC STATIC void ScriptProfiler::Start(const char* filename) {
+    strncpy(Profiler_Filename, filename, sizeof(Profiler_Filename) - 1);
+    Profiler_Filename[sizeof(Profiler_Filename) - 1] = 0;
+    ScriptProfiler::Start();
+}
+PUBLIC STATIC void ScriptProfiler::Stop() {
+    if (!Running)
+        return;
+
+    Running = false;
+    SDL_RemoveTimer(Profiler_Timer);
+    Profiler_Timer = 0;
+
+    ScriptProfiler::WriteFolded(Profiler_Filename);
+
+    SDL_LockMutex(Profiler_Lock);
+    Profiler_Stacks.clear();
+    SDL_UnlockMutex(Profiler_Lock);
+}
+PUBLIC STATIC void ScriptProfiler::Toggle() {
+    if (Running)
+        ScriptProfiler::Stop();
+    else
+        ScriptProfiler::Start();
+}
+
+PUBLIC STATIC void ScriptProfiler::Sample(VMThread* thread) {
+    Uint32 tick = (Uint32)SDL_AtomicGet(&Tick);
+    Uint32 weight = tick - thread->ProfilerTick;
+    thread->ProfilerTick = tick;
+
+    if (thread->FrameCount == 0)
+        return;
+
+    // Folded stacks go from the root frame to the leaf, separated by ';'
+    char   stack[2048];
+    size_t length = 0;
+    for (Uint32 i = 0; i < thread->FrameCount && length < sizeof(stack) - 1; i++) {
+        CallFrame*   frame = &thread->Frames[i];
+        ObjFunction* function = frame->Function;
+
+        int line = -1;
+        if (function->Chunk.Lines)
+            line = function->Chunk.Lines[frame->IPLast - frame->IPStart] & 0xFFFF;
+
+        char name[16];
+        const char* functionName = name;
+        if (BytecodeObjectManager::Tokens && BytecodeObjectManager::Tokens->Exists(function->NameHash))
+            functionName = BytecodeObjectManager::Tokens->Get(function->NameHash);
+        else
+            snprintf(name, sizeof(name), "$[%08X]", function->NameHash);
+
+        int written;
+        if (line < 0)
+            written = snprintf(stack + length, sizeof(stack) - length, "%s%s (%s)", i ? ";" : "", functionName, function->SourceFilename);
+        else
+            written = snprintf(stack + length, sizeof(stack) - length, "%s%s (%s:%d)", i ? ";" : "", functionName, function->SourceFilename, line);
+        if (written < 0)
+            break;
+
+        length += written;
+    }
+    if (length > sizeof(stack) - 1)
+        length = sizeof(stack) - 1;
+
+    SDL_LockMutex(Profiler_Lock);
+    Profiler_Stacks[string(stack, length)] += weight;
+    Profiler_SampleCount += weight;
+    SDL_UnlockMutex(Profiler_Lock);
+}
+
+PUBLIC STATIC bool ScriptProfiler::WriteFolded(const char* filename) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        Log::Print(Log::LOG_ERROR, "Could not open \"%s\" to write script profile!", filename);
+        return false;
+    }
+
+    // Sorted so that two profiles of the same run diff cleanly
+    SDL_LockMutex(Profiler_Lock);
+    vector<pair<string, Uint32>> stacks(Profiler_Stacks.begin(), Profiler_Stacks.end());
+    Uint32 sampleCount = Profiler_SampleCount;
+    SDL_UnlockMutex(Profiler_Lock);
+
+    std::sort(stacks.begin(), stacks.end());
+
+    for (size_t i = 0; i < stacks.size(); i++)
+        fprintf(f, "%s %u\n", stacks[i].first.c_str(), stacks[i].second);
+
+    fclose(f);
+
+    Log::Print(Log::LOG_INFO, "Script profiler wrote %u samples (%d unique stacks) to \"%s\".", sampleCount, (int)stacks.size(), filename);
+    return true;
+}
+
+PUBLIC STATIC void ScriptProfiler::Dispose() {
+    ScriptProfiler::Stop();
+
+    if (Profiler_Lock) {
+        SDL_DestroyMutex(Profiler_Lock);
+        Profiler_Lock = NULL;
+    }
+}
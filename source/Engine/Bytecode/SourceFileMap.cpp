@@ -1,6 +1,18 @@
 #if INTERFACE
+#include <Engine/Includes/Standard.h>
 #include <Engine/Hashing/CombinedHash.h>
 #include <Engine/Includes/HashMap.h>
+
+struct SourceFileJob {
+    char*          Filename;
+    Uint32         FilenameHash;
+    char*          Source;
+    Uint32         Checksum;
+    bool           Compile;
+    vector<Uint32> ClassHashList;
+    vector<Uint32> ClassExtendedList;
+};
+
 class SourceFileMap {
 public:
     static bool                      Initialized;
@@ -12,13 +24,17 @@ public:
 
 #include <Engine/Bytecode/SourceFileMap.h>
 
+#include <Engine/Application.h>
 #include <Engine/Bytecode/BytecodeObjectManager.h>
 #include <Engine/Bytecode/Compiler.h>
+#include <Engine/Diagnostics/Clock.h>
 #include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
 #include <Engine/IO/FileStream.h>
 #include <Engine/IO/ResourceStream.h>
 #include <Engine/Filesystem/Directory.h>
 #include <Engine/Filesystem/File.h>
+#include <Engine/Hashing/CRC32.h>
 #include <Engine/Hashing/FNV1A.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
 
@@ -27,6 +43,196 @@ HashMap<Uint32>*          SourceFileMap::Checksums = NULL;
 HashMap<vector<Uint32>*>* SourceFileMap::ClassMap = NULL;
 Uint32                    SourceFileMap::DirectoryChecksum = 0;
 
+enum {
+    SFM_PHASE_HASH,
+    SFM_PHASE_COMPILE,
+};
+#define SFM_MAX_THREADS 16
+
+vector<SourceFileJob>* SFM_Jobs = NULL;
+int                    SFM_Phase = SFM_PHASE_HASH;
+SDL_atomic_t           SFM_NextJob;
+SDL_atomic_t           SFM_CacheHits;
+
+// NOTE: Compiled bytecode is also kept in a cache folder shared by every
+//   working copy, keyed by the source text and the compiler build, so
+//   switching branches back and forth doesn't recompile anything that
+//   was compiled before.
+//   Each entry holds the class list (for Objects.hcm) followed by the
+//   .ibc file as-is:
+//     "HCCE", Uint32 classCount,
+//     classCount x (Uint32 classHash, Uint32 extended),
+//     Uint32 ibcSize, ibcSize bytes
+char                   SFM_CacheFolder[4096];
+bool                   SFM_CacheEnabled = false;
+
+void   SFM_InitCache() {
+    SFM_CacheEnabled = false;
+
+    bool useCache = true;
+    Application::Settings->GetBool("dev", "compileCache", &useCache);
+    if (!useCache)
+        return;
+
+    SFM_CacheFolder[0] = 0;
+    if (Application::Settings->GetString("dev", "compileCachePath", SFM_CacheFolder) && SFM_CacheFolder[0]) {
+        size_t len = strlen(SFM_CacheFolder);
+        if (SFM_CacheFolder[len - 1] != '/' && SFM_CacheFolder[len - 1] != '\\' && len + 1 < sizeof(SFM_CacheFolder))
+            strcat(SFM_CacheFolder, "/");
+        if (!Directory::Exists(SFM_CacheFolder))
+            Directory::Create(SFM_CacheFolder);
+    }
+    else {
+        char* prefPath = SDL_GetPrefPath("HatchGameEngine", "CompileCache");
+        if (!prefPath)
+            return;
+        snprintf(SFM_CacheFolder, sizeof(SFM_CacheFolder), "%s", prefPath);
+        SDL_free(prefPath);
+    }
+
+    SFM_CacheEnabled = Directory::Exists(SFM_CacheFolder);
+    if (!SFM_CacheEnabled)
+        Log::Print(Log::LOG_WARN, "Could not open compile cache folder \"%s\"!", SFM_CacheFolder);
+}
+void   SFM_GetCachePath(SourceFileJob* job, char* out, size_t outSize) {
+    Uint32 crc = CRC32::EncryptData(job->Source, (Uint32)strlen(job->Source));
+    snprintf(out, outSize, "%s%08X%08X%08X.hcc", SFM_CacheFolder, Compiler::GetBuildKey(), job->Checksum, crc);
+}
+bool   SFM_ReadCache(SourceFileJob* job, const char* cachePath, const char* outFile) {
+    if (!File::Exists(cachePath))
+        return false;
+
+    char*  data;
+    size_t size = File::ReadAllBytes(cachePath, &data);
+    if (!size)
+        return false;
+
+    Uint8* ptr = (Uint8*)data;
+    Uint8* end = ptr + size;
+    bool   success = false;
+    Uint32 classCount, ibcSize;
+
+    if (size < 8 || memcmp(ptr, "HCCE", 4) != 0)
+        goto DONE;
+    ptr += 4;
+
+    classCount = *(Uint32*)ptr; ptr += 4;
+    if ((size_t)(end - ptr) < (size_t)classCount * 8 + 4)
+        goto DONE;
+
+    job->ClassHashList.clear();
+    job->ClassExtendedList.clear();
+    for (Uint32 i = 0; i < classCount; i++) {
+        job->ClassHashList.push_back(*(Uint32*)ptr); ptr += 4;
+        job->ClassExtendedList.push_back(*(Uint32*)ptr); ptr += 4;
+    }
+
+    ibcSize = *(Uint32*)ptr; ptr += 4;
+    if ((size_t)(end - ptr) != ibcSize)
+        goto DONE;
+
+    success = File::WriteAllBytes(outFile, (char*)ptr, ibcSize);
+
+    DONE:
+    Memory::Free(data);
+    return success;
+}
+void   SFM_WriteCache(SourceFileJob* job, const char* cachePath, const char* outFile) {
+    char*  ibc;
+    size_t ibcSize = File::ReadAllBytes(outFile, &ibc);
+    if (!ibcSize)
+        return;
+
+    // Write to a temporary file first, so another working copy reading
+    //   the same entry never sees half of it.
+    char tempPath[4096];
+    snprintf(tempPath, sizeof(tempPath), "%s.%08X.tmp", cachePath, (Uint32)SDL_GetPerformanceCounter() ^ job->FilenameHash);
+
+    FileStream* stream = FileStream::New(tempPath, FileStream::WRITE_ACCESS);
+    if (stream) {
+        stream->WriteBytes((char*)"HCCE", 4);
+        stream->WriteUInt32((Uint32)job->ClassHashList.size());
+        for (size_t i = 0; i < job->ClassHashList.size(); i++) {
+            stream->WriteUInt32(job->ClassHashList[i]);
+            stream->WriteUInt32(job->ClassExtendedList[i]);
+        }
+        stream->WriteUInt32((Uint32)ibcSize);
+        stream->WriteBytes(ibc, ibcSize);
+        stream->Close();
+
+        if (rename(tempPath, cachePath) != 0)
+            remove(tempPath);
+    }
+
+    Memory::Free(ibc);
+}
+
+void   SFM_RunJob(SourceFileJob* job) {
+    if (SFM_Phase == SFM_PHASE_HASH) {
+        File::ReadAllBytes(job->Filename, &job->Source);
+        job->Checksum = FNV1A::EncryptString(job->Source);
+
+        Memory::Track(job->Source, "SourceFileMap::SourceText");
+        return;
+    }
+
+    if (!job->Compile)
+        return;
+
+    char outFile[256];
+    snprintf(outFile, sizeof(outFile), "Resources/Objects/%08X.ibc", job->FilenameHash);
+
+    char cachePath[4096];
+    if (SFM_CacheEnabled) {
+        SFM_GetCachePath(job, cachePath, sizeof(cachePath));
+        if (SFM_ReadCache(job, cachePath, outFile)) {
+            SDL_AtomicIncRef(&SFM_CacheHits);
+            return;
+        }
+    }
+
+    Compiler* compiler = new Compiler;
+    bool success = compiler->Compile(job->Filename, job->Source, outFile);
+
+    job->ClassHashList = compiler->ClassHashList;
+    job->ClassExtendedList = compiler->ClassExtendedList;
+
+    delete compiler;
+
+    if (success && SFM_CacheEnabled)
+        SFM_WriteCache(job, cachePath, outFile);
+}
+int    SFM_WorkerThread(void* data) {
+    int index;
+    while ((index = SDL_AtomicAdd(&SFM_NextJob, 1)) < (int)SFM_Jobs->size())
+        SFM_RunJob(&(*SFM_Jobs)[index]);
+    return 0;
+}
+
+PRIVATE STATIC void SourceFileMap::RunJobs(vector<SourceFileJob>* jobs, int phase, int threadCount) {
+    SFM_Jobs = jobs;
+    SFM_Phase = phase;
+    SDL_AtomicSet(&SFM_NextJob, 0);
+
+    // The calling thread takes jobs as well
+    int extraThreads = threadCount - 1;
+    if (extraThreads > (int)jobs->size() - 1)
+        extraThreads = (int)jobs->size() - 1;
+    if (extraThreads > SFM_MAX_THREADS)
+        extraThreads = SFM_MAX_THREADS;
+
+    SDL_Thread* threads[SFM_MAX_THREADS];
+    for (int i = 0; i < extraThreads; i++)
+        threads[i] = SDL_CreateThread(SFM_WorkerThread, "SourceFileMap::WorkerThread", NULL);
+
+    SFM_WorkerThread(NULL);
+
+    for (int i = 0; i < extraThreads; i++)
+        SDL_WaitThread(threads[i], NULL);
+
+    SFM_Jobs = NULL;
+}
+
 PUBLIC STATIC void SourceFileMap::CheckInit() {
     if (SourceFileMap::Initialized) return;
 
@@ -85,8 +291,6 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
 
     bool anyChanges = false;
 
-    bool freeTokens = true;
-
     const char* scriptFolder = "Scripts";
     size_t      scriptFolderNameLen = strlen(scriptFolder);
 
@@ -117,11 +321,10 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
         SourceFileMap::ClassMap->Clear();
     }
 
-    char outFile[256];
+    vector<SourceFileJob> jobs;
     for (size_t i = 0; i < list.size(); i++) {
         char* filename = strrchr(list[i], '/');
         Uint32 filenameHash = 0;
-        Uint32 newChecksum, oldChecksum;
         if (filename) {
             filename++;
             int dot = strlen(filename) - 4;
@@ -131,33 +334,74 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
         }
         if (!filenameHash) { Memory::Free(list[i]); continue; }
 
-        newChecksum = 0;
-        oldChecksum = 0;
+        SourceFileJob job;
+        job.Filename = list[i];
+        job.FilenameHash = filenameHash;
+        job.Source = NULL;
+        job.Checksum = 0;
+        job.Compile = false;
+        jobs.push_back(job);
+    }
+
+    int threadCount = SDL_GetCPUCount();
+    if (Application::Settings)
+        Application::Settings->GetInteger("dev", "compilerThreads", &threadCount);
 
-        char*  source;
-        File::ReadAllBytes(list[i], &source);
-        newChecksum = FNV1A::EncryptString(source);
+    Compiler::Init();
 
-        Memory::Track(source, "SourceFileMap::SourceText");
+    // Memory tracking isn't thread-safe, and the compiler's debug
+    //   output would interleave, so stay on this thread for either.
+    if (Memory::IsTracking || Compiler::IsDebugging())
+        threadCount = 1;
 
-        if (SourceFileMap::Checksums->Exists(filenameHash)) {
-            oldChecksum = SourceFileMap::Checksums->Get(filenameHash);
+    // Read and hash every file
+    SourceFileMap::RunJobs(&jobs, SFM_PHASE_HASH, threadCount);
+
+    char outFile[256];
+    int  compileCount = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        SourceFileJob* job = &jobs[i];
+
+        Uint32 oldChecksum = 0;
+        if (SourceFileMap::Checksums->Exists(job->FilenameHash)) {
+            oldChecksum = SourceFileMap::Checksums->Get(job->FilenameHash);
         }
-        anyChanges |= (newChecksum != oldChecksum);
+        anyChanges |= (job->Checksum != oldChecksum);
 
-        sprintf(outFile, "Resources/Objects/%08X.ibc", filenameHash);
+        sprintf(outFile, "Resources/Objects/%08X.ibc", job->FilenameHash);
         // If changed, then compile.
-        if (newChecksum != oldChecksum || !File::Exists(outFile) || !freeTokens) {
-            Compiler::Init();
+        if (job->Checksum != oldChecksum || !File::Exists(outFile)) {
+            job->Compile = true;
+            compileCount++;
+        }
+    }
 
-            Compiler* compiler = new Compiler;
-            compiler->Compile(list[i], source, outFile);
+    if (compileCount > 0) {
+        double ticks = Clock::GetTicks();
 
+        SFM_InitCache();
+        SDL_AtomicSet(&SFM_CacheHits, 0);
+
+        SourceFileMap::RunJobs(&jobs, SFM_PHASE_COMPILE, threadCount);
+
+        int cacheHits = SDL_AtomicGet(&SFM_CacheHits);
+        Log::Print(Log::LOG_VERBOSE, "Compiled %d script(s) in %.3f ms (%d from cache)", compileCount - cacheHits, Clock::GetTicks() - ticks, cacheHits);
+    }
+
+    Compiler::Dispose();
+
+    // Merge in directory order, so the class map comes out the same
+    //   no matter which thread finished first.
+    for (size_t i = 0; i < jobs.size(); i++) {
+        SourceFileJob* job = &jobs[i];
+        Uint32 filenameHash = job->FilenameHash;
+
+        if (job->Compile) {
             // Add this file to the list
             // Log::Print(Log::LOG_INFO, "filename: %s (0x%08X)", filename, filenameHash);
-            for (size_t h = 0; h < compiler->ClassHashList.size(); h++) {
-                Uint32 classHash = compiler->ClassHashList[h];
-                Uint32 classExtended = compiler->ClassExtendedList[h];
+            for (size_t h = 0; h < job->ClassHashList.size(); h++) {
+                Uint32 classHash = job->ClassHashList[h];
+                Uint32 classExtended = job->ClassExtendedList[h];
                 if (SourceFileMap::ClassMap->Exists(classHash)) {
                     vector<Uint32>* filenameHashList = SourceFileMap::ClassMap->Get(classHash);
                     if (std::count(filenameHashList->begin(), filenameHashList->end(), filenameHash) == 0) {
@@ -176,17 +420,13 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
                 // Log::Print(Log::LOG_INFO, "class hash: 0x%08X    size: %d",
                 //     classHash, (int)SourceFileMap::ClassMap->Get(classHash)->size());
             }
-
-            delete compiler;
-            Compiler::Dispose(freeTokens);
         }
-        if (freeTokens)
-            Memory::Free(source);
 
         // Log::Print(Log::LOG_INFO, "List: %s (%08X) (old: %08X, new: %08X) %d", list[i], filenameHash, oldChecksum, newChecksum, compiled);
 
-        SourceFileMap::Checksums->Put(filenameHash, newChecksum);
-        Memory::Free(list[i]);
+        SourceFileMap::Checksums->Put(filenameHash, job->Checksum);
+        Memory::Free(job->Source);
+        Memory::Free(job->Filename);
     }
 
     if (anyChanges) {
@@ -18,6 +18,7 @@ public:
 #include <Engine/Bytecode/BytecodeObject.h>
 #include <Engine/Bytecode/BytecodeObjectManager.h>
 #include <Engine/Bytecode/Compiler.h>
+#include <Engine/Bytecode/GarbageCollector.h>
 #include <Engine/Filesystem/File.h>
 #include <Engine/Filesystem/Directory.h>
 #include <Engine/Hashing/CombinedHash.h>
@@ -32,6 +33,7 @@ public:
 #include <Engine/Network/WebSocketClient.h>
 #include <Engine/Rendering/GL/GLRenderer.h>
 #include <Engine/Rendering/GL/GLShader.h>
+#include <Engine/ResourceTypes/ResourceLoader.h>
 #include <Engine/ResourceTypes/ResourceType.h>
 #include <Engine/TextFormats/JSON/jsmn.h>
 
@@ -127,6 +129,14 @@ namespace LOCAL {
         }
         return value;
     }
+    inline ObjTypedArray*  GetTypedArray(VMValue* args, int index, Uint32 threadID) {
+        if (!IS_TYPED_ARRAY(args[index])) {
+            BytecodeObjectManager::Threads[threadID].ThrowError(true,
+                "Expected argument %d to be of type %s instead of %s.", index + 1, "TypedArray", GetTypeString(args[index]));
+            return NULL;
+        }
+        return AS_TYPED_ARRAY(args[index]);
+    }
     inline ObjBoundMethod* GetBoundMethod(VMValue* args, int index, Uint32 threadID) {
         ObjBoundMethod* value = NULL;
         if (BytecodeObjectManager::Lock()) {
@@ -239,7 +249,9 @@ VMValue Array_Length(int argCount, VMValue* args, Uint32 threadID) {
 
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
+        BytecodeObjectManager::LockObject(array);
         int size = (int)array->Values->size();
+        BytecodeObjectManager::UnlockObject(array);
         BytecodeObjectManager::Unlock();
         return INTEGER_VAL(size);
     }
@@ -257,7 +269,10 @@ VMValue Array_Push(int argCount, VMValue* args, Uint32 threadID) {
 
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
+        BytecodeObjectManager::LockObject(array);
         array->Values->push_back(args[1]);
+        BytecodeObjectManager::UnlockObject(array);
+        GarbageCollector::WriteBarrier(array, args[1]);
         BytecodeObjectManager::Unlock();
     }
     return NULL_VAL;
@@ -274,8 +289,10 @@ VMValue Array_Pop(int argCount, VMValue* args, Uint32 threadID) {
 
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
+        BytecodeObjectManager::LockObject(array);
         VMValue   value = array->Values->back();
         array->Values->pop_back();
+        BytecodeObjectManager::UnlockObject(array);
         BytecodeObjectManager::Unlock();
         return value;
     }
@@ -295,7 +312,10 @@ VMValue Array_Insert(int argCount, VMValue* args, Uint32 threadID) {
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
         int       index = GetInteger(args, 1, threadID);
+        BytecodeObjectManager::LockObject(array);
         array->Values->insert(array->Values->begin() + index, args[2]);
+        BytecodeObjectManager::UnlockObject(array);
+        GarbageCollector::WriteBarrier(array, args[2]);
         BytecodeObjectManager::Unlock();
     }
     return NULL_VAL;
@@ -313,7 +333,9 @@ VMValue Array_Erase(int argCount, VMValue* args, Uint32 threadID) {
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
         int       index = GetInteger(args, 1, threadID);
+        BytecodeObjectManager::LockObject(array);
         array->Values->erase(array->Values->begin() + index);
+        BytecodeObjectManager::UnlockObject(array);
         BytecodeObjectManager::Unlock();
     }
     return NULL_VAL;
@@ -329,7 +351,9 @@ VMValue Array_Clear(int argCount, VMValue* args, Uint32 threadID) {
 
     if (BytecodeObjectManager::Lock()) {
         ObjArray* array = GetArray(args, 0, threadID);
+        BytecodeObjectManager::LockObject(array);
         array->Values->clear();
+        BytecodeObjectManager::UnlockObject(array);
         BytecodeObjectManager::Unlock();
     }
     return NULL_VAL;
@@ -1034,6 +1058,11 @@ VMValue Draw_SetBlendFactorExtended(int argCount, VMValue* args, Uint32 threadID
     Graphics::SetBlendMode(srcC, dstC, srcA, dstA);
     return NULL_VAL;
 }
+VMValue Draw_SetFilter(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    Graphics::SetFilter(GetInteger(args, 0, threadID));
+    return NULL_VAL;
+}
 
 VMValue Draw_Line(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(4);
@@ -1228,6 +1257,7 @@ VMValue File_ReadAllText(int argCount, VMValue* args, Uint32 threadID) {
         ObjString* text = AllocString(size);
         stream->ReadBytes(text->Chars, size);
         stream->Close();
+        text = InternString(text);
         BytecodeObjectManager::Unlock();
         return OBJECT_VAL(text);
     }
@@ -2226,6 +2256,38 @@ VMValue Resources_LoadVideo(int argCount, VMValue* args, Uint32 threadID) {
     #endif
     return INTEGER_VAL(-1);
 }
+VMValue Resources_LoadSpriteAsync(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    char*  filename = GetString(args, 0, threadID);
+    return INTEGER_VAL(ResourceLoader::Request(ResourceLoader::TYPE_SPRITE, filename, GetInteger(args, 1, threadID)));
+}
+VMValue Resources_LoadImageAsync(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    char*  filename = GetString(args, 0, threadID);
+    return INTEGER_VAL(ResourceLoader::Request(ResourceLoader::TYPE_IMAGE, filename, GetInteger(args, 1, threadID)));
+}
+VMValue Resources_LoadMusicAsync(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    char*  filename = GetString(args, 0, threadID);
+    return INTEGER_VAL(ResourceLoader::Request(ResourceLoader::TYPE_MUSIC, filename, GetInteger(args, 1, threadID)));
+}
+VMValue Resources_LoadSoundAsync(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    char*  filename = GetString(args, 0, threadID);
+    return INTEGER_VAL(ResourceLoader::Request(ResourceLoader::TYPE_SOUND, filename, GetInteger(args, 1, threadID)));
+}
+VMValue Resources_GetLoadStatus(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    return INTEGER_VAL(ResourceLoader::GetStatus(GetInteger(args, 0, threadID)));
+}
+VMValue Resources_GetLoadResult(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    return INTEGER_VAL(ResourceLoader::GetResult(GetInteger(args, 0, threadID)));
+}
+VMValue Resources_GetPendingLoadCount(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(0);
+    return INTEGER_VAL(ResourceLoader::GetPendingCount());
+}
 VMValue Resources_FileExists(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
     char*  filename = GetString(args, 0, threadID);
@@ -2397,7 +2459,7 @@ VMValue Scene_SetTile(int argCount, VMValue* args, Uint32 threadID) {
     *tile |= collA;
     *tile |= collB;
 
-    Scene::UpdateTileBatch(layer, x / 8, y / 8);
+    Scene::SetTileChunkDirty(layer, x, y);
 
     Scene::AnyLayerTileChange = true;
 
@@ -2793,12 +2855,16 @@ VMValue String_ToUpperCase(int argCount, VMValue* args, Uint32 threadID) {
 
     VMValue obj = NULL_VAL;
     if (BytecodeObjectManager::Lock()) {
-        ObjString* objStr = CopyString(string, strlen(string));
+        // NOTE: CopyString may hand back a shared interned string, so
+        //   build the result in a fresh buffer instead.
+        size_t length = strlen(string);
+        ObjString* objStr = AllocString(length);
+        memcpy(objStr->Chars, string, length);
         for (char* a = objStr->Chars; *a; a++) {
             if (*a >= 'a' && *a <= 'z')
                 *a += 'A' - 'a';
         }
-        obj = OBJECT_VAL(objStr);
+        obj = OBJECT_VAL(InternString(objStr));
         BytecodeObjectManager::Unlock();
     }
     return obj;
@@ -2809,12 +2875,16 @@ VMValue String_ToLowerCase(int argCount, VMValue* args, Uint32 threadID) {
 
     VMValue obj = NULL_VAL;
     if (BytecodeObjectManager::Lock()) {
-        ObjString* objStr = CopyString(string, strlen(string));
+        // NOTE: CopyString may hand back a shared interned string, so
+        //   build the result in a fresh buffer instead.
+        size_t length = strlen(string);
+        ObjString* objStr = AllocString(length);
+        memcpy(objStr->Chars, string, length);
         for (char* a = objStr->Chars; *a; a++) {
             if (*a >= 'A' && *a <= 'Z')
                 *a += 'a' - 'A';
         }
-        obj = OBJECT_VAL(objStr);
+        obj = OBJECT_VAL(InternString(objStr));
         BytecodeObjectManager::Unlock();
     }
     return obj;
@@ -2869,6 +2939,61 @@ VMValue Texture_FromImage(int argCount, VMValue* args, Uint32 threadID) {
     Image* arg1 = Scene::ImageList[GetInteger(args, 0, threadID)]->AsImage;
     return INTEGER_VAL((int)arg1->TexturePtr->ID);
 }
+// NOTE: Indexed textures and palettes are only drawn by renderers that
+//   support them (the software renderer), so creating one elsewhere is
+//   an error rather than a texture that never shows up.
+VMValue Texture_CreateIndexed(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(3);
+    int width = GetInteger(args, 0, threadID);
+    int height = GetInteger(args, 1, threadID);
+    ObjTypedArray* indices = GetTypedArray(args, 2, threadID);
+    if (!indices)
+        return NULL_VAL;
+
+    if (!Graphics::SupportsPalettes()) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Indexed textures are not supported by this renderer.");
+        return NULL_VAL;
+    }
+    if (width <= 0 || height <= 0) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Invalid texture size %d x %d.", width, height);
+        return NULL_VAL;
+    }
+    if (indices->ElementType != TYPEDARRAY_UINT8 || (Sint64)indices->Length < (Sint64)width * height) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Expected a UINT8 typed array of at least %d elements.", width * height);
+        return NULL_VAL;
+    }
+
+    Texture* texture = Graphics::CreateTexture(SDL_PIXELFORMAT_INDEX8, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (!texture)
+        return NULL_VAL;
+
+    Graphics::UpdateTexture(texture, NULL, indices->Data, width);
+    return INTEGER_VAL((int)texture->ID);
+}
+VMValue Texture_SetPalette(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(2);
+    Texture* texture = Graphics::TextureMap->Get((Uint32)GetInteger(args, 0, threadID));
+    int transparentIndex = argCount >= 3 ? GetInteger(args, 2, threadID) : -1;
+
+    // Colors are given as 0xRRGGBB, like Draw.SetBlendColor
+    Uint32 palette[256];
+    int count = 0;
+    if (BytecodeObjectManager::Lock()) {
+        ObjArray* colors = GetArray(args, 1, threadID);
+        BytecodeObjectManager::LockObject(colors);
+        count = (int)colors->Values->size();
+        if (count > 256)
+            count = 256;
+        for (int i = 0; i < count; i++) {
+            VMValue color = (*colors->Values)[i];
+            palette[i] = 0xFF000000U | ((IS_INTEGER(color) || IS_LINKED_INTEGER(color) ? (Uint32)AS_INTEGER(color) : 0) & 0xFFFFFF);
+        }
+        BytecodeObjectManager::UnlockObject(colors);
+        BytecodeObjectManager::Unlock();
+    }
+
+    return INTEGER_VAL(Graphics::SetTexturePalette(texture, palette, count, transparentIndex));
+}
 VMValue Texture_SetInterpolation(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
     int interpolate = GetInteger(args, 0, threadID);
@@ -3007,6 +3132,392 @@ VMValue Thread_Sleep(int argCount, VMValue* args, Uint32 threadID) {
 }
 // #endregion
 
+// #region TypedArray
+// NOTE: The bulk operations below work on whole arrays in native loops.
+//   Results are worked out as doubles and converted back to the element
+//   type, so integer arrays truncate and wrap like a C cast would.
+template <typename T> static inline T TypedArray_Convert(double value) {
+    return (T)(Sint64)value;
+}
+template <> inline float TypedArray_Convert<float>(double value) {
+    return (float)value;
+}
+
+template <typename T> static void TypedArray_DoFill(void* data, int start, int count, double value) {
+    T* dest = (T*)data + start;
+    T  v = TypedArray_Convert<T>(value);
+    for (int i = 0; i < count; i++)
+        dest[i] = v;
+}
+template <typename T> static void TypedArray_DoAdd(void* data, const void* other, int count, double value) {
+    T*       dest = (T*)data;
+    const T* src = (const T*)other;
+    if (src) {
+        for (int i = 0; i < count; i++)
+            dest[i] = TypedArray_Convert<T>(dest[i] + src[i] * value);
+    }
+    else {
+        for (int i = 0; i < count; i++)
+            dest[i] = TypedArray_Convert<T>(dest[i] + value);
+    }
+}
+template <typename T> static void TypedArray_DoMultiply(void* data, const void* other, int count, double value) {
+    T*       dest = (T*)data;
+    const T* src = (const T*)other;
+    if (src) {
+        for (int i = 0; i < count; i++)
+            dest[i] = TypedArray_Convert<T>((double)dest[i] * src[i]);
+    }
+    else {
+        for (int i = 0; i < count; i++)
+            dest[i] = TypedArray_Convert<T>(dest[i] * value);
+    }
+}
+template <typename T> static void TypedArray_DoClamp(void* data, int count, double min, double max) {
+    // Compared as doubles, so that bounds outside of the element type's
+    //   range just never match
+    T* dest = (T*)data;
+    for (int i = 0; i < count; i++) {
+        if ((double)dest[i] < min)
+            dest[i] = TypedArray_Convert<T>(min);
+        else if ((double)dest[i] > max)
+            dest[i] = TypedArray_Convert<T>(max);
+    }
+}
+template <typename T> static double TypedArray_DoSum(void* data, int count) {
+    T*     src = (T*)data;
+    double sum = 0.0;
+    for (int i = 0; i < count; i++)
+        sum += src[i];
+    return sum;
+}
+
+#define TYPEDARRAY_DISPATCH(type, CALL) \
+    switch (type) { \
+        case TYPEDARRAY_UINT8:   CALL(Uint8); break; \
+        case TYPEDARRAY_INT16:   CALL(Sint16); break; \
+        case TYPEDARRAY_UINT16:  CALL(Uint16); break; \
+        case TYPEDARRAY_INT32:   CALL(Sint32); break; \
+        case TYPEDARRAY_FLOAT32: CALL(float); break; \
+    }
+
+// Integers are read as-is, rather than through a float like GetDecimal
+double  TypedArray_GetNumber(VMValue* args, int index, Uint32 threadID) {
+    if (IS_INTEGER(args[index]) || IS_LINKED_INTEGER(args[index]))
+        return AS_INTEGER(args[index]);
+    return GetDecimal(args, index, threadID);
+}
+bool    TypedArray_CheckRange(ObjTypedArray* array, int start, int count, Uint32 threadID) {
+    if (start < 0 || count < 0 || start > array->Length - count) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true,
+            "Range %d to %d is out of bounds of array of size %d.", start, start + count, array->Length);
+        return false;
+    }
+    return true;
+}
+bool    TypedArray_CheckMatch(ObjTypedArray* array, ObjTypedArray* other, Uint32 threadID) {
+    if (other->ElementType != array->ElementType || other->Length != array->Length) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true,
+            "Typed arrays must have the same type and length.");
+        return false;
+    }
+    return true;
+}
+
+/***
+ * TypedArray.Create
+ * \desc Creates a fixed-size array of unboxed numbers, filled with zeroes.
+ * \param type (Integer): Element type (TypedArray_Uint8, TypedArray_Int16, TypedArray_Uint16, TypedArray_Int32 or TypedArray_Float32).
+ * \param length (Integer): Number of elements.
+ * \return A reference value to the typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Create(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+
+    int type = GetInteger(args, 0, threadID);
+    int length = GetInteger(args, 1, threadID);
+    if (GetTypedArrayElementSize(type) == 0) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Invalid typed array type %d.", type);
+        return NULL_VAL;
+    }
+    if (length < 0) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Typed array length cannot be negative.");
+        return NULL_VAL;
+    }
+
+    if (BytecodeObjectManager::Lock()) {
+        ObjTypedArray* array = NewTypedArray(type, length);
+        BytecodeObjectManager::Unlock();
+        return OBJECT_VAL(array);
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.FromArray
+ * \desc Creates a typed array holding the numbers of an array.
+ * \param type (Integer): Element type.
+ * \param array (Array): Array of numbers to copy.
+ * \return A reference value to the typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_FromArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+
+    int type = GetInteger(args, 0, threadID);
+    if (GetTypedArrayElementSize(type) == 0) {
+        BytecodeObjectManager::Threads[threadID].ThrowError(true, "Invalid typed array type %d.", type);
+        return NULL_VAL;
+    }
+
+    if (BytecodeObjectManager::Lock()) {
+        ObjArray* source = GetArray(args, 1, threadID);
+        BytecodeObjectManager::LockObject(source);
+        int length = (int)source->Values->size();
+        ObjTypedArray* array = NewTypedArray(type, length);
+        for (int i = 0; i < length; i++)
+            TypedArraySet(array, i, (*source->Values)[i]);
+        BytecodeObjectManager::UnlockObject(source);
+        BytecodeObjectManager::Unlock();
+        return OBJECT_VAL(array);
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.ToArray
+ * \desc Creates an array holding the numbers of a typed array.
+ * \param typedArray (TypedArray): Typed array to copy.
+ * \return A reference value to the array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_ToArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+
+    ObjTypedArray* source = GetTypedArray(args, 0, threadID);
+    if (!source)
+        return NULL_VAL;
+
+    if (BytecodeObjectManager::Lock()) {
+        ObjArray* array = NewArray();
+        array->Values->reserve(source->Length);
+        for (int i = 0; i < source->Length; i++)
+            array->Values->push_back(TypedArrayGet(source, i));
+        BytecodeObjectManager::Unlock();
+        return OBJECT_VAL(array);
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Length
+ * \desc Gets the length of a typed array.
+ * \param typedArray (TypedArray): Typed array to get the length of.
+ * \return Length of the typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Length(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    if (!array)
+        return INTEGER_VAL(0);
+    return INTEGER_VAL(array->Length);
+}
+/***
+ * TypedArray.Fill
+ * \desc Sets a range of elements of a typed array to one value.
+ * \param typedArray (TypedArray): Typed array to fill.
+ * \param value (Number): Value to fill with.
+ * \param start (Integer): First element to fill (optional, defaults to 0).
+ * \param count (Integer): Number of elements to fill (optional, defaults to the rest of the typed array).
+ * \ns TypedArray
+ */
+VMValue TypedArray_Fill(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(2);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    if (!array)
+        return NULL_VAL;
+
+    double value = TypedArray_GetNumber(args, 1, threadID);
+    int    start = argCount > 2 ? GetInteger(args, 2, threadID) : 0;
+    int    count = argCount > 3 ? GetInteger(args, 3, threadID) : array->Length - start;
+    if (!TypedArray_CheckRange(array, start, count, threadID))
+        return NULL_VAL;
+
+    #define FILL(T) TypedArray_DoFill<T>(array->Data, start, count, value)
+    TYPEDARRAY_DISPATCH(array->ElementType, FILL);
+    #undef  FILL
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Copy
+ * \desc Copies a range of elements from one typed array to another, converting between element types if they differ. The ranges may overlap.
+ * \param dest (TypedArray): Typed array to copy to.
+ * \param destStart (Integer): First element to copy to.
+ * \param source (TypedArray): Typed array to copy from.
+ * \param sourceStart (Integer): First element to copy from.
+ * \param count (Integer): Number of elements to copy.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Copy(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(5);
+
+    ObjTypedArray* dest = GetTypedArray(args, 0, threadID);
+    int            destStart = GetInteger(args, 1, threadID);
+    ObjTypedArray* source = GetTypedArray(args, 2, threadID);
+    int            sourceStart = GetInteger(args, 3, threadID);
+    int            count = GetInteger(args, 4, threadID);
+    if (!dest || !source)
+        return NULL_VAL;
+    if (!TypedArray_CheckRange(dest, destStart, count, threadID) || !TypedArray_CheckRange(source, sourceStart, count, threadID))
+        return NULL_VAL;
+
+    if (dest->ElementType == source->ElementType) {
+        memmove((Uint8*)dest->Data + (size_t)destStart * dest->ElementSize,
+            (Uint8*)source->Data + (size_t)sourceStart * source->ElementSize, (size_t)count * dest->ElementSize);
+    }
+    else {
+        // Arrays of different types are never the same array, so this
+        //   can't overlap.
+        for (int i = 0; i < count; i++)
+            TypedArraySet(dest, destStart + i, TypedArrayGet(source, sourceStart + i));
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Add
+ * \desc Adds a number to every element of a typed array, or adds another typed array to it element by element.
+ * \param typedArray (TypedArray): Typed array to add to.
+ * \param value (Number): Number, or typed array of the same type and length, to add.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Add(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    if (!array)
+        return NULL_VAL;
+
+    if (IS_TYPED_ARRAY(args[1])) {
+        ObjTypedArray* other = AS_TYPED_ARRAY(args[1]);
+        if (!TypedArray_CheckMatch(array, other, threadID))
+            return NULL_VAL;
+
+        #define ADD(T) TypedArray_DoAdd<T>(array->Data, other->Data, array->Length, 1.0)
+        TYPEDARRAY_DISPATCH(array->ElementType, ADD);
+        #undef  ADD
+    }
+    else {
+        double value = TypedArray_GetNumber(args, 1, threadID);
+
+        #define ADD(T) TypedArray_DoAdd<T>(array->Data, NULL, array->Length, value)
+        TYPEDARRAY_DISPATCH(array->ElementType, ADD);
+        #undef  ADD
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Multiply
+ * \desc Multiplies every element of a typed array by a number, or by another typed array element by element.
+ * \param typedArray (TypedArray): Typed array to multiply.
+ * \param value (Number): Number, or typed array of the same type and length, to multiply by.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Multiply(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    if (!array)
+        return NULL_VAL;
+
+    if (IS_TYPED_ARRAY(args[1])) {
+        ObjTypedArray* other = AS_TYPED_ARRAY(args[1]);
+        if (!TypedArray_CheckMatch(array, other, threadID))
+            return NULL_VAL;
+
+        #define MULTIPLY(T) TypedArray_DoMultiply<T>(array->Data, other->Data, array->Length, 1.0)
+        TYPEDARRAY_DISPATCH(array->ElementType, MULTIPLY);
+        #undef  MULTIPLY
+    }
+    else {
+        double value = TypedArray_GetNumber(args, 1, threadID);
+
+        #define MULTIPLY(T) TypedArray_DoMultiply<T>(array->Data, NULL, array->Length, value)
+        TYPEDARRAY_DISPATCH(array->ElementType, MULTIPLY);
+        #undef  MULTIPLY
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.MultiplyAdd
+ * \desc Adds another typed array, scaled by a number, to a typed array element by element (ie. dest[i] += source[i] * scale).
+ * \param dest (TypedArray): Typed array to add to.
+ * \param source (TypedArray): Typed array of the same type and length to add.
+ * \param scale (Number): Number to scale the source elements by.
+ * \ns TypedArray
+ */
+VMValue TypedArray_MultiplyAdd(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(3);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    ObjTypedArray* other = GetTypedArray(args, 1, threadID);
+    double         scale = TypedArray_GetNumber(args, 2, threadID);
+    if (!array || !other || !TypedArray_CheckMatch(array, other, threadID))
+        return NULL_VAL;
+
+    #define MULTIPLY_ADD(T) TypedArray_DoAdd<T>(array->Data, other->Data, array->Length, scale)
+    TYPEDARRAY_DISPATCH(array->ElementType, MULTIPLY_ADD);
+    #undef  MULTIPLY_ADD
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Clamp
+ * \desc Clamps every element of a typed array to a range.
+ * \param typedArray (TypedArray): Typed array to clamp.
+ * \param min (Number): Minimum value.
+ * \param max (Number): Maximum value.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Clamp(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(3);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    double         min = TypedArray_GetNumber(args, 1, threadID);
+    double         max = TypedArray_GetNumber(args, 2, threadID);
+    if (!array)
+        return NULL_VAL;
+
+    #define CLAMP(T) TypedArray_DoClamp<T>(array->Data, array->Length, min, max)
+    TYPEDARRAY_DISPATCH(array->ElementType, CLAMP);
+    #undef  CLAMP
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Sum
+ * \desc Adds up every element of a typed array.
+ * \param typedArray (TypedArray): Typed array to add up.
+ * \return The sum, as a Decimal for TypedArray_Float32 typed arrays and an Integer otherwise.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Sum(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+
+    ObjTypedArray* array = GetTypedArray(args, 0, threadID);
+    if (!array)
+        return INTEGER_VAL(0);
+
+    double sum = 0.0;
+    #define SUM(T) sum = TypedArray_DoSum<T>(array->Data, array->Length)
+    TYPEDARRAY_DISPATCH(array->ElementType, SUM);
+    #undef  SUM
+
+    if (array->ElementType == TYPEDARRAY_FLOAT32)
+        return DECIMAL_VAL((float)sum);
+    return INTEGER_VAL((int)sum);
+}
+#undef TYPEDARRAY_DISPATCH
+// #endregion
+
 // #region Video
 VMValue Video_Play(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
@@ -3513,6 +4024,7 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Draw, SetBlendMode);
     DEF_NATIVE(Draw, SetBlendFactor);
     DEF_NATIVE(Draw, SetBlendFactorExtended);
+    DEF_NATIVE(Draw, SetFilter);
     DEF_NATIVE(Draw, Line);
     DEF_NATIVE(Draw, Circle);
     DEF_NATIVE(Draw, Ellipse);
@@ -3550,6 +4062,9 @@ PUBLIC STATIC void StandardLibrary::Link() {
     BytecodeObjectManager::GlobalConstInteger(NULL, "BlendFactor_INV_DST_COLOR", BlendFactor_INV_DST_COLOR);
     BytecodeObjectManager::GlobalConstInteger(NULL, "BlendFactor_DST_ALPHA", BlendFactor_DST_ALPHA);
     BytecodeObjectManager::GlobalConstInteger(NULL, "BlendFactor_INV_DST_ALPHA", BlendFactor_INV_DST_ALPHA);
+
+    BytecodeObjectManager::GlobalConstInteger(NULL, "Filter_NONE", Filter_NONE);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "Filter_GRAYSCALE", Filter_GRAYSCALE);
     // #endregion
 
     // #region Ease
@@ -3695,12 +4210,23 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Resources, LoadMusic);
     DEF_NATIVE(Resources, LoadSound);
     DEF_NATIVE(Resources, LoadVideo);
+    DEF_NATIVE(Resources, LoadSpriteAsync);
+    DEF_NATIVE(Resources, LoadImageAsync);
+    DEF_NATIVE(Resources, LoadMusicAsync);
+    DEF_NATIVE(Resources, LoadSoundAsync);
+    DEF_NATIVE(Resources, GetLoadStatus);
+    DEF_NATIVE(Resources, GetLoadResult);
+    DEF_NATIVE(Resources, GetPendingLoadCount);
     DEF_NATIVE(Resources, FileExists);
 
     DEF_NATIVE(Resources, UnloadImage);
 
     BytecodeObjectManager::GlobalConstInteger(NULL, "SCOPE_SCENE", 0);
     BytecodeObjectManager::GlobalConstInteger(NULL, "SCOPE_GAME", 1);
+
+    BytecodeObjectManager::GlobalConstInteger(NULL, "LoadStatus_PENDING", ResourceLoader::STATUS_PENDING);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "LoadStatus_LOADED", ResourceLoader::STATUS_LOADED);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "LoadStatus_FAILED", ResourceLoader::STATUS_FAILED);
     // #endregion
 
     // #region Scene
@@ -3795,6 +4321,8 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Texture, FromSprite);
     DEF_NATIVE(Texture, FromImage);
     DEF_NATIVE(Texture, Create);
+    DEF_NATIVE(Texture, CreateIndexed);
+    DEF_NATIVE(Texture, SetPalette);
     DEF_NATIVE(Texture, SetInterpolation);
     // #endregion
 
@@ -3824,6 +4352,26 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Thread, Sleep);
     // #endregion
 
+    // #region TypedArray
+    INIT_CLASS(TypedArray);
+    DEF_NATIVE(TypedArray, Create);
+    DEF_NATIVE(TypedArray, FromArray);
+    DEF_NATIVE(TypedArray, ToArray);
+    DEF_NATIVE(TypedArray, Length);
+    DEF_NATIVE(TypedArray, Fill);
+    DEF_NATIVE(TypedArray, Copy);
+    DEF_NATIVE(TypedArray, Add);
+    DEF_NATIVE(TypedArray, Multiply);
+    DEF_NATIVE(TypedArray, MultiplyAdd);
+    DEF_NATIVE(TypedArray, Clamp);
+    DEF_NATIVE(TypedArray, Sum);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "TypedArray_Uint8", TYPEDARRAY_UINT8);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "TypedArray_Int16", TYPEDARRAY_INT16);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "TypedArray_Uint16", TYPEDARRAY_UINT16);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "TypedArray_Int32", TYPEDARRAY_INT32);
+    BytecodeObjectManager::GlobalConstInteger(NULL, "TypedArray_Float32", TYPEDARRAY_FLOAT32);
+    // #endregion
+
     // #region Video
     INIT_CLASS(Video);
     DEF_NATIVE(Video, Play);
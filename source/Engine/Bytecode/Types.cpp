@@ -21,8 +21,28 @@ static Obj*       AllocateObject(size_t size, ObjType type) {
     Obj* object = (Obj*)Memory::Malloc(size);
     object->Type = type;
     object->IsDark = false;
-    object->Next = GarbageCollector::RootObject;
-    GarbageCollector::RootObject = object;
+    object->IsRemembered = false;
+
+    // New objects go in the young generation, unless a full cycle is
+    // running, since that one works on the old list only.
+    if (GarbageCollector::State == GarbageCollector::STATE_IDLE) {
+        object->IsOld = false;
+        object->Next = GarbageCollector::YoungObject;
+        GarbageCollector::YoungObject = object;
+        GarbageCollector::YoungSize += size;
+    }
+    else {
+        object->IsOld = true;
+        object->Next = GarbageCollector::RootObject;
+        GarbageCollector::RootObject = object;
+    }
+
+    // Objects made while the collector is marking start out gray, so
+    // they live through the cycle and whatever they hold gets traced.
+    if (GarbageCollector::State == GarbageCollector::STATE_MARK) {
+        object->IsDark = true;
+        GarbageCollector::GrayList.push_back(object);
+    }
     #ifdef DEBUG_TRACE_GC
         Log::Print(Log::LOG_VERBOSE, "%p allocate %ld for %d", object, size, type);
     #endif
@@ -35,44 +55,77 @@ static ObjString* AllocateString(char* chars, int length, Uint32 hash) {
     string->Length = length;
     string->Chars = chars;
     string->Hash = hash;
-    // BytecodeObjectManager::Push(OBJECT_VAL(string));
-    // BytecodeObjectManager::Strings->Put(hash, OBJECT_VAL(string));
-    // BytecodeObjectManager::Pop();
     return string;
 }
+static ObjString* FindInternedString(const char* chars, int length, Uint32 hash) {
+    HashMap<VMValue>* strings = BytecodeObjectManager::Strings;
+    if (!strings)
+        return NULL;
+
+    int index = strings->GetIndex(hash);
+    if (index < 0)
+        return NULL;
+
+    // NOTE: Different strings may share a hash. Only the first one to
+    //   claim it is interned; the rest stay regular heap strings.
+    ObjString* interned = AS_STRING(strings->Data[index].Data);
+    if (interned->Length != length || memcmp(interned->Chars, chars, length) != 0)
+        return NULL;
+
+    return interned;
+}
+static void       RegisterInternedString(ObjString* string) {
+    HashMap<VMValue>* strings = BytecodeObjectManager::Strings;
+    if (!strings || strings->Exists(string->Hash))
+        return;
+
+    strings->Put(string->Hash, OBJECT_VAL(string));
+}
 
 ObjString*        TakeString(char* chars, int length) {
     Uint32 hash = FNV1A::EncryptData(chars, length);
-    // ObjString* interned = AS_STRING(BytecodeObjectManager::Strings->Get(hash));
-    // if (interned != NULL) {
-    //     // FREE_ARRAY(char, chars, length + 1);
-    //     free(chars);
-    //     return interned;
-    // }
-    return AllocateString(chars, length, hash);
+    ObjString* interned = FindInternedString(chars, length, hash);
+    if (interned) {
+        Memory::Free(chars);
+        return interned;
+    }
+
+    ObjString* string = AllocateString(chars, length, hash);
+    RegisterInternedString(string);
+    return string;
 }
 ObjString*        CopyString(const char* chars, int length) {
     Uint32 hash = FNV1A::EncryptData(chars, length);
-    // if (BytecodeObjectManager::Strings->Exists(hash)) {
-    //     ObjString* interned = AS_STRING(BytecodeObjectManager::Strings->Get(hash));
-    //     if (interned != NULL) {
-    //         printf("interned: %p\n", interned);
-    //         return interned;
-    //     }
-    // }
+    ObjString* interned = FindInternedString(chars, length, hash);
+    if (interned)
+        return interned;
 
     char* heapChars = ALLOCATE(char, length + 1);
     memcpy(heapChars, chars, length);
     heapChars[length] = '\0';
 
-    return AllocateString(heapChars, length, hash);
+    ObjString* string = AllocateString(heapChars, length, hash);
+    RegisterInternedString(string);
+    return string;
 }
 ObjString*        AllocString(int length) {
     char* heapChars = ALLOCATE(char, length + 1);
     heapChars[length] = '\0';
 
+    // NOTE: The contents are not known yet, so this string is not
+    //   interned. Pass it to InternString once it has been filled in.
     return AllocateString(heapChars, length, 0x00000000);
 }
+ObjString*        InternString(ObjString* string) {
+    string->Hash = FNV1A::EncryptData(string->Chars, string->Length);
+
+    ObjString* interned = FindInternedString(string->Chars, string->Length, string->Hash);
+    if (interned)
+        return interned;
+
+    RegisterInternedString(string);
+    return string;
+}
 
 char*             HeapCopyString(const char* str, size_t len) {
     char* out = (char*)malloc(len + 1);
@@ -88,6 +141,7 @@ ObjFunction*      NewFunction() {
     function->Arity = 0;
     function->UpvalueCount = 0;
     function->Name = NULL;
+    function->StatsID = 0;
     ChunkInit(&function->Chunk);
     return function;
 }
@@ -95,6 +149,7 @@ ObjNative*        NewNative(NativeFn function) {
     ObjNative* native = ALLOCATE_OBJ(ObjNative, OBJ_NATIVE);
     Memory::Track(native, "NewNative");
     native->Function = function;
+    native->StatsID = 0;
     return native;
 }
 ObjUpvalue*       NewUpvalue(VMValue* slot) {
@@ -154,6 +209,31 @@ ObjMap*           NewMap() {
     return map;
 }
 
+ObjTypedArray*    NewTypedArray(Uint8 type, int length) {
+    int elementSize = GetTypedArrayElementSize(type);
+
+    // The elements share the object's allocation
+    size_t size = sizeof(ObjTypedArray) + (size_t)length * elementSize;
+    ObjTypedArray* array = (ObjTypedArray*)AllocateObject(size, OBJ_TYPED_ARRAY);
+    Memory::Track(array, "NewTypedArray");
+    array->ElementType = type;
+    array->ElementSize = elementSize;
+    array->Length = length;
+    array->Data = array + 1;
+    memset(array->Data, 0, (size_t)length * elementSize);
+    return array;
+}
+int               GetTypedArrayElementSize(Uint8 type) {
+    switch (type) {
+        case TYPEDARRAY_UINT8:   return sizeof(Uint8);
+        case TYPEDARRAY_INT16:   return sizeof(Sint16);
+        case TYPEDARRAY_UINT16:  return sizeof(Uint16);
+        case TYPEDARRAY_INT32:   return sizeof(Sint32);
+        case TYPEDARRAY_FLOAT32: return sizeof(float);
+    }
+    return 0;
+}
+
 bool              ValuesEqual(VMValue a, VMValue b) {
     if (a.Type != b.Type) return false;
 
@@ -195,6 +275,8 @@ const char*       GetTypeString(VMValue value) {
                     return "ARRAY";
                 case OBJ_MAP:
                     return "MAP";
+                case OBJ_TYPED_ARRAY:
+                    return "TYPED_ARRAY";
                 default:
                     return "Unknown Object Type";
             }
@@ -209,6 +291,7 @@ void              ChunkInit(Chunk* chunk) {
     chunk->Code = NULL;
     chunk->Lines = NULL;
     chunk->Constants = new vector<VMValue>();
+    chunk->PropertyCache = NULL;
 }
 void              ChunkAlloc(Chunk* chunk) {
     if (!chunk->Code)
@@ -232,6 +315,18 @@ void              ChunkFree(Chunk* chunk) {
         Memory::Free(chunk->Lines);
         chunk->Lines = NULL;
     }
+    if (chunk->PropertyCache) {
+        Memory::Free(chunk->PropertyCache);
+        chunk->PropertyCache = NULL;
+    }
+}
+void              ChunkAllocPropertyCache(Chunk* chunk) {
+    if (chunk->PropertyCache)
+        Memory::Free(chunk->PropertyCache);
+
+    // NOTE: All bytes set means both cache entries are PROPERTY_CACHE_EMPTY.
+    chunk->PropertyCache = (Uint32*)Memory::TrackedMalloc("Chunk::PropertyCache", sizeof(Uint32) * chunk->Count);
+    memset(chunk->PropertyCache, 0xFF, sizeof(Uint32) * chunk->Count);
 }
 void              ChunkWrite(Chunk* chunk, Uint8 byte, int line) {
     if (chunk->Capacity < chunk->Count + 1) {
@@ -5,7 +5,10 @@
 
 #define FRAMES_MAX 64
 #define STACK_SIZE_MAX (FRAMES_MAX * 256)
+#define LOCALS_MAX 0x400
 #define THREAD_NAME_MAX 64
+#define OBJECT_LOCK_COUNT 64
+#define PROPERTY_CACHE_EMPTY 0xFFFFU
 
 typedef enum {
     VAL_NULL,
@@ -35,10 +38,15 @@ struct Chunk {
     Uint8*           Code;
     int*             Lines;
     vector<VMValue>* Constants;
+    // NOTE: One entry per code byte, holding the last two field slots
+    //   seen by the property instruction at that offset (low 16 bits
+    //   are the most recent). See VMThread::GetFieldSlot.
+    Uint32*          PropertyCache;
 };
 
 void ChunkInit(Chunk* chunk);
 void ChunkFree(Chunk* chunk);
+void ChunkAllocPropertyCache(Chunk* chunk);
 void ChunkWrite(Chunk* chunk, Uint8 byte, int line);
 int  ChunkAddConstant(Chunk* chunk, VMValue value);
 
@@ -109,6 +117,7 @@ typedef VMValue (*NativeFn)(int argCount, VMValue* args, Uint32 threadID);
 #define IS_STRING(value)        IsObjectType(value, OBJ_STRING)
 #define IS_ARRAY(value)         IsObjectType(value, OBJ_ARRAY)
 #define IS_MAP(value)           IsObjectType(value, OBJ_MAP)
+#define IS_TYPED_ARRAY(value)   IsObjectType(value, OBJ_TYPED_ARRAY)
 
 #define AS_BOUND_METHOD(value)  ((ObjBoundMethod*)AS_OBJECT(value))
 #define AS_CLASS(value)         ((ObjClass*)AS_OBJECT(value))
@@ -120,6 +129,7 @@ typedef VMValue (*NativeFn)(int argCount, VMValue* args, Uint32 threadID);
 #define AS_CSTRING(value)       (((ObjString*)AS_OBJECT(value))->Chars)
 #define AS_ARRAY(value)         ((ObjArray*)AS_OBJECT(value))
 #define AS_MAP(value)           ((ObjMap*)AS_OBJECT(value))
+#define AS_TYPED_ARRAY(value)   ((ObjTypedArray*)AS_OBJECT(value))
 
 enum ObjType {
     OBJ_BOUND_METHOD,
@@ -132,6 +142,14 @@ enum ObjType {
     OBJ_UPVALUE,
     OBJ_ARRAY,
     OBJ_MAP,
+    OBJ_TYPED_ARRAY,
+};
+enum TypedArrayType {
+    TYPEDARRAY_UINT8,
+    TYPEDARRAY_INT16,
+    TYPEDARRAY_UINT16,
+    TYPEDARRAY_INT32,
+    TYPEDARRAY_FLOAT32,
 };
 
 typedef HashMap<VMValue> Table;
@@ -139,6 +157,8 @@ typedef HashMap<VMValue> Table;
 struct Obj {
     ObjType     Type;
     bool        IsDark;
+    bool        IsOld;
+    bool        IsRemembered;
     struct Obj* Next;
 };
 struct ObjString {
@@ -155,10 +175,12 @@ struct ObjFunction {
     ObjString*   Name;
     char         SourceFilename[256];
     Uint32       NameHash;
+    int          StatsID;
 };
 struct ObjNative {
     Obj      Object;
     NativeFn Function;
+    int      StatsID;
 };
 struct ObjUpvalue {
     Obj      Object;
@@ -199,10 +221,21 @@ struct ObjMap {
     HashMap<VMValue>* Values;
     HashMap<char*>*   Keys;
 };
+// NOTE: Typed arrays store unboxed numbers right after the object, so
+//   they can't be resized, and they hold no references for the garbage
+//   collector to trace.
+struct ObjTypedArray {
+    Obj   Object;
+    Uint8 ElementType;
+    Uint8 ElementSize;
+    int   Length;
+    void* Data;
+};
 
 ObjString*         TakeString(char* chars, int length);
 ObjString*         CopyString(const char* chars, int length);
 ObjString*         AllocString(int length);
+ObjString*         InternString(ObjString* string);
 char*              HeapCopyString(const char* str, size_t len);
 ObjFunction*       NewFunction();
 ObjNative*         NewNative(NativeFn function);
@@ -213,6 +246,8 @@ ObjInstance*       NewInstance(ObjClass* klass);
 ObjBoundMethod*    NewBoundMethod(VMValue receiver, ObjFunction* method);
 ObjArray*          NewArray();
 ObjMap*            NewMap();
+ObjTypedArray*     NewTypedArray(Uint8 type, int length);
+int                GetTypedArrayElementSize(Uint8 type);
 
 bool               ValuesEqual(VMValue a, VMValue b);
 
@@ -220,6 +255,45 @@ static inline bool IsObjectType(VMValue value, ObjType type) {
     return IS_OBJECT(value) && AS_OBJECT(value)->Type == type;
 }
 
+static inline VMValue TypedArrayGet(ObjTypedArray* array, int index) {
+    switch (array->ElementType) {
+        case TYPEDARRAY_UINT8:   return INTEGER_VAL(((Uint8*)array->Data)[index]);
+        case TYPEDARRAY_INT16:   return INTEGER_VAL(((Sint16*)array->Data)[index]);
+        case TYPEDARRAY_UINT16:  return INTEGER_VAL(((Uint16*)array->Data)[index]);
+        case TYPEDARRAY_INT32:   return INTEGER_VAL(((Sint32*)array->Data)[index]);
+        case TYPEDARRAY_FLOAT32: return DECIMAL_VAL(((float*)array->Data)[index]);
+    }
+    return NULL_VAL;
+}
+// Returns false if the value isn't a number
+static inline bool    TypedArraySet(ObjTypedArray* array, int index, VMValue value) {
+    int   integer;
+    float decimal;
+    switch (value.Type) {
+        case VAL_INTEGER:
+        case VAL_LINKED_INTEGER:
+            integer = AS_INTEGER(value);
+            decimal = (float)integer;
+            break;
+        case VAL_DECIMAL:
+        case VAL_LINKED_DECIMAL:
+            decimal = AS_DECIMAL(value);
+            integer = (int)decimal;
+            break;
+        default:
+            return false;
+    }
+
+    switch (array->ElementType) {
+        case TYPEDARRAY_UINT8:   ((Uint8*)array->Data)[index] = (Uint8)integer; break;
+        case TYPEDARRAY_INT16:   ((Sint16*)array->Data)[index] = (Sint16)integer; break;
+        case TYPEDARRAY_UINT16:  ((Uint16*)array->Data)[index] = (Uint16)integer; break;
+        case TYPEDARRAY_INT32:   ((Sint32*)array->Data)[index] = (Sint32)integer; break;
+        case TYPEDARRAY_FLOAT32: ((float*)array->Data)[index] = decimal; break;
+    }
+    return true;
+}
+
 struct CallFrame {
     ObjFunction* Function;
     Uint8*       IP;
@@ -302,6 +376,15 @@ enum   OpCode {
     OP_NEW_MAP,
     //
     OP_SWITCH_TABLE,
+    // Superinstructions (see Compiler::EmitGetOperation, EmitAdd, EmitJump)
+    OP_GET_LOCAL_PROPERTY,
+    OP_ADD_LOCAL_CONSTANT,
+    OP_COMPARE_JUMP_IF_FALSE,
+    // Wide operands (.ibc version 1)
+    OP_CONSTANT_LONG,
+    OP_GET_LOCAL_LONG,
+    OP_SET_LOCAL_LONG,
+    OP_SWITCH_TABLE_LONG,
 };
 
 static const char* vmvalue_type_strings[] = {
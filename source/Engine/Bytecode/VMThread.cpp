@@ -35,6 +35,7 @@ public:
     Uint32    ID;
     Uint32    State;
     bool      DebugInfo;
+    Uint32    ProfilerTick;
 };
 #endif
 
@@ -42,9 +43,14 @@ public:
 #include <Engine/Bytecode/BytecodeObject.h>
 #include <Engine/Bytecode/BytecodeObjectManager.h>
 #include <Engine/Bytecode/Compiler.h>
+#include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/OpcodeStats.h>
+#include <Engine/Bytecode/ScriptProfiler.h>
 
 // Locks are only in 3 places:
-// Heap, which contains object memory and globals
+// Heap, which contains object memory (GlobalLock)
+//     Globals have their own read/write lock, and instance fields,
+//     arrays and maps are guarded by striped per-object locks.
 // Bytecode area, which contains function bytecode
 // Tokens & Strings
 
@@ -201,6 +207,66 @@ enum   ThreadReturnCodes {
     INTERPRET_OK = 0,
 };
 
+// NOTE: With GCC and Clang, each instruction jumps straight to the next
+//   one's handler through a table of label addresses, which the branch
+//   predictor handles much better than one shared switch. Compilers
+//   without computed goto fall back to the switch and return to
+//   RunInstructionSet after every instruction.
+#if defined(__GNUC__) || defined(__clang__)
+    #define USING_VM_DISPATCH_TABLE
+#endif
+
+// Samples land on the instruction that just finished, before IPLast
+//   moves on to the next one.
+#define VM_PROFILER_CHECK() \
+    if (ScriptProfiler::Running && ProfilerTick != (Uint32)SDL_AtomicGet(&ScriptProfiler::Tick)) \
+        ScriptProfiler::Sample(this)
+
+// NOTE: Building with VM_OPCODE_STATS times each instruction from its
+//   dispatch to the next one's. The timer's destructor closes out the
+//   last instruction when RunInstruction returns.
+#ifdef VM_OPCODE_STATS
+    struct VM_OpcodeTimer {
+        VMThread*    Thread;
+        ObjFunction* Function;
+        Uint8        Opcode;
+        Uint64       Start;
+
+        VM_OpcodeTimer(VMThread* thread) : Thread(thread), Function(NULL), Opcode(0), Start(0) { }
+        ~VM_OpcodeTimer() {
+            Next(NULL, 0);
+        }
+        void Next(ObjFunction* function, Uint8 opcode) {
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (Function)
+                OpcodeStats::RecordInstruction(Thread, Function, Opcode, now - Start);
+            Function = function;
+            Opcode = opcode;
+            Start = now;
+        }
+    };
+    #define VM_OPCODE_TIMER_NEXT() opcodeTimer.Next(frame->Function, instruction)
+#else
+    #define VM_OPCODE_TIMER_NEXT()
+#endif
+
+#ifdef USING_VM_DISPATCH_TABLE
+    #define VM_START(ins) goto *dispatchTable[(ins)];
+    #define VM_CASE(ins)  LABEL_##ins
+    #define VM_BREAK      do { \
+        VM_PROFILER_CHECK(); \
+        frame = &Frames[FrameCount - 1]; \
+        frame->IPLast = frame->IP; \
+        instruction = ReadByte(frame); \
+        VM_OPCODE_TIMER_NEXT(); \
+        goto *dispatchTable[instruction]; \
+    } while (0)
+#else
+    #define VM_START(ins) switch (ins)
+    #define VM_CASE(ins)  case ins
+    #define VM_BREAK      break
+#endif
+
 // NOTE: These should be inlined
 PUBLIC Uint8   VMThread::ReadByte(CallFrame* frame) {
     frame->IP += sizeof(Uint8);
@@ -210,6 +276,10 @@ PUBLIC Uint16  VMThread::ReadUInt16(CallFrame* frame) {
     frame->IP += sizeof(Uint16);
     return *(Uint16*)(frame->IP - sizeof(Uint16));
 }
+PUBLIC Uint32  VMThread::ReadUInt24(CallFrame* frame) {
+    Uint32 value = ReadUInt16(frame);
+    return value | ReadByte(frame) << 16;
+}
 PUBLIC Uint32  VMThread::ReadUInt32(CallFrame* frame) {
     frame->IP += sizeof(Uint32);
     return *(Uint32*)(frame->IP - sizeof(Uint32));
@@ -223,11 +293,134 @@ PUBLIC Sint32  VMThread::ReadSInt32(CallFrame* frame) {
 PUBLIC VMValue VMThread::ReadConstant(CallFrame* frame) {
     return (*frame->Function->Chunk.Constants)[ReadByte(frame)];
 }
+PUBLIC VMValue VMThread::ReadConstantLong(CallFrame* frame) {
+    return (*frame->Function->Chunk.Constants)[ReadUInt24(frame)];
+}
+
+// NOTE: Instances of the same class add their fields in the same order,
+//   so a field usually lands in the same slot of every instance's table.
+//   Each property instruction remembers the last two slots it found, and
+//   a cached slot is only trusted once its key is checked, so a stale
+//   entry costs a regular lookup and nothing more.
+PUBLIC int     VMThread::GetFieldSlot(CallFrame* frame, Table* fields, Uint32 hash) {
+    Uint32* cache = frame->Function->Chunk.PropertyCache;
+    if (!cache)
+        return fields->GetIndex(hash);
+
+    cache += frame->IPLast - frame->Function->Chunk.Code;
+
+    Uint32 entries = *cache;
+    int    slot = entries & 0xFFFF;
+    if (slot != PROPERTY_CACHE_EMPTY && fields->IsIndexOf(slot, hash))
+        return slot;
+
+    slot = entries >> 16;
+    if (slot != PROPERTY_CACHE_EMPTY && fields->IsIndexOf(slot, hash)) {
+        // Swap so the slot we just hit is tried first next time.
+        *cache = (entries << 16) | (entries >> 16);
+        return slot;
+    }
+
+    slot = fields->GetIndex(hash);
+    CacheFieldSlot(frame, slot);
+    return slot;
+}
+PUBLIC void    VMThread::CacheFieldSlot(CallFrame* frame, int slot) {
+    Uint32* cache = frame->Function->Chunk.PropertyCache;
+    if (!cache || slot < 0 || slot >= (int)PROPERTY_CACHE_EMPTY)
+        return;
+
+    cache += frame->IPLast - frame->Function->Chunk.Code;
+    *cache = (*cache << 16) | (Uint32)slot;
+}
 
 PUBLIC int     VMThread::RunInstruction() {
     CallFrame* frame;
     Uint8 instruction;
 
+    #ifdef VM_OPCODE_STATS
+    VM_OpcodeTimer opcodeTimer(this);
+    #endif
+
+    #ifdef USING_VM_DISPATCH_TABLE
+    static void* dispatchTable[0x100];
+    static bool  dispatchTableReady = false;
+    if (!dispatchTableReady) {
+        #define VM_ADD_DISPATCH(op) dispatchTable[op] = &&LABEL_##op
+
+        for (int i = 0; i < 0x100; i++)
+            dispatchTable[i] = &&LABEL_OP_UNKNOWN;
+
+        VM_ADD_DISPATCH(OP_CONSTANT);
+        VM_ADD_DISPATCH(OP_DEFINE_GLOBAL);
+        VM_ADD_DISPATCH(OP_GET_PROPERTY);
+        VM_ADD_DISPATCH(OP_SET_PROPERTY);
+        VM_ADD_DISPATCH(OP_GET_GLOBAL);
+        VM_ADD_DISPATCH(OP_SET_GLOBAL);
+        VM_ADD_DISPATCH(OP_GET_LOCAL);
+        VM_ADD_DISPATCH(OP_SET_LOCAL);
+        VM_ADD_DISPATCH(OP_PRINT_STACK);
+        VM_ADD_DISPATCH(OP_RETURN);
+        VM_ADD_DISPATCH(OP_METHOD);
+        VM_ADD_DISPATCH(OP_CLASS);
+        VM_ADD_DISPATCH(OP_CALL);
+        VM_ADD_DISPATCH(OP_INVOKE);
+        VM_ADD_DISPATCH(OP_JUMP);
+        VM_ADD_DISPATCH(OP_JUMP_IF_FALSE);
+        VM_ADD_DISPATCH(OP_JUMP_BACK);
+        VM_ADD_DISPATCH(OP_POP);
+        VM_ADD_DISPATCH(OP_COPY);
+        VM_ADD_DISPATCH(OP_ADD);
+        VM_ADD_DISPATCH(OP_SUBTRACT);
+        VM_ADD_DISPATCH(OP_MULTIPLY);
+        VM_ADD_DISPATCH(OP_DIVIDE);
+        VM_ADD_DISPATCH(OP_MODULO);
+        VM_ADD_DISPATCH(OP_NEGATE);
+        VM_ADD_DISPATCH(OP_INCREMENT);
+        VM_ADD_DISPATCH(OP_DECREMENT);
+        VM_ADD_DISPATCH(OP_BITSHIFT_LEFT);
+        VM_ADD_DISPATCH(OP_BITSHIFT_RIGHT);
+        VM_ADD_DISPATCH(OP_NULL);
+        VM_ADD_DISPATCH(OP_TRUE);
+        VM_ADD_DISPATCH(OP_FALSE);
+        VM_ADD_DISPATCH(OP_BW_NOT);
+        VM_ADD_DISPATCH(OP_BW_AND);
+        VM_ADD_DISPATCH(OP_BW_OR);
+        VM_ADD_DISPATCH(OP_BW_XOR);
+        VM_ADD_DISPATCH(OP_LG_NOT);
+        VM_ADD_DISPATCH(OP_LG_AND);
+        VM_ADD_DISPATCH(OP_LG_OR);
+        VM_ADD_DISPATCH(OP_EQUAL);
+        VM_ADD_DISPATCH(OP_EQUAL_NOT);
+        VM_ADD_DISPATCH(OP_GREATER);
+        VM_ADD_DISPATCH(OP_GREATER_EQUAL);
+        VM_ADD_DISPATCH(OP_LESS);
+        VM_ADD_DISPATCH(OP_LESS_EQUAL);
+        VM_ADD_DISPATCH(OP_PRINT);
+        VM_ADD_DISPATCH(OP_SAVE_VALUE);
+        VM_ADD_DISPATCH(OP_LOAD_VALUE);
+        VM_ADD_DISPATCH(OP_WITH);
+        VM_ADD_DISPATCH(OP_GET_ELEMENT);
+        VM_ADD_DISPATCH(OP_SET_ELEMENT);
+        VM_ADD_DISPATCH(OP_NEW_ARRAY);
+        VM_ADD_DISPATCH(OP_NEW_MAP);
+        VM_ADD_DISPATCH(OP_SWITCH_TABLE);
+        VM_ADD_DISPATCH(OP_GET_LOCAL_PROPERTY);
+        VM_ADD_DISPATCH(OP_ADD_LOCAL_CONSTANT);
+        VM_ADD_DISPATCH(OP_COMPARE_JUMP_IF_FALSE);
+        VM_ADD_DISPATCH(OP_CONSTANT_LONG);
+        VM_ADD_DISPATCH(OP_GET_LOCAL_LONG);
+        VM_ADD_DISPATCH(OP_SET_LOCAL_LONG);
+        VM_ADD_DISPATCH(OP_SWITCH_TABLE_LONG);
+
+        #undef  VM_ADD_DISPATCH
+
+        dispatchTableReady = true;
+    }
+    #endif
+
+    VM_PROFILER_CHECK();
+
     frame = &Frames[FrameCount - 1];
     frame->IPLast = frame->IP;
 
@@ -294,6 +487,13 @@ PUBLIC int     VMThread::RunInstruction() {
             PRINT_CASE(OP_NEW_ARRAY)
             PRINT_CASE(OP_NEW_MAP)
             PRINT_CASE(OP_SWITCH_TABLE)
+            PRINT_CASE(OP_GET_LOCAL_PROPERTY)
+            PRINT_CASE(OP_ADD_LOCAL_CONSTANT)
+            PRINT_CASE(OP_COMPARE_JUMP_IF_FALSE)
+            PRINT_CASE(OP_CONSTANT_LONG)
+            PRINT_CASE(OP_GET_LOCAL_LONG)
+            PRINT_CASE(OP_SET_LOCAL_LONG)
+            PRINT_CASE(OP_SWITCH_TABLE_LONG)
 
             default:
                 Log::Print(Log::LOG_ERROR, "Unknown opcode %d\n", frame->IP); break;
@@ -302,38 +502,41 @@ PUBLIC int     VMThread::RunInstruction() {
         #undef  PRINT_CASE
     }
 
-    switch (instruction = ReadByte(frame)) {
+    instruction = ReadByte(frame);
+    VM_OPCODE_TIMER_NEXT();
+
+    VM_START(instruction) {
         // Globals (heap)
-        case OP_GET_GLOBAL: {
-            if (BytecodeObjectManager::Lock()) {
-                Uint32 hash = ReadUInt32(frame);
-                if (!BytecodeObjectManager::Globals->Exists(hash)) {
-                    if (__Tokens__ && __Tokens__->Exists(hash))
-                        ThrowError(true, "Variable \"%s\" does not exist.", __Tokens__->Get(hash));
-                    else
-                        ThrowError(true, "Variable $[%08X] does not exist.", hash);
-                    Push(NULL_VAL);
-                    return INTERPRET_GLOBAL_DOES_NOT_EXIST;
-                }
+        VM_CASE(OP_GET_GLOBAL): {
+            Uint32 hash = ReadUInt32(frame);
+            VMValue result;
 
-                Push(BytecodeObjectManager::DelinkValue(BytecodeObjectManager::Globals->Get(hash)));
-                BytecodeObjectManager::Unlock();
+            BytecodeObjectManager::LockGlobalsRead();
+            bool exists = BytecodeObjectManager::Globals->Exists(hash);
+            if (exists)
+                result = BytecodeObjectManager::DelinkValue(BytecodeObjectManager::Globals->Get(hash));
+            BytecodeObjectManager::UnlockGlobalsRead();
+
+            if (!exists) {
+                if (__Tokens__ && __Tokens__->Exists(hash))
+                    ThrowError(true, "Variable \"%s\" does not exist.", __Tokens__->Get(hash));
+                else
+                    ThrowError(true, "Variable $[%08X] does not exist.", hash);
+                Push(NULL_VAL);
+                return INTERPRET_GLOBAL_DOES_NOT_EXIST;
             }
-            break;
+
+            Push(result);
+            VM_BREAK;
         }
-        case OP_SET_GLOBAL: {
-            if (BytecodeObjectManager::Lock()) {
-                Uint32 hash = ReadUInt32(frame);
-                if (!BytecodeObjectManager::Globals->Exists(hash)) {
-                    if (!__Tokens__ || !__Tokens__->Exists(hash))
-                        ThrowError(true, "Global variable $[%08X] does not exist.", hash);
-                    else
-                        ThrowError(true, "Global variable \"%s\" does not exist.", __Tokens__->Get(hash));
-                    return INTERPRET_GLOBAL_DOES_NOT_EXIST;
-                }
+        VM_CASE(OP_SET_GLOBAL): {
+            Uint32 hash = ReadUInt32(frame);
+            VMValue value = Peek(0);
 
+            BytecodeObjectManager::LockGlobalsWrite();
+            bool exists = BytecodeObjectManager::Globals->Exists(hash);
+            if (exists) {
                 VMValue LHS = BytecodeObjectManager::Globals->Get(hash);
-                VMValue value = Peek(0);
                 switch (LHS.Type) {
                     case VAL_LINKED_INTEGER:
                         AS_LINKED_INTEGER(LHS) = AS_INTEGER(value);
@@ -344,12 +547,24 @@ PUBLIC int     VMThread::RunInstruction() {
                     default:
                         BytecodeObjectManager::Globals->Put(hash, value);
                 }
-                BytecodeObjectManager::Unlock();
             }
-            break;
+            BytecodeObjectManager::UnlockGlobalsWrite();
+            GarbageCollector::WriteBarrier(NULL, value);
+
+            if (!exists) {
+                if (!__Tokens__ || !__Tokens__->Exists(hash))
+                    ThrowError(true, "Global variable $[%08X] does not exist.", hash);
+                else
+                    ThrowError(true, "Global variable \"%s\" does not exist.", __Tokens__->Get(hash));
+                return INTERPRET_GLOBAL_DOES_NOT_EXIST;
+            }
+            VM_BREAK;
         }
-        case OP_DEFINE_GLOBAL: {
+        VM_CASE(OP_DEFINE_GLOBAL): {
+            // NOTE: Defining globals also merges class method tables,
+            //   so this keeps the heap lock as well.
             if (BytecodeObjectManager::Lock()) {
+                BytecodeObjectManager::LockGlobalsWrite();
                 Uint32 hash = ReadUInt32(frame);
                 VMValue value = Peek(0);
                 // If it already exists,
@@ -363,6 +578,7 @@ PUBLIC int     VMThread::RunInstruction() {
 
                         src->Methods->WithAll([dst](Uint32 hash, VMValue value) -> void {
                             dst->Methods->Put(hash, value);
+                            GarbageCollector::WriteBarrier(dst, value);
                         });
                         src->Methods->Clear();
                     }
@@ -392,14 +608,17 @@ PUBLIC int     VMThread::RunInstruction() {
                 else {
                     BytecodeObjectManager::Globals->Put(hash, value);
                 }
+                BytecodeObjectManager::UnlockGlobalsWrite();
+                GarbageCollector::WriteBarrier(NULL, value);
                 Pop();
                 BytecodeObjectManager::Unlock();
             }
-            break;
+            VM_BREAK;
         }
 
         // Object Properties (heap)
-        case OP_GET_PROPERTY: {
+        VM_CASE(OP_GET_PROPERTY):
+        DO_GET_PROPERTY: {
             Uint32 hash;
             VMValue object;
             ObjInstance* instance;
@@ -414,37 +633,41 @@ PUBLIC int     VMThread::RunInstruction() {
             }
             instance = AS_INSTANCE(object);
 
-            if (BytecodeObjectManager::Lock()) {
-                hash = ReadUInt32(frame);
-                if (instance->Fields->Exists(hash)) {
-                    Pop();
-                    Push(BytecodeObjectManager::DelinkValue(instance->Fields->Get(hash)));
-                    BytecodeObjectManager::Unlock();
-                    break;
-                }
-                // else {
-                //     instance->Fields->WithAll([](Uint32 hash, VMValue v) -> void {
-                //         printf("%s: \n", __Tokens__ && __Tokens__->Exists(hash) ? __Tokens__->Get(hash) : "null");
-                //     });
-                // }
-
-                // printf("BindMethod %s: \n", __Tokens__ && __Tokens__->Exists(hash) ? __Tokens__->Get(hash) : "null");
-                if (BindMethod(instance->Class, hash)) {
-                    BytecodeObjectManager::Unlock();
-                    break;
-                }
-                if (__Tokens__ && __Tokens__->Exists(hash))
-                    ThrowError(false, "Could not find %s in instance!", __Tokens__->Get(hash));
-                else
-                    ThrowError(false, "Could not find %X in instance!", hash);
+            hash = ReadUInt32(frame);
+
+            VMValue result;
+            BytecodeObjectManager::LockObject(instance);
+            int slot = GetFieldSlot(frame, instance->Fields, hash);
+            bool exists = slot >= 0;
+            if (exists)
+                result = BytecodeObjectManager::DelinkValue(instance->Fields->Data[slot].Data);
+            BytecodeObjectManager::UnlockObject(instance);
+
+            if (exists) {
                 Pop();
-                Push(NULL_VAL);
-                BytecodeObjectManager::Unlock();
-                // return INTERPRET_RUNTIME_ERROR;
+                Push(result);
+                VM_BREAK;
             }
-            break;
+            // else {
+            //     instance->Fields->WithAll([](Uint32 hash, VMValue v) -> void {
+            //         printf("%s: \n", __Tokens__ && __Tokens__->Exists(hash) ? __Tokens__->Get(hash) : "null");
+            //     });
+            // }
+
+            // printf("BindMethod %s: \n", __Tokens__ && __Tokens__->Exists(hash) ? __Tokens__->Get(hash) : "null");
+            if (BindMethod(instance->Class, hash)) {
+                VM_BREAK;
+            }
+            if (__Tokens__ && __Tokens__->Exists(hash))
+                ThrowError(false, "Could not find %s in instance!", __Tokens__->Get(hash));
+            else
+                ThrowError(false, "Could not find %X in instance!", hash);
+            Pop();
+            Push(NULL_VAL);
+            // return INTERPRET_RUNTIME_ERROR;
+            VM_BREAK;
         }
-        case OP_SET_PROPERTY: {
+        VM_CASE(OP_SET_PROPERTY): {
             Uint32 hash;
             VMValue field;
             VMValue value;
@@ -460,108 +683,156 @@ PUBLIC int     VMThread::RunInstruction() {
             }
             instance = AS_INSTANCE(object);
 
-            if (BytecodeObjectManager::Lock()) {
-                hash = ReadUInt32(frame);
-
-				if (__Tokens__ && __Tokens__->Exists(hash)) {
-					// printf("OP_SET_PROPERTY: %s\n", __Tokens__->Get(hash));
-				}
-
-                value = Pop();
-                if (instance->Fields->Exists(hash)) {
-                    field = instance->Fields->Get(hash);
-                    switch (field.Type) {
-                        case VAL_LINKED_INTEGER:
-                            AS_LINKED_INTEGER(field) = AS_INTEGER(BytecodeObjectManager::CastValueAsInteger(value));
-                            break;
-                        case VAL_LINKED_DECIMAL:
-                            AS_LINKED_DECIMAL(field) = AS_DECIMAL(BytecodeObjectManager::CastValueAsDecimal(value));
-                            break;
-                        default:
-                            instance->Fields->Put(hash, value);
-                    }
-                }
-                else {
-                    instance->Fields->Put(hash, value);
-                }
+            hash = ReadUInt32(frame);
 
-                Pop(); // Instance
-                Push(value);
-                BytecodeObjectManager::Unlock();
+            value = Pop();
+
+            BytecodeObjectManager::LockObject(instance);
+            int slot = GetFieldSlot(frame, instance->Fields, hash);
+            if (slot >= 0) {
+                field = instance->Fields->Data[slot].Data;
+                switch (field.Type) {
+                    case VAL_LINKED_INTEGER:
+                        AS_LINKED_INTEGER(field) = AS_INTEGER(BytecodeObjectManager::CastValueAsInteger(value));
+                        break;
+                    case VAL_LINKED_DECIMAL:
+                        AS_LINKED_DECIMAL(field) = AS_DECIMAL(BytecodeObjectManager::CastValueAsDecimal(value));
+                        break;
+                    default:
+                        instance->Fields->Data[slot].Data = value;
+                }
             }
-            break;
+            else {
+                instance->Fields->Put(hash, value);
+                CacheFieldSlot(frame, instance->Fields->GetIndex(hash));
+            }
+            BytecodeObjectManager::UnlockObject(instance);
+            GarbageCollector::WriteBarrier(instance, value);
+
+            Pop(); // Instance
+            Push(value);
+            VM_BREAK;
         }
-        case OP_GET_ELEMENT: {
+        VM_CASE(OP_GET_ELEMENT): {
             VMValue at = Pop();
             VMValue obj = Pop();
+            // NOTE: Typed arrays never resize, so they need neither the
+            //   object lock nor (when setting) the write barrier.
+            if (IS_TYPED_ARRAY(obj)) {
+                if (!IS_INTEGER(at)) {
+                    ThrowError(true, "Cannot get value from array using non-Integer value as an index.");
+                    Push(NULL_VAL);
+                    VM_BREAK;
+                }
+
+                ObjTypedArray* array = AS_TYPED_ARRAY(obj);
+                int index = AS_INTEGER(at);
+                if (index < 0 || index >= array->Length) {
+                    ThrowError(true, "Index %d is out of bounds of array of size %d.", index, array->Length);
+                    Push(NULL_VAL);
+                    VM_BREAK;
+                }
+                Push(TypedArrayGet(array, index));
+                VM_BREAK;
+            }
             if (!IS_OBJECT(obj)) {
                 ThrowError(true, "Cannot get value from non-Array or non-Map.");
                 Push(NULL_VAL);
-                break;
+                VM_BREAK;
             }
             if (IS_ARRAY(obj)) {
                 if (!IS_INTEGER(at)) {
                     ThrowError(true, "Cannot get value from array using non-Integer value as an index.");
                     Push(NULL_VAL);
-                    break;
+                    VM_BREAK;
                 }
 
-                if (BytecodeObjectManager::Lock()) {
-                    ObjArray* array = AS_ARRAY(obj);
-                    int index = AS_INTEGER(at);
-                    if (index < 0 || (Uint32)index >= array->Values->size()) {
-                        ThrowError(true, "Index %d is out of bounds of array of size %d.", index, (int)array->Values->size());
-                        Push(NULL_VAL);
-                        BytecodeObjectManager::Unlock();
-                        break;
-                    }
-                    Push((*array->Values)[index]);
-                    BytecodeObjectManager::Unlock();
+                ObjArray* array = AS_ARRAY(obj);
+                int index = AS_INTEGER(at);
+                BytecodeObjectManager::LockObject(array);
+                int size = (int)array->Values->size();
+                VMValue result = NULL_VAL;
+                if (index >= 0 && index < size)
+                    result = (*array->Values)[index];
+                BytecodeObjectManager::UnlockObject(array);
+
+                if (index < 0 || index >= size) {
+                    ThrowError(true, "Index %d is out of bounds of array of size %d.", index, size);
+                    Push(NULL_VAL);
+                    VM_BREAK;
                 }
+                Push(result);
             }
             else if (IS_MAP(obj)) {
                 if (!IS_STRING(at)) {
                     ThrowError(true, "Cannot get value from map using non-String value as an index.");
                     Push(NULL_VAL);
-                    break;
+                    VM_BREAK;
                 }
 
-                if (BytecodeObjectManager::Lock()) {
-                    ObjMap* map = AS_MAP(obj);
-                    char* index = AS_CSTRING(at);
-                    if (!*index) {
-                        ThrowError(true, "Cannot find value at empty key.");
-                        Push(NULL_VAL);
-                        BytecodeObjectManager::Unlock();
-                        break;
-                    }
-                    if (!map->Values->Exists(index)) {
-                        // ThrowError(true, "Cannot find value at key \"%s\".", index);
-                        Push(NULL_VAL);
-                        BytecodeObjectManager::Unlock();
-                        break;
-                    }
-
-                    Push(map->Values->Get(index));
-                    BytecodeObjectManager::Unlock();
+                ObjMap* map = AS_MAP(obj);
+                char* index = AS_CSTRING(at);
+                if (!*index) {
+                    ThrowError(true, "Cannot find value at empty key.");
+                    Push(NULL_VAL);
+                    VM_BREAK;
                 }
+
+                VMValue result = NULL_VAL;
+                BytecodeObjectManager::LockObject(map);
+                if (map->Values->Exists(index))
+                    result = map->Values->Get(index);
+                // else
+                //     ThrowError(true, "Cannot find value at key \"%s\".", index);
+                BytecodeObjectManager::UnlockObject(map);
+
+                Push(result);
             }
             else {
                 ThrowError(true, "Cannot get value from object that's non-Array or non-Map.");
                 Push(NULL_VAL);
-                break;
+                VM_BREAK;
             }
-            break;
+            VM_BREAK;
         }
-        case OP_SET_ELEMENT: {
+        VM_CASE(OP_SET_ELEMENT): {
             VMValue value = Peek(0);
             VMValue at = Peek(1);
             VMValue obj = Peek(2);
+            if (IS_TYPED_ARRAY(obj)) {
+                if (!IS_INTEGER(at)) {
+                    ThrowError(true, "Cannot get value from array using non-Integer value as an index.");
+                    Pop(); Pop(); Pop();
+                    Push(NULL_VAL);
+                    VM_BREAK;
+                }
+
+                ObjTypedArray* array = AS_TYPED_ARRAY(obj);
+                int index = AS_INTEGER(at);
+                if (index < 0 || index >= array->Length) {
+                    ThrowError(true, "Index %d is out of bounds of array of size %d.", index, array->Length);
+                    Pop(); Pop(); Pop();
+                    Push(NULL_VAL);
+                    VM_BREAK;
+                }
+                if (!TypedArraySet(array, index, value)) {
+                    ThrowError(true, "Cannot store value of type %s in a typed array.", GetTypeString(value));
+                    Pop(); Pop(); Pop();
+                    Push(NULL_VAL);
+                    VM_BREAK;
+                }
+
+                Pop(); // value
+                Pop(); // at
+                Pop(); // Array
+                Push(value);
+                VM_BREAK;
+            }
             if (!IS_OBJECT(obj)) {
                 ThrowError(true, "Cannot set value in non-Array or non-Map.");
                 Pop(); Pop(); Pop();
                 Push(NULL_VAL);
-                break;
+                VM_BREAK;
             }
 
             if (IS_ARRAY(obj)) {
@@ -569,20 +840,23 @@ PUBLIC int     VMThread::RunInstruction() {
                     ThrowError(true, "Cannot get value from array using non-Integer value as an index.");
                     Pop(); Pop(); Pop();
                     Push(NULL_VAL);
-                    break;
+                    VM_BREAK;
                 }
 
-                if (BytecodeObjectManager::Lock()) {
-                    ObjArray* array = AS_ARRAY(obj);
-                    int index = AS_INTEGER(at);
-                    if (index < 0 || (Uint32)index >= array->Values->size()) {
-                        ThrowError(true, "Index %d is out of bounds of array of size %d.", index, (int)array->Values->size());
-                        Pop(); Pop(); Pop();
-                        Push(NULL_VAL);
-                        break;
-                    }
+                ObjArray* array = AS_ARRAY(obj);
+                int index = AS_INTEGER(at);
+                BytecodeObjectManager::LockObject(array);
+                int size = (int)array->Values->size();
+                if (index >= 0 && index < size)
                     (*array->Values)[index] = value;
-                    BytecodeObjectManager::Unlock();
+                BytecodeObjectManager::UnlockObject(array);
+                GarbageCollector::WriteBarrier(array, value);
+
+                if (index < 0 || index >= size) {
+                    ThrowError(true, "Index %d is out of bounds of array of size %d.", index, size);
+                    Pop(); Pop(); Pop();
+                    Push(NULL_VAL);
+                    VM_BREAK;
                 }
             }
             else if (IS_MAP(obj)) {
@@ -590,52 +864,68 @@ PUBLIC int     VMThread::RunInstruction() {
                     ThrowError(true, "Cannot get value from map using non-String value as an index.");
                     Pop(); Pop(); Pop();
                     Push(NULL_VAL);
-                    break;
+                    VM_BREAK;
                 }
 
-                if (BytecodeObjectManager::Lock()) {
-                    ObjMap* map = AS_MAP(obj);
-                    char* index = AS_CSTRING(at);
-                    if (!*index) {
-                        ThrowError(true, "Cannot find value at empty key.");
-                        Pop(); Pop(); Pop();
-                        Push(NULL_VAL);
-                        break;
-                    }
-
-                    map->Values->Put(index, value);
-                    map->Keys->Put(index, HeapCopyString(index, strlen(index)));
-                    BytecodeObjectManager::Unlock();
+                ObjMap* map = AS_MAP(obj);
+                char* index = AS_CSTRING(at);
+                if (!*index) {
+                    ThrowError(true, "Cannot find value at empty key.");
+                    Pop(); Pop(); Pop();
+                    Push(NULL_VAL);
+                    VM_BREAK;
                 }
+
+                BytecodeObjectManager::LockObject(map);
+                map->Values->Put(index, value);
+                map->Keys->Put(index, HeapCopyString(index, strlen(index)));
+                BytecodeObjectManager::UnlockObject(map);
+                GarbageCollector::WriteBarrier(map, value);
             }
             else {
                 ThrowError(true, "Cannot set value in object that's non-Array or non-Map.");
                 Pop(); Pop(); Pop();
                 Push(NULL_VAL);
-                break;
+                VM_BREAK;
             }
 
             Pop(); // value
             Pop(); // at
             Pop(); // Array
             Push(value);
-            break;
+            VM_BREAK;
         }
 
         // Locals
-        case OP_GET_LOCAL: {
+        VM_CASE(OP_GET_LOCAL): {
             Uint8 slot = ReadByte(frame);
             Push(frame->Slots[slot]);
-            break;
+            VM_BREAK;
+        }
+        VM_CASE(OP_GET_LOCAL_LONG): {
+            Uint16 slot = ReadUInt16(frame);
+            Push(frame->Slots[slot]);
+            VM_BREAK;
+        }
+        VM_CASE(OP_GET_LOCAL_PROPERTY): {
+            // GET_LOCAL followed by GET_PROPERTY; the hash operand comes
+            // right after the slot, so the property half is shared.
+            Push(frame->Slots[ReadByte(frame)]);
+            goto DO_GET_PROPERTY;
         }
-        case OP_SET_LOCAL: {
+        VM_CASE(OP_SET_LOCAL): {
             Uint8 slot = ReadByte(frame);
             frame->Slots[slot] = Peek(0);
-            break;
+            VM_BREAK;
+        }
+        VM_CASE(OP_SET_LOCAL_LONG): {
+            Uint16 slot = ReadUInt16(frame);
+            frame->Slots[slot] = Peek(0);
+            VM_BREAK;
         }
 
         // Object Allocations (heap)
-        case OP_NEW_ARRAY: {
+        VM_CASE(OP_NEW_ARRAY): {
             Uint32 count = ReadUInt32(frame);
             if (BytecodeObjectManager::Lock()) {
                 ObjArray* array = NewArray();
@@ -646,9 +936,9 @@ PUBLIC int     VMThread::RunInstruction() {
                 Push(OBJECT_VAL(array));
                 BytecodeObjectManager::Unlock();
             }
-            break;
+            VM_BREAK;
         }
-        case OP_NEW_MAP: {
+        VM_CASE(OP_NEW_MAP): {
             Uint32 count = ReadUInt32(frame);
             if (BytecodeObjectManager::Lock()) {
                 ObjMap* map = NewMap();
@@ -664,27 +954,33 @@ PUBLIC int     VMThread::RunInstruction() {
                 Push(OBJECT_VAL(map));
                 BytecodeObjectManager::Unlock();
             }
-            break;
+            VM_BREAK;
         }
 
         // Stack constants
-        case OP_NULL:           Push(NULL_VAL); break;
-        case OP_TRUE:           Push(INTEGER_VAL(1)); break;
-        case OP_FALSE:          Push(INTEGER_VAL(0)); break;
-        case OP_CONSTANT:       Push(ReadConstant(frame)); break;
+        VM_CASE(OP_NULL):       Push(NULL_VAL); VM_BREAK;
+        VM_CASE(OP_TRUE):       Push(INTEGER_VAL(1)); VM_BREAK;
+        VM_CASE(OP_FALSE):      Push(INTEGER_VAL(0)); VM_BREAK;
+        VM_CASE(OP_CONSTANT):   Push(ReadConstant(frame)); VM_BREAK;
+        VM_CASE(OP_CONSTANT_LONG):  Push(ReadConstantLong(frame)); VM_BREAK;
 
         // Switch statements
-        case OP_SWITCH_TABLE: {
+        VM_CASE(OP_SWITCH_TABLE):
+        VM_CASE(OP_SWITCH_TABLE_LONG): {
+            // The long form has 24-bit constant indices.
+            bool wide = instruction == OP_SWITCH_TABLE_LONG;
+            int default_index = wide ? 0xFFFFFF : 0xFF;
+
             Uint16 count = ReadUInt16(frame);
             VMValue switch_value = Pop();
 
-            Uint8* end = frame->IP + ((1 + 2) * count) + 3;
+            Uint8* end = frame->IP + (((wide ? 3 : 1) + 2) * count) + 3;
 
             int default_offset = -1;
             for (int i = 0; i < count; i++) {
-                int constant_index = ReadByte(frame);
+                int constant_index = wide ? ReadUInt24(frame) : ReadByte(frame);
                 int offset = ReadUInt16(frame);
-                if (constant_index == 0xFF) {
+                if (constant_index == default_index) {
                     default_offset = offset;
                 }
                 else {
@@ -701,23 +997,23 @@ PUBLIC int     VMThread::RunInstruction() {
             }
 
             JUMPED:
-            break;
+            VM_BREAK;
         }
 
         // Stack Operations
-        case OP_POP: {
+        VM_CASE(OP_POP): {
             Pop();
-            break;
+            VM_BREAK;
         }
-        case OP_COPY: {
+        VM_CASE(OP_COPY): {
             Uint8 count = ReadByte(frame);
             for (int i = 0; i < count; i++)
                 Push(Peek(count - 1));
-            break;
+            VM_BREAK;
         }
-        case OP_SAVE_VALUE:     RegisterValue = Pop(); break;
-        case OP_LOAD_VALUE:     Push(RegisterValue); break;
-        case OP_PRINT: {
+        VM_CASE(OP_SAVE_VALUE): RegisterValue = Pop(); VM_BREAK;
+        VM_CASE(OP_LOAD_VALUE): Push(RegisterValue); VM_BREAK;
+        VM_CASE(OP_PRINT): {
             VMValue v = Peek(0);
 
             char* buffer = (char*)malloc(4);
@@ -727,15 +1023,15 @@ PUBLIC int     VMThread::RunInstruction() {
             free(buffer);
 
             Pop();
-            break;
+            VM_BREAK;
         }
-        case OP_PRINT_STACK: {
+        VM_CASE(OP_PRINT_STACK): {
             PrintStack();
-            break;
+            VM_BREAK;
         }
 
         // Frame stuffs & Returning
-        case OP_RETURN: {
+        VM_CASE(OP_RETURN): {
             VMValue result = Pop();
 
             FrameCount--;
@@ -747,59 +1043,84 @@ PUBLIC int     VMThread::RunInstruction() {
             Push(result);
 
             frame = &Frames[FrameCount - 1];
-            break;
+            VM_BREAK;
         }
 
         // Jumping
-        case OP_JUMP: {
+        VM_CASE(OP_JUMP): {
             Sint32 offset = ReadSInt16(frame);
             frame->IP += offset;
-            break;
+            VM_BREAK;
         }
-        case OP_JUMP_BACK: {
+        VM_CASE(OP_JUMP_BACK): {
             Sint32 offset = ReadSInt16(frame);
             frame->IP -= offset;
-            break;
+            VM_BREAK;
         }
-        case OP_JUMP_IF_FALSE: {
+        VM_CASE(OP_JUMP_IF_FALSE): {
             Sint32 offset = ReadSInt16(frame);
             if (BytecodeObjectManager::ValueFalsey(Peek(0))) {
                 frame->IP += offset;
             }
-            break;
+            VM_BREAK;
         }
 
         // Numeric Operations
-        case OP_ADD:            Push(Values_Plus());  break;
-        case OP_SUBTRACT:       Push(Values_Minus());  break;
-        case OP_MULTIPLY:       Push(Values_Multiply());  break;
-        case OP_DIVIDE:         Push(Values_Division());  break;
-        case OP_MODULO:         Push(Values_Modulo());  break;
-        case OP_NEGATE:         Push(Values_Negate());  break;
-        case OP_INCREMENT:      Push(Values_Increment()); break;
-        case OP_DECREMENT:      Push(Values_Decrement()); break;
+        VM_CASE(OP_ADD):        Push(Values_Plus());  VM_BREAK;
+        VM_CASE(OP_SUBTRACT):   Push(Values_Minus());  VM_BREAK;
+        VM_CASE(OP_MULTIPLY):   Push(Values_Multiply());  VM_BREAK;
+        VM_CASE(OP_DIVIDE):     Push(Values_Division());  VM_BREAK;
+        VM_CASE(OP_MODULO):     Push(Values_Modulo());  VM_BREAK;
+        VM_CASE(OP_NEGATE):     Push(Values_Negate());  VM_BREAK;
+        VM_CASE(OP_INCREMENT):  Push(Values_Increment()); VM_BREAK;
+        VM_CASE(OP_DECREMENT):  Push(Values_Decrement()); VM_BREAK;
         // Bit Operations
-        case OP_BITSHIFT_LEFT:  Push(Values_BitwiseLeft());  break;
-        case OP_BITSHIFT_RIGHT: Push(Values_BitwiseRight());  break;
+        VM_CASE(OP_BITSHIFT_LEFT):  Push(Values_BitwiseLeft());  VM_BREAK;
+        VM_CASE(OP_BITSHIFT_RIGHT): Push(Values_BitwiseRight());  VM_BREAK;
         // Bitwise Operations
-        case OP_BW_NOT:         Push(Values_BitwiseNOT());  break;
-        case OP_BW_AND:         Push(Values_BitwiseAnd());  break;
-        case OP_BW_OR:          Push(Values_BitwiseOr());  break;
-        case OP_BW_XOR:         Push(Values_BitwiseXor());  break;
+        VM_CASE(OP_BW_NOT):     Push(Values_BitwiseNOT());  VM_BREAK;
+        VM_CASE(OP_BW_AND):     Push(Values_BitwiseAnd());  VM_BREAK;
+        VM_CASE(OP_BW_OR):      Push(Values_BitwiseOr());  VM_BREAK;
+        VM_CASE(OP_BW_XOR):     Push(Values_BitwiseXor());  VM_BREAK;
         // Logical Operations
-        case OP_LG_NOT:         Push(Values_LogicalNOT());  break;
-        case OP_LG_AND:         Push(Values_LogicalAND()); break;
-        case OP_LG_OR:          Push(Values_LogicalOR()); break;
+        VM_CASE(OP_LG_NOT):     Push(Values_LogicalNOT());  VM_BREAK;
+        VM_CASE(OP_LG_AND):     Push(Values_LogicalAND()); VM_BREAK;
+        VM_CASE(OP_LG_OR):      Push(Values_LogicalOR()); VM_BREAK;
         // Equality and Comparison Operators
-        case OP_EQUAL:          Push(INTEGER_VAL(BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); break;
-        case OP_EQUAL_NOT:      Push(INTEGER_VAL(!BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); break;
-        case OP_LESS:           Push(Values_LessThan()); break;
-        case OP_GREATER:        Push(Values_GreaterThan()); break;
-        case OP_LESS_EQUAL:     Push(Values_LessThanOrEqual()); break;
-        case OP_GREATER_EQUAL:  Push(Values_GreaterThanOrEqual()); break;
+        VM_CASE(OP_EQUAL):      Push(INTEGER_VAL(BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); VM_BREAK;
+        VM_CASE(OP_EQUAL_NOT):  Push(INTEGER_VAL(!BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); VM_BREAK;
+        VM_CASE(OP_LESS):       Push(Values_LessThan()); VM_BREAK;
+        VM_CASE(OP_GREATER):    Push(Values_GreaterThan()); VM_BREAK;
+        VM_CASE(OP_LESS_EQUAL): Push(Values_LessThanOrEqual()); VM_BREAK;
+        VM_CASE(OP_GREATER_EQUAL):  Push(Values_GreaterThanOrEqual()); VM_BREAK;
+
+        // Superinstructions
+        VM_CASE(OP_ADD_LOCAL_CONSTANT): {
+            Push(frame->Slots[ReadByte(frame)]);
+            Push(ReadConstant(frame));
+            Push(Values_Plus());
+            VM_BREAK;
+        }
+        VM_CASE(OP_COMPARE_JUMP_IF_FALSE): {
+            Uint8  compare = ReadByte(frame);
+            Sint32 offset = ReadSInt16(frame);
+            switch (compare) {
+                case OP_EQUAL:          Push(INTEGER_VAL(BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); break;
+                case OP_EQUAL_NOT:      Push(INTEGER_VAL(!BytecodeObjectManager::ValuesSortaEqual(Pop(), Pop()))); break;
+                case OP_LESS:           Push(Values_LessThan()); break;
+                case OP_GREATER:        Push(Values_GreaterThan()); break;
+                case OP_LESS_EQUAL:     Push(Values_LessThanOrEqual()); break;
+                case OP_GREATER_EQUAL:  Push(Values_GreaterThanOrEqual()); break;
+            }
+            // Like OP_JUMP_IF_FALSE, the result stays on the stack.
+            if (BytecodeObjectManager::ValueFalsey(Peek(0))) {
+                frame->IP += offset;
+            }
+            VM_BREAK;
+        }
 
         // Functions
-        case OP_WITH: {
+        VM_CASE(OP_WITH): {
             enum {
                 WITH_STATE_INIT,
                 WITH_STATE_CONDITION,
@@ -881,7 +1202,10 @@ PUBLIC int     VMThread::RunInstruction() {
                         WithIteratorStackTop++;
 
                         // Backup original receiver
+                        BytecodeObjectManager::LockGlobalsWrite();
                         BytecodeObjectManager::Globals->Put("other", frame->Slots[0]);
+                        BytecodeObjectManager::UnlockGlobalsWrite();
+                        GarbageCollector::WriteBarrier(NULL, frame->Slots[0]);
                         *WithReceiverStackTop = frame->Slots[0];
                         WithReceiverStackTop++;
                         // Replace receiver
@@ -889,7 +1213,10 @@ PUBLIC int     VMThread::RunInstruction() {
                     }
                     else if (IS_INSTANCE(receiver)) {
                         // Backup original receiver
+                        BytecodeObjectManager::LockGlobalsWrite();
                         BytecodeObjectManager::Globals->Put("other", frame->Slots[0]);
+                        BytecodeObjectManager::UnlockGlobalsWrite();
+                        GarbageCollector::WriteBarrier(NULL, frame->Slots[0]);
                         *WithReceiverStackTop = frame->Slots[0];
                         WithReceiverStackTop++;
                         // Replace receiver
@@ -978,18 +1305,18 @@ PUBLIC int     VMThread::RunInstruction() {
             //     printf("\n");
             // }
 
-            break;
+            VM_BREAK;
         }
-        case OP_CALL: {
+        VM_CASE(OP_CALL): {
             int argCount = ReadByte(frame);
             if (!CallValue(Peek(argCount), argCount)) {
                 ThrowError(true, "Could not call value!");
                 return INTERPRET_RUNTIME_ERROR;
             }
             frame = &Frames[FrameCount - 1];
-            break;
+            VM_BREAK;
         }
-        case OP_INVOKE: {
+        VM_CASE(OP_INVOKE): {
             Uint32 argCount = ReadByte(frame);
             Uint32 hash = ReadUInt32(frame);
 
@@ -1034,7 +1361,7 @@ PUBLIC int     VMThread::RunInstruction() {
 
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                VM_BREAK;
             }
 
             if (!Invoke(hash, argCount)) {
@@ -1044,9 +1371,9 @@ PUBLIC int     VMThread::RunInstruction() {
             }
 
             frame = &Frames[FrameCount - 1];
-            break;
+            VM_BREAK;
         }
-        case OP_CLASS: {
+        VM_CASE(OP_CLASS): {
             Uint32 hash = ReadUInt32(frame);
             ObjClass* klass = NewClass(hash);
             klass->Extended = ReadByte(frame);
@@ -1062,14 +1389,19 @@ PUBLIC int     VMThread::RunInstruction() {
             // }
 
             Push(OBJECT_VAL(klass));
-            break;
+            VM_BREAK;
         }
-        case OP_METHOD: {
+        VM_CASE(OP_METHOD): {
             int index = ReadByte(frame);
             Uint32 hash = ReadUInt32(frame);
             BytecodeObjectManager::DefineMethod(index, hash);
-            break;
+            VM_BREAK;
         }
+
+        #ifdef USING_VM_DISPATCH_TABLE
+        LABEL_OP_UNKNOWN:
+            VM_BREAK;
+        #endif
     }
 
     if (DebugInfo) {
@@ -1080,6 +1412,10 @@ PUBLIC int     VMThread::RunInstruction() {
     return INTERPRET_OK;
 }
 PUBLIC void    VMThread::RunInstructionSet() {
+    // Time spent outside of scripts isn't charged to the first sample
+    if (ReturnFrame == 0)
+        ProfilerTick = (Uint32)SDL_AtomicGet(&ScriptProfiler::Tick);
+
     while (true) {
         // if (!BytecodeObjectManager::Lock()) break;
 
@@ -1193,7 +1529,15 @@ PUBLIC bool    VMThread::CallValue(VMValue callee, int argCount) {
                 case OBJ_NATIVE: {
                     NativeFn native = AS_NATIVE(callee);
 
+                    #ifdef VM_OPCODE_STATS
+                    Uint64 nativeStart = SDL_GetPerformanceCounter();
+                    #endif
+
                     VMValue result = native(argCount, StackTop - argCount, ID);
+
+                    #ifdef VM_OPCODE_STATS
+                    OpcodeStats::RecordNative(this, (ObjNative*)AS_OBJECT(callee), SDL_GetPerformanceCounter() - nativeStart);
+                    #endif
                     // Pop arguments
                     StackTop -= argCount;
                     // Pop receiver / class
@@ -1231,6 +1575,7 @@ PUBLIC bool    VMThread::Call(ObjFunction* function, int argCount) {
     CallFrame* frame = &Frames[FrameCount++];
     frame->IP = function->Chunk.Code;
     frame->IPStart = frame->IP;
+    frame->IPLast = frame->IP;
     frame->Function = function;
     frame->Slots = StackTop - (function->Arity + 1);
 
@@ -1251,7 +1596,15 @@ PUBLIC bool    VMThread::InvokeFromClass(ObjClass* klass, Uint32 hash, int argCo
 
         if (IS_NATIVE(method)) {
             NativeFn native = AS_NATIVE(method);
+            #ifdef VM_OPCODE_STATS
+            Uint64 nativeStart = SDL_GetPerformanceCounter();
+            #endif
+
             VMValue result = native(argCount + 1, StackTop - argCount - 1, ID);
+
+            #ifdef VM_OPCODE_STATS
+            OpcodeStats::RecordNative(this, (ObjNative*)AS_OBJECT(method), SDL_GetPerformanceCounter() - nativeStart);
+            #endif
             StackTop -= argCount + 1;
             Push(result);
             BytecodeObjectManager::Unlock();
@@ -1276,20 +1629,20 @@ PUBLIC bool    VMThread::Invoke(Uint32 hash, int argCount) {
     // First look for a field which may shadow a method.
     VMValue value;
     bool exists = false;
-    if (BytecodeObjectManager::Lock()) {
-        if ((exists = instance->Fields->Exists(hash)))
-            value = instance->Fields->Get(hash);
 
-        BytecodeObjectManager::Unlock();
+    BytecodeObjectManager::LockObject(instance);
+    int slot = instance->Fields->GetIndex(hash);
+    if ((exists = slot >= 0))
+        value = instance->Fields->Data[slot].Data;
+    BytecodeObjectManager::UnlockObject(instance);
 
-        // if (IS_OBJECT(value)) {
-        //     printf("instance.%s: ", __Tokens__->Get(hash));
-        //     Compiler::PrintValue(value);
-        //     printf(" exists: %d argCount: %d\n", exists, argCount);
-        //
-        //     PrintStack();
-        // }
-    }
+    // if (IS_OBJECT(value)) {
+    //     printf("instance.%s: ", __Tokens__->Get(hash));
+    //     Compiler::PrintValue(value);
+    //     printf(" exists: %d argCount: %d\n", exists, argCount);
+    //
+    //     PrintStack();
+    // }
     if (exists) {
         // StackTop[-argCount] = value;
         return CallValue(value, argCount);
@@ -15,6 +15,8 @@ public:
 #include <Engine/FontFace.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Diagnostics/Memory.h>
+#include <Engine/Hashing/CRC32.h>
+#include <Engine/Rendering/TextureAtlas.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -212,24 +214,40 @@ PUBLIC STATIC ISprite* FontFace::SpriteFromFont(Stream* stream, int pixelSize, c
 		}
 	}
 
-    sprite->Spritesheets[0] = Graphics::CreateTextureFromPixels(package->Width, package->Height, pixelData, package->Width * sizeof(Uint32));
+    // Glyph pages share the sprite sheet atlas when it's enabled
+    Texture* texture = NULL;
+    int      offsetX = 0;
+    int      offsetY = 0;
+    if (filename) {
+        char   atlasName[256];
+        Uint32 checksum = CRC32::EncryptData(fontFileMemory, (Uint32)fontFileLength);
+        snprintf(atlasName, sizeof(atlasName), "%s@%d", filename, pixelSize);
+        if (!TextureAtlas::Get(atlasName, checksum, &texture, &offsetX, &offsetY))
+            TextureAtlas::Insert(atlasName, checksum, pixelData, package->Width, package->Height, &texture, &offsetX, &offsetY);
+    }
+    if (!texture)
+        texture = Graphics::CreateTextureFromPixels(package->Width, package->Height, pixelData, package->Width * sizeof(Uint32));
+
+    sprite->Spritesheets[0] = texture;
     sprite->SpritesheetsBorrowed[0] = false;
+    sprite->SpritesheetsOffsetX[0] = offsetX;
+    sprite->SpritesheetsOffsetY[0] = offsetY;
     sprite->SpritesheetCount = 1;
 
 	// Add preliminary chars
 	sprite->AddAnimation("Font", offsetBaseline & 0xFFFF, pixelSize, 0x100);
 	for (Uint32 c = 0; c < ' '; c++) {
-		sprite->AddFrame(0, 0, 0, 1, 1, 0, 0, 0);
+		sprite->AddFrame(0, offsetX, offsetY, 1, 1, 0, 0, 0);
 	}
 
 	for (Uint32 c = ' '; c < 0x100; c++) {
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
 			Log::Print(Log::LOG_ERROR, "FREETYTPE: Failed to load Glyph %X (%c)", c, c);
-			sprite->AddFrame(0, 0, 0, 1, 1, 0, 0, 0);
+			sprite->AddFrame(0, offsetX, offsetY, 1, 1, 0, 0, 0);
 			continue;
 		}
 
-		sprite->AddFrame(0, boxes[c].X, boxes[c].Y, face->glyph->bitmap.width, face->glyph->bitmap.rows, face->glyph->bitmap_left + offsetSlightX, -face->glyph->bitmap_top + offsetBaseline, 0);
+		sprite->AddFrame(0, boxes[c].X + offsetX, boxes[c].Y + offsetY, face->glyph->bitmap.width, face->glyph->bitmap.rows, face->glyph->bitmap_left + offsetSlightX, -face->glyph->bitmap_top + offsetBaseline, 0);
         sprite->Animations.back().Frames.back().Advance = face->glyph->advance.x >> 6;
 	}
 
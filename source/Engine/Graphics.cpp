@@ -216,7 +216,7 @@ PUBLIC STATIC void     Graphics::ChooseBackend() {
 	char renderer[64];
 	if (Application::Settings->GetString("dev", "renderer", renderer)) {
         if (!strcmp(renderer, "software")) {
-			SoftwareRenderer::SetGraphicsFunctions((void*)defaultRenderer);
+			SoftwareRenderer::SetGraphicsFunctions();
 			return;
 		}
 		else if (!strcmp(renderer, "opengl")) {
@@ -333,6 +333,14 @@ PUBLIC STATIC void     Graphics::DisposeTexture(Texture* texture) {
 
 	Memory::Free(texture);
 }
+PUBLIC STATIC bool     Graphics::SupportsPalettes() {
+	return Graphics::Internal.SetTexturePalette != NULL;
+}
+PUBLIC STATIC bool     Graphics::SetTexturePalette(Texture* texture, Uint32* palette, int count, int transparentIndex) {
+	if (!Graphics::Internal.SetTexturePalette)
+		return false;
+	return Graphics::Internal.SetTexturePalette(texture, palette, count, transparentIndex);
+}
 
 PUBLIC STATIC void     Graphics::UseShader(void* shader) {
 	Graphics::CurrentShader = shader;
@@ -484,6 +492,10 @@ PUBLIC STATIC void     Graphics::SetBlendMode(int srcC, int dstC, int srcA, int
 PUBLIC STATIC void     Graphics::SetLineWidth(float n) {
     Graphics::Internal.SetLineWidth(n);
 }
+PUBLIC STATIC void     Graphics::SetFilter(int filter) {
+	if (Graphics::Internal.SetFilter)
+		Graphics::Internal.SetFilter(filter);
+}
 
 PUBLIC STATIC void     Graphics::StrokeLine(float x1, float y1, float x2, float y2) {
     Graphics::Internal.StrokeLine(x1, y1, x2, y2);
@@ -6,4 +6,12 @@ namespace CompressionMode { enum {
     DECOMPRESS,
 }; };
 
+// NOTE: Stored in data files, so values must not change.
+namespace CompressionCodec { enum {
+    NONE = 0,
+    ZLIB = 1,
+    LZ4  = 2,
+    ZSTD = 3,
+}; };
+
 #endif /* ENGINE_IO_COMPRESSION_COMPRESSIONENUMS_H */
@@ -89,7 +89,9 @@ PUBLIC        size_t      ZLibStream::WriteBytes(void* data, size_t n) {
     return n;
 }
 
-PUBLIC STATIC void        ZLibStream::Decompress(void* dst, size_t dstLen, void* src, size_t srcLen) {
+// NOTE: Returns false unless the whole stream inflated to exactly dstLen
+//   bytes, so truncated or corrupt data can be told apart from valid data.
+PUBLIC STATIC bool        ZLibStream::Decompress(void* dst, size_t dstLen, void* src, size_t srcLen) {
     z_stream infstream;
     infstream.zalloc = Z_NULL;
     infstream.zfree = Z_NULL;
@@ -100,9 +102,30 @@ PUBLIC STATIC void        ZLibStream::Decompress(void* dst, size_t dstLen, void*
     infstream.avail_in = srcLen;
     infstream.avail_out = dstLen;
 
-    inflateInit(&infstream);
-    inflate(&infstream, Z_NO_FLUSH);
+    if (inflateInit(&infstream) != Z_OK)
+        return false;
+
+    int result = inflate(&infstream, Z_FINISH);
+    size_t written = infstream.total_out;
     inflateEnd(&infstream);
+
+    return result == Z_STREAM_END && written == dstLen;
+}
+
+PUBLIC STATIC bool        ZLibStream::Compress(void* src, size_t srcLen, void** out, size_t* outLen) {
+    uLongf dstLen = compressBound(srcLen);
+    void*  dst = Memory::Malloc(dstLen);
+    if (!dst)
+        return false;
+
+    if (compress2((Bytef*)dst, &dstLen, (Bytef*)src, srcLen, Z_BEST_SPEED) != Z_OK) {
+        Memory::Free(dst);
+        return false;
+    }
+
+    *out = dst;
+    *outLen = dstLen;
+    return true;
 }
 
 PRIVATE       void        ZLibStream::Decompress(void* in, size_t inLen) {
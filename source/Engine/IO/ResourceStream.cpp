@@ -6,6 +6,10 @@ public:
     Uint8* pointer = NULL;
     Uint8* pointer_start = NULL;
     size_t size = 0;
+    bool   owns_memory = false;
+    void*  blocks = NULL;
+    size_t block_size = 0;
+    Uint8* blocks_ready = NULL;
 };
 #endif
 
@@ -22,8 +26,25 @@ PUBLIC STATIC ResourceStream* ResourceStream::New(const char* filename) {
     if (!filename)
         goto FREE;
 
-    if (!ResourceManager::LoadResource(filename, &stream->pointer_start, &stream->size))
-        goto FREE;
+    // Uncompressed entries of a mapped data file are read in place,
+    //   and large block-compressed ones are decoded as they are read.
+    if (!ResourceManager::MapResource(filename, &stream->pointer_start, &stream->size)) {
+        stream->owns_memory = true;
+
+        if ((stream->blocks = ResourceManager::OpenResourceBlocks(filename, &stream->size, &stream->block_size))) {
+            size_t blockCount = (stream->size + stream->block_size - 1) / stream->block_size;
+            stream->pointer_start = (Uint8*)Memory::Malloc(stream->size + 1);
+            stream->blocks_ready = (Uint8*)Memory::Calloc(blockCount, sizeof(Uint8));
+            if (!stream->pointer_start || !stream->blocks_ready) {
+                stream->Close();
+                return NULL;
+            }
+            stream->pointer_start[stream->size] = 0;
+        }
+        else if (!ResourceManager::LoadResource(filename, &stream->pointer_start, &stream->size)) {
+            goto FREE;
+        }
+    }
 
     stream->pointer = stream->pointer_start;
 
@@ -34,8 +55,28 @@ PUBLIC STATIC ResourceStream* ResourceStream::New(const char* filename) {
         return NULL;
 }
 
+PUBLIC        bool            ResourceStream::ReadyBlocks(size_t offset, size_t n) {
+    size_t first = offset / block_size;
+    size_t last = (offset + n - 1) / block_size;
+    for (size_t b = first; b <= last; b++) {
+        if (blocks_ready[b])
+            continue;
+
+        if (!ResourceManager::ReadResourceBlock(blocks, (Uint32)b, pointer_start + b * block_size))
+            return false;
+
+        blocks_ready[b] = 1;
+    }
+    return true;
+}
+
 PUBLIC        void            ResourceStream::Close() {
-    Memory::Free(pointer_start);
+    if (blocks)
+        ResourceManager::CloseResourceBlocks(blocks);
+    if (blocks_ready)
+        Memory::Free(blocks_ready);
+    if (owns_memory && pointer_start)
+        Memory::Free(pointer_start);
     Stream::Close();
 }
 PUBLIC        void            ResourceStream::Seek(Sint64 offset) {
@@ -60,6 +101,9 @@ PUBLIC        size_t          ResourceStream::ReadBytes(void* data, size_t n) {
     }
     if (n == 0) return 0;
 
+    if (blocks && !ReadyBlocks(Position(), n))
+        return 0;
+
     memcpy(data, pointer, n);
     pointer += n;
     return n;
@@ -179,6 +179,25 @@ public:
         Uint32 hash = HashFunction(key);
         return Exists(hash);
     }
+    int    GetIndex(Uint32 hash) {
+        Uint32 index;
+
+        index = hash;
+        index = TranslateIndex(index);
+
+        for (int i = 0; i < ChainLength; i++) {
+            if (Data[index].Used && Data[index].Key == hash) {
+                return (int)index;
+            }
+
+            index = (index + 1) & CapacityMask; // index = (index + 1) % Capacity;
+        }
+
+        return -1;
+    }
+    bool   IsIndexOf(int index, Uint32 hash) {
+        return index < Capacity && Data[index].Used && Data[index].Key == hash;
+    }
 
     bool   Remove(Uint32 hash) {
         Uint32 index;
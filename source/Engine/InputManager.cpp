@@ -2,6 +2,7 @@
 #include <Engine/Includes/Standard.h>
 #include <Engine/Includes/StandardSDL2.h>
 #include <Engine/Application.h>
+#include <Engine/IO/Stream.h>
 
 class InputManager {
 public:
@@ -19,10 +20,14 @@ public:
 
     static SDL_TouchID TouchDevice;
     static void*       TouchStates;
+
+    static Stream*     ReplayStream;
+    static Stream*     RecordStream;
 };
 #endif
 
 #include <Engine/InputManager.h>
+#include <Engine/IO/FileStream.h>
 
 float       InputManager::MouseX = 0;
 float       InputManager::MouseY = 0;
@@ -39,6 +44,15 @@ void*       InputManager::ControllerHaptics[8];
 SDL_TouchID InputManager::TouchDevice;
 void*       InputManager::TouchStates;
 
+Stream*     InputManager::ReplayStream = NULL;
+Stream*     InputManager::RecordStream = NULL;
+
+// Input recordings are a small header followed by one fixed-size
+// record per Poll: the keyboard state, then mouse X, Y and buttons.
+#define INPUT_RECORD_MAGIC   0x504E4948 // "HINP"
+#define INPUT_RECORD_VERSION 1
+#define INPUT_RECORD_KEYS    (0x11C + 1)
+
 struct TouchState {
     float X;
     float Y;
@@ -79,9 +93,9 @@ PUBLIC STATIC void  InputManager::Init() {
 }
 
 PUBLIC STATIC void  InputManager::Poll() {
-    if (Application::Platform == Platforms::iOS ||
+    if (!ReplayStream && (Application::Platform == Platforms::iOS ||
         Application::Platform == Platforms::Android ||
-        Application::Platform == Platforms::Switch) {
+        Application::Platform == Platforms::Switch)) {
         int w, h;
         TouchState* states = (TouchState*)TouchStates;
         SDL_GetWindowSize(Application::Window, &w, &h);
@@ -133,15 +147,38 @@ PUBLIC STATIC void  InputManager::Poll() {
         }
     }
 
-    const Uint8* state = SDL_GetKeyboardState(NULL);
-    memcpy(KeyboardStateLast, KeyboardState, 0x11C + 1);
-    memcpy(KeyboardState, state, 0x11C + 1);
-
     int mx, my, buttons;
-    buttons = SDL_GetMouseState(&mx, &my);
+    memcpy(KeyboardStateLast, KeyboardState, INPUT_RECORD_KEYS);
+    if (ReplayStream) {
+        // NOTE: Once the recording runs out, hold all inputs released.
+        if (ReplayStream->Position() + INPUT_RECORD_KEYS + 12 <= ReplayStream->Length()) {
+            ReplayStream->ReadBytes(KeyboardState, INPUT_RECORD_KEYS);
+            mx = ReplayStream->ReadInt32();
+            my = ReplayStream->ReadInt32();
+            buttons = (int)ReplayStream->ReadUInt32();
+        }
+        else {
+            memset(KeyboardState, 0, INPUT_RECORD_KEYS);
+            mx = (int)MouseX;
+            my = (int)MouseY;
+            buttons = 0;
+        }
+    }
+    else {
+        const Uint8* state = SDL_GetKeyboardState(NULL);
+        memcpy(KeyboardState, state, INPUT_RECORD_KEYS);
+        buttons = SDL_GetMouseState(&mx, &my);
+    }
     MouseX = mx;
     MouseY = my;
 
+    if (RecordStream) {
+        RecordStream->WriteBytes(KeyboardState, INPUT_RECORD_KEYS);
+        RecordStream->WriteInt32(mx);
+        RecordStream->WriteInt32(my);
+        RecordStream->WriteUInt32((Uint32)buttons);
+    }
+
     int lastDown = MouseDown;
     MouseDown = 0;
     MousePressed = 0;
@@ -159,6 +196,52 @@ PUBLIC STATIC void  InputManager::Poll() {
     }
 }
 
+PUBLIC STATIC bool  InputManager::StartReplay(const char* filename) {
+    Stream* stream = FileStream::New(filename, FileStream::READ_ACCESS);
+    if (!stream) {
+        Log::Print(Log::LOG_ERROR, "Could not open input recording \"%s\"!", filename);
+        return false;
+    }
+
+    if (stream->ReadUInt32() != INPUT_RECORD_MAGIC) {
+        Log::Print(Log::LOG_ERROR, "Invalid input recording \"%s\"!", filename);
+        stream->Close();
+        return false;
+    }
+
+    Uint32 version = stream->ReadUInt32();
+    if (version != INPUT_RECORD_VERSION) {
+        Log::Print(Log::LOG_ERROR, "Unsupported input recording version %u in \"%s\"!", version, filename);
+        stream->Close();
+        return false;
+    }
+
+    if (ReplayStream)
+        ReplayStream->Close();
+    ReplayStream = stream;
+
+    Log::Print(Log::LOG_INFO, "Replaying input from \"%s\" (%d frames)", filename,
+        (int)((stream->Length() - stream->Position()) / (INPUT_RECORD_KEYS + 12)));
+    return true;
+}
+PUBLIC STATIC bool  InputManager::StartRecording(const char* filename) {
+    Stream* stream = FileStream::New(filename, FileStream::WRITE_ACCESS);
+    if (!stream) {
+        Log::Print(Log::LOG_ERROR, "Could not create input recording \"%s\"!", filename);
+        return false;
+    }
+
+    stream->WriteUInt32(INPUT_RECORD_MAGIC);
+    stream->WriteUInt32(INPUT_RECORD_VERSION);
+
+    if (RecordStream)
+        RecordStream->Close();
+    RecordStream = stream;
+
+    Log::Print(Log::LOG_INFO, "Recording input to \"%s\"", filename);
+    return true;
+}
+
 PUBLIC STATIC bool  InputManager::GetControllerAttached(int controller_index) {
     SDL_Joystick* joy = (SDL_Joystick*)InputManager::Controllers[controller_index];
     if (!joy) return false;
@@ -222,4 +305,14 @@ PUBLIC STATIC void  InputManager::Dispose() {
 
     // Dispose of touch states
     Memory::Free(InputManager::TouchStates);
+
+    // Close input recordings
+    if (InputManager::ReplayStream) {
+        InputManager::ReplayStream->Close();
+        InputManager::ReplayStream = NULL;
+    }
+    if (InputManager::RecordStream) {
+        InputManager::RecordStream->Close();
+        InputManager::RecordStream = NULL;
+    }
 }
@@ -21,6 +21,11 @@ enum {
     BlendFactor_INV_DST_ALPHA = 9,
 };
 
+enum {
+    Filter_NONE = 0,
+    Filter_GRAYSCALE = 1,
+};
+
 struct Viewport {
     float X;
     float Y;
@@ -54,6 +59,7 @@ struct GraphicsFunctions {
 	int      (*UpdateYUVTexture)(Texture* texture, SDL_Rect* src, void* pixelsY, int pitchY, void* pixelsU, int pitchU, void* pixelsV, int pitchV);
 	void     (*UnlockTexture)(Texture* texture);
 	void     (*DisposeTexture)(Texture* texture);
+	bool     (*SetTexturePalette)(Texture* texture, Uint32* palette, int count, int transparentIndex);
 
 	void     (*UseShader)(void* shader);
     void     (*SetTextureInterpolation)(bool interpolate);
@@ -75,6 +81,7 @@ struct GraphicsFunctions {
 	void     (*SetBlendColor)(float r, float g, float b, float a);
 	void     (*SetBlendMode)(int srcC, int dstC, int srcA, int dstA);
 	void     (*SetLineWidth)(float n);
+	void     (*SetFilter)(int filter);
 
 	void     (*StrokeLine)(float x1, float y1, float x2, float y2);
 	void     (*StrokeCircle)(float x, float y, float rad);
@@ -48,7 +48,6 @@ GLuint             GLRenderer::BufferSquareFill;
 
 bool               UseDepthTesting = true;
 float              RetinaScale = 1.0;
-Texture*           GL_LastTexture = NULL;
 
 struct   GL_Vec3 {
     float x;
@@ -65,6 +64,13 @@ struct   GL_AnimFrameVert {
     float u;
     float v;
 };
+struct   GL_BatchVert {
+    float x;
+    float y;
+    float z;
+    float u;
+    float v;
+};
 struct   GL_TextureData {
     GLuint TextureID;
     GLuint TextureU;
@@ -86,6 +92,22 @@ struct   GL_TextureData {
 #define GL_MONOCHROME_PIXELFORMAT GL_RED
 #define CHECK_GL() GLShader::CheckGLError(__LINE__)
 
+// NOTE: Quads are batched CPU-side and streamed into one VBO. The
+//   batch buffer is kept small enough for 16-bit indices; the VBO holds
+//   several batches and is orphaned when full and once per frame.
+#define GL_BATCH_MAX_QUADS 4096
+#define GL_BATCH_BUFFER_QUADS (GL_BATCH_MAX_QUADS * 4)
+
+GL_BatchVert       GL_BatchVertices[GL_BATCH_MAX_QUADS * 4];
+int                GL_BatchQuadCount = 0;
+Texture*           GL_BatchTexture = NULL;
+float              GL_BatchColor[4];
+Matrix4x4          GL_BatchProjection;
+Matrix4x4          GL_IdentityMatrix;
+GLuint             GL_BatchVBO = 0;
+GLuint             GL_BatchIBO = 0;
+int                GL_BatchBufferOffset = 0;
+
 #if GL_ES_VERSION_2_0 || GL_ES_VERSION_3_0
 #define GL_ES
 #undef GL_SUPPORTS_MULTISAMPLING
@@ -94,6 +116,199 @@ struct   GL_TextureData {
 #define GL_MONOCHROME_PIXELFORMAT GL_LUMINANCE
 #endif
 
+// NOTE: Shadow copy of the GL state we change most often, so calls that
+//   would not change anything can be skipped. All program, texture unit,
+//   vertex attribute, blend, viewport and scissor changes must go through
+//   the GL_Set* helpers below or the shadow copy goes stale.
+#define GL_STATE_TEXTURE_UNITS 8
+#define GL_STATE_ATTRIBS 32
+
+struct   GL_StateCache {
+    GLuint Program;
+    int    ActiveTexture;
+    GLuint BoundTextures[GL_STATE_TEXTURE_UNITS];
+    Uint32 EnabledAttribs;
+    GLenum BlendFactors[4];
+    GLint  Viewport[4];
+    int    ScissorEnabled;
+    GLint  Scissor[4];
+
+    Uint32 CallsIssued;
+    Uint32 CallsSkipped;
+};
+
+GL_StateCache      GL_State;
+
+void   GL_InvalidateState() {
+    Uint32 issued = GL_State.CallsIssued;
+    Uint32 skipped = GL_State.CallsSkipped;
+
+    // Everything is set to a value GL can never report, so the next
+    //   call to each helper always goes through.
+    memset(&GL_State, 0xFF, sizeof(GL_State));
+    GL_State.EnabledAttribs = 0;
+
+    GL_State.CallsIssued = issued;
+    GL_State.CallsSkipped = skipped;
+}
+void   GL_SetProgram(GLuint program) {
+    if (GL_State.Program == program) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.Program = program;
+    glUseProgram(program); CHECK_GL();
+}
+void   GL_SetActiveTexture(int unit) {
+    if (GL_State.ActiveTexture == unit) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.ActiveTexture = unit;
+    glActiveTexture(GL_TEXTURE0 + unit); CHECK_GL();
+}
+void   GL_SetTexture(int unit, GLuint texture) {
+    if (unit >= GL_STATE_TEXTURE_UNITS) {
+        GL_State.CallsIssued += 2;
+        GL_State.ActiveTexture = unit;
+        glActiveTexture(GL_TEXTURE0 + unit); CHECK_GL();
+        glBindTexture(GL_TEXTURE_2D, texture); CHECK_GL();
+        return;
+    }
+    if (GL_State.BoundTextures[unit] == texture) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_SetActiveTexture(unit);
+    GL_State.CallsIssued++;
+    GL_State.BoundTextures[unit] = texture;
+    glBindTexture(GL_TEXTURE_2D, texture); CHECK_GL();
+}
+void   GL_ForgetTexture(GLuint texture) {
+    // Deleted names get unbound by GL and may be handed out again
+    for (int i = 0; i < GL_STATE_TEXTURE_UNITS; i++) {
+        if (GL_State.BoundTextures[i] == texture)
+            GL_State.BoundTextures[i] = 0;
+    }
+}
+void   GL_SetAttribEnabled(GLint location, bool enabled) {
+    if (location < 0)
+        return;
+
+    Uint32 bit = location < GL_STATE_ATTRIBS ? 1U << location : 0;
+    if (bit && !!(GL_State.EnabledAttribs & bit) == enabled) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    if (enabled) {
+        GL_State.EnabledAttribs |= bit;
+        glEnableVertexAttribArray(location); CHECK_GL();
+    }
+    else {
+        GL_State.EnabledAttribs &= ~bit;
+        glDisableVertexAttribArray(location); CHECK_GL();
+    }
+}
+void   GL_SetBlendFunc(GLenum srcC, GLenum dstC, GLenum srcA, GLenum dstA) {
+    if (GL_State.BlendFactors[0] == srcC && GL_State.BlendFactors[1] == dstC &&
+        GL_State.BlendFactors[2] == srcA && GL_State.BlendFactors[3] == dstA) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.BlendFactors[0] = srcC;
+    GL_State.BlendFactors[1] = dstC;
+    GL_State.BlendFactors[2] = srcA;
+    GL_State.BlendFactors[3] = dstA;
+    glBlendFuncSeparate(srcC, dstC, srcA, dstA); CHECK_GL();
+}
+void   GL_SetViewport(GLint x, GLint y, GLint w, GLint h) {
+    if (GL_State.Viewport[0] == x && GL_State.Viewport[1] == y &&
+        GL_State.Viewport[2] == w && GL_State.Viewport[3] == h) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.Viewport[0] = x;
+    GL_State.Viewport[1] = y;
+    GL_State.Viewport[2] = w;
+    GL_State.Viewport[3] = h;
+    glViewport(x, y, w, h); CHECK_GL();
+}
+void   GL_SetScissorEnabled(bool enabled) {
+    if (GL_State.ScissorEnabled == (int)enabled) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.ScissorEnabled = enabled;
+    if (enabled) {
+        glEnable(GL_SCISSOR_TEST); CHECK_GL();
+    }
+    else {
+        glDisable(GL_SCISSOR_TEST); CHECK_GL();
+    }
+}
+void   GL_SetScissor(GLint x, GLint y, GLint w, GLint h) {
+    if (GL_State.Scissor[0] == x && GL_State.Scissor[1] == y &&
+        GL_State.Scissor[2] == w && GL_State.Scissor[3] == h) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    GL_State.Scissor[0] = x;
+    GL_State.Scissor[1] = y;
+    GL_State.Scissor[2] = w;
+    GL_State.Scissor[3] = h;
+    glScissor(x, y, w, h); CHECK_GL();
+}
+void   GL_SetSamplerUniform(GLint location, int* cached, int unit) {
+    if (*cached == unit) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    *cached = unit;
+    glUniform1i(location, unit); CHECK_GL();
+}
+void   GL_ForgetSamplerUniform(GLint location) {
+    // Scripts may point the built-in samplers somewhere else
+    GLShader* shader = GLRenderer::CurrentShader;
+    if (!shader || location < 0)
+        return;
+
+    if (location == shader->LocTexture)
+        shader->CachedTextureUnits[0] = -1;
+    if (location == shader->LocTextureU)
+        shader->CachedTextureUnits[1] = -1;
+    if (location == shader->LocTextureV)
+        shader->CachedTextureUnits[2] = -1;
+}
+void   GL_SetColor(float* color) {
+    if (memcmp(&GLRenderer::CurrentShader->CachedBlendColors[0], &color[0], sizeof(float) * 4) == 0) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    memcpy(&GLRenderer::CurrentShader->CachedBlendColors[0], &color[0], sizeof(float) * 4);
+    glUniform4f(GLRenderer::CurrentShader->LocColor, color[0], color[1], color[2], color[3]); CHECK_GL();
+}
+void   GL_SetMatrix(GLint location, Matrix4x4** cached, Matrix4x4* matrix) {
+    if (Matrix4x4::Equals(*cached, matrix)) {
+        GL_State.CallsSkipped++;
+        return;
+    }
+    GL_State.CallsIssued++;
+    if (!*cached)
+        *cached = Matrix4x4::Create();
+
+    Matrix4x4::Copy(*cached, matrix);
+    glUniformMatrix4fv(location, 1, false, (*cached)->Values); CHECK_GL();
+}
+
 void   GL_MakeShaders() {
     const GLchar* vertexShaderSource[] = {
         "attribute vec3    i_position;\n",
@@ -207,86 +422,156 @@ void   GL_MakeShapeBuffers() {
     // Reset buffer
     glBindBuffer(GL_ARRAY_BUFFER, 0); CHECK_GL();
 }
-void   GL_Predraw(Texture* texture) {
+void   GL_MakeBatchBuffers() {
+    Uint16* indices = (Uint16*)malloc(GL_BATCH_MAX_QUADS * 6 * sizeof(Uint16));
+    for (int i = 0; i < GL_BATCH_MAX_QUADS; i++) {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 2;
+        indices[i * 6 + 4] = i * 4 + 1;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+    glGenBuffers(1, &GL_BatchIBO); CHECK_GL();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_BatchIBO); CHECK_GL();
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GL_BATCH_MAX_QUADS * 6 * sizeof(Uint16), indices, GL_STATIC_DRAW); CHECK_GL();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); CHECK_GL();
+    free(indices);
+
+    glGenBuffers(1, &GL_BatchVBO); CHECK_GL();
+    glBindBuffer(GL_ARRAY_BUFFER, GL_BatchVBO); CHECK_GL();
+    glBufferData(GL_ARRAY_BUFFER, GL_BATCH_BUFFER_QUADS * 4 * sizeof(GL_BatchVert), NULL, GL_STREAM_DRAW); CHECK_GL();
+    glBindBuffer(GL_ARRAY_BUFFER, 0); CHECK_GL();
+
+    Matrix4x4::Identity(&GL_IdentityMatrix);
+    GL_BatchQuadCount = 0;
+    GL_BatchBufferOffset = 0;
+}
+void   GL_SetState(Texture* texture, Matrix4x4* projection, Matrix4x4* modelView, float* color) {
     // Use appropriate shader if changed
     if (texture) {
         GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
         if (textureData && textureData->YUV) {
             GLRenderer::UseShader(GLRenderer::ShaderTexturedShapeYUV);
 
-            glActiveTexture(GL_TEXTURE0); CHECK_GL();
-            glUniform1i(GLRenderer::CurrentShader->LocTexture, 0); CHECK_GL();
-            glBindTexture(GL_TEXTURE_2D, textureData->TextureID); CHECK_GL();
-
-            glActiveTexture(GL_TEXTURE1); CHECK_GL();
-            glUniform1i(GLRenderer::CurrentShader->LocTextureU, 1); CHECK_GL();
-            glBindTexture(GL_TEXTURE_2D, textureData->TextureU); CHECK_GL();
-
-            glActiveTexture(GL_TEXTURE2); CHECK_GL();
-            glUniform1i(GLRenderer::CurrentShader->LocTextureV, 2); CHECK_GL();
-            glBindTexture(GL_TEXTURE_2D, textureData->TextureV); CHECK_GL();
+            GLShader* shader = GLRenderer::CurrentShader;
+            GL_SetSamplerUniform(shader->LocTexture, &shader->CachedTextureUnits[0], 0);
+            GL_SetSamplerUniform(shader->LocTextureU, &shader->CachedTextureUnits[1], 1);
+            GL_SetSamplerUniform(shader->LocTextureV, &shader->CachedTextureUnits[2], 2);
+            GL_SetTexture(1, textureData->TextureU);
+            GL_SetTexture(2, textureData->TextureV);
         }
         else {
             GLRenderer::UseShader(GLRenderer::ShaderTexturedShape);
         }
 
-        glEnableVertexAttribArray(GLRenderer::CurrentShader->LocTexCoord); CHECK_GL();
+        GL_SetAttribEnabled(GLRenderer::CurrentShader->LocTexCoord, true);
     }
     else {
         if (GLRenderer::CurrentShader == GLRenderer::ShaderTexturedShape || GLRenderer::CurrentShader == GLRenderer::ShaderTexturedShapeYUV)
-            glDisableVertexAttribArray(GLRenderer::CurrentShader->LocTexCoord); CHECK_GL();
+            GL_SetAttribEnabled(GLRenderer::CurrentShader->LocTexCoord, false);
 
         GLRenderer::UseShader(GLRenderer::ShaderShape);
     }
 
     // Do texture (re-)binding if necessary
-    if (GL_LastTexture != texture) {
-        if (texture) {
-            GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
-
-            glActiveTexture(GL_TEXTURE0); CHECK_GL();
-            glBindTexture(GL_TEXTURE_2D, textureData->TextureID); CHECK_GL();
-        }
-        else {
-            glBindTexture(GL_TEXTURE_2D, 0); CHECK_GL();
-        }
+    if (texture) {
+        GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
+        GL_SetTexture(0, textureData->TextureID);
+    }
+    else {
+        GL_SetTexture(0, 0);
     }
-    GL_LastTexture = texture;
 
-    // Update color if needed
-    if (memcmp(&GLRenderer::CurrentShader->CachedBlendColors[0], &Graphics::BlendColors[0], sizeof(float) * 4) != 0) {
-        memcpy(&GLRenderer::CurrentShader->CachedBlendColors[0], &Graphics::BlendColors[0], sizeof(float) * 4);
+    // Update color and matrices if needed
+    GL_SetColor(color);
+    GL_SetMatrix(GLRenderer::CurrentShader->LocProjectionMatrix, &GLRenderer::CurrentShader->CachedProjectionMatrix, projection);
+    GL_SetMatrix(GLRenderer::CurrentShader->LocModelViewMatrix, &GLRenderer::CurrentShader->CachedModelViewMatrix, modelView);
+}
+void   GL_FlushBatch() {
+    if (GL_BatchQuadCount == 0)
+        return;
 
-        glUniform4f(GLRenderer::CurrentShader->LocColor, Graphics::BlendColors[0], Graphics::BlendColors[1], Graphics::BlendColors[2], Graphics::BlendColors[3]); CHECK_GL();
-    }
+    int quadCount = GL_BatchQuadCount;
+    GL_BatchQuadCount = 0;
 
-    // Update matrices
-    if (!Matrix4x4::Equals(GLRenderer::CurrentShader->CachedProjectionMatrix, Scene::Views[Scene::ViewCurrent].ProjectionMatrix)) {
-        if (!GLRenderer::CurrentShader->CachedProjectionMatrix)
-            GLRenderer::CurrentShader->CachedProjectionMatrix = Matrix4x4::Create();
+    // NOTE: Only draws made without a custom shader are batched, but
+    //   Graphics::UseShader sets the new one before we get to flush.
+    void* customShader = Graphics::CurrentShader;
+    Graphics::CurrentShader = NULL;
 
-        Matrix4x4::Copy(GLRenderer::CurrentShader->CachedProjectionMatrix, Scene::Views[Scene::ViewCurrent].ProjectionMatrix);
+    GL_SetState(GL_BatchTexture, &GL_BatchProjection, &GL_IdentityMatrix, GL_BatchColor);
 
-        glUniformMatrix4fv(GLRenderer::CurrentShader->LocProjectionMatrix, 1, false, GLRenderer::CurrentShader->CachedProjectionMatrix->Values); CHECK_GL();
+    glBindBuffer(GL_ARRAY_BUFFER, GL_BatchVBO); CHECK_GL();
+    if (GL_BatchBufferOffset + quadCount > GL_BATCH_BUFFER_QUADS) {
+        // Orphan the buffer instead of waiting on draws still using it
+        glBufferData(GL_ARRAY_BUFFER, GL_BATCH_BUFFER_QUADS * 4 * sizeof(GL_BatchVert), NULL, GL_STREAM_DRAW); CHECK_GL();
+        GL_BatchBufferOffset = 0;
     }
-    if (!Matrix4x4::Equals(GLRenderer::CurrentShader->CachedModelViewMatrix, Graphics::ModelViewMatrix.top())) {
-        if (!GLRenderer::CurrentShader->CachedModelViewMatrix)
-            GLRenderer::CurrentShader->CachedModelViewMatrix = Matrix4x4::Create();
 
-        Matrix4x4::Copy(GLRenderer::CurrentShader->CachedModelViewMatrix, Graphics::ModelViewMatrix.top());
+    size_t offset = GL_BatchBufferOffset * 4 * sizeof(GL_BatchVert);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, quadCount * 4 * sizeof(GL_BatchVert), GL_BatchVertices); CHECK_GL();
+    glVertexAttribPointer(GLRenderer::CurrentShader->LocPosition, 3, GL_FLOAT, GL_FALSE, sizeof(GL_BatchVert), (char*)NULL + offset); CHECK_GL();
+    glVertexAttribPointer(GLRenderer::CurrentShader->LocTexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(GL_BatchVert), (char*)NULL + offset + 12); CHECK_GL();
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_BatchIBO); CHECK_GL();
+    glDrawElements(GL_TRIANGLES, quadCount * 6, GL_UNSIGNED_SHORT, 0); CHECK_GL();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); CHECK_GL();
 
-        glUniformMatrix4fv(GLRenderer::CurrentShader->LocModelViewMatrix, 1, false, GLRenderer::CurrentShader->CachedModelViewMatrix->Values); CHECK_GL();
+    GL_BatchBufferOffset += quadCount;
+    Graphics::CurrentShader = customShader;
+}
+bool   GL_BatchQuad(Texture* texture, float u0, float v0, float u1, float v1, float x0, float y0, float x1, float y1) {
+    // Custom shaders and YUV textures take the immediate path
+    GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
+    if (Graphics::CurrentShader || !GL_BatchVBO || textureData->YUV)
+        return false;
+
+    static float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float* color = Graphics::TextureBlend ? Graphics::BlendColors : white;
+    Matrix4x4* projection = Scene::Views[Scene::ViewCurrent].ProjectionMatrix;
+
+    if (GL_BatchQuadCount > 0 && (
+        GL_BatchQuadCount == GL_BATCH_MAX_QUADS ||
+        GL_BatchTexture != texture ||
+        memcmp(GL_BatchColor, color, sizeof(GL_BatchColor)) != 0 ||
+        !Matrix4x4::Equals(&GL_BatchProjection, projection)))
+        GL_FlushBatch();
+
+    if (GL_BatchQuadCount == 0) {
+        GL_BatchTexture = texture;
+        memcpy(GL_BatchColor, color, sizeof(GL_BatchColor));
+        Matrix4x4::Copy(&GL_BatchProjection, projection);
+    }
+
+    // Vertices are moved into view space here so that sprites with
+    //   different model-view matrices can share a draw call.
+    float* m = Graphics::ModelViewMatrix.top()->Values;
+    float xs[4] = { x0, x1, x0, x1 };
+    float ys[4] = { y0, y0, y1, y1 };
+    float us[4] = { u0, u1, u0, u1 };
+    float vs[4] = { v0, v0, v1, v1 };
+    GL_BatchVert* vert = &GL_BatchVertices[GL_BatchQuadCount * 4];
+    for (int i = 0; i < 4; i++) {
+        vert[i].x = m[0] * xs[i] + m[4] * ys[i] + m[12];
+        vert[i].y = m[1] * xs[i] + m[5] * ys[i] + m[13];
+        vert[i].z = m[2] * xs[i] + m[6] * ys[i] + m[14];
+        vert[i].u = us[i];
+        vert[i].v = vs[i];
     }
+    GL_BatchQuadCount++;
+    return true;
+}
+void   GL_Predraw(Texture* texture) {
+    GL_FlushBatch();
+    GL_SetState(texture, Scene::Views[Scene::ViewCurrent].ProjectionMatrix, Graphics::ModelViewMatrix.top(), Graphics::BlendColors);
 }
 void   GL_DrawTextureBuffered(Texture* texture, GLuint buffer, int flip) {
     GL_Predraw(texture);
 
     if (!Graphics::TextureBlend) {
-        GLRenderer::CurrentShader->CachedBlendColors[0] =
-        GLRenderer::CurrentShader->CachedBlendColors[1] =
-        GLRenderer::CurrentShader->CachedBlendColors[2] =
-        GLRenderer::CurrentShader->CachedBlendColors[3] = 1.0;
-        glUniform4f(GLRenderer::CurrentShader->LocColor, 1.0, 1.0, 1.0, 1.0); CHECK_GL();
+        float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        GL_SetColor(white);
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
@@ -296,14 +581,23 @@ void   GL_DrawTextureBuffered(Texture* texture, GLuint buffer, int flip) {
     glDrawArrays(GL_TRIANGLE_STRIP, flip << 2, 4);
 }
 void   GL_DrawTexture(Texture* texture, float sx, float sy, float sw, float sh, float x, float y, float w, float h) {
+    if (sx >= 0.0) {
+        if (GL_BatchQuad(texture,
+            (sx) / texture->Width, (sy) / texture->Height,
+            (sx + sw) / texture->Width, (sy + sh) / texture->Height,
+            x, y, x + w, y + h))
+            return;
+    }
+    else {
+        if (GL_BatchQuad(texture, 0.0f, 0.0f, 1.0f, 1.0f, x, y, x + w, y + h))
+            return;
+    }
+
     GL_Predraw(texture);
 
     if (!Graphics::TextureBlend) {
-        GLRenderer::CurrentShader->CachedBlendColors[0] =
-        GLRenderer::CurrentShader->CachedBlendColors[1] =
-        GLRenderer::CurrentShader->CachedBlendColors[2] =
-        GLRenderer::CurrentShader->CachedBlendColors[3] = 1.0;
-        glUniform4f(GLRenderer::CurrentShader->LocColor, 1.0, 1.0, 1.0, 1.0);
+        float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        GL_SetColor(white);
     }
 
     // glEnableVertexAttribArray(GLRenderer::CurrentShader->LocTexCoord);
@@ -425,6 +719,8 @@ PUBLIC STATIC void     GLRenderer::Init() {
         UseDepthTesting = false;
     }
 
+    GL_InvalidateState();
+
     // Enable/Disable GL features
     glEnable(GL_BLEND); CHECK_GL();
     if (UseDepthTesting) {
@@ -438,7 +734,7 @@ PUBLIC STATIC void     GLRenderer::Init() {
     }
     #endif
 
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); CHECK_GL();
+    GL_SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD); CHECK_GL();
     glDepthFunc(GL_LEQUAL); CHECK_GL();
 
@@ -451,9 +747,10 @@ PUBLIC STATIC void     GLRenderer::Init() {
 
     GL_MakeShaders();
     GL_MakeShapeBuffers();
+    GL_MakeBatchBuffers();
 
     UseShader(ShaderShape);
-    glEnableVertexAttribArray(GLRenderer::CurrentShader->LocPosition); CHECK_GL();
+    GL_SetAttribEnabled(GLRenderer::CurrentShader->LocPosition, true);
 
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &DefaultFramebuffer); CHECK_GL();
 }
@@ -521,6 +818,12 @@ PUBLIC STATIC void     GLRenderer::SetGraphicsFunctions() {
     Graphics::Internal.MakeFrameBufferID = GLRenderer::MakeFrameBufferID;
 }
 PUBLIC STATIC void     GLRenderer::Dispose() {
+    GL_FlushBatch();
+    glDeleteBuffers(1, &GL_BatchVBO);
+    glDeleteBuffers(1, &GL_BatchIBO);
+    GL_BatchVBO = 0;
+    GL_BatchIBO = 0;
+
     glDeleteBuffers(1, &BufferCircleFill);
     glDeleteBuffers(1, &BufferCircleStroke);
     glDeleteBuffers(1, &BufferSquareFill);
@@ -600,7 +903,7 @@ PUBLIC STATIC Texture* GLRenderer::CreateTexture(Uint32 format, Uint32 access, U
 
     // Generate texture buffer
     glGenTextures(1, &textureData->TextureID); CHECK_GL();
-    glBindTexture(textureData->TextureTarget, textureData->TextureID); CHECK_GL();
+    GL_SetTexture(0, textureData->TextureID);
 
     // Set target
     switch (textureData->TextureTarget) {
@@ -639,14 +942,14 @@ PUBLIC STATIC Texture* GLRenderer::CreateTexture(Uint32 format, Uint32 access, U
         glGenTextures(1, &textureData->TextureU); CHECK_GL();
         glGenTextures(1, &textureData->TextureV); CHECK_GL();
 
-        glBindTexture(textureData->TextureTarget, textureData->TextureU); CHECK_GL();
+        GL_SetTexture(0, textureData->TextureU);
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_MAG_FILTER, textureFilter); CHECK_GL();
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_MIN_FILTER, textureFilter); CHECK_GL();
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); CHECK_GL();
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); CHECK_GL();
         glTexImage2D(textureData->TextureTarget, 0, textureData->TextureStorageFormat, (width + 1) / 2, (height + 1) / 2, 0, textureData->PixelDataFormat, textureData->PixelDataType, NULL); CHECK_GL();
 
-        glBindTexture(textureData->TextureTarget, textureData->TextureV); CHECK_GL();
+        GL_SetTexture(0, textureData->TextureV);
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_MAG_FILTER, textureFilter); CHECK_GL();
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_MIN_FILTER, textureFilter); CHECK_GL();
         glTexParameteri(textureData->TextureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); CHECK_GL();
@@ -654,7 +957,7 @@ PUBLIC STATIC Texture* GLRenderer::CreateTexture(Uint32 format, Uint32 access, U
         glTexImage2D(textureData->TextureTarget, 0, textureData->TextureStorageFormat, (width + 1) / 2, (height + 1) / 2, 0, textureData->PixelDataFormat, textureData->PixelDataType, NULL); CHECK_GL();
     }
 
-    glBindTexture(textureData->TextureTarget, 0); CHECK_GL();
+    GL_SetTexture(0, 0);
 
     texture->ID = textureData->TextureID;
     Graphics::TextureMap->Put(texture->ID, texture);
@@ -665,6 +968,7 @@ PUBLIC STATIC int      GLRenderer::LockTexture(Texture* texture, void** pixels,
     return 0;
 }
 PUBLIC STATIC int      GLRenderer::UpdateTexture(Texture* texture, SDL_Rect* src, void* pixels, int pitch) {
+    GL_FlushBatch();
     int inputPixelsX = 0;
     int inputPixelsY = 0;
     int inputPixelsW = texture->Width;
@@ -682,13 +986,14 @@ PUBLIC STATIC int      GLRenderer::UpdateTexture(Texture* texture, SDL_Rect* src
     textureData->PixelDataFormat = GL_RGBA;
     textureData->PixelDataType = GL_UNSIGNED_BYTE;
 
-    glBindTexture(textureData->TextureTarget, textureData->TextureID); CHECK_GL();
+    GL_SetTexture(0, textureData->TextureID);
     glTexSubImage2D(textureData->TextureTarget, 0,
         inputPixelsX, inputPixelsY, inputPixelsW, inputPixelsH,
         textureData->PixelDataFormat, textureData->PixelDataType, pixels); CHECK_GL();
     return 0;
 }
 PUBLIC STATIC int      GLRenderer::UpdateTextureYUV(Texture* texture, SDL_Rect* src, void* pixelsY, int pitchY, void* pixelsU, int pitchU, void* pixelsV, int pitchV) {
+    GL_FlushBatch();
     int inputPixelsX = 0;
     int inputPixelsY = 0;
     int inputPixelsW = texture->Width;
@@ -702,7 +1007,7 @@ PUBLIC STATIC int      GLRenderer::UpdateTextureYUV(Texture* texture, SDL_Rect*
 
     GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
 
-    glBindTexture(textureData->TextureTarget, textureData->TextureID); CHECK_GL();
+    GL_SetTexture(0, textureData->TextureID);
     glTexSubImage2D(textureData->TextureTarget, 0,
         inputPixelsX, inputPixelsY, inputPixelsW, inputPixelsH,
         textureData->PixelDataFormat, textureData->PixelDataType, pixelsY); CHECK_GL();
@@ -712,13 +1017,13 @@ PUBLIC STATIC int      GLRenderer::UpdateTextureYUV(Texture* texture, SDL_Rect*
     inputPixelsW = (inputPixelsW + 1) / 2;
     inputPixelsH = (inputPixelsH + 1) / 2;
 
-    glBindTexture(textureData->TextureTarget, texture->Format != SDL_PIXELFORMAT_YV12 ? textureData->TextureV : textureData->TextureU);
+    GL_SetTexture(0, texture->Format != SDL_PIXELFORMAT_YV12 ? textureData->TextureV : textureData->TextureU);
 
     glTexSubImage2D(textureData->TextureTarget, 0,
         inputPixelsX, inputPixelsY, inputPixelsW, inputPixelsH,
         textureData->PixelDataFormat, textureData->PixelDataType, pixelsU);
 
-    glBindTexture(textureData->TextureTarget, texture->Format != SDL_PIXELFORMAT_YV12 ? textureData->TextureU : textureData->TextureV);
+    GL_SetTexture(0, texture->Format != SDL_PIXELFORMAT_YV12 ? textureData->TextureU : textureData->TextureV);
 
     glTexSubImage2D(textureData->TextureTarget, 0,
         inputPixelsX, inputPixelsY, inputPixelsW, inputPixelsH,
@@ -729,6 +1034,7 @@ PUBLIC STATIC void     GLRenderer::UnlockTexture(Texture* texture) {
 
 }
 PUBLIC STATIC void     GLRenderer::DisposeTexture(Texture* texture) {
+    GL_FlushBatch();
     GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
     if (texture->Access == SDL_TEXTUREACCESS_TARGET) {
         glDeleteFramebuffers(1, &textureData->FBO); CHECK_GL();
@@ -742,13 +1048,17 @@ PUBLIC STATIC void     GLRenderer::DisposeTexture(Texture* texture) {
     if (textureData->YUV) {
         glDeleteTextures(1, &textureData->TextureU); CHECK_GL();
         glDeleteTextures(1, &textureData->TextureV); CHECK_GL();
+        GL_ForgetTexture(textureData->TextureU);
+        GL_ForgetTexture(textureData->TextureV);
     }
     glDeleteTextures(1, &textureData->TextureID); CHECK_GL();
+    GL_ForgetTexture(textureData->TextureID);
     Memory::Free(texture->DriverData);
 }
 
 // Viewport and view-related functions
 PUBLIC STATIC void     GLRenderer::SetRenderTarget(Texture* texture) {
+    GL_FlushBatch();
     if (texture == NULL) {
         glBindFramebuffer(GL_FRAMEBUFFER, DefaultFramebuffer); CHECK_GL();
 
@@ -781,13 +1091,14 @@ PUBLIC STATIC void     GLRenderer::UpdateWindowSize(int width, int height) {
     GLRenderer::UpdateViewport();
 }
 PUBLIC STATIC void     GLRenderer::UpdateViewport() {
+    GL_FlushBatch();
     Viewport* vp = &Graphics::CurrentViewport;
     if (Graphics::CurrentRenderTarget) {
-        glViewport(vp->X * RetinaScale, vp->Y * RetinaScale, vp->Width * RetinaScale, vp->Height * RetinaScale); CHECK_GL();
+        GL_SetViewport(vp->X * RetinaScale, vp->Y * RetinaScale, vp->Width * RetinaScale, vp->Height * RetinaScale);
     }
     else {
         int h; SDL_GetWindowSize(Application::Window, NULL, &h);
-        glViewport(vp->X * RetinaScale, (h - vp->Y - vp->Height) * RetinaScale, vp->Width * RetinaScale, vp->Height * RetinaScale); CHECK_GL();
+        GL_SetViewport(vp->X * RetinaScale, (h - vp->Y - vp->Height) * RetinaScale, vp->Width * RetinaScale, vp->Height * RetinaScale);
     }
 
     // NOTE: According to SDL2 we should be setting projection matrix here.
@@ -795,13 +1106,14 @@ PUBLIC STATIC void     GLRenderer::UpdateViewport() {
     GLRenderer::UpdateProjectionMatrix();
 }
 PUBLIC STATIC void     GLRenderer::UpdateClipRect() {
+    GL_FlushBatch();
     ClipArea clip = Graphics::CurrentClip;
     if (Graphics::CurrentClip.Enabled) {
         Viewport view = Graphics::CurrentViewport;
 
-        glEnable(GL_SCISSOR_TEST); CHECK_GL();
+        GL_SetScissorEnabled(true);
         if (Graphics::CurrentRenderTarget) {
-            glScissor((view.X + clip.X) * RetinaScale, (view.Y + clip.Y) * RetinaScale, (clip.Width) * RetinaScale, (clip.Height) * RetinaScale); CHECK_GL();
+            GL_SetScissor((view.X + clip.X) * RetinaScale, (view.Y + clip.Y) * RetinaScale, (clip.Width) * RetinaScale, (clip.Height) * RetinaScale);
         }
         else {
             int w, h;
@@ -812,11 +1124,11 @@ PUBLIC STATIC void     GLRenderer::UpdateClipRect() {
             scaleW *= w / currentView->Width;
             scaleH *= h / currentView->Height;
 
-            glScissor((view.X + clip.X) * scaleW, h * RetinaScale - (view.Y + clip.Y + clip.Height) * scaleH, (clip.Width) * scaleW, (clip.Height) * scaleH); CHECK_GL();
+            GL_SetScissor((view.X + clip.X) * scaleW, h * RetinaScale - (view.Y + clip.Y + clip.Height) * scaleH, (clip.Width) * scaleW, (clip.Height) * scaleH);
         }
     }
     else {
-        glDisable(GL_SCISSOR_TEST); CHECK_GL();
+        GL_SetScissorEnabled(false);
     }
 }
 PUBLIC STATIC void     GLRenderer::UpdateOrtho(float left, float top, float right, float bottom) {
@@ -837,20 +1149,25 @@ PUBLIC STATIC void     GLRenderer::UpdateProjectionMatrix() {
 
 // Shader-related functions
 PUBLIC STATIC void     GLRenderer::UseShader(void* shader) {
+    GL_FlushBatch();
+
     // Override shader
     if (Graphics::CurrentShader)
         shader = Graphics::CurrentShader;
 
     if (GLRenderer::CurrentShader != (GLShader*)shader) {
         GLRenderer::CurrentShader = (GLShader*)shader;
-        GLRenderer::CurrentShader->Use();
+        GL_SetProgram(GLRenderer::CurrentShader->ProgramID);
         // glEnableVertexAttribArray(CurrentShader->LocTexCoord);
 
-        glActiveTexture(GL_TEXTURE0); CHECK_GL();
-        glUniform1i(GLRenderer::CurrentShader->LocTexture, 0); CHECK_GL();
+        GL_SetSamplerUniform(GLRenderer::CurrentShader->LocTexture, &GLRenderer::CurrentShader->CachedTextureUnits[0], 0);
+    }
+    else {
+        GL_State.CallsSkipped++;
     }
 }
 PUBLIC STATIC void     GLRenderer::SetUniformF(int location, int count, float* values) {
+    GL_FlushBatch();
     switch (count) {
         case 1: glUniform1f(location, values[0]); CHECK_GL(); break;
         case 2: glUniform2f(location, values[0], values[1]); CHECK_GL(); break;
@@ -859,17 +1176,21 @@ PUBLIC STATIC void     GLRenderer::SetUniformF(int location, int count, float* v
     }
 }
 PUBLIC STATIC void     GLRenderer::SetUniformI(int location, int count, int* values) {
+    GL_FlushBatch();
+    GL_ForgetSamplerUniform(location);
     glUniform1iv(location, count, values); CHECK_GL();
 }
 PUBLIC STATIC void     GLRenderer::SetUniformTexture(Texture* texture, int uniform_index, int slot) {
+    GL_FlushBatch();
     GL_TextureData* textureData = (GL_TextureData*)texture->DriverData;
-    glActiveTexture(GL_TEXTURE0 + slot); CHECK_GL();
+    GL_ForgetSamplerUniform(uniform_index);
     glUniform1i(uniform_index, slot); CHECK_GL();
-    glBindTexture(GL_TEXTURE_2D, textureData->TextureID); CHECK_GL();
+    GL_SetTexture(slot, textureData->TextureID);
 }
 
 // These guys
 PUBLIC STATIC void     GLRenderer::Clear() {
+    GL_FlushBatch();
     glClearColor(0.0, 0.0, 0.0, 0.0); CHECK_GL();
     if (UseDepthTesting) {
         #ifdef GL_ES
@@ -884,7 +1205,21 @@ PUBLIC STATIC void     GLRenderer::Clear() {
     }
 }
 PUBLIC STATIC void     GLRenderer::Present() {
+    GL_FlushBatch();
     SDL_GL_SwapWindow(Application::Window);
+
+    // Start the next frame in fresh buffer storage
+    GL_BatchBufferOffset = GL_BATCH_BUFFER_QUADS;
+}
+PUBLIC STATIC void     GLRenderer::GetStateCacheCounters(Uint32* issued, Uint32* skipped) {
+    if (issued)
+        *issued = GL_State.CallsIssued;
+    if (skipped)
+        *skipped = GL_State.CallsSkipped;
+}
+PUBLIC STATIC void     GLRenderer::ResetStateCacheCounters() {
+    GL_State.CallsIssued = 0;
+    GL_State.CallsSkipped = 0;
 }
 
 // Draw mode setting functions
@@ -892,9 +1227,10 @@ PUBLIC STATIC void     GLRenderer::SetBlendColor(float r, float g, float b, floa
 
 }
 PUBLIC STATIC void     GLRenderer::SetBlendMode(int srcC, int dstC, int srcA, int dstA) {
-    glBlendFuncSeparate(
+    GL_FlushBatch();
+    GL_SetBlendFunc(
         GL_GetBlendFactorFromHatchEnum(srcC), GL_GetBlendFactorFromHatchEnum(dstC),
-        GL_GetBlendFactorFromHatchEnum(srcA), GL_GetBlendFactorFromHatchEnum(dstA)); CHECK_GL();
+        GL_GetBlendFactorFromHatchEnum(srcA), GL_GetBlendFactorFromHatchEnum(dstA));
 }
 PUBLIC STATIC void     GLRenderer::SetLineWidth(float n) {
     glLineWidth(n); CHECK_GL();
@@ -1051,6 +1387,13 @@ PUBLIC STATIC Uint32   GLRenderer::CreateTexturedShapeBuffer(float* data, int ve
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexCount * 5, data, GL_STATIC_DRAW);
     return bufferID;
 }
+PUBLIC STATIC void     GLRenderer::UpdateTexturedShapeBuffer(Uint32 bufferID, float* data, int vertexCount) {
+    glBindBuffer(GL_ARRAY_BUFFER, bufferID); CHECK_GL();
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexCount * 5, data, GL_STATIC_DRAW); CHECK_GL();
+}
+PUBLIC STATIC void     GLRenderer::DisposeTexturedShapeBuffer(Uint32 bufferID) {
+    glDeleteBuffers(1, &bufferID); CHECK_GL();
+}
 PUBLIC STATIC void     GLRenderer::DrawTexturedShapeBuffer(Texture* texture, Uint32 bufferID, int vertexCount) {
     GL_Predraw(texture);
 
@@ -1071,24 +1414,24 @@ PUBLIC STATIC void     GLRenderer::DrawTexture(Texture* texture, float sx, float
 PUBLIC STATIC void     GLRenderer::DrawSprite(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY) {
     if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
 
-    // /*
     AnimFrame animframe = sprite->Animations[animation].Frames[frame];
+    Texture* texture = sprite->Spritesheets[animframe.SheetNumber];
+    float fX = flipX ? -1.0 : 1.0;
+    float fY = flipY ? -1.0 : 1.0;
+    float x0 = x + fX * animframe.OffsetX;
+    float y0 = y + fY * animframe.OffsetY;
+    float x1 = x + fX * (animframe.OffsetX + animframe.Width);
+    float y1 = y + fY * (animframe.OffsetY + animframe.Height);
+    if (GL_BatchQuad(texture,
+        animframe.X / (float)texture->Width, animframe.Y / (float)texture->Height,
+        (animframe.X + animframe.Width) / (float)texture->Width, (animframe.Y + animframe.Height) / (float)texture->Height,
+        x0, y0, x1, y1))
+        return;
+
     Graphics::Save();
         Graphics::Translate(x, y, 0.0f);
-        GL_DrawTextureBuffered(sprite->Spritesheets[animframe.SheetNumber], animframe.ID, ((int)flipY << 1) | (int)flipX);
+        GL_DrawTextureBuffered(texture, animframe.ID, ((int)flipY << 1) | (int)flipX);
     Graphics::Restore();
-    //*/
-
-    // AnimFrame animframe = sprite->Animations[animation].Frames[frame];
-    // float fX = flipX ? -1.0 : 1.0;
-    // float fY = flipY ? -1.0 : 1.0;
-    // float sw  = animframe.Width;
-    // float sh  = animframe.Height;
-    //
-    // GLRenderer::DrawTexture(sprite->Spritesheets[animframe.SheetNumber],
-    //     animframe.X, animframe.Y, sw, sh,
-    //     x + fX * animframe.OffsetX,
-    //     y + fY * animframe.OffsetY, fX * sw, fY * sh);
 }
 PUBLIC STATIC void     GLRenderer::DrawSpritePart(ISprite* sprite, int animation, int frame, int sx, int sy, int sw, int sh, int x, int y, bool flipX, bool flipY) {
     if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
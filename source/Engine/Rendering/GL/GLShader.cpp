@@ -26,6 +26,7 @@ public:
     float      CachedBlendColors[4];
     Matrix4x4* CachedProjectionMatrix = NULL;
     Matrix4x4* CachedModelViewMatrix = NULL;
+    int        CachedTextureUnits[3];
 };
 #endif
 
@@ -157,6 +158,7 @@ PRIVATE void  GLShader::AttachAndLink() {
     // printf("\n");
 
     CachedBlendColors[0] = CachedBlendColors[1] = CachedBlendColors[2] = CachedBlendColors[3] = 0.0;
+    CachedTextureUnits[0] = CachedTextureUnits[1] = CachedTextureUnits[2] = -1;
 }
 
 
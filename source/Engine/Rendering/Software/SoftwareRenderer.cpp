@@ -2,1449 +2,1115 @@
 #include <Engine/Includes/Standard.h>
 #include <Engine/Includes/StandardSDL2.h>
 #include <Engine/ResourceTypes/ISprite.h>
-#include <Engine/ResourceTypes/IModel.h>
 #include <Engine/Math/Matrix4x4.h>
-#include <Engine/Rendering/GL/GLShader.h>
 #include <Engine/Rendering/Texture.h>
 #include <Engine/Includes/HashMap.h>
 
 class SoftwareRenderer {
 public:
-    static GraphicsFunctions  BackendFunctions;
+    static Uint32*            FrameBuffer;
+    static int                FrameBufferWidth;
+    static int                FrameBufferHeight;
 };
 #endif
 
 #include <Engine/Rendering/Software/SoftwareRenderer.h>
 
+#include <Engine/Application.h>
+#include <Engine/Graphics.h>
+#include <Engine/Scene.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Diagnostics/Memory.h>
-#include <Engine/IO/ResourceStream.h>
-
-GraphicsFunctions  SoftwareRenderer::BackendFunctions;
-// // Framebuffer-related variables
-// Uint32*       SoftwareRenderer::FrameBuffer = NULL;
-// int           SoftwareRenderer::FrameBufferSize = 0;
-// int           SoftwareRenderer::FrameBufferStride = 0;
-// SDL_Surface*  SoftwareRenderer::FrameBufferSurface = NULL;
-// void*         SoftwareRenderer::FrameBufferSurfaceOriginalPixels = NULL;
-// // Pixel coloring variables
-// uint8_t       SoftwareRenderer::Fade = 0;
-// bool          SoftwareRenderer::FadeToWhite = false;
-// int           SoftwareRenderer::WaterPaletteStartLine = 0xFFFF;
-// int           SoftwareRenderer::DivideBy3Table[0x100];
-// // Pixel positioning variables
-// int           SoftwareRenderer::Clip[4];
-// bool          SoftwareRenderer::ClipSet = false;
-// Sint8*        SoftwareRenderer::Deform = NULL;
-// bool          SoftwareRenderer::DoDeform = false;
-// // Draw mode variables
-// int           SoftwareRenderer::DrawAlpha = 0xFF;
-// int           SoftwareRenderer::DrawModeOverlay = false;
-// int           SoftwareRenderer::DrawPixelFilter = 0;
-// void          (*SoftwareRenderer::PixelFunction)(int, int, Uint32) = NULL;
-// Uint32        (*SoftwareRenderer::FilterFunction[4])(Uint32);
-// // Other variables
-// Uint8         SoftwareRenderer::BitmapFont[128][8];
-
-int DivideBy3Table[0x100];
-
-struct SWTextureData {
-	Uint32*           Palette = NULL;
-	int               PaletteSize = 0;
-	int               PaletteCount = 0;
-	int               TransparentColorIndex = 0;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SW_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define SW_USE_NEON
+#endif
+
+// NOTE: All pixels are ARGB8888 (0xAARRGGBB). Every blend below
+//   works on the four channels of a pixel with the same formulas
+//   in the scalar and SIMD paths, so both produce identical
+//   output and rendering tests can compare frames across hosts.
+
+#define SW_SPAN_CHUNK 256
+#define SW_MAX_TEXTURE_SIZE 16384
+
+#define SW_MAX_THREADS 16
+#define SW_BAND_HEIGHT 32
+
+Uint32*            SoftwareRenderer::FrameBuffer = NULL;
+int                SoftwareRenderer::FrameBufferWidth = 0;
+int                SoftwareRenderer::FrameBufferHeight = 0;
+
+struct SW_TextureData {
+    Uint32* Palette;
+    int     PaletteCount;
+    int     TransparentColorIndex;
+};
+struct SW_Surface {
+    Uint32* Pixels;
+    int     Width;
+    int     Height;
+    int     Stride;
 };
 
-inline Uint32 ColorAdd(Uint32 color1, Uint32 color2, int percent) {
-	Uint32 r = (color1 & 0xFF0000U) + (((color2 & 0xFF0000U) * percent) >> 8);
-	Uint32 g = (color1 & 0xFF00U) + (((color2 & 0xFF00U) * percent) >> 8);
-	Uint32 b = (color1 & 0xFFU) + (((color2 & 0xFFU) * percent) >> 8);
-    if (r > 0xFF0000U) r = 0xFF0000U;
-	if (g > 0xFF00U) g = 0xFF00U;
-	if (b > 0xFFU) b = 0xFFU;
-	return r | g | b;
-}
-inline Uint32 ColorBlend(Uint32 color1, Uint32 color2, int percent) {
-	Uint32 rb = color1 & 0xFF00FFU;
-	Uint32 g  = color1 & 0x00FF00U;
-	rb += (((color2 & 0xFF00FFU) - rb) * percent) >> 8;
-	g  += (((color2 & 0x00FF00U) - g) * percent) >> 8;
-	return (rb & 0xFF00FFU) | (g & 0x00FF00U);
-}
-inline Uint32 ColorSubtract(Uint32 color1, Uint32 color2, int percent) {
-    Sint32 r = (color1 & 0xFF0000U) - (((color2 & 0xFF0000U) * percent) >> 8);
-	Sint32 g = (color1 & 0xFF00U) - (((color2 & 0xFF00U) * percent) >> 8);
-	Sint32 b = (color1 & 0xFFU) - (((color2 & 0xFFU) * percent) >> 8);
-    if (r < 0) r = 0;
-	if (g < 0) g = 0;
-	if (b < 0) b = 0;
-	return r | g | b;
-}
-
-inline Uint32 FilterNone(Uint32 pixel) {
-	return pixel;
+SW_Surface         SW_Target;
+int                SW_Clip[4];
+int                SW_BlendMode = BlendMode_NORMAL;
+int                SW_Filter = 0;
+float              SW_LineWidth = 1.0f;
+Uint32             SW_NextTextureID = 1;
+float              SW_Transform[16];
+
+// Scalar pixel operations
+inline Uint32 SW_Mul255(Uint32 a, Uint32 b) {
+    return (a * b + 255) >> 8;
+}
+inline Uint32 ColorModulate(Uint32 pixel, Uint32 color) {
+    return
+        SW_Mul255(pixel >> 24, color >> 24) << 24 |
+        SW_Mul255(pixel >> 16 & 0xFF, color >> 16 & 0xFF) << 16 |
+        SW_Mul255(pixel >> 8 & 0xFF, color >> 8 & 0xFF) << 8 |
+        SW_Mul255(pixel & 0xFF, color & 0xFF);
+}
+inline Uint32 ColorBlend(Uint32 dst, Uint32 src) {
+    Uint32 a = src >> 24, ia = 255 - a, out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        Uint32 s = src >> shift & 0xFF;
+        Uint32 d = dst >> shift & 0xFF;
+        out |= ((s * a + d * ia + 255) >> 8) << shift;
+    }
+    return out;
+}
+inline Uint32 ColorAdd(Uint32 dst, Uint32 src) {
+    Uint32 a = src >> 24, out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        Uint32 c = (dst >> shift & 0xFF) + SW_Mul255(src >> shift & 0xFF, a);
+        if (c > 0xFF) c = 0xFF;
+        out |= c << shift;
+    }
+    return out;
+}
+inline Uint32 ColorMax(Uint32 dst, Uint32 src) {
+    Uint32 a = src >> 24, out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        Uint32 s = src >> shift & 0xFF;
+        Uint32 c = SW_Mul255(s, a) + SW_Mul255(dst >> shift & 0xFF, 255 - s);
+        if (c > 0xFF) c = 0xFF;
+        out |= c << shift;
+    }
+    return out;
+}
+// Matches the GL factors for BlendMode_SUBTRACT (ZERO, INV_SRC_COLOR),
+// so color is dst * (1 - src) and alpha is blended normally.
+inline Uint32 ColorSubtract(Uint32 dst, Uint32 src) {
+    Uint32 out = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+        out |= SW_Mul255(dst >> shift & 0xFF, 255 - (src >> shift & 0xFF)) << shift;
+    return out | (ColorBlend(dst, src) & 0xFF000000U);
+}
+inline Uint32 ColorBlendMode(Uint32 dst, Uint32 src, int mode) {
+    switch (mode) {
+        case BlendMode_ADD:      return ColorAdd(dst, src);
+        case BlendMode_MAX:      return ColorMax(dst, src);
+        case BlendMode_SUBTRACT: return ColorSubtract(dst, src);
+    }
+    return ColorBlend(dst, src);
 }
+
 inline Uint32 FilterGrayscale(Uint32 pixel) {
-	pixel = (
-		DivideBy3Table[((pixel >> 16) & 0xFF)] +
-		DivideBy3Table[((pixel >> 8) & 0xFF)] +
-		DivideBy3Table[(pixel & 0xFF)]) & 0xFF;
-	pixel = pixel << 16 | pixel << 8 | pixel;
-	return pixel;
-}
-inline Uint32 FilterInversionRadius(Uint32 pixel) {
-	// if ((x - 200) * (x - 200) + (y - Application::HEIGHT / 2) * (y - Application::HEIGHT / 2) < invertRadius * invertRadius)
-	//     pixel = pixel ^ 0xFFFFFF;
-	return pixel;
-}
-
-inline void   SetPixelNormal(int x, int y, Uint32 pixel) {
-	// *(SoftwareRenderer::FrameBuffer + y * SoftwareRenderer::FrameBufferStride + x) = pixel;
-}
-inline void   SetPixelAlpha(int x, int y, Uint32 pixel) {
-	// *(SoftwareRenderer::FrameBuffer + y * SoftwareRenderer::FrameBufferStride + x) = ColorBlend(*(SoftwareRenderer::FrameBuffer + y * SoftwareRenderer::FrameBufferStride + x), pixel, SoftwareRenderer::DrawAlpha);
-}
-inline void   SetPixelAdditive(int x, int y, Uint32 pixel) {
-	// *(SoftwareRenderer::FrameBuffer + y * SoftwareRenderer::FrameBufferStride + x) = ColorAdd(*(SoftwareRenderer::FrameBuffer + y * SoftwareRenderer::FrameBufferStride + x), pixel, SoftwareRenderer::DrawAlpha);
-}
-
-inline void SetPixel(int x, int y, Uint32 color) {
-	// if (DoDeform) x += Deform[y];
-
-	// if (x <  Clip[0]) return;
-	// if (y <  Clip[1]) return;
-	// if (x >= Clip[2]) return;
-	// if (y >= Clip[3]) return;
-
-	// SetPixelFunction(x, y, GetPixelOutputColor(color));
-	// SetPixelFunction(x, y, color);
-}
-
-inline Uint32 GetPixelOutputColor(Uint32 color) {
-	// color = (this->*SetFilterFunction[0])(color);
-	// color = (this->*SetFilterFunction[1])(color);
-	// color = (this->*SetFilterFunction[2])(color);
-	// color = (this->*SetFilterFunction[3])(color);
-
-	return color;
-}
-
-bool SaveScreenshot(const char* filename) {
-    /*
-	Uint32* palette = (Uint32*)Memory::Calloc(256, sizeof(Uint32));
-	Uint32* pixelChecked = (Uint32*)Memory::Calloc(FrameBufferSize, sizeof(Uint32));
-	Uint32* pixelIndexes = (Uint32*)Memory::Calloc(FrameBufferSize, sizeof(Uint32));
-	Uint32  paletteCount = 0;
-	for (int checking = 0; checking < FrameBufferSize; checking++) {
-		if (!pixelChecked[checking]) {
-			Uint32 color = FrameBuffer[checking] & 0xFFFFFF;
-			for (int comparing = checking; comparing < FrameBufferSize; comparing++) {
-				if (color == (FrameBuffer[comparing] & 0xFFFFFF)) {
-					pixelIndexes[comparing] = paletteCount;
-					pixelChecked[comparing] = 1;
-				}
-			}
-			if (paletteCount == 255) {
-				Memory::Free(palette);
-				Memory::Free(pixelChecked);
-				Memory::Free(pixelIndexes);
-				Log::Print(Log::LOG_ERROR, "Too many colors!");
-				return false;
-			}
-			palette[paletteCount++] = color;
-		}
-	}
-
-	char filenameStr[100];
-	time_t now; time(&now);
-	struct tm* local = localtime(&now);
-	sprintf(filenameStr, "ImpostorEngine3_%02d-%02d-%02d_%02d-%02d-%02d.gif", local->tm_mday, local->tm_mon + 1, local->tm_year - 100, local->tm_hour, local->tm_min, local->tm_sec);
-
-	GIF* gif = new GIF;
-	gif->Colors = palette;
-    gif->Data = pixelIndexes;
-    gif->Width = Application::WIDTH;
-    gif->Height = Application::HEIGHT;
-    gif->TransparentColorIndex = 0xFF;
-	if (!gif->Save(filenameStr)) {
-		gif->Data = NULL;
-		delete gif;
-		Memory::Free(palette);
-		Memory::Free(pixelChecked);
-		Memory::Free(pixelIndexes);
-		return false;
-	}
-	gif->Data = NULL;
-	delete gif;
-	Memory::Free(palette);
-	Memory::Free(pixelChecked);
-	Memory::Free(pixelIndexes);
-
-    */
-
-	return true;
-}
-
-PUBLIC STATIC inline Uint32 SoftwareRenderer::GetPixelIndex(ISprite* sprite, int x, int y) {
-	// return sprite->Data[x + y * sprite->Width];
-	return 0;
-}
-
-// Rendering functions
-PUBLIC STATIC void    SoftwareRenderer::SetDrawAlpha(int a) {
-	// DrawAlpha = a;
-    //
-	// if (SetPixelFunction != &SoftwareRenderer::SetPixelNormal && SetPixelFunction != &SoftwareRenderer::SetPixelAlpha) return;
-    //
-	// if (DrawAlpha == 0xFF)
-	// 	SetPixelFunction = &SoftwareRenderer::SetPixelNormal;
-	// else
-	// 	SetPixelFunction = &SoftwareRenderer::SetPixelAlpha;
-}
-PUBLIC STATIC void    SoftwareRenderer::SetDrawFunc(int a) {
-	// switch (a) {
-	// 	case 1:
-	// 		SetPixelFunction = &SoftwareRenderer::SetPixelAdditive;
-	// 		break;
-	// 	default:
-	// 		SetPixelFunction = &SoftwareRenderer::SetPixelNormal;
-	// 		SetDrawAlpha(DrawAlpha);
-	// 		break;
-	// }
-}
-
-PUBLIC STATIC void    SoftwareRenderer::SetFade(int fade) {
-	// if (fade < 0)
-	// 	Fade = 0x00;
-	// else if (fade > 0xFF)
-	// 	Fade = 0xFF;
-	// else
-	// 	Fade = fade;
-}
-PUBLIC STATIC void    SoftwareRenderer::SetFilter(int filter) {
-	// DrawPixelFilter = filter;
-    //
-	// SetFilterFunction[0] = &SoftwareRenderer::FilterNone;
-	// // SetFilterFunction[1] = &SoftwareRenderer::FilterNone;
-	// // SetFilterFunction[2] = &SoftwareRenderer::FilterNone;
-	// SetFilterFunction[3] = &SoftwareRenderer::FilterNone;
-	// if ((DrawPixelFilter & 0x1) == 0x1)
-	// 	SetFilterFunction[0] = &SoftwareRenderer::FilterGrayscale;
-	// if ((DrawPixelFilter & 0x4) == 0x4)
-	// 	SetFilterFunction[3] = &SoftwareRenderer::FilterFadeToBlack;
-}
-PUBLIC STATIC int     SoftwareRenderer::GetFilter() {
-	// return DrawPixelFilter;
-    return 0;
+    Uint32 gray = (((pixel >> 16 & 0xFF) + (pixel >> 8 & 0xFF) + (pixel & 0xFF)) * 85) >> 8;
+    return (pixel & 0xFF000000U) | gray << 16 | gray << 8 | gray;
+}
+
+// Scanline kernels
+#if defined(SW_USE_SSE2)
+inline __m128i SW_Mul255x8(__m128i a, __m128i b) {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(255)), 8);
+}
+inline __m128i SW_BlendHalf(__m128i s, __m128i d, __m128i c, int mode, bool modulate, __m128i* t) {
+    __m128i v255 = _mm_set1_epi16(255);
+    if (modulate)
+        s = SW_Mul255x8(s, c);
+
+    __m128i a = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+            a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+
+    switch (mode) {
+        case BlendMode_ADD:
+            *t = SW_Mul255x8(s, a);
+            break;
+        case BlendMode_SUBTRACT:
+            *t = SW_Mul255x8(d, _mm_sub_epi16(v255, s));
+            break;
+        case BlendMode_MAX:
+            *t = _mm_add_epi16(SW_Mul255x8(s, a), SW_Mul255x8(d, _mm_sub_epi16(v255, s)));
+            break;
+    }
+
+    // Normal blend, also needed for the alpha of subtract
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(s, a),
+        _mm_mullo_epi16(d, _mm_sub_epi16(v255, a))), v255), 8);
+}
+inline __m128i SW_Blend4(__m128i src, __m128i dst, __m128i c, int mode, bool modulate) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i tLo = zero, tHi = zero;
+    __m128i nLo = SW_BlendHalf(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), c, mode, modulate, &tLo);
+    __m128i nHi = SW_BlendHalf(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), c, mode, modulate, &tHi);
+    __m128i normal = _mm_packus_epi16(nLo, nHi);
+    switch (mode) {
+        case BlendMode_ADD:
+            return _mm_adds_epu8(dst, _mm_packus_epi16(tLo, tHi));
+        case BlendMode_MAX:
+            return _mm_packus_epi16(tLo, tHi);
+        case BlendMode_SUBTRACT: {
+            __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+            __m128i sub = _mm_packus_epi16(tLo, tHi);
+            return _mm_or_si128(_mm_andnot_si128(alphaMask, sub), _mm_and_si128(alphaMask, normal));
+        }
+    }
+    return normal;
+}
+#elif defined(SW_USE_NEON)
+inline uint8x8_t SW_Mul255x8(uint8x8_t a, uint8x8_t b) {
+    return vshrn_n_u16(vaddq_u16(vmull_u8(a, b), vdupq_n_u16(255)), 8);
+}
+inline uint8x16_t SW_Blend4(uint8x16_t src, uint8x16_t dst, uint8x16_t c, int mode, bool modulate) {
+    if (modulate)
+        src = vcombine_u8(
+            SW_Mul255x8(vget_low_u8(src), vget_low_u8(c)),
+            SW_Mul255x8(vget_high_u8(src), vget_high_u8(c)));
+
+    // Broadcast each pixel's alpha into all four of its channels
+    uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(vshrq_n_u32(vreinterpretq_u32_u8(src), 24), 0x01010101U));
+    uint8x16_t ia = vmvnq_u8(a);
+
+    uint8x16_t normal = vcombine_u8(
+        vshrn_n_u16(vaddq_u16(vmlal_u8(vmull_u8(vget_low_u8(src), vget_low_u8(a)), vget_low_u8(dst), vget_low_u8(ia)), vdupq_n_u16(255)), 8),
+        vshrn_n_u16(vaddq_u16(vmlal_u8(vmull_u8(vget_high_u8(src), vget_high_u8(a)), vget_high_u8(dst), vget_high_u8(ia)), vdupq_n_u16(255)), 8));
+    if (mode == BlendMode_NORMAL)
+        return normal;
+
+    uint8x16_t t = vcombine_u8(
+        SW_Mul255x8(vget_low_u8(src), vget_low_u8(a)),
+        SW_Mul255x8(vget_high_u8(src), vget_high_u8(a)));
+    switch (mode) {
+        case BlendMode_ADD:
+            return vqaddq_u8(dst, t);
+        case BlendMode_MAX: {
+            uint8x16_t is = vmvnq_u8(src);
+            uint8x16_t m = vcombine_u8(
+                SW_Mul255x8(vget_low_u8(dst), vget_low_u8(is)),
+                SW_Mul255x8(vget_high_u8(dst), vget_high_u8(is)));
+            return vqaddq_u8(t, m);
+        }
+        case BlendMode_SUBTRACT: {
+            uint8x16_t is = vmvnq_u8(src);
+            uint8x16_t sub = vcombine_u8(
+                SW_Mul255x8(vget_low_u8(dst), vget_low_u8(is)),
+                SW_Mul255x8(vget_high_u8(dst), vget_high_u8(is)));
+            uint8x16_t alphaMask = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000U));
+            return vbslq_u8(alphaMask, normal, sub);
+        }
+    }
+    return normal;
 }
+#endif
 
-// Utility functions
-PUBLIC STATIC bool    SoftwareRenderer::IsOnScreen(int x, int y, int w, int h) {
-	// return (
-	// 	x + w >= Clip[0] &&
-	// 	y + h >= Clip[1] &&
-	// 	x     <  Clip[2] &&
-	// 	y     <  Clip[3]);
-    return false;
-}
-
-// Drawing Shapes
-long ContourX[800][2];
-PUBLIC STATIC void    SoftwareRenderer::DrawPoint(int x, int y, Uint32 color) {
-	SetPixel(x, y, color);
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawLine(int x0, int y0, int x1, int y1, Uint32 color) {
-	int dx = Math::Abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-	int dy = Math::Abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
-	int err = (dx > dy ? dx : -dy) / 2, e2;
-
-	while (true) {
-		SetPixel(x0, y0, color);
-		if (x0 == x1 && y0 == y1) break;
-		e2 = err;
-
-		if (e2 > -dx) { err -= dy; x0 += sx; }
-		if (e2 <  dy) { err += dx; y0 += sy; }
-	}
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawCircle(int x, int y, int radius, Uint32 color) {
-
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawCircleStroke(int x, int y, int radius, Uint32 color) {
-
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawEllipse(int x, int y, int width, int height, Uint32 color) {
-
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawEllipseStroke(int x, int y, int width, int height, int radius, Uint32 color) {
-
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawTriangle(int p0_x, int p0_y, int p1_x, int p1_y, int p2_x, int p2_y, Uint32 color) {
-	// // Bresenham Scanline method:
-	// int y, maxX, maxY;
-	// for (y = 0; y < Application::HEIGHT; y++) {
-	// 	ContourX[y][0] = LONG_MAX; // min X
-	// 	ContourX[y][1] = LONG_MIN; // max X
-	// }
-    //
-	// ScanLine(p0_x, p0_y, p1_x, p1_y);
-	// ScanLine(p1_x, p1_y, p2_x, p2_y);
-	// ScanLine(p2_x, p2_y, p0_x, p0_y);
-    //
-	// maxX = Math::Max(p0_x, Math::Max(p1_x, p2_x));
-	// maxY = Math::Max(p0_y, Math::Max(p1_y, p2_y));
-    //
-	// for (y = 0; y < Application::HEIGHT; y++) {
-	// 	if (ContourX[y][1] >= ContourX[y][0]) {
-	// 		long x = ContourX[y][0];
-	// 		long len = ContourX[y][1] - ContourX[y][0];
-    //
-	// 		// Can draw a horizontal line instead of individual pixels here
-	// 		while (len--) {
-	// 			if (x < maxX && y < maxY)
-	// 				SetPixel(x++, y, color);
-	// 		}
-	// 	}
-	// }
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawTriangleStroke(int p0_x, int p0_y, int p1_x, int p1_y, int p2_x, int p2_y, Uint32 color) {
-	DrawLine(p0_x, p0_y, p1_x, p1_y, color);
-	DrawLine(p1_x, p1_y, p2_x, p2_y, color);
-	DrawLine(p2_x, p2_y, p0_x, p0_y, color);
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawRectangle(int x, int y, int width, int height, Uint32 color) {
-	// NOTE: Faster
-	/*
-	int Amin, Amax, Bmin, Bmax;
-	Amin = x;
-    Amax = Amin + width;
-    Bmin = Clip[0];
-    Bmax = Clip[2];
-    if (Bmin > Amin)
-        Amin = Bmin;
-    x = Amin;
-    if (Bmax < Amax)
-        Amax = Bmax;
-    width = Amax - Amin;
-
-    Amin = y;
-    Amax = Amin + height;
-    Bmin = Clip[1];
-    Bmax = Clip[3];
-    if (Bmin > Amin)
-        Amin = Bmin;
-    y = Amin;
-    if (Bmax < Amax)
-        Amax = Bmax;
-    height = Amax - Amin;
-
-	if ((width <= 0) || (height <= 0)) return;
-
-	color = GetPixelOutputColor(color);
-
-	if (SetPixelFunction == &SoftwareRenderer::SetPixelNormal) {
-		int pitch = FrameBufferStride << 2;
-		Uint8* pixels = (Uint8*)(FrameBuffer + x + y * FrameBufferStride);
-		while (height--) {
-	        Memory::Memset4(pixels, color, width);
-	        pixels += pitch;
-	    }
-	}
-	else {
-		int bx = x + width;
-		for (int b = 0; b < width * height; b++) {
-			SetPixelFunction(x, y, color);
-
-			x++;
-			if (x >= bx) {
-				x -= width;
-				y++;
-			}
-		}
-	}
-	//*/
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawRectangleStroke(int x, int y, int width, int height, Uint32 color) {
-	int x1, x2, y1, y2;
-
-	x1 = x;
-	x2 = x + width - 1;
-	if (width < 0)
-		x1 += width, x2 -= width;
-
-	y1 = y;
-	y2 = y + height - 1;
-	if (height < 0)
-		y1 += height, y2 -= height;
-
-	for (int b = x1; b <= x2; b++) {
-		SetPixel(b, y1, color);
-		SetPixel(b, y2, color);
-	}
-	for (int b = y1 + 1; b < y2; b++) {
-		SetPixel(x1, b, color);
-		SetPixel(x2, b, color);
-	}
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawRectangleSkewedH(int x, int y, int width, int height, int sk, Uint32 color) {
-	DrawTriangle(
-		x, y,
-		x + width, y,
-		x + width + sk, y + height, color);
-
-	DrawTriangle(
-		x, y,
-		x + sk, y + height,
-		x + width + sk, y + height, color);
-}
-
-// Drawing Sprites
-PUBLIC STATIC void    SoftwareRenderer::DrawSpriteNormal(ISprite* sprite, int SrcX, int SrcY, int Width, int Height, int CenterX, int CenterY, bool FlipX, bool FlipY, int RealCenterX, int RealCenterY) {
-	// Uint32 PC;
-	// bool AltPal = false;
-	// Uint32* Pal = sprite->Palette;
-	// int DX = 0, DY = 0, PX, PY, size = Width * Height;
-	// // Uint32 TrPal = sprite->Palette[sprite->TransparentColorIndex];
-	// Width--;
-	// Height--;
-	//
-	// if (!AltPal && CenterY + RealCenterY >= WaterPaletteStartLine && sprite->PaletteCount == 2) {
-	// 	AltPal = true;
-	// 	Pal = sprite->PaletteAlt;
-	// 	// TrPal = sprite->PaletteAlt[sprite->TransparentColorIndex];
-	// }
-	// for (int D = 0; D < size; D++) {
-	// 	PX = DX;
-	// 	PY = DY;
-	// 	if (FlipX)
-	// 		PX = Width - PX;
-	// 	if (FlipY)
-	// 		PY = Height - PY;
-	//
-	// 	PC = GetPixelIndex(sprite, SrcX + PX, SrcY + PY);
-	// 	if (sprite->PaletteCount == 0) {
-	// 		SetPixel(CenterX + DX + RealCenterX, CenterY + DY + RealCenterY, PC);
-	// 	}
-	// 	else if (PC) {
-	// 		SetPixel(CenterX + DX + RealCenterX, CenterY + DY + RealCenterY, Pal[PC]);
-	// 	}
-	//
-	// 	DX++;
-	// 	if (DX > Width) {
-	// 		DX = 0;
-	// 		DY++;
-	//
-	// 		if (!AltPal && CenterY + DY + RealCenterY >= WaterPaletteStartLine && sprite->PaletteCount == 2) {
-	// 			AltPal = true;
-	// 			Pal = sprite->PaletteAlt;
-	// 			// TrPal = sprite->PaletteAlt[sprite->TransparentColorIndex];
-	// 		}
-	// 	}
-	// }
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawSpriteTransformed(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY, int scaleW, int scaleH, int angle) {
-	if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
-
-	// AnimFrame animframe = sprite->Animations[animation].Frames[frame];
-
-	// TODO: Add shortcut here if angle == 0 && scaleW == 0x100 && scaleH = 0x100
-	// DrawSpriteNormal();
-	// return;
-
-	/*
-
-	int srcx = 0, srcy = 0, srcw = animframe.W, srch = animframe.H;
-	if (srcw >= animframe.Width- srcx)
-		srcw  = animframe.Width- srcx;
-	if (srch >= animframe.H - srcy)
-		srch  = animframe.H - srcy;
-
-	bool AltPal = false;
-	Uint32 PixelIndex, *Pal = sprite->Palette;
-	int DX = 0, DY = 0, PX, PY, size;
-	int CenterX = x, CenterY = y, RealCenterX = animframe.OffX, RealCenterY = animframe.OffY;
-	int SrcX = animframe.X + srcx, SrcY = animframe.Y + srcy, Width = srcw - 1, Height = srch - 1;
-	if (flipX)
-		RealCenterX = -RealCenterX - Width - 1;
-	if (flipY)
-		RealCenterY = -RealCenterY - Height - 1;
-
-	int minX = 0, maxX = 0, minY = 0, maxY = 0,
-		c0x, c0y,
-		mcos = Math::Cos(-angle), msin = Math::Sin(-angle),
-		left = RealCenterX, top = RealCenterY;
-	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-	left += Width;
-	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-	top += Height;
-	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-	left = RealCenterX;
-	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-
-	minX >>= 16; maxX >>= 16;
-	minY >>= 16; maxY >>= 16;
-
-	size = (maxX - minX + 1) * (maxY - minY + 1);
-
-	minX *= scaleW; maxX *= scaleW;
-	minY *= scaleH; maxY *= scaleH;
-	size *= scaleW * scaleH;
-
-	minX >>= 8; maxX >>= 8;
-	minY >>= 8; maxY >>= 8;
-	size >>= 16;
-
-	// DrawRectangle(minX + CenterX, minY + CenterY, maxX - minX + 1, maxY - minY + 1, 0xFF00FF);
-
-
-	mcos = Math::Cos(angle);
-	msin = Math::Sin(angle);
-
-	if (!AltPal && CenterY + DY + minY >= WaterPaletteStartLine)
-		AltPal = true, Pal = sprite->PaletteAlt;
-
-	int NPX, NPY, X, Y, FX, FY;
-	for (int D = 0; D < size; D++) {
-		PX = DX + minX;
-		PY = DY + minY;
-
-		NPX = PX;
-		NPY = PY;
-		NPX = (NPX << 8) / scaleW;
-		NPY = (NPY << 8) / scaleH;
-		X = (NPX * mcos - NPY * msin) >> 16;
-		Y = (NPX * msin + NPY * mcos) >> 16;
-
-		FX = CenterX + PX;
-		FY = CenterY + PY;
-		if (FX <  Clip[0]) goto CONTINUE;
-		if (FY <  Clip[1]) goto CONTINUE;
-		if (FX >= Clip[2]) goto CONTINUE;
-		if (FY >= Clip[3]) return;
-
-		if (X >= RealCenterX && Y >= RealCenterY && X <= RealCenterX + Width && Y <= RealCenterY + Height) {
-			int SX = X - RealCenterX;
-			int SY = Y - RealCenterY;
-			if (flipX)
-				SX = Width - SX;
-			if (flipY)
-				SY = Height - SY;
-
-			PixelIndex = GetPixelIndex(sprite, SrcX + SX, SrcY + SY);
-			if (sprite->PaletteCount) {
-				if (PixelIndex != sprite->TransparentColorIndex)
-					SetPixelFunction(FX, FY, GetPixelOutputColor(Pal[PixelIndex]));
-					// SetPixelFunction(FX, FY, Pal[PixelIndex]);
-			}
-			else if (PixelIndex & 0xFF000000U) {
-				SetPixelFunction(FX, FY, GetPixelOutputColor(PixelIndex));
-				// SetPixelFunction(FX, FY, PixelIndex);
-			}
-		}
-
-		CONTINUE:
-
-		DX++;
-		if (DX >= maxX - minX + 1) {
-			DX = 0, DY++;
-
-			if (!AltPal && CenterY + PY >= WaterPaletteStartLine)
-				AltPal = true, Pal = sprite->PaletteAlt;
-		}
-	}
-	//*/
-}
-
-PUBLIC STATIC void    SoftwareRenderer::DrawSpriteSizedTransformed(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY, int width, int height, int angle) {
-	if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
-
-	// ignores X/Y offsets of sprite
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawSpriteAtlas(ISprite* sprite, int x, int y, int pivotX, int pivotY, bool flipX, bool flipY) {
-	if (!sprite) return;
-
-	// bool AltPal = false;
-	// Uint32 PixelIndex, *Pal = sprite->Palette;
-	//
-	// int DX = 0, DY = 0, PX, PY, size = sprite->Width * sprite->Height;
-	// int CenterX = x, CenterY = y, RealCenterX = -pivotX, RealCenterY = -pivotY;
-	// int SrcX = 0, SrcY = 0, Width = sprite->Width - 1, Height = sprite->Height - 1;
-	//
-	// if (!AltPal && CenterY + RealCenterY >= WaterPaletteStartLine)
-	// 	AltPal = true, Pal = sprite->PaletteAlt;
-	//
-	// for (int D = 0; D < size; D++) {
-	// 	PX = DX;
-	// 	PY = DY;
-	// 	if (flipX)
-	// 		PX = Width - PX;
-	// 	if (flipY)
-	// 		PY = Height - PY;
-	//
-	// 	PixelIndex = GetPixelIndex(sprite, SrcX + PX, SrcY + PY);
-	// 	if (sprite->PaletteCount) {
-	// 		if (PixelIndex != sprite->TransparentColorIndex)
-	// 			SetPixel(CenterX + DX + RealCenterX, CenterY + DY + RealCenterY, Pal[PixelIndex]);
-	// 	}
-	// 	else if (PixelIndex & 0xFF000000U) {
-	// 		SetPixel(CenterX + DX + RealCenterX, CenterY + DY + RealCenterY, PixelIndex);
-	// 	}
-	//
-	// 	DX++;
-	// 	if (DX > Width) {
-	// 		DX = 0, DY++;
-	//
-	// 		if (!AltPal && CenterY + DY + RealCenterY >= WaterPaletteStartLine)
-	// 			AltPal = true, Pal = sprite->PaletteAlt;
-	// 	}
-	// }
-}
-
-PUBLIC STATIC void    SoftwareRenderer::DrawSpritePart(ISprite* sprite, int animation, int frame, int srcx, int srcy, int srcw, int srch, int x, int y, bool flipX, bool flipY) {
-	if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
-
-	/*
-
-	bool AltPal = false;
-	Uint32 PixelIndex, *Pal = sprite->Palette;
-	AnimFrame animframe = sprite->Animations[animation].Frames[frame];
-
-	srcw = Math::Min(srcw, animframe.Width- srcx);
-	srch = Math::Min(srch, animframe.H - srcy);
-
-	int DX = 0, DY = 0, PX, PY, size = srcw * srch;
-	int CenterX = x, CenterY = y, RealCenterX = animframe.OffX, RealCenterY = animframe.OffY;
-	int SrcX = animframe.X + srcx, SrcY = animframe.Y + srcy, Width = srcw - 1, Height = srch - 1;
-
-	if (flipX)
-		RealCenterX = -RealCenterX - Width - 1;
-	if (flipY)
-		RealCenterY = -RealCenterY - Height - 1;
-
-	if (!AltPal && CenterY + RealCenterY >= WaterPaletteStartLine)
-		AltPal = true, Pal = sprite->PaletteAlt;
-
-	if (CenterX + Width + RealCenterX < Clip[0]) return;
-	if (CenterY + Height + RealCenterY < Clip[1]) return;
-	if (CenterX + RealCenterX >= Clip[2]) return;
-	if (CenterY + RealCenterY >= Clip[3]) return;
-
-	int FX, FY;
-	for (int D = 0; D < size; D++) {
-		PX = DX;
-		PY = DY;
-		if (flipX)
-			PX = Width - PX;
-		if (flipY)
-			PY = Height - PY;
-
-		FX = CenterX + DX + RealCenterX;
-		FY = CenterY + DY + RealCenterY;
-		if (FX <  Clip[0]) goto CONTINUE;
-		if (FY <  Clip[1]) goto CONTINUE;
-		if (FX >= Clip[2]) goto CONTINUE;
-		if (FY >= Clip[3]) return;
-
-		PixelIndex = GetPixelIndex(sprite, SrcX + PX, SrcY + PY);
-		if (sprite->PaletteCount) {
-			if (PixelIndex != sprite->TransparentColorIndex)
-				SetPixelFunction(FX, FY, GetPixelOutputColor(Pal[PixelIndex]));
-				// SetPixelFunction(FX, FY, Pal[PixelIndex]);
-		}
-		else if (PixelIndex & 0xFF000000U) {
-			SetPixelFunction(FX, FY, GetPixelOutputColor(PixelIndex));
-			// SetPixelFunction(FX, FY, PixelIndex);
-		}
-
-		CONTINUE:
-
-		DX++;
-		if (DX > Width) {
-			DX = 0, DY++;
-
-			if (!AltPal && CenterY + DY + RealCenterY >= WaterPaletteStartLine)
-				AltPal = true, Pal = sprite->PaletteAlt;
-		}
-	}
-	//*/
-}
-
-// Drawing Text
-PUBLIC STATIC void    SoftwareRenderer::DrawText(int x, int y, const char* string, unsigned int pixel) {
-	pixel = GetPixelOutputColor(pixel);
-	// for (size_t i = 0; i < strlen(string); i++) {
-	// 	for (int by = 0; by < 8; by++) {
-	// 		for (int bx = 0; bx < 8; bx++) {
-	// 			if (Font8x8_basic[(int)string[i]][by] & 1 << bx) {
-	// 				SetPixel(x + bx + i * 8, y + by, pixel);
-	// 			}
-	// 		}
-	// 	}
-	// }
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawTextShadow(int x, int y, const char* string, unsigned int pixel) {
-	DrawText(x + 1, y + 1, string, 0x000000);
-	DrawText(x, y, string, pixel);
-}
-
-PUBLIC STATIC void    SoftwareRenderer::DrawTextSprite(ISprite* sprite, int animation, char first, int x, int y, const char* string) {
-	AnimFrame animframe;
-	for (int i = 0; i < (int)strlen(string); i++) {
-		animframe = sprite->Animations[animation].Frames[string[i] - first];
-		// DrawSpriteNormal(sprite, animation, string[i] - first, x - animframe.OffsetX, y, false, false);
-
-		x += animframe.Width;
-	}
-}
-PUBLIC STATIC int     SoftwareRenderer::MeasureTextSprite(ISprite* sprite, int animation, char first, const char* string) {
-	int x = 0;
-	AnimFrame animframe;
-	for (int i = 0; i < (int)strlen(string); i++) {
-		animframe = sprite->Animations[animation].Frames[string[i] - first];
-		x += animframe.Width;
-	}
-	return x;
-}
-
-// Drawing 3D
-PUBLIC STATIC void    SoftwareRenderer::DrawModelOn2D(IModel* model, int x, int y, double scale, int rx, int ry, int rz, Uint32 color, bool wireframe) {
-	// rx &= 0xFF;
-	// IMatrix3 rotateX = IMatrix3(
-	// 	1, 0, 0,
-	// 	0, Math::Cos(rx), Math::Sin(rx),
-	// 	0, -Math::Sin(rx), Math::Cos(rx));
-    //
-	// ry &= 0xFF;
-	// IMatrix3 rotateY = IMatrix3(
-	// 	Math::Cos(ry), 0, -Math::Sin(ry),
-	// 	0, 1, 0,
-	// 	Math::Sin(ry), 0, Math::Cos(ry));
-    //
-	// rz &= 0xFF;
-	// IMatrix3 rotateZ = IMatrix3(
-	// 	Math::Cos(rz), -Math::Sin(rz), 0,
-	// 	Math::Sin(rz), Math::Cos(rz), 0,
-	// 	0, 0, 1);
-    //
-	// IMatrix3 transform = rotateX.Multiply(rotateY).Multiply(rotateZ);
-    //
-	// int size = FrameBufferSize;
-	// double* zBuffer = (double*)malloc(size * sizeof(double));
-	// for (int q = 0; q < size; q++) {
-	// 	zBuffer[q] = -9999999999.9f;
-	// }
-    //
-	// int wHalf = Application::WIDTH / 2;
-	// int hHalf = Application::HEIGHT / 2;
-    //
-	// int frame = 0;
-    //
-	// for (int i = 0; i < (int)model->Faces.size(); i++) {
-	// 	IFace t = model->Faces[i];
-    //
-	// 	if (t.Quad && !wireframe) {
-	// 		IVertex v1 = transform.Transform(model->Vertices[frame][t.v1]).Multiply(scale, scale, scale);
-	// 		IVertex v2 = transform.Transform(model->Vertices[frame][t.v3]).Multiply(scale, scale, scale);
-	// 		IVertex v3 = transform.Transform(model->Vertices[frame][t.v4]).Multiply(scale, scale, scale);
-    //
-	// 		// Offset model
-	// 		v1.x += x;
-	// 		v1.y += y;
-	// 		v2.x += x;
-	// 		v2.y += y;
-	// 		v3.x += x;
-	// 		v3.y += y;
-    //
-	// 		IVertex n1 = transform.Transform(model->Normals[frame][t.v1].Normalize());
-	// 		IVertex n2 = transform.Transform(model->Normals[frame][t.v3].Normalize());
-	// 		IVertex n3 = transform.Transform(model->Normals[frame][t.v4].Normalize());
-    //
-	// 		IVertex varying_intensity;
-	// 		IVertex lightdir = IVertex(0.0, -1.0, 0.0);
-    //
-	// 		varying_intensity.x = fmax(0.0, lightdir.DotProduct(n1));
-	// 		varying_intensity.y = fmax(0.0, lightdir.DotProduct(n2));
-	// 		varying_intensity.z = fmax(0.0, lightdir.DotProduct(n3));
-    //
-	// 		double intensity = varying_intensity.Distance();
-    //
-	// 		int minX = (int)fmax(0.0, ceil(fmin(v1.x, fmin(v2.x, v3.x))));
-	// 		int maxX = (int)fmin(wHalf * 2 - 1.0, floor(fmax(v1.x, fmax(v2.x, v3.x))));
-	// 		int minY = (int)fmax(0.0, ceil(fmin(v1.y, fmin(v2.y, v3.y))));
-	// 		int maxY = (int)fmin(hHalf * 2 - 1.0, floor(fmax(v1.y, fmax(v2.y, v3.y))));
-    //
-	// 		double triangleArea = (v1.y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - v1.x);
-    //
-	// 		for (int y = minY; y <= maxY; y++) {
-	// 			for (int x = minX; x <= maxX; x++) {
-	// 				double b1 = ((y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - x)) / triangleArea;
-	// 				double b2 = ((y - v1.y) * (v3.x - v1.x) + (v3.y - v1.y) * (v1.x - x)) / triangleArea;
-	// 				double b3 = ((y - v2.y) * (v1.x - v2.x) + (v1.y - v2.y) * (v2.x - x)) / triangleArea;
-	// 				if (b1 >= 0 && b1 <= 1 && b2 >= 0 && b2 <= 1 && b3 >= 0 && b3 <= 1) {
-	// 					double depth = b1 * v1.z + b2 * v2.z + b3 * v3.z;
-    //
-	// 					intensity = (double)varying_intensity.DotProduct(b1, b2, b3);
-    //
-	// 					int zIndex = y * wHalf * 2 + x;
-	// 					if (zBuffer[zIndex] < depth) {
-	// 						if (intensity > 0.5)
-	// 							SetPixel(x, y, ColorBlend(color, 0xFFFFFF, intensity * 2.0 - 1.0));
-	// 						else
-	// 							SetPixel(x, y, ColorBlend(color, 0x000000, (0.5 - intensity)));
-	// 						zBuffer[zIndex] = depth;
-	// 					}
-	// 				}
-	// 			}
-	// 		}
-	// 	}
-    //
-	// 	IVertex v1 = transform.Transform(model->Vertices[frame][t.v1]).Multiply((float)scale, (float)scale, (float)scale);
-	// 	IVertex v2 = transform.Transform(model->Vertices[frame][t.v2]).Multiply((float)scale, (float)scale, (float)scale);
-	// 	IVertex v3 = transform.Transform(model->Vertices[frame][t.v3]).Multiply((float)scale, (float)scale, (float)scale);
-    //
-	// 	// Offset model
-	// 	v1.x += x;
-	// 	v1.y += y;
-	// 	v2.x += x;
-	// 	v2.y += y;
-	// 	v3.x += x;
-	// 	v3.y += y;
-    //
-	// 	IVertex n1 = transform.Transform(model->Normals[frame][t.v1].Normalize());
-	// 	IVertex n2 = transform.Transform(model->Normals[frame][t.v2].Normalize());
-	// 	IVertex n3 = transform.Transform(model->Normals[frame][t.v3].Normalize());
-    //
-	// 	IVertex varying_intensity;
-	// 	IVertex lightdir = IVertex(0.0, -1.0, 0.0);
-    //
-	// 	varying_intensity.x = fmax(0.0f, lightdir.DotProduct(n1));
-	// 	varying_intensity.y = fmax(0.0f, lightdir.DotProduct(n2));
-	// 	varying_intensity.z = fmax(0.0f, lightdir.DotProduct(n3));
-    //
-	// 	double intensity;// = varying_intensity.Distance();
-    //
-	// 	int minX = (int)fmax(0.0, ceil(fmin(v1.x, fmin(v2.x, v3.x))));
-	// 	int maxX = (int)fmin(wHalf * 2 - 1.0, floor(fmax(v1.x, fmax(v2.x, v3.x))));
-	// 	int minY = (int)fmax(0.0, ceil(fmin(v1.y, fmin(v2.y, v3.y))));
-	// 	int maxY = (int)fmin(hHalf * 2 - 1.0, floor(fmax(v1.y, fmax(v2.y, v3.y))));
-    //
-	// 	if (wireframe) {
-	// 		intensity = fmin(1.0, fmax(0.0, varying_intensity.Distance()));
-    //
-	// 		if (intensity > 0.5) {
-	// 			DrawLine((int)v1.x, (int)v1.y, (int)v2.x, (int)v2.y, ColorBlend(color, 0xFFFFFF, intensity * 2.0 - 1.0));
-	// 			DrawLine((int)v3.x, (int)v3.y, (int)v2.x, (int)v2.y, ColorBlend(color, 0xFFFFFF, intensity * 2.0 - 1.0));
-	// 		}
-	// 		else {
-	// 			DrawLine((int)v1.x, (int)v1.y, (int)v2.x, (int)v2.y, ColorBlend(color, 0x000000, (0.5 - intensity)));
-	// 			DrawLine((int)v3.x, (int)v3.y, (int)v2.x, (int)v2.y, ColorBlend(color, 0x000000, (0.5 - intensity)));
-	// 		}
-	// 	}
-	// 	else {
-	// 		double triangleArea = (v1.y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - v1.x);
-    //
-	// 		for (int y = minY; y <= maxY; y++) {
-	// 			for (int x = minX; x <= maxX; x++) {
-	// 				double b1 = ((y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - x)) / triangleArea;
-	// 				double b2 = ((y - v1.y) * (v3.x - v1.x) + (v3.y - v1.y) * (v1.x - x)) / triangleArea;
-	// 				double b3 = ((y - v2.y) * (v1.x - v2.x) + (v1.y - v2.y) * (v2.x - x)) / triangleArea;
-	// 				if (b1 >= 0 && b1 <= 1 && b2 >= 0 && b2 <= 1 && b3 >= 0 && b3 <= 1) {
-	// 					double depth = b1 * v1.z + b2 * v2.z + b3 * v3.z;
-	// 					// b1, b2, b3 make up "bar"; a Vector3
-    //
-	// 					// fragment
-	// 					intensity = varying_intensity.DotProduct((float)b1, (float)b2, (float)b3);
-    //
-	// 					int zIndex = y * wHalf * 2 + x;
-	// 					if (zBuffer[zIndex] < depth) {
-	// 						if (intensity > 0.5)
-	// 							SetPixel(x, y, ColorBlend(color, 0xFFFFFF, intensity * 2.0 - 1.0));
-	// 						else
-	// 							SetPixel(x, y, ColorBlend(color, 0x000000, (0.5 - intensity)));
-	// 						zBuffer[zIndex] = depth;
-	// 					}
-	// 				}
-	// 			}
-	// 		}
-	// 	}
-	// }
-    //
-	// free(zBuffer);
-}
-PUBLIC STATIC void    SoftwareRenderer::DrawSpriteIn3D(ISprite* sprite, int animation, int frame, int x, int y, int z, double scale, int rx, int ry, int rz) {
-	// rx &= 0xFF;
-	// IMatrix3 rotateX = IMatrix3(
-	// 	1, 0, 0,
-	// 	0, Math::Cos(rx), Math::Sin(rx),
-	// 	0, -Math::Sin(rx), Math::Cos(rx));
-    //
-	// ry &= 0xFF;
-	// IMatrix3 rotateY = IMatrix3(
-	// 	Math::Cos(ry), 0, -Math::Sin(ry),
-	// 	0, 1, 0,
-	// 	Math::Sin(ry), 0, Math::Cos(ry));
-    //
-	// rz &= 0xFF;
-	// IMatrix3 rotateZ = IMatrix3(
-	// 	Math::Cos(rz), -Math::Sin(rz), 0,
-	// 	Math::Sin(rz), Math::Cos(rz), 0,
-	// 	0, 0, 1);
-    //
-	// IMatrix3 transform = rotateX.Multiply(rotateY).Multiply(rotateZ);
-    //
-	// int size = FrameBufferSize;
-	// double* zBuffer = (double*)malloc(size * sizeof(double));
-	// for (int q = 0; q < size; q++) {
-	// 	zBuffer[q] = -9999999999.9f;
-	// }
-    //
-	// int wHalf = Application::WIDTH / 2;
-	// int hHalf = Application::HEIGHT / 2;
-    //
-	// IFace t(1, 0, 2, 3);
-	// vector<IVertex> Vertices;
-	// vector<IVertex2> UVs;
-    //
-	// IMatrix2x3 varying_uv;
-    //
-	// Vertices.push_back(IVertex(0.0, 0.0, -0.5));
-	// Vertices.push_back(IVertex(1.0, 0.0, -0.5));
-	// Vertices.push_back(IVertex(0.0, 1.0, -0.5));
-	// Vertices.push_back(IVertex(1.0, 1.0, -0.5));
-    //
-	// UVs.push_back(IVertex2(0.0, 0.0));
-	// UVs.push_back(IVertex2(1.0, 0.0));
-	// UVs.push_back(IVertex2(0.0, 1.0));
-	// UVs.push_back(IVertex2(1.0, 1.0));
-    //
-	// /*
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].X,
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].Y,
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].W,
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].H, X - CamX, Y - CamY, 0, IE_NOFLIP,
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].OffX,
-	// Sprite.Animations[CurrentAnimation].Frames[Frame >> 8].OffY
-	// */
-    //
-	// AnimFrame currentFrame = sprite->Animations[animation].Frames[frame];
-    //
-	// x += currentFrame.OffX;
-	// y += currentFrame.OffY;
-    //
-	// if (t.Quad) {
-	// 	IVertex v1 = transform.Transform(Vertices[t.v1]).Multiply((float)scale, (float)scale, (float)scale);
-	// 	IVertex v2 = transform.Transform(Vertices[t.v3]).Multiply((float)scale, (float)scale, (float)scale);
-	// 	IVertex v3 = transform.Transform(Vertices[t.v4]).Multiply((float)scale, (float)scale, (float)scale);
-    //
-	// 	varying_uv.SetColumn(0, UVs[t.v1]);
-	// 	varying_uv.SetColumn(1, UVs[t.v3]);
-	// 	varying_uv.SetColumn(2, UVs[t.v4]);
-    //
-	// 	v1 = v1.Multiply((float)currentFrame.W, (float)currentFrame.H, 1.0);
-	// 	v2 = v2.Multiply((float)currentFrame.W, (float)currentFrame.H, 1.0);
-	// 	v3 = v3.Multiply((float)currentFrame.W, (float)currentFrame.H, 1.0);
-    //
-	// 	// Offset model
-	// 	v1.x += x;
-	// 	v1.y += y;
-	// 	v2.x += x;
-	// 	v2.y += y;
-	// 	v3.x += x;
-	// 	v3.y += y;
-    //
-	// 	int minX = (int)fmax(0.0, ceil(fmin(v1.x, fmin(v2.x, v3.x))));
-	// 	int maxX = (int)fmin(wHalf * 2 - 1.0, floor(fmax(v1.x, fmax(v2.x, v3.x))));
-	// 	int minY = (int)fmax(0.0, ceil(fmin(v1.y, fmin(v2.y, v3.y))));
-	// 	int maxY = (int)fmin(hHalf * 2 - 1.0, floor(fmax(v1.y, fmax(v2.y, v3.y))));
-    //
-	// 	double triangleArea = (v1.y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - v1.x);
-    //
-	// 	for (int y = minY; y <= maxY; y++) {
-	// 		for (int x = minX; x <= maxX; x++) {
-	// 			double b1 = ((y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - x)) / triangleArea;
-	// 			double b2 = ((y - v1.y) * (v3.x - v1.x) + (v3.y - v1.y) * (v1.x - x)) / triangleArea;
-	// 			double b3 = ((y - v2.y) * (v1.x - v2.x) + (v1.y - v2.y) * (v2.x - x)) / triangleArea;
-	// 			if (b1 >= 0 && b1 <= 1 && b2 >= 0 && b2 <= 1 && b3 >= 0 && b3 <= 1) {
-	// 				double depth = b1 * v1.z + b2 * v2.z + b3 * v3.z;
-    //
-	// 				IVertex2 uv = varying_uv.Transform(IVertex((float)b1, (float)b2, (float)b3));
-	// 				Uint32 color = GetPixelIndex(sprite,
-	// 					currentFrame.X + (int)(uv.x * (currentFrame.W - 1)),
-	// 					currentFrame.Y + (int)(uv.y * (currentFrame.H - 1)));
-	// 				// color = sprite->Palette[color];
-    //
-	// 				int zIndex = y * wHalf * 2 + x;
-	// 				if (zBuffer[zIndex] < depth) {
-	// 					SetPixel(x, y, color);
-	// 					zBuffer[zIndex] = depth;
-	// 				}
-	// 			}
-	// 		}
-	// 	}
-	// }
-    //
-	// IVertex v1 = transform.Transform(Vertices[t.v1]).Multiply((float)scale, (float)scale, (float)scale);
-	// IVertex v2 = transform.Transform(Vertices[t.v2]).Multiply((float)scale, (float)scale, (float)scale);
-	// IVertex v3 = transform.Transform(Vertices[t.v3]).Multiply((float)scale, (float)scale, (float)scale);
-    //
-	// varying_uv.SetColumn(0, UVs[t.v1]);
-	// varying_uv.SetColumn(1, UVs[t.v2]);
-	// varying_uv.SetColumn(2, UVs[t.v3]);
-    //
-	// v1 = v1.Multiply((float)currentFrame.Width, (float)currentFrame.Height, 1.0);
-	// v2 = v2.Multiply((float)currentFrame.Width, (float)currentFrame.Height, 1.0);
-	// v3 = v3.Multiply((float)currentFrame.Width, (float)currentFrame.Height, 1.0);
-	// // v1 = v1.Multiply(currentFrame.W - 1, currentFrame.H - 1, 1.0);
-	// // v2 = v2.Multiply(currentFrame.W - 1, currentFrame.H - 1, 1.0);
-	// // v3 = v3.Multiply(currentFrame.W - 1, currentFrame.H - 1, 1.0);
-    //
-	// // Offset model
-	// v1.x += x;
-	// v1.y += y;
-	// v2.x += x;
-	// v2.y += y;
-	// v3.x += x;
-	// v3.y += y;
-    //
-	// int minX = (int)fmax(0.0, ceil(fmin(v1.x, fmin(v2.x, v3.x))));
-	// int maxX = (int)fmin(wHalf * 2 - 1.0, floor(fmax(v1.x, fmax(v2.x, v3.x))));
-	// int minY = (int)fmax(0.0, ceil(fmin(v1.y, fmin(v2.y, v3.y))));
-	// int maxY = (int)fmin(hHalf * 2 - 1.0, floor(fmax(v1.y, fmax(v2.y, v3.y))));
-    //
-	// double triangleArea = (v1.y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - v1.x);
-    //
-	// for (int y = minY; y <= maxY; y++) {
-	// 	for (int x = minX; x <= maxX; x++) {
-	// 		double b1 = ((y - v3.y) * (v2.x - v3.x) + (v2.y - v3.y) * (v3.x - x)) / triangleArea;
-	// 		double b2 = ((y - v1.y) * (v3.x - v1.x) + (v3.y - v1.y) * (v1.x - x)) / triangleArea;
-	// 		double b3 = ((y - v2.y) * (v1.x - v2.x) + (v1.y - v2.y) * (v2.x - x)) / triangleArea;
-	// 		if (b1 >= 0 && b1 <= 1 && b2 >= 0 && b2 <= 1 && b3 >= 0 && b3 <= 1) {
-	// 			double depth = b1 * v1.z + b2 * v2.z + b3 * v3.z;
-    //
-	// 			IVertex2 uv = varying_uv.Transform(IVertex(b1, b2, b3));
-	// 			Uint32 color = GetPixelIndex(sprite,
-	// 				currentFrame.X + (int)(uv.x * (currentFrame.W - 1)),
-	// 				currentFrame.Y + (int)(uv.y * (currentFrame.H - 1)));
-	// 			// color = sprite->Palette[color];
-    //
-	// 			int zIndex = y * wHalf * 2 + x;
-	// 			if (zBuffer[zIndex] < depth) {
-	// 				SetPixel(x, y, color);
-	// 				zBuffer[zIndex] = depth;
-	// 			}
-	// 		}
-	// 	}
-	// }
-    //
-	// free(zBuffer);
-}
-
-// Utility Functions
-PUBLIC STATIC Uint32  SoftwareRenderer::ColorAdd(Uint32 color1, Uint32 color2, int percent) {
-	Uint32 r = color1 >> 16 & 0xFF;
-	Uint32 g = color1 >> 8 & 0xFF;
-	Uint32 b = color1 & 0xFF;
-
-	r += (color2 >> 16 & 0xFF) * percent >> 8;
-	g += (color2 >> 8 & 0xFF) * percent >> 8;
-	b += (color2 & 0xFF) * percent >> 8;
-
-	if (r > 0xFF) r = 0xFF;
-	if (g > 0xFF) g = 0xFF;
-	if (b > 0xFF) b = 0xFF;
-
-	return r << 16 | g << 8 | b;
-}
-PUBLIC STATIC Uint32  SoftwareRenderer::ColorBlend(Uint32 color1, Uint32 color2, int percent) {
-	Uint32 rb = color1 & 0xff00ff;
-	Uint32 g = color1 & 0x00ff00;
-	rb += ((color2 & 0xff00ff) - rb) * percent >> 8;
-	g += ((color2 & 0x00ff00) - g) * percent >> 8;
-	return (rb & 0xff00ff) | (g & 0xff00);
-}
-
-PUBLIC STATIC void    SoftwareRenderer::ScanLine(long x1, long y1, long x2, long y2) {
-	long sx, sy, dx1, dy1, dx2, dy2, x, y, m, n, k, cnt;
-
-	sx = x2 - x1;
-	sy = y2 - y1;
-
-	if (sx > 0) dx1 = 1;
-	else if (sx < 0) dx1 = -1;
-	else dx1 = 0;
-
-	if (sy > 0) dy1 = 1;
-	else if (sy < 0) dy1 = -1;
-	else dy1 = 0;
-
-	m = labs(sx);
-	n = labs(sy);
-	dx2 = dx1;
-	dy2 = 0;
-
-	if (m < n) {
-		m = labs(sy);
-		n = labs(sx);
-		dx2 = 0;
-		dy2 = dy1;
-	}
-
-	x = x1;
-	y = y1;
-	cnt = m;
-	k = n / 2;
-
-	// while (cnt--) {
-	// 	if ((y >= 0) && (y < Application::HEIGHT)) {
-	// 		if (x < ContourX[y][0]) ContourX[y][0] = x;
-	// 		if (x > ContourX[y][1]) ContourX[y][1] = x;
-	// 	}
-    //
-	// 	k += n;
-	// 	if (k < m) {
-	// 		x += dx2;
-	// 		y += dy2;
-	// 	}
-	// 	else {
-	// 		k -= m;
-	// 		x += dx1;
-	// 		y += dy1;
-	// 	}
-	// }
-}
-
-/*
-// PUBLIC STATIC void   SoftwareRenderer::DrawSpritePart(ISprite* sprite, int animation, int frame, int srcx, int srcy, int srcw, int srch, int x, int y, bool flipX, bool flipY) {
-// 	if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
-//
-// 	bool AltPal = false;
-// 	Uint32 PixelIndex, *Pal = sprite->Palette;
-// 	AnimFrame animframe = sprite->Animations[animation].Frames[frame];
-//
-// 	srcw = Math::Min(srcw, animframe.Width- srcx);
-// 	srch = Math::Min(srch, animframe.H - srcy);
-//
-// 	int DX = 0, DY = 0, PX, PY, size = srcw * srch;
-// 	int CenterX = x, CenterY = y, RealCenterX = animframe.OffX, RealCenterY = animframe.OffY;
-// 	int SrcX = animframe.X + srcx, SrcY = animframe.Y + srcy, Width = srcw - 1, Height = srch - 1;
-//
-// 	if (flipX)
-// 		RealCenterX = -RealCenterX - Width - 1;
-// 	if (flipY)
-// 		RealCenterY = -RealCenterY - Height - 1;
-//
-// 	if (!AltPal && CenterY + RealCenterY >= WaterPaletteStartLine)
-// 		AltPal = true, Pal = sprite->PaletteAlt;
-//
-// 	if (CenterX + Width + RealCenterX < Clip[0]) return;
-// 	if (CenterY + Height + RealCenterY < Clip[1]) return;
-// 	if (CenterX + RealCenterX >= Clip[2]) return;
-// 	if (CenterY + RealCenterY >= Clip[3]) return;
-//
-// 	int FX, FY;
-// 	for (int D = 0; D < size; D++) {
-// 		PX = DX;
-// 		PY = DY;
-// 		if (flipX)
-// 			PX = Width - PX;
-// 		if (flipY)
-// 			PY = Height - PY;
-//
-// 		FX = CenterX + DX + RealCenterX;
-// 		FY = CenterY + DY + RealCenterY;
-// 		if (FX <  Clip[0]) goto CONTINUE;
-// 		if (FY <  Clip[1]) goto CONTINUE;
-// 		if (FX >= Clip[2]) goto CONTINUE;
-// 		if (FY >= Clip[3]) return;
-//
-// 		PixelIndex = GetPixelIndex(sprite, SrcX + PX, SrcY + PY);
-// 		if (sprite->PaletteCount) {
-// 			if (PixelIndex != sprite->TransparentColorIndex)
-// 				SetPixelFunction(FX, FY, GetPixelOutputColor(Pal[PixelIndex]));
-// 				// SetPixelFunction(FX, FY, Pal[PixelIndex]);
-// 		}
-// 		else if (PixelIndex & 0xFF000000U) {
-// 			SetPixelFunction(FX, FY, GetPixelOutputColor(PixelIndex));
-// 			// SetPixelFunction(FX, FY, PixelIndex);
-// 		}
-//
-// 		CONTINUE:
-//
-// 		DX++;
-// 		if (DX > Width) {
-// 			DX = 0, DY++;
-//
-// 			if (!AltPal && CenterY + DY + RealCenterY >= WaterPaletteStartLine)
-// 				AltPal = true, Pal = sprite->PaletteAlt;
-// 		}
-// 	}
-// }
-// PUBLIC STATIC void   SoftwareRenderer::DrawSpriteTransformed(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY, int scaleW, int scaleH, int angle) {
-// 	if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
-//
-// 	AnimFrame animframe = sprite->Animations[animation].Frames[frame];
-//
-// 	// TODO: Add shortcut here if angle == 0 && scaleW == 0x100 && scaleH = 0x100
-// 	// DrawSpriteNormal();
-// 	// return;
-//
-// 	int srcx = 0, srcy = 0, srcw = animframe.W, srch = animframe.H;
-// 	if (srcw >= animframe.Width- srcx)
-// 		srcw  = animframe.Width- srcx;
-// 	if (srch >= animframe.H - srcy)
-// 		srch  = animframe.H - srcy;
-//
-// 	bool AltPal = false;
-// 	Uint32 PixelIndex, *Pal = sprite->Palette;
-// 	int DX = 0, DY = 0, PX, PY, size;
-// 	int CenterX = x, CenterY = y, RealCenterX = animframe.OffX, RealCenterY = animframe.OffY;
-// 	int SrcX = animframe.X + srcx, SrcY = animframe.Y + srcy, Width = srcw - 1, Height = srch - 1;
-// 	if (flipX)
-// 		RealCenterX = -RealCenterX - Width - 1;
-// 	if (flipY)
-// 		RealCenterY = -RealCenterY - Height - 1;
-//
-// 	int minX = 0, maxX = 0, minY = 0, maxY = 0,
-// 		c0x, c0y,
-// 		mcos = Math::Cos(-angle), msin = Math::Sin(-angle),
-// 		left = RealCenterX, top = RealCenterY;
-// 	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-// 	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-// 	left += Width;
-// 	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-// 	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-// 	top += Height;
-// 	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-// 	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-// 	left = RealCenterX;
-// 	c0x = ((left) * mcos - (top) * msin); minX = Math::Min(minX, c0x); maxX = Math::Max(maxX, c0x);
-// 	c0y = ((left) * msin + (top) * mcos); minY = Math::Min(minY, c0y); maxY = Math::Max(maxY, c0y);
-//
-// 	minX >>= 16; maxX >>= 16;
-// 	minY >>= 16; maxY >>= 16;
-//
-// 	size = (maxX - minX + 1) * (maxY - minY + 1);
-//
-// 	minX *= scaleW; maxX *= scaleW;
-// 	minY *= scaleH; maxY *= scaleH;
-// 	size *= scaleW * scaleH;
-//
-// 	minX >>= 8; maxX >>= 8;
-// 	minY >>= 8; maxY >>= 8;
-// 	size >>= 16;
-//
-// 	// DrawRectangle(minX + CenterX, minY + CenterY, maxX - minX + 1, maxY - minY + 1, 0xFF00FF);
-//
-//
-// 	mcos = Math::Cos(angle);
-// 	msin = Math::Sin(angle);
-//
-// 	if (!AltPal && CenterY + DY + minY >= WaterPaletteStartLine)
-// 		AltPal = true, Pal = sprite->PaletteAlt;
-//
-// 	int NPX, NPY, X, Y, FX, FY;
-// 	for (int D = 0; D < size; D++) {
-// 		PX = DX + minX;
-// 		PY = DY + minY;
-//
-// 		NPX = PX;
-// 		NPY = PY;
-// 		NPX = (NPX << 8) / scaleW;
-// 		NPY = (NPY << 8) / scaleH;
-// 		X = (NPX * mcos - NPY * msin) >> 16;
-// 		Y = (NPX * msin + NPY * mcos) >> 16;
-//
-// 		FX = CenterX + PX;
-// 		FY = CenterY + PY;
-// 		if (FX <  Clip[0]) goto CONTINUE;
-// 		if (FY <  Clip[1]) goto CONTINUE;
-// 		if (FX >= Clip[2]) goto CONTINUE;
-// 		if (FY >= Clip[3]) return;
-//
-// 		if (X >= RealCenterX && Y >= RealCenterY && X <= RealCenterX + Width && Y <= RealCenterY + Height) {
-// 			int SX = X - RealCenterX;
-// 			int SY = Y - RealCenterY;
-// 			if (flipX)
-// 				SX = Width - SX;
-// 			if (flipY)
-// 				SY = Height - SY;
-//
-// 			PixelIndex = GetPixelIndex(sprite, SrcX + SX, SrcY + SY);
-// 			if (sprite->PaletteCount) {
-// 				if (PixelIndex != sprite->TransparentColorIndex)
-// 					SetPixelFunction(FX, FY, GetPixelOutputColor(Pal[PixelIndex]));
-// 					// SetPixelFunction(FX, FY, Pal[PixelIndex]);
-// 			}
-// 			else if (PixelIndex & 0xFF000000U) {
-// 				SetPixelFunction(FX, FY, GetPixelOutputColor(PixelIndex));
-// 				// SetPixelFunction(FX, FY, PixelIndex);
-// 			}
-// 		}
-//
-// 		CONTINUE:
-//
-// 		DX++;
-// 		if (DX >= maxX - minX + 1) {
-// 			DX = 0, DY++;
-//
-// 			if (!AltPal && CenterY + PY >= WaterPaletteStartLine)
-// 				AltPal = true, Pal = sprite->PaletteAlt;
-// 		}
-// 	}
-// }
-*/
+// NOTE: Blends "count" pixels of "src" onto "dst". With srcStep 0
+//   the same source pixel is used for the whole span (solid fills).
+//   "color" is multiplied into each source pixel first unless it is
+//   opaque white.
+void SW_BlendSpan(Uint32* dst, const Uint32* src, int srcStep, int count, int mode, Uint32 color) {
+    bool modulate = color != 0xFFFFFFFFU;
+
+    if (mode == BlendMode_NORMAL && srcStep == 0) {
+        Uint32 pixel = modulate ? ColorModulate(*src, color) : *src;
+        if ((pixel >> 24) == 0xFF) {
+            Memory::Memset4(dst, pixel, count);
+            return;
+        }
+        if ((pixel >> 24) == 0x00)
+            return;
+    }
+
+    int i = 0;
+#if defined(SW_USE_SSE2)
+    __m128i c = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), _mm_setzero_si128());
+    __m128i solid = _mm_set1_epi32((int)*src);
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = srcStep ? _mm_loadu_si128((const __m128i*)(src + i)) : solid;
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), SW_Blend4(s, d, c, mode, modulate));
+    }
+#elif defined(SW_USE_NEON)
+    uint8x16_t c = vreinterpretq_u8_u32(vdupq_n_u32(color));
+    uint8x16_t solid = vreinterpretq_u8_u32(vdupq_n_u32(*src));
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t s = srcStep ? vreinterpretq_u8_u32(vld1q_u32(src + i)) : solid;
+        uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dst + i));
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(SW_Blend4(s, d, c, mode, modulate)));
+    }
+#endif
+    for (; i < count; i++) {
+        Uint32 pixel = src[i * srcStep];
+        if (modulate)
+            pixel = ColorModulate(pixel, color);
+        dst[i] = ColorBlendMode(dst[i], pixel, mode);
+    }
+}
+
+// Texture sampling
+inline Uint32 SW_SampleTexel(Texture* texture, int x, int y) {
+    SW_TextureData* textureData = (SW_TextureData*)texture->DriverData;
+    if (texture->Format == SDL_PIXELFORMAT_INDEX8) {
+        // Indexed textures draw transparent until they get a palette
+        Uint8 index = ((Uint8*)texture->Pixels)[x + y * texture->Pitch];
+        if (!textureData->Palette || index == textureData->TransparentColorIndex || index >= textureData->PaletteCount)
+            return 0;
+        return textureData->Palette[index];
+    }
+    return ((Uint32*)texture->Pixels)[x + y * (texture->Pitch >> 2)];
+}
+void   SW_GatherSpan(Uint32* out, Texture* texture, int count, Sint64 u, Sint64 v, Sint64 du, Sint64 dv, int* srcRect, int filter) {
+    for (int i = 0; i < count; i++, u += du, v += dv) {
+        int x = (int)(u >> 16);
+        int y = (int)(v >> 16);
+        // NOTE: Rounding at the span edges can land a sample just
+        //   outside of the source rectangle.
+        if (x < srcRect[0]) x = srcRect[0];
+        if (y < srcRect[1]) y = srcRect[1];
+        if (x >= srcRect[2]) x = srcRect[2] - 1;
+        if (y >= srcRect[3]) y = srcRect[3] - 1;
+        out[i] = SW_SampleTexel(texture, x, y);
+    }
+    if (filter & Filter_GRAYSCALE) {
+        for (int i = 0; i < count; i++)
+            out[i] = FilterGrayscale(out[i]);
+    }
+}
+
+// Draw commands
+// NOTE: Draw calls are recorded with their geometry already in
+//   target space, and rasterized when the target is needed
+//   (presenting, switching targets, touching a texture). The target
+//   is cut into horizontal bands that the worker threads take in
+//   any order; each band replays the whole list in order, so
+//   overlapping draws blend exactly as they would in a single pass.
+enum {
+    SW_COMMAND_CLEAR,
+    SW_COMMAND_POLYGON,
+    SW_COMMAND_LINE,
+    SW_COMMAND_TEXTURE,
+};
+struct SW_Command {
+    int      Type;
+    int      BlendMode;
+    int      Filter;
+    Uint32   Color;
+    int      Clip[4];
+    Texture* Source;
+    int      SourceRect[4];
+    float    Data[10];
+    int      VertexStart;
+    int      VertexCount;
+};
+
+vector<SW_Command> SW_Commands;
+vector<float>      SW_CommandVertices;
+
+SDL_Thread*        SW_Threads[SW_MAX_THREADS];
+int                SW_ThreadCount = 0;
+SDL_sem*           SW_WorkSemaphore = NULL;
+SDL_sem*           SW_DoneSemaphore = NULL;
+SDL_atomic_t       SW_NextBand;
+int                SW_BandCount = 0;
+bool               SW_ThreadsQuit = false;
+
+SW_Command* SW_NewCommand(int type) {
+    if (!SW_Target.Pixels)
+        return NULL;
+
+    SW_Commands.emplace_back();
+    SW_Command* command = &SW_Commands.back();
+    command->Type = type;
+    command->BlendMode = SW_BlendMode;
+    command->Filter = SW_Filter;
+    command->Color = 0xFFFFFFFFU;
+    memcpy(command->Clip, SW_Clip, sizeof(SW_Clip));
+    return command;
+}
+bool        SW_ClipCommand(SW_Command* command, int x0, int y0, int x1, int y1) {
+    if (command->Clip[0] < x0) command->Clip[0] = x0;
+    if (command->Clip[1] < y0) command->Clip[1] = y0;
+    if (command->Clip[2] > x1) command->Clip[2] = x1;
+    if (command->Clip[3] > y1) command->Clip[3] = y1;
+    if (command->Clip[0] >= command->Clip[2] || command->Clip[1] >= command->Clip[3]) {
+        SW_Commands.pop_back();
+        return false;
+    }
+    return true;
+}
+
+// Transform and rasterization helpers
+Uint32 SW_GetBlendColor() {
+    Uint32 color = 0;
+    for (int i = 0; i < 4; i++) {
+        float c = Graphics::BlendColors[i];
+        if (c < 0.0f) c = 0.0f;
+        if (c > 1.0f) c = 1.0f;
+        color |= (Uint32)(c * 255.0f + 0.5f) << (i == 3 ? 24 : 16 - i * 8);
+    }
+    return color;
+}
+void   SW_UpdateTransform() {
+    Matrix4x4 combined;
+    Matrix4x4::Multiply(&combined, Scene::Views[Scene::ViewCurrent].ProjectionMatrix, Graphics::ModelViewMatrix.top());
+    memcpy(SW_Transform, combined.Values, sizeof(SW_Transform));
+}
+void   SW_Project(float x, float y, float* outX, float* outY) {
+    float* m = SW_Transform;
+    float cx = m[0] * x + m[4] * y + m[12];
+    float cy = m[1] * x + m[5] * y + m[13];
+    float cw = m[3] * x + m[7] * y + m[15];
+    if (cw != 0.0f && cw != 1.0f) {
+        cx /= cw;
+        cy /= cw;
+    }
+
+    // NOTE: Render targets are stored top-down with NDC -1 on the
+    //   first row, like GL framebuffer textures are. The screen has
+    //   NDC +1 on the first row.
+    Viewport* vp = &Graphics::CurrentViewport;
+    *outX = vp->X + (cx + 1.0f) * 0.5f * vp->Width;
+    if (Graphics::CurrentRenderTarget)
+        *outY = vp->Y + (cy + 1.0f) * 0.5f * vp->Height;
+    else
+        *outY = vp->Y + (1.0f - cy) * 0.5f * vp->Height;
+}
+inline int  SW_PixelStart(float x) {
+    // First pixel whose center is at or after x
+    return (int)std::ceil(x - 0.5f);
+}
+void   SW_FillPolygon(float* xs, float* ys, int n, Uint32 color) {
+    if (n < 3)
+        return;
+
+    SW_Command* command = SW_NewCommand(SW_COMMAND_POLYGON);
+    if (!command)
+        return;
+
+    float minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+    for (int i = 1; i < n; i++) {
+        if (minX > xs[i]) minX = xs[i];
+        if (maxX < xs[i]) maxX = xs[i];
+        if (minY > ys[i]) minY = ys[i];
+        if (maxY < ys[i]) maxY = ys[i];
+    }
+    if (!SW_ClipCommand(command, SW_PixelStart(minX), SW_PixelStart(minY), SW_PixelStart(maxX), SW_PixelStart(maxY)))
+        return;
+
+    command->Color = color;
+    if (SW_Filter & Filter_GRAYSCALE)
+        command->Color = FilterGrayscale(color);
+
+    command->VertexStart = (int)SW_CommandVertices.size();
+    command->VertexCount = n;
+    for (int i = 0; i < n; i++) {
+        SW_CommandVertices.push_back(xs[i]);
+        SW_CommandVertices.push_back(ys[i]);
+    }
+}
+void   SW_StrokeLineScreen(float x1, float y1, float x2, float y2, Uint32 color) {
+    if (SW_LineWidth > 1.0f) {
+        float dx = x2 - x1, dy = y2 - y1;
+        float len = std::sqrt(dx * dx + dy * dy);
+        if (len == 0.0f)
+            return;
+
+        float nx = -dy / len * SW_LineWidth * 0.5f;
+        float ny = dx / len * SW_LineWidth * 0.5f;
+        float xs[4] = { x1 + nx, x2 + nx, x2 - nx, x1 - nx };
+        float ys[4] = { y1 + ny, y2 + ny, y2 - ny, y1 - ny };
+        SW_FillPolygon(xs, ys, 4, color);
+        return;
+    }
+
+    SW_Command* command = SW_NewCommand(SW_COMMAND_LINE);
+    if (!command)
+        return;
+
+    int px1 = (int)std::floor(x1), py1 = (int)std::floor(y1);
+    int px2 = (int)std::floor(x2), py2 = (int)std::floor(y2);
+    if (!SW_ClipCommand(command,
+        px1 < px2 ? px1 : px2, py1 < py2 ? py1 : py2,
+        (px1 > px2 ? px1 : px2) + 1, (py1 > py2 ? py1 : py2) + 1))
+        return;
+
+    command->Color = color;
+    if (SW_Filter & Filter_GRAYSCALE)
+        command->Color = FilterGrayscale(color);
+
+    command->Data[0] = x1;
+    command->Data[1] = y1;
+    command->Data[2] = x2;
+    command->Data[3] = y2;
+}
+int    SW_GetEllipseSegments(float cx, float cy, float rx, float ry) {
+    float sx0, sy0, sx1, sy1, sx2, sy2;
+    SW_Project(cx, cy, &sx0, &sy0);
+    SW_Project(cx + rx, cy, &sx1, &sy1);
+    SW_Project(cx, cy + ry, &sx2, &sy2);
+
+    float r1 = std::sqrt((sx1 - sx0) * (sx1 - sx0) + (sy1 - sy0) * (sy1 - sy0));
+    float r2 = std::sqrt((sx2 - sx0) * (sx2 - sx0) + (sy2 - sy0) * (sy2 - sy0));
+    int segments = 8 + (int)(r1 > r2 ? r1 : r2);
+    if (segments > 360)
+        segments = 360;
+    return segments;
+}
+void   SW_MakeEllipse(float cx, float cy, float rx, float ry, int segments, float* xs, float* ys) {
+    for (int i = 0; i < segments; i++) {
+        float angle = i * 2.0f * (float)M_PI / segments;
+        SW_Project(cx + std::cos(angle) * rx, cy + std::sin(angle) * ry, &xs[i], &ys[i]);
+    }
+}
+void   SW_DrawTexturedQuad(Texture* texture, float sx, float sy, float sw, float sh, float x, float y, float w, float h) {
+    if (!texture || !texture->Pixels || texture->Pixels == SW_Target.Pixels)
+        return;
+
+    SW_UpdateTransform();
+
+    // Screen-space parallelogram spanned by the quad's u and v edges
+    float ox, oy, ux, uy, vx, vy;
+    SW_Project(x, y, &ox, &oy);
+    SW_Project(x + w, y, &ux, &uy);
+    SW_Project(x, y + h, &vx, &vy);
+    ux -= ox; uy -= oy;
+    vx -= ox; vy -= oy;
+
+    float det = ux * vy - uy * vx;
+    if (std::fabs(det) < 1e-6f)
+        return;
+
+    int srcRect[4];
+    srcRect[0] = (int)std::floor(sx);
+    srcRect[1] = (int)std::floor(sy);
+    srcRect[2] = (int)std::ceil(sx + sw);
+    srcRect[3] = (int)std::ceil(sy + sh);
+    if (srcRect[0] < 0) srcRect[0] = 0;
+    if (srcRect[1] < 0) srcRect[1] = 0;
+    if (srcRect[2] > (int)texture->Width) srcRect[2] = texture->Width;
+    if (srcRect[3] > (int)texture->Height) srcRect[3] = texture->Height;
+    if (srcRect[0] >= srcRect[2] || srcRect[1] >= srcRect[3])
+        return;
+
+    SW_Command* command = SW_NewCommand(SW_COMMAND_TEXTURE);
+    if (!command)
+        return;
+
+    float xs[4] = { ox, ox + ux, ox + ux + vx, ox + vx };
+    float ys[4] = { oy, oy + uy, oy + uy + vy, oy + vy };
+    float minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+    for (int i = 1; i < 4; i++) {
+        if (minX > xs[i]) minX = xs[i];
+        if (maxX < xs[i]) maxX = xs[i];
+        if (minY > ys[i]) minY = ys[i];
+        if (maxY < ys[i]) maxY = ys[i];
+    }
+    if (!SW_ClipCommand(command, SW_PixelStart(minX), SW_PixelStart(minY), SW_PixelStart(maxX), SW_PixelStart(maxY)))
+        return;
+
+    command->Color = Graphics::TextureBlend ? SW_GetBlendColor() : 0xFFFFFFFFU;
+    command->Source = texture;
+    memcpy(command->SourceRect, srcRect, sizeof(srcRect));
+
+    float* data = command->Data;
+    data[0] = ox; data[1] = oy;
+    data[2] = ux; data[3] = uy;
+    data[4] = vx; data[5] = vy;
+    data[6] = sx; data[7] = sy;
+    data[8] = sw; data[9] = sh;
+}
+
+// Command execution
+void   SW_ExecuteClear(SW_Command* command, int* clip) {
+    for (int y = clip[1]; y < clip[3]; y++)
+        memset(SW_Target.Pixels + clip[0] + y * SW_Target.Stride, 0, (clip[2] - clip[0]) * sizeof(Uint32));
+}
+void   SW_ExecutePolygon(SW_Command* command, int* clip) {
+    float* vertices = &SW_CommandVertices[command->VertexStart];
+    int n = command->VertexCount;
+
+    // NOTE: Only convex polygons are drawn (rectangles, triangles,
+    //   ellipses), so each row is covered by a single span between
+    //   the leftmost and rightmost edge crossing.
+    for (int y = clip[1]; y < clip[3]; y++) {
+        float yc = y + 0.5f;
+        float left = 1e30f, right = -1e30f;
+        for (int i = 0, j = n - 1; i < n; j = i++) {
+            float xa = vertices[j * 2], ya = vertices[j * 2 + 1];
+            float xb = vertices[i * 2], yb = vertices[i * 2 + 1];
+            if ((yc < ya) == (yc < yb))
+                continue;
+
+            float x = xa + (yc - ya) * (xb - xa) / (yb - ya);
+            if (left > x) left = x;
+            if (right < x) right = x;
+        }
+        if (left > right)
+            continue;
+
+        int x0 = SW_PixelStart(left), x1 = SW_PixelStart(right);
+        if (x0 < clip[0]) x0 = clip[0];
+        if (x1 > clip[2]) x1 = clip[2];
+        if (x0 >= x1)
+            continue;
+
+        SW_BlendSpan(SW_Target.Pixels + x0 + y * SW_Target.Stride, &command->Color, 0, x1 - x0, command->BlendMode, 0xFFFFFFFFU);
+    }
+}
+void   SW_ExecuteLine(SW_Command* command, int* clip) {
+    int x0 = (int)std::floor(command->Data[0]), y0 = (int)std::floor(command->Data[1]);
+    int xe = (int)std::floor(command->Data[2]), ye = (int)std::floor(command->Data[3]);
+    int dx = xe > x0 ? xe - x0 : x0 - xe, sx = x0 < xe ? 1 : -1;
+    int dy = ye > y0 ? ye - y0 : y0 - ye, sy = y0 < ye ? 1 : -1;
+    int err = (dx > dy ? dx : -dy) / 2, e2;
+
+    // NOTE: Every band walks the whole line so that each one plots
+    //   exactly the pixels a single pass would.
+    while (true) {
+        if (x0 >= clip[0] && y0 >= clip[1] && x0 < clip[2] && y0 < clip[3]) {
+            Uint32* dst = SW_Target.Pixels + x0 + y0 * SW_Target.Stride;
+            *dst = ColorBlendMode(*dst, command->Color, command->BlendMode);
+        }
+        if (x0 == xe && y0 == ye) break;
+        e2 = err;
+
+        if (e2 > -dx) { err -= dy; x0 += sx; }
+        if (e2 <  dy) { err += dx; y0 += sy; }
+    }
+}
+void   SW_ExecuteTexture(SW_Command* command, int* clip) {
+    Texture* texture = command->Source;
+    float* data = command->Data;
+    float ox = data[0], oy = data[1];
+    float ux = data[2], uy = data[3];
+    float vx = data[4], vy = data[5];
+    float sx = data[6], sy = data[7];
+    float sw = data[8], sh = data[9];
+    int* srcRect = command->SourceRect;
+    int x0 = clip[0], x1 = clip[2];
+
+    // Inverse mapping from screen to (u, v) in 0..1
+    float det = ux * vy - uy * vx;
+    float dudx =  vy / det, dudy = -vx / det;
+    float dvdx = -uy / det, dvdy =  ux / det;
+
+    bool canCopyRows = texture->Format != SDL_PIXELFORMAT_INDEX8 && !(command->Filter & Filter_GRAYSCALE);
+
+    Sint64 du = (Sint64)std::floor(dudx * sw * 65536.0f + 0.5f);
+    Sint64 dv = (Sint64)std::floor(dvdx * sh * 65536.0f + 0.5f);
+
+    Uint32 spanBuffer[SW_SPAN_CHUNK];
+    for (int py = clip[1]; py < clip[3]; py++) {
+        float cy = py + 0.5f - oy;
+        float cx = x0 + 0.5f - ox;
+        float u = cx * dudx + cy * dudy;
+        float v = cx * dvdx + cy * dvdy;
+
+        // Find the pixels of this row where 0 <= u, v < 1
+        float lo = (float)x0, hi = (float)x1;
+        float bounds[2][2] = { { u, dudx }, { v, dvdx } };
+        for (int b = 0; b < 2; b++) {
+            float start = bounds[b][0], step = bounds[b][1];
+            if (step == 0.0f) {
+                if (start < 0.0f || start >= 1.0f)
+                    hi = lo;
+                continue;
+            }
+            float e0 = x0 + (0.0f - start) / step;
+            float e1 = x0 + (1.0f - start) / step;
+            if (e0 > e1) { float t = e0; e0 = e1; e1 = t; }
+            if (lo < e0) lo = e0;
+            if (hi > e1) hi = e1;
+        }
+        int spanX0 = (int)std::ceil(lo);
+        int spanX1 = (int)std::ceil(hi);
+        if (spanX0 < x0) spanX0 = x0;
+        if (spanX1 > x1) spanX1 = x1;
+        if (spanX0 >= spanX1)
+            continue;
+
+        float uStart = u + (spanX0 - x0) * dudx;
+        float vStart = v + (spanX0 - x0) * dvdx;
+        Sint64 tu = (Sint64)std::floor((sx + uStart * sw) * 65536.0f);
+        Sint64 tv = (Sint64)std::floor((sy + vStart * sh) * 65536.0f);
+
+        Uint32* dst = SW_Target.Pixels + spanX0 + py * SW_Target.Stride;
+        int count = spanX1 - spanX0;
+
+        // NOTE: Unscaled, unrotated and unflipped rows are blended
+        //   straight out of the texture.
+        if (canCopyRows && du == 0x10000 && dv == 0) {
+            int tx = (int)(tu >> 16), ty = (int)(tv >> 16);
+            if (tx >= srcRect[0] && ty >= srcRect[1] && ty < srcRect[3] && tx + count <= srcRect[2]) {
+                Uint32* src = (Uint32*)texture->Pixels + tx + ty * (texture->Pitch >> 2);
+                SW_BlendSpan(dst, src, 1, count, command->BlendMode, command->Color);
+                continue;
+            }
+        }
+
+        while (count > 0) {
+            int chunk = count < SW_SPAN_CHUNK ? count : SW_SPAN_CHUNK;
+            SW_GatherSpan(spanBuffer, texture, chunk, tu, tv, du, dv, srcRect, command->Filter);
+            SW_BlendSpan(dst, spanBuffer, 1, chunk, command->BlendMode, command->Color);
+            tu += du * chunk;
+            tv += dv * chunk;
+            dst += chunk;
+            count -= chunk;
+        }
+    }
+}
+void   SW_ExecuteBand(int y0, int y1) {
+    int clip[4];
+    for (size_t i = 0; i < SW_Commands.size(); i++) {
+        SW_Command* command = &SW_Commands[i];
+        if (command->Clip[3] <= y0 || command->Clip[1] >= y1)
+            continue;
+
+        clip[0] = command->Clip[0];
+        clip[1] = command->Clip[1] > y0 ? command->Clip[1] : y0;
+        clip[2] = command->Clip[2];
+        clip[3] = command->Clip[3] < y1 ? command->Clip[3] : y1;
+
+        switch (command->Type) {
+            case SW_COMMAND_CLEAR:   SW_ExecuteClear(command, clip); break;
+            case SW_COMMAND_POLYGON: SW_ExecutePolygon(command, clip); break;
+            case SW_COMMAND_LINE:    SW_ExecuteLine(command, clip); break;
+            case SW_COMMAND_TEXTURE: SW_ExecuteTexture(command, clip); break;
+        }
+    }
+}
+void   SW_ExecuteBands() {
+    int band;
+    while ((band = SDL_AtomicAdd(&SW_NextBand, 1)) < SW_BandCount) {
+        int y0 = band * SW_BAND_HEIGHT;
+        int y1 = y0 + SW_BAND_HEIGHT;
+        if (y1 > SW_Target.Height)
+            y1 = SW_Target.Height;
+        SW_ExecuteBand(y0, y1);
+    }
+}
+int    SW_WorkerThread(void* data) {
+    while (true) {
+        SDL_SemWait(SW_WorkSemaphore);
+        if (SW_ThreadsQuit)
+            break;
+
+        SW_ExecuteBands();
+        SDL_SemPost(SW_DoneSemaphore);
+    }
+    return 0;
+}
+void   SW_FlushCommands() {
+    if (SW_Commands.size() == 0)
+        return;
+
+    if (SW_Target.Pixels) {
+        SW_BandCount = (SW_Target.Height + SW_BAND_HEIGHT - 1) / SW_BAND_HEIGHT;
+        SDL_AtomicSet(&SW_NextBand, 0);
+
+        int workers = SW_ThreadCount;
+        if (workers > SW_BandCount - 1)
+            workers = SW_BandCount - 1;
+
+        for (int i = 0; i < workers; i++)
+            SDL_SemPost(SW_WorkSemaphore);
+
+        SW_ExecuteBands();
+
+        for (int i = 0; i < workers; i++)
+            SDL_SemWait(SW_DoneSemaphore);
+    }
+
+    SW_Commands.clear();
+    SW_CommandVertices.clear();
+}
+void   SW_StartThreads() {
+    int threadCount = SDL_GetCPUCount();
+    if (Application::Settings)
+        Application::Settings->GetInteger("dev", "softwareThreads", &threadCount);
+
+    // The calling thread renders a share of the bands too
+    SW_ThreadCount = threadCount - 1;
+    if (SW_ThreadCount < 0)
+        SW_ThreadCount = 0;
+    if (SW_ThreadCount > SW_MAX_THREADS)
+        SW_ThreadCount = SW_MAX_THREADS;
+    if (SW_ThreadCount == 0)
+        return;
+
+    SW_ThreadsQuit = false;
+    SW_WorkSemaphore = SDL_CreateSemaphore(0);
+    SW_DoneSemaphore = SDL_CreateSemaphore(0);
+    for (int i = 0; i < SW_ThreadCount; i++)
+        SW_Threads[i] = SDL_CreateThread(SW_WorkerThread, "SoftwareRenderer::WorkerThread", NULL);
+}
+void   SW_StopThreads() {
+    if (SW_ThreadCount == 0)
+        return;
+
+    SW_ThreadsQuit = true;
+    for (int i = 0; i < SW_ThreadCount; i++)
+        SDL_SemPost(SW_WorkSemaphore);
+    for (int i = 0; i < SW_ThreadCount; i++)
+        SDL_WaitThread(SW_Threads[i], NULL);
+
+    SDL_DestroySemaphore(SW_WorkSemaphore);
+    SDL_DestroySemaphore(SW_DoneSemaphore);
+    SW_WorkSemaphore = NULL;
+    SW_DoneSemaphore = NULL;
+    SW_ThreadCount = 0;
+}
+void   SW_ResizeFrameBuffer(int width, int height) {
+    if (width == SoftwareRenderer::FrameBufferWidth && height == SoftwareRenderer::FrameBufferHeight && SoftwareRenderer::FrameBuffer)
+        return;
+
+    SW_FlushCommands();
+    if (SoftwareRenderer::FrameBuffer)
+        Memory::Free(SoftwareRenderer::FrameBuffer);
+
+    SoftwareRenderer::FrameBuffer = (Uint32*)Memory::TrackedCalloc("SoftwareRenderer::FrameBuffer", width * height, sizeof(Uint32));
+    SoftwareRenderer::FrameBufferWidth = width;
+    SoftwareRenderer::FrameBufferHeight = height;
+
+    if (!Graphics::CurrentRenderTarget) {
+        SW_Target.Pixels = SoftwareRenderer::FrameBuffer;
+        SW_Target.Width = width;
+        SW_Target.Height = height;
+        SW_Target.Stride = width;
+    }
+}
+void   SW_YUVToARGB(Uint8 y, Uint8 u, Uint8 v, Uint32* out) {
+    int c = (int)y - 16, d = (int)u - 128, e = (int)v - 128;
+    int r = (298 * c + 409 * e + 128) >> 8;
+    int g = (298 * c - 100 * d - 208 * e + 128) >> 8;
+    int b = (298 * c + 516 * d + 128) >> 8;
+    r = r < 0 ? 0 : r > 255 ? 255 : r;
+    g = g < 0 ? 0 : g > 255 ? 255 : g;
+    b = b < 0 ? 0 : b > 255 ? 255 : b;
+    *out = 0xFF000000U | r << 16 | g << 8 | b;
+}
 
 // Initialization and disposal functions
 PUBLIC STATIC void     SoftwareRenderer::Init() {
-    SoftwareRenderer::BackendFunctions.Init();
-
-    // PixelFunction = SetPixelNormal;
-	// FilterFunction[0] = FilterNone;
-	// FilterFunction[1] = FilterNone;
-	// FilterFunction[2] = FilterNone;
-	// FilterFunction[3] = FilterNone;
-    //
-	// Deform = (Sint8*)Memory::TrackedCalloc("SoftwareRenderer::DeformMap", Application::HEIGHT, 1);
-    //
-	// Clip[0] = 0;
-	// Clip[1] = 0;
-	// Clip[2] = Application::WIDTH;
-	// Clip[3] = Application::HEIGHT;
-    // ClipSet = false;
-    //
-	// for (int i = 0; i < 0x100; i++)
-	// 	DivideBy3Table[i] = i / 3;
-    //
-	// FrameBufferSize = Application::WIDTH * Application::HEIGHT;
-	// FrameBuffer = (Uint32*)Memory::TrackedCalloc("SoftwareRenderer::FrameBuffer", FrameBufferSize, sizeof(Uint32));
-	// FrameBufferStride = Application::WIDTH;
-    //
-	// ResourceStream* res;
-    // if ((res = ResourceStream::New("Sprites/UI/DevFont.bin"))) {
-    // 	res->ReadBytes(BitmapFont, 0x400);
-    //     res->Close();
-    // }
+    Graphics::SupportsBatching = false;
+    Graphics::PreferredPixelFormat = SDL_PIXELFORMAT_ARGB8888;
+
+    Graphics::MaxTextureWidth = SW_MAX_TEXTURE_SIZE;
+    Graphics::MaxTextureHeight = SW_MAX_TEXTURE_SIZE;
+
+    #if defined(SW_USE_SSE2)
+        Log::Print(Log::LOG_INFO, "Renderer: Software (SSE2)");
+    #elif defined(SW_USE_NEON)
+        Log::Print(Log::LOG_INFO, "Renderer: Software (NEON)");
+    #else
+        Log::Print(Log::LOG_INFO, "Renderer: Software");
+    #endif
+
+    int w, h;
+    SDL_GetWindowSize(Application::Window, &w, &h);
+    SW_ResizeFrameBuffer(w, h);
+
+    SW_StartThreads();
+    Log::Print(Log::LOG_VERBOSE, "Software Renderer Threads: %d", SW_ThreadCount + 1);
+
+    SW_BlendMode = BlendMode_NORMAL;
+    SoftwareRenderer::UpdateViewport();
+    SoftwareRenderer::UpdateClipRect();
 }
 PUBLIC STATIC Uint32   SoftwareRenderer::GetWindowFlags() {
-    return SoftwareRenderer::BackendFunctions.GetWindowFlags();
-}
-PUBLIC STATIC void     SoftwareRenderer::SetGraphicsFunctions(void* baseGFXfunctions) {
-    ((void(*)())baseGFXfunctions)();
-    SoftwareRenderer::BackendFunctions = Graphics::Internal; // memcpy(&SoftwareRenderer::BackendFunctions, Graphics::Internal, sizeof(Graphics::Internal));
-
-    return;
-
-    // Graphics::Internal.Init = SoftwareRenderer::Init;
-    // Graphics::Internal.GetWindowFlags = SoftwareRenderer::GetWindowFlags;
-    // Graphics::Internal.Dispose = SoftwareRenderer::Dispose;
-    //
-    // // Texture management functions
-    // Graphics::Internal.CreateTexture = SoftwareRenderer::CreateTexture;
-    // Graphics::Internal.LockTexture = SoftwareRenderer::LockTexture;
-    // Graphics::Internal.UpdateTexture = SoftwareRenderer::UpdateTexture;
-    // Graphics::Internal.UpdateYUVTexture = SoftwareRenderer::UpdateTextureYUV;
-    // Graphics::Internal.UnlockTexture = SoftwareRenderer::UnlockTexture;
-    // Graphics::Internal.DisposeTexture = SoftwareRenderer::DisposeTexture;
-    //
-    // // Viewport and view-related functions
-    // Graphics::Internal.SetRenderTarget = SoftwareRenderer::SetRenderTarget;
-    // Graphics::Internal.UpdateWindowSize = SoftwareRenderer::UpdateWindowSize;
-    // Graphics::Internal.UpdateViewport = SoftwareRenderer::UpdateViewport;
-    // Graphics::Internal.UpdateClipRect = SoftwareRenderer::UpdateClipRect;
-    // Graphics::Internal.UpdateOrtho = SoftwareRenderer::UpdateOrtho;
-    // Graphics::Internal.UpdatePerspective = SoftwareRenderer::UpdatePerspective;
-    // Graphics::Internal.UpdateProjectionMatrix = SoftwareRenderer::UpdateProjectionMatrix;
-    //
-    // // Shader-related functions
-    // Graphics::Internal.UseShader = SoftwareRenderer::UseShader;
-    // Graphics::Internal.SetUniformF = SoftwareRenderer::SetUniformF;
-    // Graphics::Internal.SetUniformI = SoftwareRenderer::SetUniformI;
-    // Graphics::Internal.SetUniformTexture = SoftwareRenderer::SetUniformTexture;
-    //
-    // // These guys
-    // Graphics::Internal.Clear = SoftwareRenderer::Clear;
-    // Graphics::Internal.Present = SoftwareRenderer::Present;
-    //
-    // // Draw mode setting functions
-    // Graphics::Internal.SetBlendColor = SoftwareRenderer::SetBlendColor;
-    // Graphics::Internal.SetBlendMode = SoftwareRenderer::SetBlendMode;
-    // Graphics::Internal.SetLineWidth = SoftwareRenderer::SetLineWidth;
-    //
-    // // Primitive drawing functions
-    // Graphics::Internal.StrokeLine = SoftwareRenderer::StrokeLine;
-    // Graphics::Internal.StrokeCircle = SoftwareRenderer::StrokeCircle;
-    // Graphics::Internal.StrokeEllipse = SoftwareRenderer::StrokeEllipse;
-    // Graphics::Internal.StrokeRectangle = SoftwareRenderer::StrokeRectangle;
-    // Graphics::Internal.FillCircle = SoftwareRenderer::FillCircle;
-    // Graphics::Internal.FillEllipse = SoftwareRenderer::FillEllipse;
-    // Graphics::Internal.FillTriangle = SoftwareRenderer::FillTriangle;
-    // Graphics::Internal.FillRectangle = SoftwareRenderer::FillRectangle;
-    //
-    // // Texture drawing functions
-    // Graphics::Internal.DrawTexture = SoftwareRenderer::DrawTexture;
-    // Graphics::Internal.DrawSprite = SoftwareRenderer::DrawSprite;
-    // Graphics::Internal.DrawSpritePart = SoftwareRenderer::DrawSpritePart;
-    // Graphics::Internal.MakeFrameBufferID = SoftwareRenderer::MakeFrameBufferID;
+    return 0;
+}
+PUBLIC STATIC void     SoftwareRenderer::SetGraphicsFunctions() {
+    Graphics::Internal.Init = SoftwareRenderer::Init;
+    Graphics::Internal.GetWindowFlags = SoftwareRenderer::GetWindowFlags;
+    Graphics::Internal.Dispose = SoftwareRenderer::Dispose;
+
+    // Texture management functions
+    Graphics::Internal.CreateTexture = SoftwareRenderer::CreateTexture;
+    Graphics::Internal.LockTexture = SoftwareRenderer::LockTexture;
+    Graphics::Internal.UpdateTexture = SoftwareRenderer::UpdateTexture;
+    Graphics::Internal.UpdateYUVTexture = SoftwareRenderer::UpdateYUVTexture;
+    Graphics::Internal.UnlockTexture = SoftwareRenderer::UnlockTexture;
+    Graphics::Internal.DisposeTexture = SoftwareRenderer::DisposeTexture;
+    Graphics::Internal.SetTexturePalette = SoftwareRenderer::SetTexturePalette;
+
+    // Viewport and view-related functions
+    Graphics::Internal.SetRenderTarget = SoftwareRenderer::SetRenderTarget;
+    Graphics::Internal.UpdateWindowSize = SoftwareRenderer::UpdateWindowSize;
+    Graphics::Internal.UpdateViewport = SoftwareRenderer::UpdateViewport;
+    Graphics::Internal.UpdateClipRect = SoftwareRenderer::UpdateClipRect;
+    Graphics::Internal.UpdateOrtho = SoftwareRenderer::UpdateOrtho;
+    Graphics::Internal.UpdatePerspective = SoftwareRenderer::UpdatePerspective;
+    Graphics::Internal.UpdateProjectionMatrix = SoftwareRenderer::UpdateProjectionMatrix;
+
+    // Shader-related functions
+    Graphics::Internal.UseShader = SoftwareRenderer::UseShader;
+    Graphics::Internal.SetUniformF = SoftwareRenderer::SetUniformF;
+    Graphics::Internal.SetUniformI = SoftwareRenderer::SetUniformI;
+    Graphics::Internal.SetUniformTexture = SoftwareRenderer::SetUniformTexture;
+
+    // These guys
+    Graphics::Internal.Clear = SoftwareRenderer::Clear;
+    Graphics::Internal.Present = SoftwareRenderer::Present;
+
+    // Draw mode setting functions
+    Graphics::Internal.SetBlendColor = SoftwareRenderer::SetBlendColor;
+    Graphics::Internal.SetBlendMode = SoftwareRenderer::SetBlendMode;
+    Graphics::Internal.SetLineWidth = SoftwareRenderer::SetLineWidth;
+    Graphics::Internal.SetFilter = SoftwareRenderer::SetFilter;
+
+    // Primitive drawing functions
+    Graphics::Internal.StrokeLine = SoftwareRenderer::StrokeLine;
+    Graphics::Internal.StrokeCircle = SoftwareRenderer::StrokeCircle;
+    Graphics::Internal.StrokeEllipse = SoftwareRenderer::StrokeEllipse;
+    Graphics::Internal.StrokeRectangle = SoftwareRenderer::StrokeRectangle;
+    Graphics::Internal.FillCircle = SoftwareRenderer::FillCircle;
+    Graphics::Internal.FillEllipse = SoftwareRenderer::FillEllipse;
+    Graphics::Internal.FillTriangle = SoftwareRenderer::FillTriangle;
+    Graphics::Internal.FillRectangle = SoftwareRenderer::FillRectangle;
+
+    // Texture drawing functions
+    Graphics::Internal.DrawTexture = SoftwareRenderer::DrawTexture;
+    Graphics::Internal.DrawSprite = SoftwareRenderer::DrawSprite;
+    Graphics::Internal.DrawSpritePart = SoftwareRenderer::DrawSpritePart;
+    Graphics::Internal.MakeFrameBufferID = NULL;
 }
 PUBLIC STATIC void     SoftwareRenderer::Dispose() {
-	// Memory::Free(Deform);
-	// Memory::Free(FrameBuffer);
-	// SDL_FreeSurface(WindowScreen);
-	// SDL_DestroyTexture(ScreenTexture);
-	// SDL_DestroyWindow(Window);
-    //
-	// Screen->pixels = ScreenOriginalPixels;
-	// SDL_FreeSurface(Screen);
-    SoftwareRenderer::BackendFunctions.Dispose();
+    SW_FlushCommands();
+    SW_StopThreads();
+
+    if (SoftwareRenderer::FrameBuffer)
+        Memory::Free(SoftwareRenderer::FrameBuffer);
+
+    SoftwareRenderer::FrameBuffer = NULL;
+    SoftwareRenderer::FrameBufferWidth = 0;
+    SoftwareRenderer::FrameBufferHeight = 0;
+    SW_Target.Pixels = NULL;
 }
 
 // Texture management functions
 PUBLIC STATIC Texture* SoftwareRenderer::CreateTexture(Uint32 format, Uint32 access, Uint32 width, Uint32 height) {
     Texture* texture = Texture::New(format, access, width, height);
+    texture->DriverData = Memory::TrackedCalloc("Texture::DriverData", 1, sizeof(SW_TextureData));
+
+    // NOTE: Everything but paletted textures is stored as ARGB8888;
+    //   other formats are converted when uploaded.
+    if (format == SDL_PIXELFORMAT_INDEX8)
+        texture->Pitch = width;
+    else
+        texture->Pitch = width * sizeof(Uint32);
 
-    return NULL;
+    texture->Pixels = Memory::TrackedCalloc("Texture::Pixels", texture->Pitch, height);
+
+    texture->ID = SW_NextTextureID++;
+    Graphics::TextureMap->Put(texture->ID, texture);
+
+    return texture;
 }
 PUBLIC STATIC int      SoftwareRenderer::LockTexture(Texture* texture, void** pixels, int* pitch) {
+    if (!texture)
+        return -1;
+
+    SW_FlushCommands();
+
+    *pixels = texture->Pixels;
+    *pitch = texture->Pitch;
     return 0;
 }
 PUBLIC STATIC int      SoftwareRenderer::UpdateTexture(Texture* texture, SDL_Rect* src, void* pixels, int pitch) {
+    if (!texture || !pixels)
+        return -1;
+
+    SW_FlushCommands();
+
+    int inputPixelsX = 0;
+    int inputPixelsY = 0;
+    int inputPixelsW = texture->Width;
+    int inputPixelsH = texture->Height;
+    if (src) {
+        inputPixelsX = src->x;
+        inputPixelsY = src->y;
+        inputPixelsW = src->w;
+        inputPixelsH = src->h;
+    }
+
+    int bpp = texture->Format == SDL_PIXELFORMAT_INDEX8 ? 1 : 4;
+    Uint8* dst = (Uint8*)texture->Pixels + inputPixelsX * bpp + inputPixelsY * texture->Pitch;
+
+    if (texture->Format != SDL_PIXELFORMAT_ARGB8888 && texture->Format != SDL_PIXELFORMAT_INDEX8) {
+        return SDL_ConvertPixels(inputPixelsW, inputPixelsH,
+            texture->Format, pixels, pitch,
+            SDL_PIXELFORMAT_ARGB8888, dst, texture->Pitch);
+    }
+
+    for (int y = 0; y < inputPixelsH; y++) {
+        memcpy(dst, (Uint8*)pixels + y * pitch, inputPixelsW * bpp);
+        dst += texture->Pitch;
+    }
     return 0;
 }
-PUBLIC STATIC int      SoftwareRenderer::UpdateYUVTexture(Texture* texture, SDL_Rect* src, Uint8* pixelsY, int pitchY, Uint8* pixelsU, int pitchU, Uint8* pixelsV, int pitchV) {
+PUBLIC STATIC int      SoftwareRenderer::UpdateYUVTexture(Texture* texture, SDL_Rect* src, void* pixelsY, int pitchY, void* pixelsU, int pitchU, void* pixelsV, int pitchV) {
+    if (!texture)
+        return -1;
+
+    SW_FlushCommands();
+
+    int inputPixelsX = 0;
+    int inputPixelsY = 0;
+    int inputPixelsW = texture->Width;
+    int inputPixelsH = texture->Height;
+    if (src) {
+        inputPixelsX = src->x;
+        inputPixelsY = src->y;
+        inputPixelsW = src->w;
+        inputPixelsH = src->h;
+    }
+
+    for (int y = 0; y < inputPixelsH; y++) {
+        Uint8*  rowY = (Uint8*)pixelsY + y * pitchY;
+        Uint8*  rowU = (Uint8*)pixelsU + (y >> 1) * pitchU;
+        Uint8*  rowV = (Uint8*)pixelsV + (y >> 1) * pitchV;
+        Uint32* dst = (Uint32*)texture->Pixels + inputPixelsX + (inputPixelsY + y) * (texture->Pitch >> 2);
+        for (int x = 0; x < inputPixelsW; x++)
+            SW_YUVToARGB(rowY[x], rowU[x >> 1], rowV[x >> 1], &dst[x]);
+    }
     return 0;
 }
 PUBLIC STATIC void     SoftwareRenderer::UnlockTexture(Texture* texture) {
 
 }
 PUBLIC STATIC void     SoftwareRenderer::DisposeTexture(Texture* texture) {
+    SW_TextureData* textureData = (SW_TextureData*)texture->DriverData;
+    if (!textureData)
+        return;
+
+    SW_FlushCommands();
+    if (SW_Target.Pixels == texture->Pixels)
+        SW_Target.Pixels = NULL;
 
+    if (textureData->Palette)
+        Memory::Free(textureData->Palette);
+
+    Memory::Free(texture->Pixels);
+    Memory::Free(texture->DriverData);
+    texture->Pixels = NULL;
+    texture->DriverData = NULL;
+}
+PUBLIC STATIC bool     SoftwareRenderer::SetTexturePalette(Texture* texture, Uint32* palette, int count, int transparentIndex) {
+    if (!texture || texture->Format != SDL_PIXELFORMAT_INDEX8)
+        return false;
+
+    SW_FlushCommands();
+
+    SW_TextureData* textureData = (SW_TextureData*)texture->DriverData;
+    if (count > 256)
+        count = 256;
+
+    if (!textureData->Palette)
+        textureData->Palette = (Uint32*)Memory::TrackedCalloc("Texture::Palette", 256, sizeof(Uint32));
+
+    memcpy(textureData->Palette, palette, count * sizeof(Uint32));
+    textureData->PaletteCount = count;
+    textureData->TransparentColorIndex = transparentIndex;
+    return true;
 }
 
 // Viewport and view-related functions
 PUBLIC STATIC void     SoftwareRenderer::SetRenderTarget(Texture* texture) {
+    SW_FlushCommands();
+
+    if (texture == NULL) {
+        SW_Target.Pixels = SoftwareRenderer::FrameBuffer;
+        SW_Target.Width = SoftwareRenderer::FrameBufferWidth;
+        SW_Target.Height = SoftwareRenderer::FrameBufferHeight;
+        SW_Target.Stride = SoftwareRenderer::FrameBufferWidth;
+    }
+    else {
+        if (texture->Format == SDL_PIXELFORMAT_INDEX8) {
+            Log::Print(Log::LOG_WARN, "Cannot render to paletted texture!");
+            return;
+        }
+
+        SW_Target.Pixels = (Uint32*)texture->Pixels;
+        SW_Target.Width = texture->Width;
+        SW_Target.Height = texture->Height;
+        SW_Target.Stride = texture->Pitch >> 2;
+    }
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdateWindowSize(int width, int height) {
+    SW_ResizeFrameBuffer(width, height);
+    SoftwareRenderer::UpdateViewport();
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdateViewport() {
+    SoftwareRenderer::UpdateClipRect();
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdateClipRect() {
+    // NOTE: GL clips everything to the viewport, and additionally
+    //   to the scissor rectangle when a clip is set.
+    Viewport* vp = &Graphics::CurrentViewport;
+    float x0 = vp->X, y0 = vp->Y;
+    float x1 = vp->X + vp->Width, y1 = vp->Y + vp->Height;
+
+    ClipArea clip = Graphics::CurrentClip;
+    if (clip.Enabled) {
+        float scaleW = 1.0f, scaleH = 1.0f;
+        if (!Graphics::CurrentRenderTarget) {
+            View* currentView = &Scene::Views[Scene::ViewCurrent];
+            if (currentView->Width > 0.0f && currentView->Height > 0.0f) {
+                scaleW = SW_Target.Width / currentView->Width;
+                scaleH = SW_Target.Height / currentView->Height;
+            }
+        }
+
+        float cx0 = (vp->X + clip.X) * scaleW, cy0 = (vp->Y + clip.Y) * scaleH;
+        float cx1 = cx0 + clip.Width * scaleW, cy1 = cy0 + clip.Height * scaleH;
+        if (x0 < cx0) x0 = cx0;
+        if (y0 < cy0) y0 = cy0;
+        if (x1 > cx1) x1 = cx1;
+        if (y1 > cy1) y1 = cy1;
+    }
+
+    SW_Clip[0] = (int)x0;
+    SW_Clip[1] = (int)y0;
+    SW_Clip[2] = (int)x1;
+    SW_Clip[3] = (int)y1;
+    if (SW_Clip[0] < 0) SW_Clip[0] = 0;
+    if (SW_Clip[1] < 0) SW_Clip[1] = 0;
+    if (SW_Clip[2] > SW_Target.Width) SW_Clip[2] = SW_Target.Width;
+    if (SW_Clip[3] > SW_Target.Height) SW_Clip[3] = SW_Target.Height;
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdateOrtho(float left, float top, float right, float bottom) {
+    Matrix4x4::Ortho(Scene::Views[Scene::ViewCurrent].BaseProjectionMatrix, left, right, top, bottom, -500.0f, 500.0f);
+    Matrix4x4::Copy(Scene::Views[Scene::ViewCurrent].ProjectionMatrix, Scene::Views[Scene::ViewCurrent].BaseProjectionMatrix);
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdatePerspective(float fovy, float aspect, float nearv, float farv) {
+    Matrix4x4::Perspective(Scene::Views[Scene::ViewCurrent].BaseProjectionMatrix, fovy, aspect, nearv, farv);
+    Matrix4x4::Copy(Scene::Views[Scene::ViewCurrent].ProjectionMatrix, Scene::Views[Scene::ViewCurrent].BaseProjectionMatrix);
+}
+PUBLIC STATIC void     SoftwareRenderer::UpdateProjectionMatrix() {
 
 }
 
 // Shader-related functions
 PUBLIC STATIC void     SoftwareRenderer::UseShader(void* shader) {
-    // NOTE: THESE WILL JUST BE A POINTER TO AN ARRAY of 0x10000 Uint16s
-
-    // Override shader
-    // if (Graphics::CurrentShader)
-    //     shader = Graphics::CurrentShader;
-    //
-    // if (GLRenderer::CurrentShader != (GLShader*)shader) {
-    //     GLRenderer::CurrentShader = (GLShader*)shader;
-    //     GLRenderer::CurrentShader->Use();
-    //     // glEnableVertexAttribArray(CurrentShader->LocTexCoord);
-    //
-    //     glActiveTexture(GL_TEXTURE0); CHECK_GL();
-    //     glUniform1i(GLRenderer::CurrentShader->LocTexture, 0); CHECK_GL();
-    // }
+
 }
 PUBLIC STATIC void     SoftwareRenderer::SetUniformF(int location, int count, float* values) {
 
@@ -1458,112 +1124,177 @@ PUBLIC STATIC void     SoftwareRenderer::SetUniformTexture(Texture* texture, int
 
 // These guys
 PUBLIC STATIC void     SoftwareRenderer::Clear() {
-
+    SW_Command* command = SW_NewCommand(SW_COMMAND_CLEAR);
+    if (!command)
+        return;
+
+    // NOTE: Like glClear, this ignores the viewport but respects
+    //   the clip rectangle.
+    if (!Graphics::CurrentClip.Enabled) {
+        command->Clip[0] = 0;
+        command->Clip[1] = 0;
+        command->Clip[2] = SW_Target.Width;
+        command->Clip[3] = SW_Target.Height;
+    }
+    SW_ClipCommand(command, 0, 0, SW_Target.Width, SW_Target.Height);
 }
 PUBLIC STATIC void     SoftwareRenderer::Present() {
+    SW_FlushCommands();
 
-}
+    SDL_Surface* surface = SDL_GetWindowSurface(Application::Window);
+    if (!surface || !SoftwareRenderer::FrameBuffer)
+        return;
 
-// Draw mode setting functions
-PUBLIC STATIC void     SoftwareRenderer::SetBlendColor(float r, float g, float b, float a) {
+    int w = surface->w < SoftwareRenderer::FrameBufferWidth ? surface->w : SoftwareRenderer::FrameBufferWidth;
+    int h = surface->h < SoftwareRenderer::FrameBufferHeight ? surface->h : SoftwareRenderer::FrameBufferHeight;
 
-}
-PUBLIC STATIC void     SoftwareRenderer::SetBlendMode(int srcC, int dstC, int srcA, int dstA) {
+    if (SDL_MUSTLOCK(surface))
+        SDL_LockSurface(surface);
 
-}
+    SDL_ConvertPixels(w, h,
+        SDL_PIXELFORMAT_ARGB8888, SoftwareRenderer::FrameBuffer, SoftwareRenderer::FrameBufferWidth * sizeof(Uint32),
+        surface->format->format, surface->pixels, surface->pitch);
 
-PUBLIC STATIC void     SoftwareRenderer::Resize(int width, int height) {
-    // Deform = (Sint8*)Memory::Realloc(Deform, height);
-    // // memset(Deform + last_height, 0, height - last_height);
-    //
-    // if (!ClipSet) {
-    //     Clip[0] = 0;
-    // 	Clip[1] = 0;
-    // 	Clip[2] = width;
-    // 	Clip[3] = height;
-    // }
-    //
-	// FrameBuffer = (Uint32*)Memory::Realloc(FrameBuffer, width * height * sizeof(Uint32));
-    // if (width * height - FrameBufferSize > 0)
-    //     memset(FrameBuffer + FrameBufferSize, 0, width * height - FrameBufferSize);
-    // FrameBufferSize = width * height;
-	// FrameBufferStride = width;
-}
+    if (SDL_MUSTLOCK(surface))
+        SDL_UnlockSurface(surface);
 
-PUBLIC STATIC void     SoftwareRenderer::SetClip(float x, float y, float width, float height) {
-    // ClipSet = true;
-    //
-    // Clip[0] = (int)x;
-	// Clip[1] = (int)y;
-	// Clip[2] = (int)x + (int)w;
-	// Clip[3] = (int)y + (int)h;
-    //
-	// if (Clip[0] < 0)
-	// 	Clip[0] = 0;
-	// if (Clip[1] < 0)
-	// 	Clip[1] = 0;
-	// if (Clip[2] > Application::WIDTH)
-	// 	Clip[2] = Application::WIDTH;
-	// if (Clip[3] > Application::HEIGHT)
-	// 	Clip[3] = Application::HEIGHT;
-}
-PUBLIC STATIC void     SoftwareRenderer::ClearClip() {
-    // ClipSet = false;
-    //
-    // Clip[0] = 0;
-	// Clip[1] = 0;
-	// Clip[2] = Application::WIDTH;
-	// Clip[3] = Application::HEIGHT;
+    SDL_UpdateWindowSurface(Application::Window);
+
+    // Follow the window if it was resized without an event
+    if (surface->w != SoftwareRenderer::FrameBufferWidth || surface->h != SoftwareRenderer::FrameBufferHeight)
+        SoftwareRenderer::UpdateWindowSize(surface->w, surface->h);
 }
 
-PUBLIC STATIC void     SoftwareRenderer::Save() {
+// Draw mode setting functions
+PUBLIC STATIC void     SoftwareRenderer::SetBlendColor(float r, float g, float b, float a) {
 
 }
-PUBLIC STATIC void     SoftwareRenderer::Translate(float x, float y, float z) {
-
+PUBLIC STATIC void     SoftwareRenderer::SetBlendMode(int srcC, int dstC, int srcA, int dstA) {
+    // NOTE: Only the factor combinations that Draw.SetBlendMode
+    //   produces are supported; anything else blends normally.
+    if (srcC == BlendFactor_SRC_ALPHA && dstC == BlendFactor_ONE)
+        SW_BlendMode = BlendMode_ADD;
+    else if (srcC == BlendFactor_SRC_ALPHA && dstC == BlendFactor_INV_SRC_COLOR)
+        SW_BlendMode = BlendMode_MAX;
+    else if (srcC == BlendFactor_ZERO && dstC == BlendFactor_INV_SRC_COLOR)
+        SW_BlendMode = BlendMode_SUBTRACT;
+    else
+        SW_BlendMode = BlendMode_NORMAL;
 }
-PUBLIC STATIC void     SoftwareRenderer::Rotate(float x, float y, float z) {
-
+PUBLIC STATIC void     SoftwareRenderer::SetLineWidth(float n) {
+    SW_LineWidth = n;
 }
-PUBLIC STATIC void     SoftwareRenderer::Scale(float x, float y, float z) {
-
+PUBLIC STATIC void     SoftwareRenderer::SetFilter(int filter) {
+    SW_Filter = filter;
 }
-PUBLIC STATIC void     SoftwareRenderer::Restore() {
-
+PUBLIC STATIC int      SoftwareRenderer::GetFilter() {
+    return SW_Filter;
 }
 
-PUBLIC STATIC void     SoftwareRenderer::SetLineWidth(float n) {
-
-}
+// Primitive drawing functions
 PUBLIC STATIC void     SoftwareRenderer::StrokeLine(float x1, float y1, float x2, float y2) {
-
+    float sx1, sy1, sx2, sy2;
+    SW_UpdateTransform();
+    SW_Project(x1, y1, &sx1, &sy1);
+    SW_Project(x2, y2, &sx2, &sy2);
+    SW_StrokeLineScreen(sx1, sy1, sx2, sy2, SW_GetBlendColor());
 }
 PUBLIC STATIC void     SoftwareRenderer::StrokeCircle(float x, float y, float rad) {
-
+    SoftwareRenderer::StrokeEllipse(x - rad, y - rad, rad * 2.0f, rad * 2.0f);
 }
 PUBLIC STATIC void     SoftwareRenderer::StrokeEllipse(float x, float y, float w, float h) {
+    float xs[360], ys[360];
+    SW_UpdateTransform();
+
+    int segments = SW_GetEllipseSegments(x + w / 2, y + h / 2, w / 2, h / 2);
+    SW_MakeEllipse(x + w / 2, y + h / 2, w / 2, h / 2, segments, xs, ys);
 
+    Uint32 color = SW_GetBlendColor();
+    for (int i = 0, j = segments - 1; i < segments; j = i++)
+        SW_StrokeLineScreen(xs[j], ys[j], xs[i], ys[i], color);
 }
 PUBLIC STATIC void     SoftwareRenderer::StrokeRectangle(float x, float y, float w, float h) {
+    StrokeLine(x, y, x + w, y);
+    StrokeLine(x, y + h, x + w, y + h);
 
+    StrokeLine(x, y, x, y + h);
+    StrokeLine(x + w, y, x + w, y + h);
 }
-
 PUBLIC STATIC void     SoftwareRenderer::FillCircle(float x, float y, float rad) {
-
+    SoftwareRenderer::FillEllipse(x - rad, y - rad, rad * 2.0f, rad * 2.0f);
 }
 PUBLIC STATIC void     SoftwareRenderer::FillEllipse(float x, float y, float w, float h) {
+    float xs[360], ys[360];
+    SW_UpdateTransform();
 
+    int segments = SW_GetEllipseSegments(x + w / 2, y + h / 2, w / 2, h / 2);
+    SW_MakeEllipse(x + w / 2, y + h / 2, w / 2, h / 2, segments, xs, ys);
+    SW_FillPolygon(xs, ys, segments, SW_GetBlendColor());
+}
+PUBLIC STATIC void     SoftwareRenderer::FillTriangle(float x1, float y1, float x2, float y2, float x3, float y3) {
+    float xs[3], ys[3];
+    SW_UpdateTransform();
+    SW_Project(x1, y1, &xs[0], &ys[0]);
+    SW_Project(x2, y2, &xs[1], &ys[1]);
+    SW_Project(x3, y3, &xs[2], &ys[2]);
+    SW_FillPolygon(xs, ys, 3, SW_GetBlendColor());
 }
 PUBLIC STATIC void     SoftwareRenderer::FillRectangle(float x, float y, float w, float h) {
-
+    float xs[4], ys[4];
+    SW_UpdateTransform();
+    SW_Project(x, y, &xs[0], &ys[0]);
+    SW_Project(x + w, y, &xs[1], &ys[1]);
+    SW_Project(x + w, y + h, &xs[2], &ys[2]);
+    SW_Project(x, y + h, &xs[3], &ys[3]);
+    SW_FillPolygon(xs, ys, 4, SW_GetBlendColor());
 }
 
+// Texture drawing functions
 PUBLIC STATIC void     SoftwareRenderer::DrawTexture(Texture* texture, float sx, float sy, float sw, float sh, float x, float y, float w, float h) {
-
-}
-PUBLIC STATIC void     SoftwareRenderer::DrawTexture(Texture* texture, float x, float y, float w, float h) {
-
-}
-PUBLIC STATIC void     SoftwareRenderer::DrawTexture(Texture* texture, float x, float y) {
-
+    if (!texture)
+        return;
+
+    if (sx < 0.0f) {
+        sx = 0.0f;
+        sy = 0.0f;
+        sw = texture->Width;
+        sh = texture->Height;
+    }
+    SW_DrawTexturedQuad(texture, sx, sy, sw, sh, x, y, w, h);
+}
+PUBLIC STATIC void     SoftwareRenderer::DrawSprite(ISprite* sprite, int animation, int frame, int x, int y, bool flipX, bool flipY) {
+    if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
+
+    AnimFrame animframe = sprite->Animations[animation].Frames[frame];
+    float fX = flipX ? -1.0 : 1.0;
+    float fY = flipY ? -1.0 : 1.0;
+    float sw  = animframe.Width;
+    float sh  = animframe.Height;
+
+    SW_DrawTexturedQuad(sprite->Spritesheets[animframe.SheetNumber],
+        animframe.X, animframe.Y, sw, sh,
+        x + fX * animframe.OffsetX,
+        y + fY * animframe.OffsetY, fX * sw, fY * sh);
+}
+PUBLIC STATIC void     SoftwareRenderer::DrawSpritePart(ISprite* sprite, int animation, int frame, int sx, int sy, int sw, int sh, int x, int y, bool flipX, bool flipY) {
+    if (Graphics::SpriteRangeCheck(sprite, animation, frame)) return;
+
+    AnimFrame animframe = sprite->Animations[animation].Frames[frame];
+    if (sx == animframe.Width)
+        return;
+    if (sy == animframe.Height)
+        return;
+
+    float fX = flipX ? -1.0 : 1.0;
+    float fY = flipY ? -1.0 : 1.0;
+    if (sw >= animframe.Width - sx)
+        sw  = animframe.Width - sx;
+    if (sh >= animframe.Height - sy)
+        sh  = animframe.Height - sy;
+
+    SW_DrawTexturedQuad(sprite->Spritesheets[animframe.SheetNumber],
+        animframe.X + sx, animframe.Y + sy,
+        sw, sh,
+        x + fX * (sx + animframe.OffsetX),
+        y + fY * (sy + animframe.OffsetY), fX * sw, fY * sh);
 }
@@ -0,0 +1,454 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Rendering/Texture.h>
+
+class TextureAtlas {
+public:
+    static bool Enabled;
+    static int  PageSize;
+    static int  MaxSheetSize;
+};
+#endif
+
+#include <Engine/Rendering/TextureAtlas.h>
+
+#include <Engine/Application.h>
+#include <Engine/Graphics.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+#include <Engine/Filesystem/File.h>
+#include <Engine/Hashing/CRC32.h>
+#include <Engine/Includes/HashMap.h>
+#include <Engine/IO/Compression/ZLibStream.h>
+#include <Engine/IO/FileStream.h>
+#include <Engine/IO/MemoryStream.h>
+#include <Engine/ResourceTypes/ResourceManager.h>
+
+#define ATLAS_CACHE_FILENAME "AtlasCache.bin"
+#define ATLAS_CACHE_VERSION 2
+#define ATLAS_MAX_PAGES 8
+// Transparent gutter kept between packed sheets, so that linear
+// filtering doesn't pull in texels from a neighbouring sheet.
+#define ATLAS_PADDING 2
+
+// NOTE: The cache holds each sheet's pixels on their own rather than
+//   whole pages. Only its index is read at startup; a sheet's pixels are
+//   read and packed into this run's pages the first time it's asked for
+//   and still matches its source. Pages therefore only ever hold sheets
+//   this run uses. Saving writes those plus the cached sheets this run
+//   never asked for, copied over as they are, so only sheets whose
+//   source changed drop out of the cache.
+struct AtlasShelf {
+    int X;
+    int Y;
+    int Height;
+};
+struct AtlasPage {
+    Texture*           Page;
+    vector<AtlasShelf> Shelves;
+    int                NextShelfY;
+};
+struct AtlasEntry {
+    Uint32 SourceChecksum;
+    int    Page;
+    int    X;
+    int    Y;
+    int    Width;
+    int    Height;
+    // zlib-compressed pixels, kept to write the cache back out
+    void*  Data;
+    Uint32 DataSize;
+};
+struct AtlasCacheEntry {
+    Uint32 SourceChecksum;
+    Uint32 Width;
+    Uint32 Height;
+    Uint32 Offset;
+    Uint32 DataSize;
+};
+
+bool                      TextureAtlas::Enabled = false;
+int                       TextureAtlas::PageSize = 2048;
+int                       TextureAtlas::MaxSheetSize = 1024;
+
+vector<AtlasPage*>        Atlas_Pages;
+HashMap<AtlasEntry>*      Atlas_Entries = NULL;
+HashMap<AtlasCacheEntry>* Atlas_CacheEntries = NULL;
+Stream*                   Atlas_CacheStream = NULL;
+bool                      Atlas_Dirty = false;
+
+AtlasPage* Atlas_NewPage() {
+    if (Atlas_Pages.size() >= ATLAS_MAX_PAGES)
+        return NULL;
+
+    // Sheets are uploaded straight to the page texture as they're
+    //   packed, so the page's pixels only exist long enough to clear it.
+    Uint32* pixels = (Uint32*)Memory::Calloc(TextureAtlas::PageSize * TextureAtlas::PageSize, sizeof(Uint32));
+    if (!pixels)
+        return NULL;
+
+    Texture* texture = Graphics::CreateTextureFromPixels(TextureAtlas::PageSize, TextureAtlas::PageSize, pixels, TextureAtlas::PageSize * sizeof(Uint32));
+    Memory::Free(pixels);
+    if (!texture)
+        return NULL;
+
+    AtlasPage* page = new AtlasPage;
+    page->Page = texture;
+    page->NextShelfY = 0;
+    Atlas_Pages.push_back(page);
+    return page;
+}
+// Finds room for a width x height rect, preferring the shelf that
+// wastes the least height.
+bool       Atlas_Allocate(int width, int height, int* pageIndex, int* x, int* y) {
+    int paddedW = width + ATLAS_PADDING;
+    int paddedH = height + ATLAS_PADDING;
+
+    AtlasShelf* best = NULL;
+    int bestPage = -1;
+    for (size_t p = 0; p < Atlas_Pages.size(); p++) {
+        AtlasPage* page = Atlas_Pages[p];
+        for (size_t s = 0; s < page->Shelves.size(); s++) {
+            AtlasShelf* shelf = &page->Shelves[s];
+            if (shelf->Height < paddedH || shelf->X + paddedW > TextureAtlas::PageSize)
+                continue;
+            if (!best || shelf->Height < best->Height) {
+                best = shelf;
+                bestPage = (int)p;
+            }
+        }
+    }
+
+    if (!best) {
+        for (size_t p = 0; p <= Atlas_Pages.size(); p++) {
+            AtlasPage* page = p < Atlas_Pages.size() ? Atlas_Pages[p] : Atlas_NewPage();
+            if (!page)
+                return false;
+            if (page->NextShelfY + paddedH > TextureAtlas::PageSize)
+                continue;
+
+            AtlasShelf shelf;
+            shelf.X = 0;
+            shelf.Y = page->NextShelfY;
+            shelf.Height = paddedH;
+            page->Shelves.push_back(shelf);
+            page->NextShelfY += paddedH;
+
+            best = &page->Shelves.back();
+            bestPage = (int)p;
+            break;
+        }
+    }
+
+    *pageIndex = bestPage;
+    *x = best->X;
+    *y = best->Y;
+    best->X += paddedW;
+    return true;
+}
+// Packs a sheet into this run's pages. Takes ownership of data, the
+// sheet's compressed pixels, on success.
+bool       Atlas_Place(Uint32 hash, Uint32 sourceChecksum, Uint32* pixels, Uint32 width, Uint32 height, void* data, Uint32 dataSize, AtlasEntry* out) {
+    AtlasEntry entry;
+    if (!Atlas_Allocate(width, height, &entry.Page, &entry.X, &entry.Y))
+        return false;
+
+    entry.SourceChecksum = sourceChecksum;
+    entry.Width = width;
+    entry.Height = height;
+    entry.Data = data;
+    entry.DataSize = dataSize;
+
+    SDL_Rect rect = { entry.X, entry.Y, (int)width, (int)height };
+    Graphics::UpdateTexture(Atlas_Pages[entry.Page]->Page, &rect, pixels, width * sizeof(Uint32));
+
+    // A sheet packed again this run leaves its old rect unused until
+    //   the next run, since the cache is repacked from scratch.
+    if (Atlas_Entries->Exists(hash))
+        Memory::Free(Atlas_Entries->Get(hash).Data);
+    // Any copy still waiting in the old cache is superseded as well
+    Atlas_CacheEntries->Remove(hash);
+
+    Atlas_Entries->Put(hash, entry);
+    *out = entry;
+    return true;
+}
+void       Atlas_RemoveEntry(Uint32 hash) {
+    Memory::Free(Atlas_Entries->Get(hash).Data);
+    Atlas_Entries->Remove(hash);
+    Atlas_Dirty = true;
+}
+
+void       Atlas_LoadCache() {
+    if (!File::Exists(ATLAS_CACHE_FILENAME))
+        return;
+
+    Stream* stream = FileStream::New(ATLAS_CACHE_FILENAME, FileStream::READ_ACCESS);
+    if (!stream)
+        return;
+
+    size_t fileSize = stream->Length();
+    if (fileSize < 12 ||
+        stream->ReadUInt32() != *(Uint32*)"HATL" ||
+        stream->ReadUInt32() != ATLAS_CACHE_VERSION) {
+        Log::Print(Log::LOG_VERBOSE, "Ignoring stale texture atlas cache.");
+        stream->Close();
+        Atlas_Dirty = true;
+        return;
+    }
+
+    Uint32 entryCount = stream->ReadUInt32();
+    if ((Uint64)entryCount * 24 > fileSize - 12) {
+        Log::Print(Log::LOG_WARN, "Texture atlas cache is truncated, ignoring it.");
+        stream->Close();
+        Atlas_Dirty = true;
+        return;
+    }
+
+    // Anything out of range is left out, and rewritten on exit
+    for (Uint32 e = 0; e < entryCount; e++) {
+        Uint32 hash = stream->ReadUInt32();
+
+        AtlasCacheEntry entry;
+        entry.SourceChecksum = stream->ReadUInt32();
+        entry.Width = stream->ReadUInt32();
+        entry.Height = stream->ReadUInt32();
+        entry.Offset = stream->ReadUInt32();
+        entry.DataSize = stream->ReadUInt32();
+
+        if (entry.Width == 0 || entry.Width > (Uint32)TextureAtlas::MaxSheetSize ||
+            entry.Height == 0 || entry.Height > (Uint32)TextureAtlas::MaxSheetSize ||
+            entry.Offset > fileSize || entry.DataSize > fileSize - entry.Offset) {
+            Atlas_Dirty = true;
+            continue;
+        }
+
+        Atlas_CacheEntries->Put(hash, entry);
+    }
+
+    // Kept open to read sheets from as they're asked for
+    Atlas_CacheStream = stream;
+
+    Log::Print(Log::LOG_VERBOSE, "Loaded %d texture atlas cache entries.", Atlas_CacheEntries->Count);
+}
+bool       Atlas_LoadFromCache(Uint32 hash, Uint32 sourceChecksum, AtlasEntry* out) {
+    // Each cached sheet is only looked at once; from here on it either
+    //   lives in this run's pages or is gone.
+    AtlasCacheEntry cached = Atlas_CacheEntries->Get(hash);
+    Atlas_CacheEntries->Remove(hash);
+
+    if (cached.SourceChecksum != sourceChecksum || !Atlas_CacheStream) {
+        Atlas_Dirty = true;
+        return false;
+    }
+
+    size_t  pixelsSize = (size_t)cached.Width * cached.Height * sizeof(Uint32);
+    void*   data = Memory::Malloc(cached.DataSize);
+    Uint32* pixels = (Uint32*)Memory::Malloc(pixelsSize);
+    bool    success = false;
+    if (data && pixels) {
+        Atlas_CacheStream->Seek(cached.Offset);
+        success = Atlas_CacheStream->ReadBytes(data, cached.DataSize) == cached.DataSize &&
+            ZLibStream::Decompress(pixels, pixelsSize, data, cached.DataSize) &&
+            Atlas_Place(hash, sourceChecksum, pixels, cached.Width, cached.Height, data, cached.DataSize, out);
+    }
+
+    Memory::Free(pixels);
+    if (!success) {
+        Memory::Free(data);
+        Atlas_Dirty = true;
+    }
+    return success;
+}
+void       Atlas_SaveCache() {
+    vector<pair<Uint32, AtlasEntry>> entries;
+    Atlas_Entries->WithAll([&entries](Uint32 hash, AtlasEntry entry) -> void {
+        if (entry.Data)
+            entries.push_back(std::make_pair(hash, entry));
+    });
+
+    // Sheets still waiting in the old cache are read in before it's
+    //   overwritten; only these copies are freed below.
+    size_t carriedStart = entries.size();
+    if (Atlas_CacheStream) {
+        Atlas_CacheEntries->WithAll([&entries](Uint32 hash, AtlasCacheEntry cached) -> void {
+            void* data = Memory::Malloc(cached.DataSize);
+            if (!data)
+                return;
+
+            Atlas_CacheStream->Seek(cached.Offset);
+            if (Atlas_CacheStream->ReadBytes(data, cached.DataSize) != cached.DataSize) {
+                Memory::Free(data);
+                return;
+            }
+
+            AtlasEntry entry;
+            entry.SourceChecksum = cached.SourceChecksum;
+            entry.Page = -1;
+            entry.X = entry.Y = 0;
+            entry.Width = cached.Width;
+            entry.Height = cached.Height;
+            entry.Data = data;
+            entry.DataSize = cached.DataSize;
+            entries.push_back(std::make_pair(hash, entry));
+        });
+
+        Atlas_CacheStream->Close();
+        Atlas_CacheStream = NULL;
+    }
+    Atlas_CacheEntries->Clear();
+
+    Stream* stream = FileStream::New(ATLAS_CACHE_FILENAME, FileStream::WRITE_ACCESS);
+    if (!stream) {
+        Log::Print(Log::LOG_WARN, "Could not write texture atlas cache!");
+        for (size_t e = carriedStart; e < entries.size(); e++)
+            Memory::Free(entries[e].second.Data);
+        return;
+    }
+
+    stream->WriteUInt32(*(Uint32*)"HATL");
+    stream->WriteUInt32(ATLAS_CACHE_VERSION);
+    stream->WriteUInt32((Uint32)entries.size());
+
+    Uint32 offset = 12 + (Uint32)entries.size() * 24;
+    for (size_t e = 0; e < entries.size(); e++) {
+        AtlasEntry* entry = &entries[e].second;
+        stream->WriteUInt32(entries[e].first);
+        stream->WriteUInt32(entry->SourceChecksum);
+        stream->WriteUInt32(entry->Width);
+        stream->WriteUInt32(entry->Height);
+        stream->WriteUInt32(offset);
+        stream->WriteUInt32(entry->DataSize);
+        offset += entry->DataSize;
+    }
+    for (size_t e = 0; e < entries.size(); e++)
+        stream->WriteBytes(entries[e].second.Data, entries[e].second.DataSize);
+    stream->Close();
+
+    for (size_t e = carriedStart; e < entries.size(); e++)
+        Memory::Free(entries[e].second.Data);
+}
+
+PUBLIC STATIC void     TextureAtlas::Init() {
+    if (Application::Settings)
+        Application::Settings->GetBool("display", "textureAtlas", &TextureAtlas::Enabled);
+    if (!TextureAtlas::Enabled)
+        return;
+
+    TextureAtlas::PageSize = 2048;
+    if (TextureAtlas::PageSize > (int)Graphics::MaxTextureWidth)
+        TextureAtlas::PageSize = Graphics::MaxTextureWidth;
+    if (TextureAtlas::PageSize > (int)Graphics::MaxTextureHeight)
+        TextureAtlas::PageSize = Graphics::MaxTextureHeight;
+    TextureAtlas::MaxSheetSize = TextureAtlas::PageSize / 2;
+
+    Atlas_Entries = new HashMap<AtlasEntry>(NULL, 64);
+    Atlas_CacheEntries = new HashMap<AtlasCacheEntry>(NULL, 64);
+    Atlas_LoadCache();
+}
+PUBLIC STATIC Uint32   TextureAtlas::GetResourceChecksum(const char* filename) {
+    Uint8* data;
+    size_t size;
+    if (ResourceManager::MapResource(filename, &data, &size))
+        return CRC32::EncryptData(data, (Uint32)size);
+
+    if (!ResourceManager::LoadResource(filename, &data, &size))
+        return 0;
+
+    Uint32 checksum = CRC32::EncryptData(data, (Uint32)size);
+    Memory::Free(data);
+    return checksum;
+}
+PUBLIC STATIC bool     TextureAtlas::Get(const char* name, Uint32 sourceChecksum, Texture** page, int* x, int* y) {
+    if (!TextureAtlas::Enabled)
+        return false;
+
+    Uint32 hash = CRC32::EncryptString(name);
+
+    AtlasEntry entry;
+    if (Atlas_Entries->Exists(hash)) {
+        entry = Atlas_Entries->Get(hash);
+        if (entry.SourceChecksum != sourceChecksum) {
+            Atlas_RemoveEntry(hash);
+            return false;
+        }
+    }
+    else if (!Atlas_CacheEntries->Exists(hash) || !Atlas_LoadFromCache(hash, sourceChecksum, &entry))
+        return false;
+
+    *page = Atlas_Pages[entry.Page]->Page;
+    *x = entry.X;
+    *y = entry.Y;
+    return true;
+}
+PUBLIC STATIC bool     TextureAtlas::GetSheet(const char* filename, Texture** page, int* x, int* y) {
+    if (!TextureAtlas::Enabled)
+        return false;
+
+    // Only check the source file against the cache the first time
+    //   it's asked for; sheets packed this run are already current.
+    Uint32 hash = CRC32::EncryptString(filename);
+    if (Atlas_Entries->Exists(hash)) {
+        AtlasEntry entry = Atlas_Entries->Get(hash);
+        *page = Atlas_Pages[entry.Page]->Page;
+        *x = entry.X;
+        *y = entry.Y;
+        return true;
+    }
+
+    if (!Atlas_CacheEntries->Exists(hash))
+        return false;
+
+    return TextureAtlas::Get(filename, TextureAtlas::GetResourceChecksum(filename), page, x, y);
+}
+PUBLIC STATIC bool     TextureAtlas::Insert(const char* name, Uint32 sourceChecksum, Uint32* pixels, Uint32 width, Uint32 height, Texture** page, int* x, int* y) {
+    if (!TextureAtlas::Enabled)
+        return false;
+    if ((int)width > TextureAtlas::MaxSheetSize || (int)height > TextureAtlas::MaxSheetSize)
+        return false;
+
+    // Without compressed pixels the sheet is still packed, just not cached
+    void*  data = NULL;
+    size_t dataSize = 0;
+    if (!ZLibStream::Compress(pixels, (size_t)width * height * sizeof(Uint32), &data, &dataSize))
+        data = NULL;
+
+    AtlasEntry entry;
+    if (!Atlas_Place(CRC32::EncryptString(name), sourceChecksum, pixels, width, height, data, (Uint32)dataSize, &entry)) {
+        Memory::Free(data);
+        return false;
+    }
+
+    Atlas_Dirty = true;
+
+    *page = Atlas_Pages[entry.Page]->Page;
+    *x = entry.X;
+    *y = entry.Y;
+    return true;
+}
+PUBLIC STATIC void     TextureAtlas::Dispose() {
+    if (!Atlas_Entries)
+        return;
+
+    if (Atlas_Dirty)
+        Atlas_SaveCache();
+
+    if (Atlas_CacheStream) {
+        Atlas_CacheStream->Close();
+        Atlas_CacheStream = NULL;
+    }
+
+    Atlas_Entries->WithAll([](Uint32 hash, AtlasEntry entry) -> void {
+        Memory::Free(entry.Data);
+    });
+
+    for (size_t p = 0; p < Atlas_Pages.size(); p++)
+        delete Atlas_Pages[p];
+    Atlas_Pages.clear();
+
+    delete Atlas_Entries;
+    Atlas_Entries = NULL;
+    delete Atlas_CacheEntries;
+    Atlas_CacheEntries = NULL;
+    Atlas_Dirty = false;
+}
@@ -8,9 +8,11 @@ public:
     char              Filename[256];
     bool              Print = false;
 
-    Texture*          Spritesheets[4];
-    bool              SpritesheetsBorrowed[4];
-    char              SpritesheetsFilenames[128][4];
+    Texture*          Spritesheets[32];
+    bool              SpritesheetsBorrowed[32];
+    char              SpritesheetsFilenames[32][128];
+    int               SpritesheetsOffsetX[32];
+    int               SpritesheetsOffsetY[32];
     int               SpritesheetCount = 0;
     int               CollisionBoxCount = 0;
 
@@ -33,15 +35,21 @@ public:
 
 #include <Engine/IO/FileStream.h>
 #include <Engine/IO/ResourceStream.h>
+#include <Engine/Rendering/TextureAtlas.h>
+#include <Engine/ResourceTypes/Image.h>
 
 PUBLIC ISprite::ISprite() {
     memset(Spritesheets, 0, sizeof(Spritesheets));
     memset(SpritesheetsBorrowed, 0, sizeof(SpritesheetsBorrowed));
+    memset(SpritesheetsOffsetX, 0, sizeof(SpritesheetsOffsetX));
+    memset(SpritesheetsOffsetY, 0, sizeof(SpritesheetsOffsetY));
     memset(Filename, 0, 256);
 }
 PUBLIC ISprite::ISprite(const char* filename) {
     memset(Spritesheets, 0, sizeof(Spritesheets));
     memset(SpritesheetsBorrowed, 0, sizeof(SpritesheetsBorrowed));
+    memset(SpritesheetsOffsetX, 0, sizeof(SpritesheetsOffsetX));
+    memset(SpritesheetsOffsetY, 0, sizeof(SpritesheetsOffsetY));
     memset(Filename, 0, 256);
 
     strncpy(Filename, filename, 255);
@@ -141,6 +149,50 @@ PUBLIC STATIC Texture* ISprite::AddSpriteSheet(const char* filename) {
     return texture;
 }
 
+// Like AddSpriteSheet, but packs the sheet into a shared atlas page when
+// atlasing is enabled. Frames must be offset by the returned position.
+PUBLIC STATIC Texture* ISprite::AddSpriteSheet(const char* filename, int* offsetX, int* offsetY) {
+    Texture* texture = NULL;
+    Uint32*  data = NULL;
+    Uint32   width = 0;
+    Uint32   height = 0;
+
+    *offsetX = 0;
+    *offsetY = 0;
+
+    if (!TextureAtlas::Enabled || Graphics::SpriteSheetTextureMap->Exists(filename))
+        return ISprite::AddSpriteSheet(filename);
+
+    if (TextureAtlas::GetSheet(filename, &texture, offsetX, offsetY))
+        return texture;
+
+    data = Image::LoadPixelsFromResource(filename, &width, &height);
+    if (!data) {
+        Log::Print(Log::LOG_ERROR, "Sprite sheet \"%s\" could not be loaded!", filename);
+        return NULL;
+    }
+
+    texture = ISprite::AddSpriteSheet(filename, TextureAtlas::GetResourceChecksum(filename), data, width, height, offsetX, offsetY);
+    Memory::Free(data);
+    return texture;
+}
+// Adds an already decoded sheet, to the atlas if it fits and otherwise as
+// its own texture. Doesn't take ownership of the pixels.
+PUBLIC STATIC Texture* ISprite::AddSpriteSheet(const char* filename, Uint32 checksum, Uint32* data, Uint32 width, Uint32 height, int* offsetX, int* offsetY) {
+    Texture* texture = NULL;
+
+    *offsetX = 0;
+    *offsetY = 0;
+
+    if (TextureAtlas::Insert(filename, checksum, data, width, height, &texture, offsetX, offsetY))
+        return texture;
+
+    texture = Image::CreateTextureFromPixels(filename, data, width, height);
+    if (texture)
+        Graphics::SpriteSheetTextureMap->Put(filename, texture);
+    return texture;
+}
+
 /*
 // PUBLIC void ISprite::RotatePaletteLeft(Uint32* color, int index, int size) {
 //     color += index;
@@ -227,23 +279,33 @@ PUBLIC bool ISprite::LoadAnimation(const char* filename) {
     reader->ReadUInt32();
 
     // Get texture count
-    this->SpritesheetCount = reader->ReadByte();
+    int sheetCount = reader->ReadByte();
+    this->SpritesheetCount = sheetCount;
+    if (this->SpritesheetCount > 32) {
+        Log::Print(Log::LOG_ERROR, "Sprite \"%s\" has %d sheets, only the first 32 will be loaded!", filename, sheetCount);
+        this->SpritesheetCount = 32;
+    }
 
     // Load textures
-    for (int i = 0; i < this->SpritesheetCount; i++) {
+    for (int i = 0; i < sheetCount; i++) {
         str = reader->ReadHeaderedString();
+        if (i >= this->SpritesheetCount) {
+            Memory::Free(str);
+            continue;
+        }
         if (Print)
             Log::Print(Log::LOG_VERBOSE, " - %s", str);
 
-        strcpy(SpritesheetsFilenames[i], str);
+        strncpy(SpritesheetsFilenames[i], str, 127);
+        SpritesheetsFilenames[i][127] = 0;
 
-        sprintf(altered, "Sprites/%s", str);
+        snprintf(altered, sizeof(altered), "Sprites/%s", str);
         Memory::Free(str);
 
         if (Graphics::SpriteSheetTextureMap->Exists(altered))
             SpritesheetsBorrowed[i] = true;
 
-        Spritesheets[i] = AddSpriteSheet(altered);
+        Spritesheets[i] = AddSpriteSheet(altered, &SpritesheetsOffsetX[i], &SpritesheetsOffsetY[i]);
         // Spritesheets[i] = Image::LoadTextureFromResource(altered);
     }
 
@@ -281,8 +343,10 @@ PUBLIC bool ISprite::LoadAnimation(const char* filename) {
             AnimFrame anfrm;
             anfrm.SheetNumber = reader->ReadByte();
 
-            if (anfrm.SheetNumber >= SpritesheetCount)
+            if (anfrm.SheetNumber >= SpritesheetCount) {
                 Log::Print(Log::LOG_ERROR, "Sheet number %d outside of range of sheet count %d! (Animation %d, Frame %d)", anfrm.SheetNumber, SpritesheetCount, a, i);
+                anfrm.SheetNumber = 0;
+            }
 
             anfrm.Duration = reader->ReadInt16();
             anfrm.ID = reader->ReadUInt16();
@@ -293,6 +357,10 @@ PUBLIC bool ISprite::LoadAnimation(const char* filename) {
             anfrm.OffsetX = reader->ReadInt16();
             anfrm.OffsetY = reader->ReadInt16();
 
+            // Move the frame to where its sheet was packed
+            anfrm.X += SpritesheetsOffsetX[anfrm.SheetNumber];
+            anfrm.Y += SpritesheetsOffsetY[anfrm.SheetNumber];
+
             anfrm.BoxCount = this->CollisionBoxCount;
             if (anfrm.BoxCount) {
                 anfrm.Boxes = (CollisionBox*)Memory::Malloc(anfrm.BoxCount * sizeof(CollisionBox));
@@ -386,8 +454,8 @@ PUBLIC bool ISprite::SaveAnimation(const char* filename) {
             stream->WriteByte(anfrm.SheetNumber);
             stream->WriteUInt16(anfrm.Duration);
             stream->WriteUInt16(anfrm.ID);
-            stream->WriteUInt16(anfrm.X);
-            stream->WriteUInt16(anfrm.Y);
+            stream->WriteUInt16(anfrm.X - SpritesheetsOffsetX[anfrm.SheetNumber]);
+            stream->WriteUInt16(anfrm.Y - SpritesheetsOffsetY[anfrm.SheetNumber]);
             stream->WriteUInt16(anfrm.Width);
             stream->WriteUInt16(anfrm.Height);
             stream->WriteInt16(anfrm.OffsetX);
@@ -28,6 +28,10 @@ PUBLIC Image::Image(const char* filename) {
     strncpy(Filename, filename, 255);
     TexturePtr = Image::LoadTextureFromResource(Filename);
 }
+PUBLIC Image::Image(const char* filename, Texture* texture) {
+    strncpy(Filename, filename, 255);
+    TexturePtr = texture;
+}
 
 PUBLIC void Image::Dispose() {
     if (TexturePtr) {
@@ -40,18 +44,14 @@ PUBLIC Image::~Image() {
     Dispose();
 }
 
-PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
-    Texture* texture = NULL;
-    Uint32*  data = NULL;
-    Uint32   width = 0;
-    Uint32   height = 0;
+PUBLIC STATIC Uint32*  Image::LoadPixelsFromResource(const char* filename, Uint32* width, Uint32* height) {
+    Uint32* data = NULL;
+    double  ticks;
 
     const char* altered = filename;
 
-    // if ((texture = Graphics::SpriteSheetTextureMap->Get(altered))) {
-    //     return texture;
-    // }
-
+    // NOTE: This may be called from the resource loader's worker
+    //   threads, so it must not touch the renderer or Clock::Start/End.
     Uint32 magic = 0x000000;
     Stream* stream;
     if (strncmp(altered, "file:", 5) == 0)
@@ -70,12 +70,12 @@ PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
 
     // 0x474E5089U PNG
     if (magic == 0x474E5089U) {
-        Clock::Start();
+        ticks = Clock::GetTicks();
         PNG* png = PNG::Load(altered);
         if (png) {
-            Log::Print(Log::LOG_VERBOSE, "PNG load took %.3f ms", Clock::End());
-            width = (Uint32)png->Width;
-            height = (Uint32)png->Height;
+            Log::Print(Log::LOG_VERBOSE, "PNG load took %.3f ms", Clock::GetTicks() - ticks);
+            *width = (Uint32)png->Width;
+            *height = (Uint32)png->Height;
 
             data = png->Data;
             Memory::Track(data, "Texture::Data");
@@ -89,12 +89,12 @@ PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
     }
     // 0xE0FFD8FFU JPEG
     else if ((magic & 0xFFFF) == 0xD8FFU) {
-        Clock::Start();
+        ticks = Clock::GetTicks();
         JPEG* jpeg = JPEG::Load(altered);
         if (jpeg) {
-            Log::Print(Log::LOG_VERBOSE, "JPEG load took %.3f ms", Clock::End());
-            width = (Uint32)jpeg->Width;
-            height = (Uint32)jpeg->Height;
+            Log::Print(Log::LOG_VERBOSE, "JPEG load took %.3f ms", Clock::GetTicks() - ticks);
+            *width = (Uint32)jpeg->Width;
+            *height = (Uint32)jpeg->Height;
 
             data = jpeg->Data;
             Memory::Track(data, "Texture::Data");
@@ -107,12 +107,12 @@ PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
         }
     }
     else if (strstr(altered, ".gif")) {
-        Clock::Start();
+        ticks = Clock::GetTicks();
         GIF* gif = GIF::Load(altered);
         if (gif) {
-            Log::Print(Log::LOG_VERBOSE, "GIF load took %.3f ms", Clock::End());
-            width = (Uint32)gif->Width;
-            height = (Uint32)gif->Height;
+            Log::Print(Log::LOG_VERBOSE, "GIF load took %.3f ms", Clock::GetTicks() - ticks);
+            *width = (Uint32)gif->Width;
+            *height = (Uint32)gif->Height;
 
             data = gif->Data;
             // Palette = gif->Colors;
@@ -137,15 +137,34 @@ PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
         return NULL;
     }
 
+    return data;
+}
+PUBLIC STATIC Texture* Image::CreateTextureFromPixels(const char* filename, Uint32* data, Uint32 width, Uint32 height) {
     if (width > Graphics::MaxTextureWidth || height > Graphics::MaxTextureHeight) {
-		Log::Print(Log::LOG_ERROR, "Image file \"%s\" of size %d x %d is larger than maximum size of %d x %d!", altered, width, height, Graphics::MaxTextureWidth, Graphics::MaxTextureHeight);
+		Log::Print(Log::LOG_ERROR, "Image file \"%s\" of size %d x %d is larger than maximum size of %d x %d!", filename, width, height, Graphics::MaxTextureWidth, Graphics::MaxTextureHeight);
 		return NULL;
 	}
 
-    texture = Graphics::CreateTextureFromPixels(width, height, data, width * sizeof(Uint32));
+    return Graphics::CreateTextureFromPixels(width, height, data, width * sizeof(Uint32));
+}
+PUBLIC STATIC Texture* Image::LoadTextureFromResource(const char* filename) {
+    Texture* texture = NULL;
+    Uint32*  data = NULL;
+    Uint32   width = 0;
+    Uint32   height = 0;
+
+    // if ((texture = Graphics::SpriteSheetTextureMap->Get(filename))) {
+    //     return texture;
+    // }
+
+    data = Image::LoadPixelsFromResource(filename, &width, &height);
+    if (!data)
+        return NULL;
+
+    texture = Image::CreateTextureFromPixels(filename, data, width, height);
     Memory::Free(data);
 
-    // Graphics::SpriteSheetTextureMap->Put(altered, texture);
+    // Graphics::SpriteSheetTextureMap->Put(filename, texture);
 
     return texture;
 }
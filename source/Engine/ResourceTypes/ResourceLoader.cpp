@@ -0,0 +1,433 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+
+class ResourceLoader {
+public:
+    static int    ThreadCount;
+    static int    FrameBudget;
+
+    enum {
+        TYPE_SPRITE,
+        TYPE_IMAGE,
+        TYPE_SOUND,
+        TYPE_MUSIC,
+    };
+    enum {
+        STATUS_PENDING = 0,
+        STATUS_LOADED = 1,
+        STATUS_FAILED = 2,
+    };
+};
+#endif
+
+#include <Engine/ResourceTypes/ResourceLoader.h>
+
+#include <Engine/Application.h>
+#include <Engine/Graphics.h>
+#include <Engine/Scene.h>
+#include <Engine/Diagnostics/Clock.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+#include <Engine/Hashing/CRC32.h>
+#include <Engine/IO/ResourceStream.h>
+#include <Engine/Rendering/TextureAtlas.h>
+#include <Engine/ResourceTypes/Image.h>
+#include <Engine/ResourceTypes/ISound.h>
+#include <Engine/ResourceTypes/ISprite.h>
+#include <Engine/ResourceTypes/ResourceType.h>
+
+#define LOADER_MAX_THREADS 4
+#define LOADER_MAX_SHEETS 32
+
+struct LoadRequest {
+    int          Handle;
+    int          Type;
+    char         Filename[256];
+    Uint32       FilenameHash;
+    Uint32       UnloadPolicy;
+    bool         Cancelled;
+
+    // Filled in by whichever thread decodes the request
+    bool         Decoded;
+    int          SheetCount;
+    char         SheetFilenames[LOADER_MAX_SHEETS][256];
+    Uint32*      SheetPixels[LOADER_MAX_SHEETS];
+    Uint32       SheetWidths[LOADER_MAX_SHEETS];
+    Uint32       SheetHeights[LOADER_MAX_SHEETS];
+    Uint32       SheetChecksums[LOADER_MAX_SHEETS];
+    ISound*      Sound;
+
+    LoadRequest* Next;
+};
+struct LoadResult {
+    int Status;
+    int Index;
+};
+
+int                  ResourceLoader::ThreadCount = 0;
+int                  ResourceLoader::FrameBudget = 4;
+
+SDL_Thread*          Loader_Threads[LOADER_MAX_THREADS];
+SDL_sem*             Loader_WorkSemaphore = NULL;
+SDL_mutex*           Loader_QueueLock = NULL;
+bool                 Loader_ThreadsQuit = false;
+
+// Both queues are guarded by Loader_QueueLock
+LoadRequest*         Loader_PendingHead = NULL;
+LoadRequest*         Loader_PendingTail = NULL;
+LoadRequest*         Loader_FinishedHead = NULL;
+LoadRequest*         Loader_FinishedTail = NULL;
+
+// Main thread only
+vector<LoadRequest*> Loader_Outstanding;
+vector<LoadResult>   Loader_Results;
+
+void         Loader_Push(LoadRequest** head, LoadRequest** tail, LoadRequest* request) {
+    request->Next = NULL;
+    if (*tail)
+        (*tail)->Next = request;
+    else
+        *head = request;
+    *tail = request;
+}
+LoadRequest* Loader_Pop(LoadRequest** head, LoadRequest** tail) {
+    LoadRequest* request = *head;
+    if (request) {
+        *head = request->Next;
+        if (!*head)
+            *tail = NULL;
+        request->Next = NULL;
+    }
+    return request;
+}
+
+// NOTE: Runs on a worker thread (or on the main thread when there are
+//   none), so only file reading and CPU decoding may happen here.
+void         Loader_Decode(LoadRequest* request) {
+    switch (request->Type) {
+        case ResourceLoader::TYPE_IMAGE: {
+            Uint32* data = Image::LoadPixelsFromResource(request->Filename, &request->SheetWidths[0], &request->SheetHeights[0]);
+            if (!data)
+                return;
+
+            strcpy(request->SheetFilenames[0], request->Filename);
+            request->SheetPixels[0] = data;
+            request->SheetCount = 1;
+            break;
+        }
+        case ResourceLoader::TYPE_SPRITE: {
+            // Only the sheet images are decoded ahead of time; the
+            //   animation data itself is small enough to read when the
+            //   sprite is created.
+            Stream* reader = ResourceStream::New(request->Filename);
+            if (!reader)
+                return;
+
+            if (reader->ReadUInt32() != 0x00525053) {
+                reader->Close();
+                return;
+            }
+
+            reader->ReadUInt32();
+
+            int sheetCount = reader->ReadByte();
+            if (sheetCount > LOADER_MAX_SHEETS)
+                sheetCount = LOADER_MAX_SHEETS;
+
+            for (int i = 0; i < sheetCount; i++) {
+                char* str = reader->ReadHeaderedString();
+                snprintf(request->SheetFilenames[i], 256, "Sprites/%s", str);
+                Memory::Free(str);
+            }
+            reader->Close();
+
+            for (int i = 0; i < sheetCount; i++) {
+                request->SheetPixels[i] = Image::LoadPixelsFromResource(request->SheetFilenames[i], &request->SheetWidths[i], &request->SheetHeights[i]);
+                if (TextureAtlas::Enabled)
+                    request->SheetChecksums[i] = TextureAtlas::GetResourceChecksum(request->SheetFilenames[i]);
+                request->SheetCount = i + 1;
+            }
+            break;
+        }
+        case ResourceLoader::TYPE_SOUND:
+        case ResourceLoader::TYPE_MUSIC: {
+            ISound* sound = new ISound(request->Filename);
+            if (sound->LoadFailed) {
+                sound->Dispose();
+                delete sound;
+                return;
+            }
+            request->Sound = sound;
+            break;
+        }
+    }
+    request->Decoded = true;
+}
+void         Loader_Free(LoadRequest* request) {
+    for (int i = 0; i < request->SheetCount; i++) {
+        if (request->SheetPixels[i])
+            Memory::Free(request->SheetPixels[i]);
+    }
+    if (request->Sound) {
+        request->Sound->Dispose();
+        delete request->Sound;
+    }
+    delete request;
+}
+int          Loader_WorkerThread(void* data) {
+    while (true) {
+        SDL_SemWait(Loader_WorkSemaphore);
+        if (Loader_ThreadsQuit)
+            break;
+
+        SDL_LockMutex(Loader_QueueLock);
+        LoadRequest* request = Loader_Pop(&Loader_PendingHead, &Loader_PendingTail);
+        SDL_UnlockMutex(Loader_QueueLock);
+        if (!request)
+            continue;
+
+        Loader_Decode(request);
+
+        SDL_LockMutex(Loader_QueueLock);
+        Loader_Push(&Loader_FinishedHead, &Loader_FinishedTail, request);
+        SDL_UnlockMutex(Loader_QueueLock);
+    }
+    return 0;
+}
+
+vector<ResourceType*>* Loader_GetList(int type) {
+    switch (type) {
+        case ResourceLoader::TYPE_SPRITE: return &Scene::SpriteList;
+        case ResourceLoader::TYPE_IMAGE:  return &Scene::ImageList;
+        case ResourceLoader::TYPE_SOUND:  return &Scene::SoundList;
+        case ResourceLoader::TYPE_MUSIC:  return &Scene::MusicList;
+    }
+    return NULL;
+}
+int          Loader_FindInList(vector<ResourceType*>* list, Uint32 filenameHash) {
+    for (size_t i = 0, listSz = list->size(); i < listSz; i++) {
+        if ((*list)[i] && (*list)[i]->FilenameHash == filenameHash)
+            return (int)i;
+    }
+    return -1;
+}
+// Returns the list index of the new resource, or -1 on failure
+int          Loader_Install(LoadRequest* request) {
+    vector<ResourceType*>* list = Loader_GetList(request->Type);
+
+    // Another load of the same file may have finished first
+    int index = Loader_FindInList(list, request->FilenameHash);
+    if (index >= 0)
+        return index;
+
+    ResourceType* resource = new ResourceType;
+    resource->FilenameHash = request->FilenameHash;
+    resource->UnloadPolicy = request->UnloadPolicy;
+
+    switch (request->Type) {
+        case ResourceLoader::TYPE_IMAGE: {
+            Texture* texture = Image::CreateTextureFromPixels(request->Filename, request->SheetPixels[0], request->SheetWidths[0], request->SheetHeights[0]);
+            if (!texture) {
+                delete resource;
+                return -1;
+            }
+            resource->AsImage = new Image(request->Filename, texture);
+            break;
+        }
+        case ResourceLoader::TYPE_SPRITE: {
+            // Upload the sheets into the atlas or the sprite sheet map,
+            //   where the sprite will find them instead of decoding them
+            //   again.
+            for (int i = 0; i < request->SheetCount; i++) {
+                if (!request->SheetPixels[i])
+                    continue;
+                if (Graphics::SpriteSheetTextureMap->Exists(request->SheetFilenames[i]))
+                    continue;
+
+                Texture* texture;
+                int offsetX, offsetY;
+                if (TextureAtlas::Get(request->SheetFilenames[i], request->SheetChecksums[i], &texture, &offsetX, &offsetY))
+                    continue;
+
+                ISprite::AddSpriteSheet(request->SheetFilenames[i], request->SheetChecksums[i], request->SheetPixels[i], request->SheetWidths[i], request->SheetHeights[i], &offsetX, &offsetY);
+            }
+            resource->AsSprite = new ISprite(request->Filename);
+            break;
+        }
+        case ResourceLoader::TYPE_SOUND:
+        case ResourceLoader::TYPE_MUSIC:
+            resource->AsSound = request->Sound;
+            request->Sound = NULL;
+            break;
+    }
+
+    bool emptySlot = false;
+    for (size_t i = 0, listSz = list->size(); i < listSz; i++) {
+        if (!(*list)[i]) {
+            (*list)[i] = resource;
+            index = (int)i;
+            emptySlot = true;
+            break;
+        }
+    }
+    if (!emptySlot) {
+        index = (int)list->size();
+        list->push_back(resource);
+    }
+    return index;
+}
+void         Loader_Finish(LoadRequest* request) {
+    LoadResult* result = &Loader_Results[request->Handle];
+    if (request->Cancelled) {
+        result->Status = ResourceLoader::STATUS_FAILED;
+        result->Index = -1;
+    }
+    else {
+        result->Index = request->Decoded ? Loader_Install(request) : -1;
+        result->Status = result->Index >= 0 ? ResourceLoader::STATUS_LOADED : ResourceLoader::STATUS_FAILED;
+        if (result->Status == ResourceLoader::STATUS_FAILED)
+            Log::Print(Log::LOG_ERROR, "Could not load \"%s\"!", request->Filename);
+    }
+
+    for (size_t i = 0; i < Loader_Outstanding.size(); i++) {
+        if (Loader_Outstanding[i] == request) {
+            Loader_Outstanding.erase(Loader_Outstanding.begin() + i);
+            break;
+        }
+    }
+    Loader_Free(request);
+}
+
+PUBLIC STATIC void ResourceLoader::Init() {
+    int threadCount = SDL_GetCPUCount() / 2;
+    if (threadCount < 1)
+        threadCount = 1;
+    if (Application::Settings) {
+        Application::Settings->GetInteger("dev", "loaderThreads", &threadCount);
+        Application::Settings->GetInteger("dev", "loaderBudget", &ResourceLoader::FrameBudget);
+    }
+    // Memory tracking isn't thread-safe, so decode on the main thread
+    //   while it's on.
+    if (Memory::IsTracking)
+        threadCount = 0;
+
+    ResourceLoader::ThreadCount = threadCount;
+    if (ResourceLoader::ThreadCount < 0)
+        ResourceLoader::ThreadCount = 0;
+    if (ResourceLoader::ThreadCount > LOADER_MAX_THREADS)
+        ResourceLoader::ThreadCount = LOADER_MAX_THREADS;
+
+    Loader_QueueLock = SDL_CreateMutex();
+    if (ResourceLoader::ThreadCount == 0)
+        return;
+
+    Loader_ThreadsQuit = false;
+    Loader_WorkSemaphore = SDL_CreateSemaphore(0);
+    for (int i = 0; i < ResourceLoader::ThreadCount; i++)
+        Loader_Threads[i] = SDL_CreateThread(Loader_WorkerThread, "ResourceLoader::WorkerThread", NULL);
+}
+PUBLIC STATIC int  ResourceLoader::Request(int type, const char* filename, Uint32 unloadPolicy) {
+    LoadResult result;
+    result.Status = ResourceLoader::STATUS_PENDING;
+    result.Index = -1;
+
+    int handle = (int)Loader_Results.size();
+
+    Uint32 filenameHash = CRC32::EncryptString(filename);
+    int index = Loader_FindInList(Loader_GetList(type), filenameHash);
+    if (index >= 0) {
+        result.Status = ResourceLoader::STATUS_LOADED;
+        result.Index = index;
+        Loader_Results.push_back(result);
+        return handle;
+    }
+    Loader_Results.push_back(result);
+
+    LoadRequest* request = new LoadRequest;
+    memset(request, 0, sizeof(LoadRequest));
+    request->Handle = handle;
+    request->Type = type;
+    strncpy(request->Filename, filename, 255);
+    request->FilenameHash = filenameHash;
+    request->UnloadPolicy = unloadPolicy;
+    Loader_Outstanding.push_back(request);
+
+    SDL_LockMutex(Loader_QueueLock);
+    Loader_Push(&Loader_PendingHead, &Loader_PendingTail, request);
+    SDL_UnlockMutex(Loader_QueueLock);
+
+    if (ResourceLoader::ThreadCount > 0)
+        SDL_SemPost(Loader_WorkSemaphore);
+
+    return handle;
+}
+PUBLIC STATIC int  ResourceLoader::GetStatus(int handle) {
+    if (handle < 0 || handle >= (int)Loader_Results.size())
+        return ResourceLoader::STATUS_FAILED;
+    return Loader_Results[handle].Status;
+}
+PUBLIC STATIC int  ResourceLoader::GetResult(int handle) {
+    if (handle < 0 || handle >= (int)Loader_Results.size())
+        return -1;
+    return Loader_Results[handle].Index;
+}
+PUBLIC STATIC int  ResourceLoader::GetPendingCount() {
+    return (int)Loader_Outstanding.size();
+}
+PUBLIC STATIC void ResourceLoader::Update() {
+    if (Loader_Outstanding.size() == 0)
+        return;
+
+    // Always finish at least one request per frame, so a single slow
+    //   upload can't stall the queue.
+    double start = Clock::GetTicks();
+    do {
+        SDL_LockMutex(Loader_QueueLock);
+        LoadRequest* request = Loader_Pop(&Loader_FinishedHead, &Loader_FinishedTail);
+        if (!request && ResourceLoader::ThreadCount == 0)
+            request = Loader_Pop(&Loader_PendingHead, &Loader_PendingTail);
+        SDL_UnlockMutex(Loader_QueueLock);
+        if (!request)
+            break;
+
+        if (!request->Decoded && !request->Cancelled && ResourceLoader::ThreadCount == 0)
+            Loader_Decode(request);
+
+        Loader_Finish(request);
+    }
+    while (Clock::GetTicks() - start < ResourceLoader::FrameBudget);
+}
+PUBLIC STATIC void ResourceLoader::DisposeInScope(Uint32 scope) {
+    // Requests that are still in flight are thrown away once they
+    //   finish, rather than ending up in the next scene's lists.
+    for (size_t i = 0; i < Loader_Outstanding.size(); i++) {
+        if (Loader_Outstanding[i]->UnloadPolicy <= scope)
+            Loader_Outstanding[i]->Cancelled = true;
+    }
+}
+PUBLIC STATIC void ResourceLoader::Dispose() {
+    if (ResourceLoader::ThreadCount > 0) {
+        Loader_ThreadsQuit = true;
+        for (int i = 0; i < ResourceLoader::ThreadCount; i++)
+            SDL_SemPost(Loader_WorkSemaphore);
+        for (int i = 0; i < ResourceLoader::ThreadCount; i++)
+            SDL_WaitThread(Loader_Threads[i], NULL);
+
+        SDL_DestroySemaphore(Loader_WorkSemaphore);
+        Loader_WorkSemaphore = NULL;
+        ResourceLoader::ThreadCount = 0;
+    }
+
+    for (size_t i = 0; i < Loader_Outstanding.size(); i++)
+        Loader_Free(Loader_Outstanding[i]);
+    Loader_Outstanding.clear();
+    Loader_Results.clear();
+    Loader_PendingHead = Loader_PendingTail = NULL;
+    Loader_FinishedHead = Loader_FinishedTail = NULL;
+
+    if (Loader_QueueLock) {
+        SDL_DestroyMutex(Loader_QueueLock);
+        Loader_QueueLock = NULL;
+    }
+}
@@ -16,26 +16,342 @@ public:
 #include <Engine/Filesystem/File.h>
 #include <Engine/Hashing/CRC32.h>
 #include <Engine/Includes/StandardSDL2.h>
+#include <Engine/IO/Compression/CompressionEnums.h>
 #include <Engine/IO/Compression/ZLibStream.h>
 #include <Engine/IO/FileStream.h>
 #include <Engine/IO/MemoryStream.h>
 #include <Engine/IO/Stream.h>
 #include <Engine/Application.h>
 
-struct      StreamNode {
-    Stream*            Table;
-    struct StreamNode* Next;
+#if WIN32
+    #include <windows.h>
+    #define RESOURCE_USE_MMAP
+#elif MACOSX || LINUX || UBUNTU || IOS
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define RESOURCE_USE_MMAP
+#endif
+
+#ifdef USING_LZ4
+    #include <lz4.h>
+#endif
+#ifdef USING_ZSTD
+    #include <zstd.h>
+#endif
+
+// NOTE: Data files are memory-mapped where the platform allows it, so
+//   only the pages of assets that are actually used get read in, and
+//   uncompressed entries can be handed out without copying. Otherwise
+//   entries are read at their offset from the open file.
+struct      ResourceBlock {
+    Uint64                  Offset;
+    Uint32                  CompressedSize;
+    Uint32                  Size;
+    Uint8                   Codec;
 };
-StreamNode* StreamNodeHead = NULL;
+struct      ResourceArchive {
+    Uint8*                  Data;
+    size_t                  Size;
+    ResourceBlock*          Blocks;
+    Uint32                  BlockCount;
+    Uint32                  BlockSize;
+    SDL_RWops*              RW;
+    SDL_mutex*              Lock;
+    #if WIN32
+    HANDLE                  FileHandle;
+    HANDLE                  MappingHandle;
+    #endif
+    struct ResourceArchive* Next;
+};
+ResourceArchive* ArchiveHead = NULL;
 
+// NOTE: Version 1 entries are a single zlib stream or raw data at
+//   Offset. Version 2 entries are BlockCount blocks starting at
+//   FirstBlock, each of them compressed on its own.
 struct  ResourceRegistryItem {
-    Stream* Table;
-    Uint64  Offset;
-    Uint64  Size;
-    Uint64  CompressedSize;
+    ResourceArchive* Archive;
+    Uint64           Offset;
+    Uint64           Size;
+    Uint64           CompressedSize;
+    Uint32           FirstBlock;
+    Uint32           BlockCount;
 };
 HashMap<ResourceRegistryItem>* ResourceRegistry = NULL;
 
+bool ResourceArchive_Map(ResourceArchive* archive, const char* path) {
+    #if WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        archive->Data = (Uint8*)data;
+        archive->Size = (size_t)size.QuadPart;
+        archive->FileHandle = file;
+        archive->MappingHandle = mapping;
+        return true;
+    #elif defined(RESOURCE_USE_MMAP)
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        archive->Data = (Uint8*)data;
+        archive->Size = (size_t)st.st_size;
+        return true;
+    #else
+        return false;
+    #endif
+}
+void ResourceArchive_Close(ResourceArchive* archive) {
+    if (archive->Data) {
+        #if WIN32
+            UnmapViewOfFile(archive->Data);
+            CloseHandle(archive->MappingHandle);
+            CloseHandle(archive->FileHandle);
+        #elif defined(RESOURCE_USE_MMAP)
+            munmap(archive->Data, archive->Size);
+        #endif
+    }
+    if (archive->RW)
+        SDL_RWclose(archive->RW);
+    if (archive->Lock)
+        SDL_DestroyMutex(archive->Lock);
+    if (archive->Blocks)
+        Memory::Free(archive->Blocks);
+    delete archive;
+}
+bool ResourceArchive_Read(ResourceArchive* archive, Uint64 offset, void* out, size_t size) {
+    if (offset > archive->Size || size > archive->Size - offset)
+        return false;
+
+    if (archive->Data) {
+        memcpy(out, archive->Data + offset, size);
+        return true;
+    }
+
+    // Seeking and reading have to happen together
+    SDL_LockMutex(archive->Lock);
+    bool success = SDL_RWseek(archive->RW, (Sint64)offset, RW_SEEK_SET) == (Sint64)offset &&
+        SDL_RWread(archive->RW, out, size, 1) == 1;
+    SDL_UnlockMutex(archive->Lock);
+    return success;
+}
+bool ResourceArchive_DecodeBlock(ResourceArchive* archive, ResourceBlock* block, Uint8* out) {
+    if (block->Codec == CompressionCodec::NONE)
+        return ResourceArchive_Read(archive, block->Offset, out, block->Size);
+
+    Uint8* src;
+    if (archive->Data) {
+        if (block->Offset > archive->Size || block->CompressedSize > archive->Size - block->Offset)
+            return false;
+        src = archive->Data + block->Offset;
+    }
+    else {
+        src = (Uint8*)Memory::Malloc(block->CompressedSize);
+        if (!src)
+            return false;
+        if (!ResourceArchive_Read(archive, block->Offset, src, block->CompressedSize)) {
+            Memory::Free(src);
+            return false;
+        }
+    }
+
+    bool success = true;
+    switch (block->Codec) {
+        case CompressionCodec::ZLIB:
+            success = ZLibStream::Decompress(out, block->Size, src, block->CompressedSize);
+            break;
+        #ifdef USING_LZ4
+        case CompressionCodec::LZ4:
+            success = LZ4_decompress_safe((const char*)src, (char*)out, (int)block->CompressedSize, (int)block->Size) == (int)block->Size;
+            break;
+        #endif
+        #ifdef USING_ZSTD
+        case CompressionCodec::ZSTD:
+            success = ZSTD_decompress(out, block->Size, src, block->CompressedSize) == block->Size;
+            break;
+        #endif
+        default:
+            Log::Print(Log::LOG_ERROR, "Unsupported resource block codec %d!", block->Codec);
+            success = false;
+            break;
+    }
+
+    if (!archive->Data)
+        Memory::Free(src);
+    return success;
+}
+bool ResourceArchive_LoadTableV1(ResourceArchive* archive) {
+    Uint8 count[2];
+    if (!ResourceArchive_Read(archive, 8, count, sizeof(count)))
+        return false;
+
+    Uint16 fileCount = count[0] | count[1] << 8;
+
+    // Only the table is read up front; entries stay in the archive
+    size_t tableSize = (size_t)fileCount * 32;
+    MemoryStream* tableStream = MemoryStream::New(tableSize);
+    if (!tableStream)
+        return false;
+    if (!ResourceArchive_Read(archive, 10, tableStream->pointer_start, tableSize)) {
+        tableStream->Close();
+        return false;
+    }
+
+    for (int i = 0; i < fileCount; i++) {
+        Uint32 crc32 = tableStream->ReadUInt32();
+        Uint64 offset = tableStream->ReadUInt64();
+        Uint64 size = tableStream->ReadUInt64();
+        // bool   compressed =
+        tableStream->ReadUInt32();
+        Uint64 compressedSize = tableStream->ReadUInt64();
+
+        ResourceRegistryItem item { archive, offset, size, compressedSize, 0, 0 };
+        ResourceRegistry->Put(crc32, item);
+        // Log::Print(Log::LOG_VERBOSE, "%08X: Offset: %08llX Size: %08llX Comp Size: %08llX", crc32, offset, size, compressedSize);
+    }
+    tableStream->Close();
+    return true;
+}
+bool ResourceArchive_LoadTableV2(ResourceArchive* archive) {
+    // Uint32 entryCount, blockCount, blockSize, reserved;
+    // Uint64 indexOffset;
+    Uint8 header[24];
+    if (!ResourceArchive_Read(archive, 8, header, sizeof(header)))
+        return false;
+
+    MemoryStream* headerStream = MemoryStream::New(header, sizeof(header));
+    Uint32 entryCount = headerStream->ReadUInt32();
+    Uint32 blockCount = headerStream->ReadUInt32();
+    Uint32 blockSize = headerStream->ReadUInt32();
+    headerStream->ReadUInt32();
+    Uint64 indexOffset = headerStream->ReadUInt64();
+    headerStream->Close();
+
+    if (blockSize == 0)
+        return false;
+
+    // Index is the sorted entry table followed by the block table
+    size_t indexSize = (size_t)entryCount * 24 + (size_t)blockCount * 20;
+    MemoryStream* indexStream = MemoryStream::New(indexSize);
+    if (!indexStream)
+        return false;
+    if (!ResourceArchive_Read(archive, indexOffset, indexStream->pointer_start, indexSize)) {
+        indexStream->Close();
+        return false;
+    }
+
+    archive->BlockSize = blockSize;
+    archive->BlockCount = blockCount;
+    archive->Blocks = (ResourceBlock*)Memory::TrackedCalloc("ResourceArchive::Blocks", blockCount ? blockCount : 1, sizeof(ResourceBlock));
+
+    indexStream->Seek((Sint64)entryCount * 24);
+    for (Uint32 i = 0; i < blockCount; i++) {
+        ResourceBlock* block = &archive->Blocks[i];
+        block->Offset = indexStream->ReadUInt64();
+        block->CompressedSize = indexStream->ReadUInt32();
+        block->Size = indexStream->ReadUInt32();
+        block->Codec = indexStream->ReadByte();
+        indexStream->Skip(3);
+    }
+
+    indexStream->Seek(0);
+    for (Uint32 i = 0; i < entryCount; i++) {
+        Uint32 crc32 = indexStream->ReadUInt32();
+        Uint32 firstBlock = indexStream->ReadUInt32();
+        Uint32 entryBlocks = indexStream->ReadUInt32();
+        // Uint32 flags =
+        indexStream->ReadUInt32();
+        Uint64 size = indexStream->ReadUInt64();
+
+        if (firstBlock > blockCount || entryBlocks > blockCount - firstBlock) {
+            indexStream->Close();
+            return false;
+        }
+
+        Uint64 offset = entryBlocks ? archive->Blocks[firstBlock].Offset : 0;
+        Uint64 compressedSize = 0;
+        for (Uint32 b = 0; b < entryBlocks; b++)
+            compressedSize += archive->Blocks[firstBlock + b].CompressedSize;
+
+        ResourceRegistryItem item { archive, offset, size, compressedSize, firstBlock, entryBlocks };
+        ResourceRegistry->Put(crc32, item);
+    }
+    indexStream->Close();
+    return true;
+}
+bool ResourceArchive_ReadEntry(ResourceRegistryItem* item, Uint8* out) {
+    if (item->BlockCount) {
+        Uint8* dst = out;
+        for (Uint32 b = 0; b < item->BlockCount; b++) {
+            ResourceBlock* block = &item->Archive->Blocks[item->FirstBlock + b];
+            if ((Uint64)(dst - out) + block->Size > item->Size)
+                return false;
+            if (!ResourceArchive_DecodeBlock(item->Archive, block, dst))
+                return false;
+            dst += block->Size;
+        }
+        // The blocks have to cover the entry exactly
+        return (Uint64)(dst - out) == item->Size;
+    }
+
+    if (item->Size == item->CompressedSize)
+        return ResourceArchive_Read(item->Archive, item->Offset, out, (size_t)item->Size);
+
+    // Mapped archives can be inflated straight from the mapping
+    ResourceArchive* archive = item->Archive;
+    if (archive->Data) {
+        if (item->Offset > archive->Size || item->CompressedSize > archive->Size - item->Offset)
+            return false;
+
+        return ZLibStream::Decompress(out, (size_t)item->Size, archive->Data + item->Offset, (size_t)item->CompressedSize);
+    }
+
+    Uint8* compressedMemory = (Uint8*)Memory::Malloc(item->CompressedSize);
+    if (!compressedMemory)
+        return false;
+    if (!ResourceArchive_Read(archive, item->Offset, compressedMemory, (size_t)item->CompressedSize)) {
+        Memory::Free(compressedMemory);
+        return false;
+    }
+
+    bool success = ZLibStream::Decompress(out, (size_t)item->Size, compressedMemory, (size_t)item->CompressedSize);
+    Memory::Free(compressedMemory);
+    return success;
+}
+
 bool                 ResourceManager::UsingDataFolder = true;
 
 PUBLIC STATIC void   ResourceManager::PrefixResourcePath(char* out, const char* path) {
@@ -91,61 +407,51 @@ PUBLIC STATIC void   ResourceManager::Load(const char* filename) {
     char resourcePath[256];
     ResourceManager::PrefixParentPath(resourcePath, filename);
 
-    SDL_RWops* rw = SDL_RWFromFile(resourcePath, "rb");
-    if (!rw) {
-        // Log::Print(Log::LOG_ERROR, "ResourceManager::Load: No RW!: %s", resourcePath, SDL_GetError());
-        return;
-    }
+    ResourceArchive* archive = new ResourceArchive();
+    if (!ResourceArchive_Map(archive, resourcePath)) {
+        archive->RW = SDL_RWFromFile(resourcePath, "rb");
+        if (!archive->RW) {
+            // Log::Print(Log::LOG_ERROR, "ResourceManager::Load: No RW!: %s", resourcePath, SDL_GetError());
+            delete archive;
+            return;
+        }
 
-    Sint64 rwSize = SDL_RWsize(rw);
-    if (rwSize < 0) {
-        Log::Print(Log::LOG_ERROR, "Could not get size of file \"%s\": %s", resourcePath, SDL_GetError());
-        return;
+        Sint64 rwSize = SDL_RWsize(archive->RW);
+        if (rwSize < 0) {
+            Log::Print(Log::LOG_ERROR, "Could not get size of file \"%s\": %s", resourcePath, SDL_GetError());
+            ResourceArchive_Close(archive);
+            return;
+        }
+        archive->Size = (size_t)rwSize;
+        archive->Lock = SDL_CreateMutex();
     }
 
-    MemoryStream* dataTableStream = MemoryStream::New(rwSize);
-    if (!dataTableStream) {
-        Log::Print(Log::LOG_ERROR, "Could not open MemoryStream!");
+    Uint8 header[8];
+    if (!ResourceArchive_Read(archive, 0, header, sizeof(header)) || memcmp(header, "HATCH", 5)) {
+        Log::Print(Log::LOG_ERROR, "Invalid HATCH data file \"%s\"!", filename);
+        ResourceArchive_Close(archive);
         return;
     }
 
-    SDL_RWread(rw, dataTableStream->pointer_start, rwSize, 1);
-    SDL_RWclose(rw);
+    // Uint8 major, minor, pad;
+    Uint8 major = header[5];
 
-    Uint16 fileCount;
-    Uint8 magicHATCH[5];
-    dataTableStream->ReadBytes(magicHATCH, 5);
-    if (memcmp(magicHATCH, "HATCH", 5)) {
+    Log::Print(Log::LOG_VERBOSE, "Loading resource table from \"%s\" (version %d%s)...", filename, major, archive->Data ? ", mapped" : "");
+    bool loaded;
+    if (major >= 2)
+        loaded = ResourceArchive_LoadTableV2(archive);
+    else
+        loaded = ResourceArchive_LoadTableV1(archive);
+
+    if (!loaded) {
         Log::Print(Log::LOG_ERROR, "Invalid HATCH data file \"%s\"!", filename);
-        dataTableStream->Close();
+        ResourceArchive_Close(archive);
         return;
     }
 
-    // Uint8 major, minor, pad;
-    dataTableStream->ReadByte();
-    dataTableStream->ReadByte();
-    dataTableStream->ReadByte();
-
-    // Add stream to list for closure on disposal
-    StreamNode* streamNode = new StreamNode;
-    streamNode->Table = dataTableStream;
-    streamNode->Next = StreamNodeHead;
-    StreamNodeHead = streamNode;
-
-    Log::Print(Log::LOG_VERBOSE, "Loading resource table from \"%s\"...", filename);
-    fileCount = dataTableStream->ReadUInt16();
-    for (int i = 0; i < fileCount; i++) {
-        Uint32 crc32 = dataTableStream->ReadUInt32();
-        Uint64 offset = dataTableStream->ReadUInt64();
-        Uint64 size = dataTableStream->ReadUInt64();
-        // bool   compressed =
-        dataTableStream->ReadUInt32();
-        Uint64 compressedSize = dataTableStream->ReadUInt64();
-
-        ResourceRegistryItem item { dataTableStream, offset, size, compressedSize };
-        ResourceRegistry->Put(crc32, item);
-        // Log::Print(Log::LOG_VERBOSE, "%08X: Offset: %08llX Size: %08llX Comp Size: %08llX", crc32, offset, size, compressedSize);
-    }
+    // Add archive to list for closure on disposal
+    archive->Next = ArchiveHead;
+    ArchiveHead = archive;
 }
 PUBLIC STATIC bool   ResourceManager::LoadResource(const char* filename, Uint8** out, size_t* size) {
     Uint8* memory;
@@ -169,20 +475,9 @@ PUBLIC STATIC bool   ResourceManager::LoadResource(const char* filename, Uint8**
 
     memory[item.Size] = 0;
 
-    item.Table->Seek(item.Offset);
-    if (item.Size != item.CompressedSize) {
-        Uint8* compressedMemory = (Uint8*)Memory::Malloc(item.Size);
-        if (!compressedMemory) {
-            Memory::Free(memory);
-            goto DATA_FOLDER;
-        }
-        item.Table->ReadBytes(compressedMemory, item.CompressedSize);
-
-        ZLibStream::Decompress(memory, (size_t)item.Size, compressedMemory, (size_t)item.CompressedSize);
-        Memory::Free(compressedMemory);
-    }
-    else {
-        item.Table->ReadBytes(memory, item.Size);
+    if (!ResourceArchive_ReadEntry(&item, memory)) {
+        Memory::Free(memory);
+        goto DATA_FOLDER;
     }
 
     *out = memory;
@@ -216,6 +511,73 @@ PUBLIC STATIC bool   ResourceManager::LoadResource(const char* filename, Uint8**
     *size = rwSize;
     return true;
 }
+PUBLIC STATIC bool   ResourceManager::MapResource(const char* filename, Uint8** out, size_t* size) {
+    if (ResourceManager::UsingDataFolder || !ResourceRegistry)
+        return false;
+
+    if (!ResourceRegistry->Exists(filename))
+        return false;
+
+    // Only uncompressed entries in a mapped archive can be viewed in place
+    ResourceRegistryItem item = ResourceRegistry->Get(filename);
+    if (!item.Archive->Data || item.Size != item.CompressedSize)
+        return false;
+    for (Uint32 b = 0; b < item.BlockCount; b++) {
+        ResourceBlock* block = &item.Archive->Blocks[item.FirstBlock + b];
+        if (block->Codec != CompressionCodec::NONE || block->Offset != item.Offset + (Uint64)b * item.Archive->BlockSize)
+            return false;
+    }
+    if (item.Offset > item.Archive->Size || item.Size > item.Archive->Size - item.Offset)
+        return false;
+
+    *out = item.Archive->Data + item.Offset;
+    *size = (size_t)item.Size;
+    return true;
+}
+PUBLIC STATIC void*  ResourceManager::OpenResourceBlocks(const char* filename, size_t* size, size_t* blockSize) {
+    if (ResourceManager::UsingDataFolder || !ResourceRegistry)
+        return NULL;
+
+    if (!ResourceRegistry->Exists(filename))
+        return NULL;
+
+    // Only worth it for entries that span more than one block
+    ResourceRegistryItem item = ResourceRegistry->Get(filename);
+    if (item.BlockCount < 2)
+        return NULL;
+
+    // Blocks are laid out at fixed BlockSize strides in the stream's
+    //   buffer, so every block but the last has to be full.
+    Uint64 stride = item.Archive->BlockSize;
+    if (item.BlockCount != (item.Size + stride - 1) / stride)
+        return NULL;
+
+    ResourceRegistryItem* entry = new ResourceRegistryItem(item);
+    *size = (size_t)item.Size;
+    *blockSize = item.Archive->BlockSize;
+    return entry;
+}
+PUBLIC STATIC bool   ResourceManager::ReadResourceBlock(void* entry, Uint32 index, Uint8* out) {
+    ResourceRegistryItem* item = (ResourceRegistryItem*)entry;
+    if (index >= item->BlockCount)
+        return false;
+
+    ResourceBlock* block = &item->Archive->Blocks[item->FirstBlock + index];
+    Uint64 start = (Uint64)index * item->Archive->BlockSize;
+    if (start >= item->Size)
+        return false;
+
+    Uint64 expected = item->Size - start;
+    if (expected > item->Archive->BlockSize)
+        expected = item->Archive->BlockSize;
+    if (block->Size != expected)
+        return false;
+
+    return ResourceArchive_DecodeBlock(item->Archive, block, out);
+}
+PUBLIC STATIC void   ResourceManager::CloseResourceBlocks(void* entry) {
+    delete (ResourceRegistryItem*)entry;
+}
 PUBLIC STATIC bool   ResourceManager::ResourceExists(const char* filename) {
     char resourcePath[256];
     if (ResourceManager::UsingDataFolder)
@@ -240,15 +602,13 @@ PUBLIC STATIC bool   ResourceManager::ResourceExists(const char* filename) {
     return true;
 }
 PUBLIC STATIC void   ResourceManager::Dispose() {
-    if (StreamNodeHead) {
-        for (StreamNode *old, *streamNode = StreamNodeHead; streamNode; ) {
-            old = streamNode;
-            streamNode = streamNode->Next;
+    for (ResourceArchive *old, *archive = ArchiveHead; archive; ) {
+        old = archive;
+        archive = archive->Next;
 
-            old->Table->Close();
-            delete old;
-        }
+        ResourceArchive_Close(old);
     }
+    ArchiveHead = NULL;
     if (ResourceRegistry) {
         delete ResourceRegistry;
     }
@@ -452,7 +452,7 @@ PUBLIC STATIC bool RSDKSceneReader::Read(const char* filename, const char* paren
                                 ObjString* str = AllocString(r->ReadUInt16());
                                 for (int c = 0; c < str->Length; c++)
                                     str->Chars[c] = (char)(Uint8)r->ReadUInt16();
-                                val = OBJECT_VAL(str);
+                                val = OBJECT_VAL(InternString(str));
                                 break;
                             }
                             // Position
@@ -30,6 +30,8 @@ public:
     static int                   DynamicObjectCount;
     static Entity*               DynamicObjectFirst;
     static Entity*               DynamicObjectLast;
+    static vector<Entity*>       StaticObjectArray;
+    static vector<Entity*>       DynamicObjectArray;
 
     static int                   PriorityPerLayer;
     static vector<Entity*>*      PriorityLists;
@@ -92,6 +94,7 @@ public:
 #include <Engine/Rendering/GL/GLRenderer.h>
 #include <Engine/ResourceTypes/SceneFormats/RSDKSceneReader.h>
 #include <Engine/ResourceTypes/ISound.h>
+#include <Engine/ResourceTypes/ResourceLoader.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
 #include <Engine/ResourceTypes/SceneFormats/TiledMapReader.h>
 #include <Engine/TextFormats/XML/XMLParser.h>
@@ -128,6 +131,9 @@ Entity*               Scene::StaticObjectLast = NULL;
 int                   Scene::DynamicObjectCount = 0;
 Entity*               Scene::DynamicObjectFirst = NULL;
 Entity*               Scene::DynamicObjectLast = NULL;
+vector<Entity*>       Scene::StaticObjectArray;
+vector<Entity*>       Scene::DynamicObjectArray;
+int                   ObjectArrayHoles = 0;
 
 // Tile variables
 ISprite*              Scene::TileSprite = NULL;
@@ -167,15 +173,45 @@ const char*           DEBUG_lastTileColFilename = NULL;
 
 int SCOPE_SCENE = 0;
 int SCOPE_GAME = 1;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH_ENTITY(ent) __builtin_prefetch(ent)
+#else
+#define PREFETCH_ENTITY(ent)
+#endif
+
+// NOTE: How many slots ahead of the current entity the update
+//   passes prefetch.
+#define ENTITY_PREFETCH_DISTANCE 4
+
 int TileViewRenderFlag = 0x01;
-int TileBatchMaxSize = 8;
 
-struct TileBatch {
+// NOTE: Tile layers are drawn in chunks of TILE_CHUNK_SIZE x
+//   TILE_CHUNK_SIZE tiles when the renderer supports batching. Each
+//   chunk keeps a static vertex buffer that is only rebuilt after
+//   SetTile marks it dirty.
+#define TILE_CHUNK_SIZE 16
+
+struct TileChunk {
     Uint32 BufferID;
     Uint32 VertexCount;
-    Uint32 Width;
-    Uint32 Height;
+    bool   Dirty;
 };
+struct TileChunkVertex {
+    float x;
+    float y;
+    float z;
+    float u;
+    float v;
+};
+
+TileChunkVertex TileChunkVertices[TILE_CHUNK_SIZE * TILE_CHUNK_SIZE * 6];
+
+int TileFloorDiv(int a, int b) {
+    if (a >= 0)
+        return a / b;
+    return -((-a + b - 1) / b);
+}
 
 void _ObjectList_RemoveNonPersistentDynamicFromLists(Uint32, ObjectList* list) {
     // NOTE: We don't use any list clearing functions so that
@@ -297,6 +333,21 @@ void _UpdateObject(Entity* ent) {
     ent->PriorityOld = ent->Priority;
 }
 
+void _UpdateObjectArray(vector<Entity*>& array, void (*update)(Entity*)) {
+    // NOTE: The size is re-read every iteration so that objects
+    //   created during this pass are still updated this frame,
+    //   same as when it walked the linked list. Removed objects
+    //   leave a NULL slot behind until the array is compacted.
+    for (size_t i = 0; i < array.size(); i++) {
+        if (i + ENTITY_PREFETCH_DISTANCE < array.size())
+            PREFETCH_ENTITY(array[i + ENTITY_PREFETCH_DISTANCE]);
+
+        Entity* ent = array[i];
+        if (ent)
+            update(ent);
+    }
+}
+
 // Double linked-list functions
 PUBLIC STATIC void Scene::Add(Entity** first, Entity** last, int* count, Entity* obj) {
     // Set "prev" of obj to last
@@ -315,6 +366,11 @@ PUBLIC STATIC void Scene::Add(Entity** first, Entity** last, int* count, Entity*
 
     (*count)++;
 
+    // Add to the dense array
+    vector<Entity*>* array = Scene::GetObjectArray(first);
+    obj->SceneIndex = (int)array->size();
+    array->push_back(obj);
+
     // Add to proper list
     if (!obj->List) {
         Log::Print(Log::LOG_IMPORTANT, "obj->List = NULL");
@@ -339,6 +395,14 @@ PUBLIC STATIC void Scene::Remove(Entity** first, Entity** last, int* count, Enti
 
     (*count)--;
 
+    // Leave a hole in the dense array, filled in by CompactObjectArrays
+    vector<Entity*>* array = Scene::GetObjectArray(first);
+    if (obj->SceneIndex >= 0 && obj->SceneIndex < (int)array->size() && (*array)[obj->SceneIndex] == obj) {
+        (*array)[obj->SceneIndex] = NULL;
+        ObjectArrayHoles++;
+    }
+    obj->SceneIndex = -1;
+
     // Remove from proper list
     if (!obj->List) {
         Log::Print(Log::LOG_IMPORTANT, "obj->List = NULL");
@@ -350,6 +414,32 @@ PUBLIC STATIC void Scene::Clear(Entity** first, Entity** last, int* count) {
     (*first) = NULL;
     (*last) = NULL;
     (*count) = 0;
+
+    Scene::GetObjectArray(first)->clear();
+}
+PUBLIC STATIC void Scene::CompactObjectArrays() {
+    if (!ObjectArrayHoles)
+        return;
+
+    vector<Entity*>* arrays[2] = { &Scene::StaticObjectArray, &Scene::DynamicObjectArray };
+    for (int a = 0; a < 2; a++) {
+        vector<Entity*>& array = *arrays[a];
+        size_t w = 0;
+        for (size_t r = 0, rSz = array.size(); r < rSz; r++) {
+            Entity* ent = array[r];
+            if (!ent)
+                continue;
+            ent->SceneIndex = (int)w;
+            array[w++] = ent;
+        }
+        array.resize(w);
+    }
+    ObjectArrayHoles = 0;
+}
+PRIVATE STATIC vector<Entity*>* Scene::GetObjectArray(Entity** first) {
+    if (first == &Scene::StaticObjectFirst)
+        return &Scene::StaticObjectArray;
+    return &Scene::DynamicObjectArray;
 }
 
 // Object management
@@ -420,38 +510,28 @@ PUBLIC STATIC void Scene::Update() {
     if (Scene::ObjectLists)
         Scene::ObjectLists->ForAll(_ObjectList_ResetPerf);
 
+    // NOTE: These passes walk the dense object arrays instead of
+    //   the NextEntity chain; the linked lists are still kept for
+    //   everything else that iterates over objects.
+
     // Early Update
-    for (Entity* ent = Scene::StaticObjectFirst, *next; ent; ent = next) {
-        next = ent->NextEntity;
-        _UpdateObjectEarly(ent);
-    }
-    for (Entity* ent = Scene::DynamicObjectFirst, *next; ent; ent = next) {
-        next = ent->NextEntity;
-        _UpdateObjectEarly(ent);
-    }
+    _UpdateObjectArray(Scene::StaticObjectArray, _UpdateObjectEarly);
+    _UpdateObjectArray(Scene::DynamicObjectArray, _UpdateObjectEarly);
 
     // Update objects
-    for (Entity* ent = Scene::StaticObjectFirst, *next; ent; ent = next) {
-        // Store the "next" so that when/if the current is removed,
-        // it can still be used to point at the end of the loop.
-        next = ent->NextEntity;
+    _UpdateObjectArray(Scene::StaticObjectArray, _UpdateObject);
+    _UpdateObjectArray(Scene::DynamicObjectArray, _UpdateObject);
 
-        // Execute whatever on object
-        _UpdateObject(ent);
-    }
-    for (Entity* ent = Scene::DynamicObjectFirst, *next; ent; ent = next) {
-        next = ent->NextEntity;
+    // Late Update
+    _UpdateObjectArray(Scene::StaticObjectArray, _UpdateObjectLate);
+    for (size_t i = 0; i < Scene::DynamicObjectArray.size(); i++) {
+        if (i + ENTITY_PREFETCH_DISTANCE < Scene::DynamicObjectArray.size())
+            PREFETCH_ENTITY(Scene::DynamicObjectArray[i + ENTITY_PREFETCH_DISTANCE]);
 
-        _UpdateObject(ent);
-    }
+        Entity* ent = Scene::DynamicObjectArray[i];
+        if (!ent)
+            continue;
 
-    // Late Update
-    for (Entity* ent = Scene::StaticObjectFirst, *next; ent; ent = next) {
-        next = ent->NextEntity;
-        _UpdateObjectLate(ent);
-    }
-    for (Entity* ent = Scene::DynamicObjectFirst, *next; ent; ent = next) {
-        next = ent->NextEntity;
         _UpdateObjectLate(ent);
 
         if (!ent->Active) {
@@ -460,6 +540,8 @@ PUBLIC STATIC void Scene::Update() {
         }
     }
 
+    Scene::CompactObjectArrays();
+
     #ifndef NO_LIBAV
         AudioManager::Lock();
         Uint8 audio_buffer[0x8000]; // <-- Should be larger than AudioManager::AudioQueueMaxSize
@@ -628,79 +710,12 @@ PUBLIC STATIC void Scene::Render() {
 
                     TileConfig* baseTileCfg = Scene::ShowTileCollisionFlag == 2 ? Scene::TileCfgB : Scene::TileCfgA;
 
-                    int layerWidth = layer.Width / tileSize;
-                    int layerHeight = layer.Height / tileSize;
-
                     Graphics::SetBlendColor(1.0, 1.0, 1.0, 1.0);
 
-                    if (false && (!layer.ScrollInfosSplitIndexes || layer.ScrollInfosSplitIndexesCount == 0 || layer.RelativeY == 0x100)) {
-                        baseXOff = (int)std::floor(currentView->X);
-                        baseYOff = (int)std::floor(currentView->Y);
-                        baseXOff += layer.OffsetX;
-                        baseYOff += layer.OffsetY;
-
-                        TileBaseX = baseXOff;
-                        TileBaseY = baseYOff;
-
-                        int xxx = cx;
-                        int yyy = cy;
-                        // int xxx = baseXOff % layerWidth;
-                        // int yyy = baseYOff % layerHeight;
-                        // if (xxx < 0) xxx += layerWidth;
-                        // if (yyy < 0) yyy += layerHeight;
-
-                        // xxx += ;
-                        // yyy += ;
-
-                        Graphics::Translate(-xxx, -yyy, 0.0f);
-                        int batch_start_x = (int)(baseXOff / tileSize) / TileBatchMaxSize - 1;
-                        int batch_start_y = (int)(baseYOff / tileSize) / TileBatchMaxSize - 1;
-                        int batch_end_x = ((int)(baseXOff + currentView->Width) / tileSize) / TileBatchMaxSize + 2;
-                        int batch_end_y = ((int)(baseYOff + currentView->Height) / tileSize) / TileBatchMaxSize + 2;
-
-                        int batch_count_x = (layer.Width + TileBatchMaxSize - 1) / TileBatchMaxSize;
-                        int batch_count_y = (layer.Height + TileBatchMaxSize - 1) / TileBatchMaxSize;
-                        if (batch_start_x < 0)
-                            batch_start_x = 0;
-                        if (batch_start_y < 0)
-                            batch_start_y = 0;
-                        if (batch_end_x > batch_count_x)
-                            batch_end_x = batch_count_x;
-                        if (batch_end_y > batch_count_y)
-                            batch_end_y = batch_count_y;
-
-                        for (int x = batch_start_x; x < batch_end_x; x++) {
-                            for (int y = batch_start_y; y < batch_end_y; y++) {
-                                TileBatch* tileBatch = &((TileBatch*)layer.TileBatches)[x + y * batch_count_x];
-                                // Graphics::Save();
-                                // Graphics::Translate(-xxx + x * 1.0f, -yyy + y * 1.0, 0.0f);
-                                    GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], tileBatch->BufferID, tileBatch->VertexCount);
-                                // Graphics::Restore();
-                            }
-                        }
-
-                        // if (Graphics::SupportsBatching && Application::Platform == Platforms::Android && false) { // && Scene::UseBatchedTiles
-                        //     int xxx = baseXOff % layerWidth;
-                        //     int yyy = baseYOff % layerHeight;
-                        //     if (xxx < 0) xxx += layerWidth;
-                        //     if (yyy < 0) yyy += layerHeight;
-                        //
-                        //     Graphics::Save();
-                        //     Graphics::Translate(-xxx, -yyy, 0.0f);
-                        //         GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                        //         if (!(layer.Flags & SceneLayer::FLAGS_NO_REPEAT_X)) {
-                        //             Graphics::Translate(layerWidth, 0.0f, 0.0f);
-                        //             GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                        //         }
-                        //         if (layerWidth < currentView->Width) {
-                        //             Graphics::Translate(layerWidth, 0.0f, 0.0f);
-                        //             GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                        //         }
-                        //     Graphics::Restore();
-                        //
-                        //     Graphics::Restore();
-                        //     continue;
-                        // }
+                    if (Graphics::SupportsBatching && !Scene::ShowTileCollisionFlag &&
+                        (!layer.ScrollInfosSplitIndexes || layer.ScrollInfosSplitIndexesCount == 0) &&
+                        Scene::TileSprite->Spritesheets[0]) {
+                        Scene::RenderTileChunks(li, currentView);
                     }
                     else {
                         if (layer.ScrollInfosSplitIndexes && layer.ScrollInfosSplitIndexesCount > 0) {
@@ -869,29 +884,6 @@ PUBLIC STATIC void Scene::Render() {
                             TileBaseX = baseXOff;
                             TileBaseY = baseYOff;
 
-                            if (Graphics::SupportsBatching && Application::Platform == Platforms::Android && false) { // && Scene::UseBatchedTiles
-                                int xxx = baseXOff % layerWidth;
-                                int yyy = baseYOff % layerHeight;
-                                if (xxx < 0) xxx += layerWidth;
-                                if (yyy < 0) yyy += layerHeight;
-
-                                Graphics::Save();
-                                Graphics::Translate(-xxx, -yyy, 0.0f);
-                                    GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                                    if (!(layer.Flags & SceneLayer::FLAGS_NO_REPEAT_X)) {
-                                        Graphics::Translate(layerWidth, 0.0f, 0.0f);
-                                        GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                                    }
-                                    if (layerWidth < currentView->Width) {
-                                        Graphics::Translate(layerWidth, 0.0f, 0.0f);
-                                        GLRenderer::DrawTexturedShapeBuffer(Scene::TileSprite->Spritesheets[0], layer.BufferID, layer.VertexCount);
-                                    }
-                                Graphics::Restore();
-
-                                Graphics::Restore();
-                                continue;
-                            }
-
                             int tileCellStartX = (TileBaseX / tileSize);
                             int tileCellStartY = (TileBaseY / tileSize);
                             int tileCellEndX = tileCellStartX + tileCellMaxWidth;
@@ -1287,8 +1279,11 @@ PUBLIC STATIC void Scene::Restart() {
             memcpy(Layers[l].Tiles, Layers[l].TilesBackup, Layers[l].Width * Layers[l].Height * sizeof(Uint32));
         }
         Scene::AnyLayerTileChange = false;
+
+        for (int l = 0; l < (int)Layers.size(); l++) {
+            Scene::SetTileChunksDirty(l);
+        }
     }
-    Scene::UpdateTileBatchAll();
 
     if (Scene::PriorityLists) {
         for (int l = 0; l < Scene::PriorityPerLayer; l++) {
@@ -1378,6 +1373,7 @@ PUBLIC STATIC void Scene::LoadScene(const char* filename) {
 
     // Dispose of layers
     for (size_t i = 0; i < Scene::Layers.size(); i++) {
+        Scene::DisposeTileChunks(&Scene::Layers[i]);
         Scene::Layers[i].Dispose();
     }
     Scene::Layers.clear();
@@ -1732,6 +1728,8 @@ PUBLIC STATIC void Scene::SaveTileCollisions() {
 }
 
 PUBLIC STATIC void Scene::DisposeInScope(Uint32 scope) {
+    ResourceLoader::DisposeInScope(scope);
+
     // Images
     for (size_t i = 0, i_sz = Scene::ImageList.size(); i < i_sz; i++) {
         if (!Scene::ImageList[i]) continue;
@@ -1843,6 +1841,7 @@ PUBLIC STATIC void Scene::Dispose() {
     Scene::PriorityLists = NULL;
 
     for (size_t i = 0; i < Scene::Layers.size(); i++) {
+        Scene::DisposeTileChunks(&Scene::Layers[i]);
         Scene::Layers[i].Dispose();
     }
     Scene::Layers.clear();
@@ -1885,124 +1884,37 @@ PUBLIC STATIC void Scene::Exit() {
 
 }
 
-// Tile Batching
-PUBLIC STATIC void Scene::UpdateTileBatchAll() {
-    for (size_t l = 0; l < Scene::Layers.size(); l++) {
-        SceneLayer* layer = &Scene::Layers[l];
-        int batch_count_x = (layer->Width + TileBatchMaxSize - 1) / TileBatchMaxSize;
-        int batch_count_y = (layer->Height + TileBatchMaxSize - 1) / TileBatchMaxSize;
-        for (int x = 0; x < batch_count_x; x++) {
-            for (int y = 0; y < batch_count_y; y++) {
-                UpdateTileBatch(l, x, y);
-            }
-        }
-    }
-    /*
-    struct tempVertex {
-        float x;
-        float y;
-        float z;
-        float u;
-        float v;
-    };
-    float spriteW = Scene::TileSprite->Spritesheets[0]->Width;
-    float spriteH = Scene::TileSprite->Spritesheets[0]->Height;
-    float tileSize = (float)Scene::TileSize;
-    for (size_t l = 0; l < Scene::Layers.size(); l++) {
-        SceneLayer* layer = &Scene::Layers[l];
-        int sz = layer->Width * layer->Height;
-        if (!layer->Visible) continue;
-
-        tempVertex* buffer = (tempVertex*)Memory::Malloc(sz * sizeof(tempVertex) * 6);
-
-        int    vertexCount = 0;
-        int    tSauce, tileID, flipX, flipY, tx, ty, srcx, srcy;
-        float  left, right, top, bottom, posX, posY, posXW, posYH;
-        for (int t = 0; t < sz; t++) {
-            if ((layer->Tiles[t] & TILE_IDENT_MASK) == EmptyTile) continue;
-
-            tSauce = layer->Tiles[t];
-
-            tileID = tSauce & TILE_IDENT_MASK;
-            flipX  = tSauce & TILE_FLIPX_MASK;
-            flipY  = tSauce & TILE_FLIPY_MASK;
-
-            tx = t % layer->Width;
-            ty = t / layer->Width;
-            srcx = Scene::TileSprite->Animations[0].Frames[tileID].X;
-            srcy = Scene::TileSprite->Animations[0].Frames[tileID].Y;
-
-            if (flipX) {
-                right = (srcx) / spriteW;
-                left  = (srcx + tileSize) / spriteW;
-            }
-            else {
-                left  = (srcx) / spriteW;
-                right = (srcx + tileSize) / spriteW;
-            }
-            if (flipY) {
-                bottom = (srcy) / spriteH;
-                top    = (srcy + tileSize) / spriteH;
-            }
-            else {
-                top    = (srcy) / spriteH;
-                bottom = (srcy + tileSize) / spriteH;
-            }
-
-            posX = tx * tileSize;
-            posY = ty * tileSize;
-            posXW = posX + tileSize;
-            posYH = posY + tileSize;
-
-            buffer[vertexCount++] = tempVertex { posX, posY, 0.0f, left, top };
-            buffer[vertexCount++] = tempVertex { posX, posYH, 0.0f, left, bottom };
-            buffer[vertexCount++] = tempVertex { posXW, posY, 0.0f, right, top };
-
-            buffer[vertexCount++] = tempVertex { posXW, posY, 0.0f, right, top };
-            buffer[vertexCount++] = tempVertex { posX, posYH, 0.0f, left, bottom };
-            buffer[vertexCount++] = tempVertex { posXW, posYH, 0.0f, right, bottom };
-        }
-
-        layer->BufferID = GLRenderer::CreateTexturedShapeBuffer((float*)buffer, vertexCount);
-        // layer->BufferID = D3DRenderer::CreateTexturedShapeBuffer((float**)&buffer, vertexCount);
-        layer->VertexCount = vertexCount;
+// Tile Chunks
+PUBLIC STATIC void Scene::SetTileChunksDirty(int l) {
+    SceneLayer* layer = &Scene::Layers[l];
+    TileChunk* chunks = (TileChunk*)layer->TileChunks;
+    if (!chunks)
+        return;
 
-        Memory::Free(buffer);
-    }
-    //*/
+    int chunkCount = layer->TileChunkCountX * layer->TileChunkCountY;
+    for (int i = 0; i < chunkCount; i++)
+        chunks[i].Dirty = true;
 }
-PUBLIC STATIC void Scene::UpdateTileBatch(int l, int batchx, int batchy) {
-    // if (!Scene::UseBatchedTiles)
-    //     return;
-
-    if (!Graphics::SupportsBatching || !Scene::TileSprite)
+PUBLIC STATIC void Scene::SetTileChunkDirty(int l, int x, int y) {
+    SceneLayer* layer = &Scene::Layers[l];
+    TileChunk* chunks = (TileChunk*)layer->TileChunks;
+    if (!chunks)
         return;
 
-    SceneLayer* layer = &Scene::Layers[l];
-    int batch_count_x = (layer->Width + TileBatchMaxSize - 1) / TileBatchMaxSize;
-    int batch_count_y = (layer->Height + TileBatchMaxSize - 1) / TileBatchMaxSize;
-    if (!layer->TileBatches) {
-        layer->TileBatches = Memory::Malloc(batch_count_x * batch_count_y * sizeof(TileBatch));
-    }
+    chunks[x / TILE_CHUNK_SIZE + (y / TILE_CHUNK_SIZE) * layer->TileChunkCountX].Dirty = true;
+}
+PUBLIC STATIC void Scene::UpdateTileChunk(SceneLayer* layer, int chunkX, int chunkY) {
+    TileChunk* chunk = &((TileChunk*)layer->TileChunks)[chunkX + chunkY * layer->TileChunkCountX];
 
     float spriteW = Scene::TileSprite->Spritesheets[0]->Width;
     float spriteH = Scene::TileSprite->Spritesheets[0]->Height;
     float tileSize = (float)Scene::TileSize;
 
-    struct tempVertex {
-        float x;
-        float y;
-        float z;
-        float u;
-        float v;
-    };
-    tempVertex* buffer = (tempVertex*)Memory::Malloc(TileBatchMaxSize * TileBatchMaxSize * sizeof(tempVertex) * 6);
-
     int    vertexCount = 0;
-    int    tStartX = batchx * TileBatchMaxSize;
-    int    tStartY = batchy * TileBatchMaxSize;
-    int    tEndX = tStartX + TileBatchMaxSize;
-    int    tEndY = tStartY + TileBatchMaxSize;
+    int    tStartX = chunkX * TILE_CHUNK_SIZE;
+    int    tStartY = chunkY * TILE_CHUNK_SIZE;
+    int    tEndX = tStartX + TILE_CHUNK_SIZE;
+    int    tEndY = tStartY + TILE_CHUNK_SIZE;
     int    tSauce, tileID, flipX, flipY, tx, ty, srcx, srcy;
     float  left, right, top, bottom, posX, posY, posXW, posYH;
 
@@ -2011,9 +1923,10 @@ PUBLIC STATIC void Scene::UpdateTileBatch(int l, int batchx, int batchy) {
     if (tEndY >= layer->Height)
         tEndY  = layer->Height;
 
-    for (tx = tStartX; tx < tEndX; tx++) {
-        int t = tx + tStartY * layer->Width;
-        for (ty = tStartY; ty < tEndY; t += layer->Width, ty++) {
+    TileChunkVertex* buffer = TileChunkVertices;
+    for (ty = tStartY; ty < tEndY; ty++) {
+        int t = tStartX + ty * layer->Width;
+        for (tx = tStartX; tx < tEndX; tx++, t++) {
             if ((layer->Tiles[t] & TILE_IDENT_MASK) == EmptyTile) continue;
 
             tSauce = layer->Tiles[t];
@@ -2047,22 +1960,105 @@ PUBLIC STATIC void Scene::UpdateTileBatch(int l, int batchx, int batchy) {
             posXW = posX + tileSize;
             posYH = posY + tileSize;
 
-            buffer[vertexCount++] = tempVertex { posX, posY, 0.0f, left, top };
-            buffer[vertexCount++] = tempVertex { posX, posYH, 0.0f, left, bottom };
-            buffer[vertexCount++] = tempVertex { posXW, posY, 0.0f, right, top };
+            buffer[vertexCount++] = TileChunkVertex { posX, posY, 0.0f, left, top };
+            buffer[vertexCount++] = TileChunkVertex { posX, posYH, 0.0f, left, bottom };
+            buffer[vertexCount++] = TileChunkVertex { posXW, posY, 0.0f, right, top };
 
-            buffer[vertexCount++] = tempVertex { posXW, posY, 0.0f, right, top };
-            buffer[vertexCount++] = tempVertex { posX, posYH, 0.0f, left, bottom };
-            buffer[vertexCount++] = tempVertex { posXW, posYH, 0.0f, right, bottom };
+            buffer[vertexCount++] = TileChunkVertex { posXW, posY, 0.0f, right, top };
+            buffer[vertexCount++] = TileChunkVertex { posX, posYH, 0.0f, left, bottom };
+            buffer[vertexCount++] = TileChunkVertex { posXW, posYH, 0.0f, right, bottom };
         }
     }
 
-    TileBatch* tileBatch = &((TileBatch*)layer->TileBatches)[batchx + batchy * batch_count_x];
-    tileBatch->BufferID = GLRenderer::CreateTexturedShapeBuffer((float*)buffer, vertexCount);
-    // tileBatch->BufferID = D3DRenderer::CreateTexturedShapeBuffer((float**)&buffer, vertexCount);
-    tileBatch->VertexCount = vertexCount;
+    // Reuse the chunk's buffer instead of making a new one every rebuild
+    if (chunk->BufferID)
+        GLRenderer::UpdateTexturedShapeBuffer(chunk->BufferID, (float*)buffer, vertexCount);
+    else if (vertexCount)
+        chunk->BufferID = GLRenderer::CreateTexturedShapeBuffer((float*)buffer, vertexCount);
+
+    chunk->VertexCount = vertexCount;
+    chunk->Dirty = false;
+}
+PUBLIC STATIC void Scene::RenderTileChunks(int l, View* currentView) {
+    SceneLayer* layer = &Scene::Layers[l];
+    if (layer->Width <= 0 || layer->Height <= 0)
+        return;
+
+    if (!layer->TileChunks) {
+        layer->TileChunkCountX = (layer->Width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+        layer->TileChunkCountY = (layer->Height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+        layer->TileChunks = Memory::TrackedCalloc("SceneLayer::TileChunks", layer->TileChunkCountX * layer->TileChunkCountY, sizeof(TileChunk));
+        Scene::SetTileChunksDirty(l);
+    }
+
+    TileChunk* chunks = (TileChunk*)layer->TileChunks;
+    Texture* texture = Scene::TileSprite->Spritesheets[0];
+    int tileSize = Scene::TileSize;
+
+    int baseXOff = (int)std::floor(currentView->X) + layer->OffsetX;
+    int baseYOff = (int)std::floor(currentView->Y) + layer->OffsetY;
+
+    // Visible tile range, as if the layer repeated forever
+    int startX = TileFloorDiv(baseXOff, tileSize);
+    int startY = TileFloorDiv(baseYOff, tileSize);
+    int endX = TileFloorDiv(baseXOff + (int)std::ceil(currentView->Width) - 1, tileSize) + 1;
+    int endY = TileFloorDiv(baseYOff + (int)std::ceil(currentView->Height) - 1, tileSize) + 1;
+
+    // Which repeats of the layer are on screen
+    int copyStartX = TileFloorDiv(startX, layer->Width);
+    int copyStartY = TileFloorDiv(startY, layer->Height);
+    int copyEndX = TileFloorDiv(endX - 1, layer->Width);
+    int copyEndY = TileFloorDiv(endY - 1, layer->Height);
+    if (layer->Flags & SceneLayer::FLAGS_NO_REPEAT_X) {
+        if (copyStartX < 0) copyStartX = 0;
+        if (copyEndX > 0) copyEndX = 0;
+    }
+    if (layer->Flags & SceneLayer::FLAGS_NO_REPEAT_Y) {
+        if (copyStartY < 0) copyStartY = 0;
+        if (copyEndY > 0) copyEndY = 0;
+    }
+
+    for (int copyY = copyStartY; copyY <= copyEndY; copyY++) {
+        int offY = copyY * layer->Height;
+        int y0 = startY - offY < 0 ? 0 : startY - offY;
+        int y1 = endY - offY > layer->Height ? layer->Height : endY - offY;
+        if (y0 >= y1)
+            continue;
+
+        for (int copyX = copyStartX; copyX <= copyEndX; copyX++) {
+            int offX = copyX * layer->Width;
+            int x0 = startX - offX < 0 ? 0 : startX - offX;
+            int x1 = endX - offX > layer->Width ? layer->Width : endX - offX;
+            if (x0 >= x1)
+                continue;
 
-    Memory::Free(buffer);
+            Graphics::Save();
+            Graphics::Translate(offX * tileSize - baseXOff, offY * tileSize - baseYOff, 0.0f);
+            for (int cy = y0 / TILE_CHUNK_SIZE; cy <= (y1 - 1) / TILE_CHUNK_SIZE; cy++) {
+                for (int cx = x0 / TILE_CHUNK_SIZE; cx <= (x1 - 1) / TILE_CHUNK_SIZE; cx++) {
+                    TileChunk* chunk = &chunks[cx + cy * layer->TileChunkCountX];
+                    if (chunk->Dirty)
+                        Scene::UpdateTileChunk(layer, cx, cy);
+                    if (chunk->VertexCount)
+                        GLRenderer::DrawTexturedShapeBuffer(texture, chunk->BufferID, chunk->VertexCount);
+                }
+            }
+            Graphics::Restore();
+        }
+    }
+}
+PUBLIC STATIC void Scene::DisposeTileChunks(SceneLayer* layer) {
+    TileChunk* chunks = (TileChunk*)layer->TileChunks;
+    if (!chunks)
+        return;
+
+    int chunkCount = layer->TileChunkCountX * layer->TileChunkCountY;
+    for (int i = 0; i < chunkCount; i++) {
+        if (chunks[i].BufferID)
+            GLRenderer::DisposeTexturedShapeBuffer(chunks[i].BufferID);
+    }
+    Memory::Free(chunks);
+    layer->TileChunks = NULL;
 }
 PUBLIC STATIC void Scene::SetTile(int layer, int x, int y, int tileID, int flip_x, int flip_y, int collA, int collB) {
     Uint32* tile = &Scene::Layers[layer].Tiles[x + y * Scene::Layers[layer].Width];
@@ -2075,7 +2071,7 @@ PUBLIC STATIC void Scene::SetTile(int layer, int x, int y, int tileID, int flip_
     *tile |= collA << 28;
     *tile |= collB << 26;
 
-    UpdateTileBatch(layer, x / TileBatchMaxSize, y / TileBatchMaxSize);
+    Scene::SetTileChunkDirty(layer, x, y);
 }
 
 // Tile Collision
@@ -61,6 +61,7 @@ public:
 
     Entity*      PrevEntity = NULL;
     Entity*      NextEntity = NULL;
+    int          SceneIndex = -1;
 
     ObjectList*  List = NULL;
     Entity*      PrevEntityInList = NULL;
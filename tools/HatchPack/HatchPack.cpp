@@ -0,0 +1,336 @@
+// HatchPack: packs a resource folder into a version 2 HATCH data file.
+//
+// Build:
+//   g++ -O2 -std=c++11 -o HatchPack HatchPack.cpp -lz
+// Optional codecs (the engine must be built with the same defines to
+// read them back):
+//   -DUSING_LZ4 -llz4
+//   -DUSING_ZSTD -lzstd
+//
+// Usage:
+//   HatchPack <resource folder> <output file> [-codec none|zlib|lz4|zstd|auto] [-block <KiB>]
+//
+// Layout (all values little-endian):
+//   Header (32 bytes)
+//     "HATCH", Uint8 major (2), Uint8 minor (0), Uint8 pad
+//     Uint32 entryCount, Uint32 blockCount, Uint32 blockSize, Uint32 reserved
+//     Uint64 indexOffset
+//   Block data
+//   Index at indexOffset
+//     entryCount entries sorted by CRC32 (24 bytes each)
+//       Uint32 crc32, Uint32 firstBlock, Uint32 blockCount, Uint32 flags, Uint64 size
+//     blockCount blocks (20 bytes each)
+//       Uint64 offset, Uint32 compressedSize, Uint32 size, Uint8 codec, Uint8 pad[3]
+//
+// Every block but the last of an entry holds exactly blockSize bytes of
+// the entry, and is compressed on its own so it can be decoded without
+// the blocks before it.
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <zlib.h>
+#ifdef USING_LZ4
+    #include <lz4.h>
+    #include <lz4hc.h>
+#endif
+#ifdef USING_ZSTD
+    #include <zstd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+// Must match CompressionCodec in the engine
+enum {
+    CODEC_NONE = 0,
+    CODEC_ZLIB = 1,
+    CODEC_LZ4  = 2,
+    CODEC_ZSTD = 3,
+    CODEC_AUTO = 0xFF,
+};
+
+struct PackBlock {
+    uint64_t Offset;
+    uint32_t CompressedSize;
+    uint32_t Size;
+    uint8_t  Codec;
+};
+struct PackEntry {
+    string   Path;
+    uint32_t CRC32;
+    uint32_t FirstBlock;
+    uint32_t BlockCount;
+    uint64_t Size;
+};
+
+// Same as CRC32::EncryptString in the engine
+uint32_t HashPath(const char* path) {
+    uint32_t crc = 0xFFFFFFFFU;
+    for (const uint8_t* p = (const uint8_t*)path; *p; p++) {
+        crc ^= *p;
+        for (int j = 7; j >= 0; j--)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+void ListFiles(const string& root, const string& relative, vector<string>* out) {
+    string path = relative.empty() ? root : root + "/" + relative;
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+        return;
+
+    struct dirent* ent;
+    while ((ent = readdir(dir))) {
+        if (ent->d_name[0] == '.')
+            continue;
+
+        string child = relative.empty() ? string(ent->d_name) : relative + "/" + ent->d_name;
+        string full = root + "/" + child;
+
+        struct stat st;
+        if (stat(full.c_str(), &st) != 0)
+            continue;
+
+        if (S_ISDIR(st.st_mode))
+            ListFiles(root, child, out);
+        else if (S_ISREG(st.st_mode))
+            out->push_back(child);
+    }
+    closedir(dir);
+}
+
+bool ReadFile(const string& path, vector<uint8_t>* out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    out->resize(size);
+    bool success = size == 0 || fread(&(*out)[0], size, 1, f) == 1;
+    fclose(f);
+    return success;
+}
+
+// Returns the compressed size, or 0 if the codec is unavailable or fails
+size_t CompressBlock(int codec, const uint8_t* src, size_t size, vector<uint8_t>* out) {
+    switch (codec) {
+        case CODEC_ZLIB: {
+            uLongf len = compressBound(size);
+            out->resize(len);
+            if (compress2(&(*out)[0], &len, src, size, 9) != Z_OK)
+                return 0;
+            return len;
+        }
+        #ifdef USING_LZ4
+        case CODEC_LZ4: {
+            out->resize(LZ4_compressBound((int)size));
+            int len = LZ4_compress_HC((const char*)src, (char*)&(*out)[0], (int)size, (int)out->size(), LZ4HC_CLEVEL_MAX);
+            return len > 0 ? len : 0;
+        }
+        #endif
+        #ifdef USING_ZSTD
+        case CODEC_ZSTD: {
+            out->resize(ZSTD_compressBound(size));
+            size_t len = ZSTD_compress(&(*out)[0], out->size(), src, size, 19);
+            return ZSTD_isError(len) ? 0 : len;
+        }
+        #endif
+    }
+    return 0;
+}
+
+void WriteU8(FILE* f, uint8_t v) {
+    fwrite(&v, 1, 1, f);
+}
+void WriteU32(FILE* f, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        WriteU8(f, (v >> (i * 8)) & 0xFF);
+}
+void WriteU64(FILE* f, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        WriteU8(f, (v >> (i * 8)) & 0xFF);
+}
+
+int ParseCodec(const char* name) {
+    if (!strcmp(name, "none")) return CODEC_NONE;
+    if (!strcmp(name, "zlib")) return CODEC_ZLIB;
+    if (!strcmp(name, "lz4"))  return CODEC_LZ4;
+    if (!strcmp(name, "zstd")) return CODEC_ZSTD;
+    if (!strcmp(name, "auto")) return CODEC_AUTO;
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("Usage: %s <resource folder> <output file> [-codec none|zlib|lz4|zstd|auto] [-block <KiB>]\n", argv[0]);
+        return 1;
+    }
+
+    const char* inputFolder = argv[1];
+    const char* outputFile = argv[2];
+    int codec = CODEC_AUTO;
+    uint32_t blockSize = 64 * 1024;
+
+    for (int i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "-codec") && i + 1 < argc) {
+            codec = ParseCodec(argv[++i]);
+            if (codec < 0) {
+                printf("Unknown codec \"%s\"!\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-block") && i + 1 < argc) {
+            blockSize = (uint32_t)atoi(argv[++i]) * 1024;
+            if (blockSize == 0) {
+                printf("Invalid block size!\n");
+                return 1;
+            }
+        }
+        else {
+            printf("Unknown option \"%s\"!\n", argv[i]);
+            return 1;
+        }
+    }
+
+    #ifndef USING_LZ4
+    if (codec == CODEC_LZ4) {
+        printf("HatchPack was built without LZ4 support!\n");
+        return 1;
+    }
+    #endif
+    #ifndef USING_ZSTD
+    if (codec == CODEC_ZSTD) {
+        printf("HatchPack was built without zstd support!\n");
+        return 1;
+    }
+    #endif
+
+    vector<string> files;
+    ListFiles(inputFolder, "", &files);
+    std::sort(files.begin(), files.end());
+
+    FILE* out = fopen(outputFile, "wb");
+    if (!out) {
+        printf("Could not open \"%s\" for writing!\n", outputFile);
+        return 1;
+    }
+
+    // Header is written again once the index offset is known
+    for (int i = 0; i < 32; i++)
+        WriteU8(out, 0);
+
+    vector<PackEntry> entries;
+    vector<PackBlock> blocks;
+    vector<uint8_t> data, best, scratch;
+    uint64_t offset = 32, totalSize = 0;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!ReadFile(string(inputFolder) + "/" + files[i], &data)) {
+            printf("Could not read \"%s\"!\n", files[i].c_str());
+            fclose(out);
+            return 1;
+        }
+
+        PackEntry entry;
+        entry.Path = files[i];
+        entry.CRC32 = HashPath(files[i].c_str());
+        entry.FirstBlock = (uint32_t)blocks.size();
+        entry.BlockCount = 0;
+        entry.Size = data.size();
+
+        for (size_t start = 0; start < data.size(); start += blockSize) {
+            const uint8_t* src = &data[start];
+            size_t size = std::min((size_t)blockSize, data.size() - start);
+
+            // Keep whichever codec does best, and store the block as-is
+            //   if none of them make it smaller.
+            PackBlock block;
+            block.Codec = CODEC_NONE;
+            block.Size = (uint32_t)size;
+            block.CompressedSize = (uint32_t)size;
+
+            for (int c = CODEC_ZLIB; c <= CODEC_ZSTD; c++) {
+                if (codec != CODEC_AUTO && codec != c)
+                    continue;
+
+                size_t len = CompressBlock(c, src, size, &scratch);
+                if (len && len < block.CompressedSize) {
+                    block.Codec = (uint8_t)c;
+                    block.CompressedSize = (uint32_t)len;
+                    best.swap(scratch);
+                }
+            }
+
+            block.Offset = offset;
+            if (block.Codec == CODEC_NONE)
+                fwrite(src, 1, size, out);
+            else
+                fwrite(&best[0], 1, block.CompressedSize, out);
+
+            offset += block.CompressedSize;
+            blocks.push_back(block);
+            entry.BlockCount++;
+        }
+
+        totalSize += entry.Size;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const PackEntry& a, const PackEntry& b) -> bool {
+        return a.CRC32 < b.CRC32;
+    });
+    for (size_t i = 1; i < entries.size(); i++) {
+        if (entries[i].CRC32 == entries[i - 1].CRC32) {
+            printf("\"%s\" and \"%s\" have the same hash!\n", entries[i - 1].Path.c_str(), entries[i].Path.c_str());
+            fclose(out);
+            return 1;
+        }
+    }
+
+    uint64_t indexOffset = offset;
+    for (size_t i = 0; i < entries.size(); i++) {
+        WriteU32(out, entries[i].CRC32);
+        WriteU32(out, entries[i].FirstBlock);
+        WriteU32(out, entries[i].BlockCount);
+        WriteU32(out, 0);
+        WriteU64(out, entries[i].Size);
+    }
+    for (size_t i = 0; i < blocks.size(); i++) {
+        WriteU64(out, blocks[i].Offset);
+        WriteU32(out, blocks[i].CompressedSize);
+        WriteU32(out, blocks[i].Size);
+        WriteU8(out, blocks[i].Codec);
+        WriteU8(out, 0);
+        WriteU8(out, 0);
+        WriteU8(out, 0);
+    }
+
+    fseek(out, 0, SEEK_SET);
+    fwrite("HATCH", 1, 5, out);
+    WriteU8(out, 2);
+    WriteU8(out, 0);
+    WriteU8(out, 0);
+    WriteU32(out, (uint32_t)entries.size());
+    WriteU32(out, (uint32_t)blocks.size());
+    WriteU32(out, blockSize);
+    WriteU32(out, 0);
+    WriteU64(out, indexOffset);
+    fclose(out);
+
+    printf("Packed %d files (%llu bytes) into %llu bytes in %d blocks.\n",
+        (int)entries.size(), (unsigned long long)totalSize, (unsigned long long)indexOffset, (int)blocks.size());
+    return 0;
+}